@@ -24,7 +24,9 @@ namespace Coffee {
         float BlendTime = 0.0f; ///< Time duration for blending between animations.
         float AnimationTime = 0.0f; ///< Current time position in the current animation.
         float NextAnimationTime = 0.0f; ///< Current time position in the next animation.
+        unsigned int ContextSlot = 0; ///< The sampling context of the current animation, the other one samples the next animation.
         std::vector<ozz::math::SoaTransform> LocalTransforms; ///< Local transforms for the animation joints.
+        std::vector<ozz::math::SoaTransform> NextTransforms; ///< Local transforms of the next animation while blending, reused every frame.
         std::vector<ozz::math::SimdFloat4> JointWeights; ///< Weights for blending animation joints.
 
         template<class Archive> void serialize(Archive& archive, std::uint32_t const version);
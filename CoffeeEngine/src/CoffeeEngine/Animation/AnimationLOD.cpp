@@ -0,0 +1,59 @@
+#include "AnimationLOD.h"
+
+#include <algorithm>
+
+namespace Coffee {
+
+    AnimationLODLevel AnimationLOD::SelectLevel(const AnimationLODSettings& settings, float distance, bool visible)
+    {
+        if (!settings.Enabled)
+            return AnimationLODLevel::Full;
+
+        if (!visible && settings.PauseWhenCulled)
+            return AnimationLODLevel::Paused;
+
+        if (distance >= settings.LowRateDistance)
+            return AnimationLODLevel::Low;
+
+        if (distance >= settings.ReducedRateDistance)
+            return AnimationLODLevel::Reduced;
+
+        return AnimationLODLevel::Full;
+    }
+
+    uint32_t AnimationLOD::GetUpdateInterval(const AnimationLODSettings& settings, AnimationLODLevel level)
+    {
+        switch (level)
+        {
+            case AnimationLODLevel::Full: return 1;
+            case AnimationLODLevel::Reduced: return std::max(settings.ReducedRateInterval, 1u);
+            case AnimationLODLevel::Low: return std::max(settings.LowRateInterval, 1u);
+            case AnimationLODLevel::Paused: return 0;
+        }
+        return 1;
+    }
+
+    AnimationLODDecision AnimationLOD::Schedule(const AnimationLODSettings& settings, AnimationLODState& state, uint64_t frameIndex, float deltaTime)
+    {
+        AnimationLODLevel level = SelectLevel(settings, state.Distance, state.Visible);
+        uint32_t interval = GetUpdateInterval(settings, level);
+
+        // Getting more detailed shows at once, like an animator coming into view
+        bool refined = level < state.Level;
+        state.Level = level;
+        state.PendingTime += deltaTime;
+
+        AnimationLODDecision decision;
+        decision.FullBody = level < AnimationLODLevel::Low;
+        decision.Evaluate = interval != 0 && (refined || (frameIndex + state.Phase) % interval == 0);
+
+        if (decision.Evaluate)
+        {
+            decision.DeltaTime = state.PendingTime;
+            state.PendingTime = 0.0f;
+        }
+
+        return decision;
+    }
+
+}
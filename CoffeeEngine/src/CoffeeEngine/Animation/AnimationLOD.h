@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cereal/cereal.hpp>
+
+#include <cstdint>
+#include <limits>
+
+namespace Coffee {
+
+    /**
+     * @brief The level of detail an animator is updated at.
+     */
+    enum class AnimationLODLevel : uint8_t
+    {
+        Full,    ///< Every frame, with partial body blending.
+        Reduced, ///< Every few frames, with partial body blending.
+        Low,     ///< Every few more frames, with the lower body layer only.
+        Paused   ///< Not evaluated, the pose is held until the animator is visible again.
+    };
+
+    /**
+     * @brief The animation level of detail settings of an animator.
+     */
+    struct AnimationLODSettings
+    {
+        bool Enabled = false; ///< Whether the animator is throttled, otherwise it is updated every frame.
+        float ReducedRateDistance = 20.0f; ///< From this distance to the camera the animator uses the Reduced level.
+        uint32_t ReducedRateInterval = 2; ///< The frames between two updates at the Reduced level.
+        float LowRateDistance = 50.0f; ///< From this distance to the camera the animator uses the Low level.
+        uint32_t LowRateInterval = 4; ///< The frames between two updates at the Low level.
+        bool PauseWhenCulled = true; ///< Whether the animator pauses when none of its meshes is visible.
+
+        template<class Archive> void serialize(Archive& archive, std::uint32_t const version);
+    };
+
+    /**
+     * @brief The animation level of detail state of an animator, not serialized.
+     */
+    struct AnimationLODState
+    {
+        float Distance = 0.0f; ///< Input: the distance from the camera to the closest mesh of the animator.
+        bool Visible = true; ///< Input: whether a mesh of the animator is visible.
+
+        AnimationLODLevel Level = AnimationLODLevel::Full; ///< The level of the last frame.
+        uint32_t Phase = std::numeric_limits<uint32_t>::max(); ///< Offsets the update frames, so throttled animators do not all update on the same frame.
+        float PendingTime = 0.0f; ///< The time elapsed since the last update.
+    };
+
+    /**
+     * @brief What to do with an animator in the current frame.
+     */
+    struct AnimationLODDecision
+    {
+        bool Evaluate = true; ///< Whether to update the animator.
+        float DeltaTime = 0.0f; ///< The time to advance the animator by, everything elapsed since its last update.
+        bool FullBody = true; ///< Whether to blend the upper body layer.
+    };
+
+    /**
+     * @class AnimationLOD
+     * @brief Decides which animators are updated each frame from their distance to the camera and visibility.
+     *
+     * Throttled animators skip frames and hold their pose. The skipped time is not lost: it accumulates and the
+     * next update advances the animator by all of it, so the clips stay in sync with an unthrottled animator.
+     *
+     * The decisions only depend on the settings, the inputs and the frame index, there is no rendering involved.
+     */
+    class AnimationLOD
+    {
+    public:
+        /**
+         * @brief Selects the level of an animator.
+         * @param settings The settings of the animator.
+         * @param distance The distance from the camera to the animator.
+         * @param visible Whether the animator is visible.
+         * @return The level to update the animator at.
+         */
+        static AnimationLODLevel SelectLevel(const AnimationLODSettings& settings, float distance, bool visible);
+
+        /**
+         * @brief Gets the frames between two updates at a level.
+         * @param settings The settings of the animator.
+         * @param level The level.
+         * @return The interval, 1 for every frame and 0 for never.
+         */
+        static uint32_t GetUpdateInterval(const AnimationLODSettings& settings, AnimationLODLevel level);
+
+        /**
+         * @brief Decides whether to update an animator this frame.
+         * @param settings The settings of the animator.
+         * @param state The state of the animator, its inputs must be set for this frame.
+         * @param frameIndex The index of the frame, increasing by one every frame.
+         * @param deltaTime The time elapsed since the last frame.
+         * @return The decision for this frame.
+         */
+        static AnimationLODDecision Schedule(const AnimationLODSettings& settings, AnimationLODState& state, uint64_t frameIndex, float deltaTime);
+    };
+
+    template<class Archive>
+    void AnimationLODSettings::serialize(Archive& archive, std::uint32_t const version)
+    {
+        archive(cereal::make_nvp("Enabled", Enabled),
+                cereal::make_nvp("ReducedRateDistance", ReducedRateDistance),
+                cereal::make_nvp("ReducedRateInterval", ReducedRateInterval),
+                cereal::make_nvp("LowRateDistance", LowRateDistance),
+                cereal::make_nvp("LowRateInterval", LowRateInterval),
+                cereal::make_nvp("PauseWhenCulled", PauseWhenCulled));
+    }
+
+}
+
+CEREAL_CLASS_VERSION(Coffee::AnimationLODSettings, 0);
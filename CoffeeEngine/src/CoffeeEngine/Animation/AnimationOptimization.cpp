@@ -0,0 +1,164 @@
+#include "AnimationOptimization.h"
+
+#include "CoffeeEngine/Core/Hash.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <ozz/animation/offline/animation_builder.h>
+#include <ozz/animation/offline/animation_optimizer.h>
+#include <ozz/animation/runtime/local_to_model_job.h>
+#include <ozz/animation/runtime/sampling_job.h>
+#include <ozz/base/maths/simd_math.h>
+#include <ozz/base/maths/soa_transform.h>
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace Coffee {
+
+    uint64_t AnimationOptimizationSettings::GetHash() const
+    {
+        auto hashTolerance = [](const AnimationJointTolerance& tolerance, uint64_t seed) {
+            seed = Hash::FNV1a(&tolerance.Tolerance, sizeof(tolerance.Tolerance), seed);
+            return Hash::FNV1a(&tolerance.Distance, sizeof(tolerance.Distance), seed);
+        };
+
+        uint64_t hash = Hash::FNV1a(&Enabled, sizeof(Enabled));
+        hash = hashTolerance(Default, hash);
+
+        // std::map iterates in key order, the hash does not depend on the insertion order
+        for (const auto& [jointName, tolerance] : JointOverrides)
+        {
+            hash = Hash::FNV1a(jointName, hash);
+            hash = hashTolerance(tolerance, hash);
+        }
+        return hash;
+    }
+
+    ozz::unique_ptr<ozz::animation::Animation> AnimationOptimization::Build(const ozz::animation::offline::RawAnimation& rawAnimation,
+                                                                             const ozz::animation::Skeleton& skeleton,
+                                                                             const std::map<std::string, int>& jointIndices,
+                                                                             const AnimationOptimizationSettings& settings,
+                                                                             AnimationOptimizationReport& report)
+    {
+        ZoneScoped;
+
+        ozz::animation::offline::AnimationBuilder builder;
+        ozz::unique_ptr<ozz::animation::Animation> animation = builder(rawAnimation);
+        if (!animation)
+            return nullptr;
+
+        report.Name = rawAnimation.name.c_str();
+        report.KeysBefore = report.KeysAfter = CountKeys(rawAnimation);
+        report.BytesBefore = report.BytesAfter = animation->size();
+        report.MaxError = 0.0f;
+
+        if (!settings.Enabled)
+            return animation;
+
+        ozz::animation::offline::AnimationOptimizer optimizer;
+        optimizer.setting = ozz::animation::offline::AnimationOptimizer::Setting(settings.Default.Tolerance, settings.Default.Distance);
+
+        for (const auto& [jointName, tolerance] : settings.JointOverrides)
+        {
+            auto it = jointIndices.find(jointName);
+            if (it == jointIndices.end())
+            {
+                COFFEE_CORE_WARN("Animation optimization: joint {0} of the overrides is not in the skeleton", jointName);
+                continue;
+            }
+            optimizer.joints_setting_override[it->second] = ozz::animation::offline::AnimationOptimizer::Setting(tolerance.Tolerance, tolerance.Distance);
+        }
+
+        ozz::animation::offline::RawAnimation optimizedRawAnimation;
+        if (!optimizer(rawAnimation, skeleton, &optimizedRawAnimation))
+        {
+            COFFEE_CORE_WARN("Animation optimization: failed to optimize {0}, keeping every keyframe", report.Name);
+            return animation;
+        }
+
+        ozz::unique_ptr<ozz::animation::Animation> optimizedAnimation = builder(optimizedRawAnimation);
+        if (!optimizedAnimation)
+            return animation;
+
+        // An error that can not be measured is not known to be within the tolerance
+        float maxError = MeasureError(skeleton, *animation, *optimizedAnimation);
+        if (maxError < 0.0f)
+        {
+            COFFEE_CORE_WARN("Animation optimization: failed to measure the error of {0}, keeping every keyframe", report.Name);
+            return animation;
+        }
+
+        report.KeysAfter = CountKeys(optimizedRawAnimation);
+        report.BytesAfter = optimizedAnimation->size();
+        report.MaxError = maxError;
+
+        return optimizedAnimation;
+    }
+
+    float AnimationOptimization::MeasureError(const ozz::animation::Skeleton& skeleton, const ozz::animation::Animation& reference,
+                                              const ozz::animation::Animation& animation)
+    {
+        ZoneScoped;
+
+        const int numJoints = skeleton.num_joints();
+        const int numSoaJoints = skeleton.num_soa_joints();
+
+        // One context per animation, a context caches the keys of the last animation it sampled
+        ozz::animation::SamplingJob::Context referenceContext(numJoints);
+        ozz::animation::SamplingJob::Context animationContext(numJoints);
+
+        std::vector<ozz::math::SoaTransform> localTransforms(numSoaJoints);
+        std::vector<ozz::math::Float4x4> referenceModels(numJoints);
+        std::vector<ozz::math::Float4x4> animationModels(numJoints);
+
+        auto samplePose = [&](const ozz::animation::Animation& source, ozz::animation::SamplingJob::Context& context, float ratio,
+                              std::vector<ozz::math::Float4x4>& output) {
+            ozz::animation::SamplingJob samplingJob;
+            samplingJob.animation = &source;
+            samplingJob.context = &context;
+            samplingJob.ratio = ratio;
+            samplingJob.output = ozz::make_span(localTransforms);
+
+            ozz::animation::LocalToModelJob localToModelJob;
+            localToModelJob.skeleton = &skeleton;
+            localToModelJob.input = ozz::make_span(localTransforms);
+            localToModelJob.output = ozz::make_span(output);
+
+            return samplingJob.Run() && localToModelJob.Run();
+        };
+
+        const int steps = std::max(1, (int)std::ceil(reference.duration() * ErrorSampleRate));
+        float maxError = 0.0f;
+
+        for (int step = 0; step <= steps; step++)
+        {
+            float ratio = (float)step / steps;
+            if (!samplePose(reference, referenceContext, ratio, referenceModels) || !samplePose(animation, animationContext, ratio, animationModels))
+                return MeasureFailed;
+
+            for (int joint = 0; joint < numJoints; joint++)
+            {
+                float a[4], b[4];
+                ozz::math::StorePtrU(referenceModels[joint].cols[3], a);
+                ozz::math::StorePtrU(animationModels[joint].cols[3], b);
+
+                float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+                maxError = std::max(maxError, std::sqrt(dx * dx + dy * dy + dz * dz));
+            }
+        }
+
+        return maxError;
+    }
+
+    uint32_t AnimationOptimization::CountKeys(const ozz::animation::offline::RawAnimation& rawAnimation)
+    {
+        uint32_t keys = 0;
+        for (const auto& track : rawAnimation.tracks)
+            keys += (uint32_t)(track.translations.size() + track.rotations.size() + track.scales.size());
+        return keys;
+    }
+
+}
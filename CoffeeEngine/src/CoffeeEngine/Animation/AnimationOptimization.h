@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+
+#include <ozz/animation/offline/raw_animation.h>
+#include <ozz/animation/runtime/animation.h>
+#include <ozz/animation/runtime/skeleton.h>
+#include <ozz/base/memory/unique_ptr.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace Coffee {
+
+    /**
+     * @brief Error tolerance of the keyframe optimization for one joint.
+     */
+    struct AnimationJointTolerance
+    {
+        float Tolerance = 1e-3f; ///< Maximum error introduced by the optimization, in meters.
+        float Distance = 0.1f; ///< Distance from the joint the error is measured at, in meters. Larger for joints driving long limbs.
+
+        template<class Archive>
+        void serialize(Archive& archive, std::uint32_t const version)
+        {
+            archive(CEREAL_NVP(Tolerance), CEREAL_NVP(Distance));
+        }
+    };
+
+    /**
+     * @brief Settings of the keyframe optimization run when the animations of a model are imported.
+     */
+    struct AnimationOptimizationSettings
+    {
+        bool Enabled = true; ///< Remove the keyframes that can be interpolated from their neighbours.
+        AnimationJointTolerance Default; ///< Tolerance of the joints without an override.
+        std::map<std::string, AnimationJointTolerance> JointOverrides; ///< Tolerances of specific joints, by name.
+
+        /**
+         * @brief Hashes the settings, the optimized animations change whenever this hash changes.
+         * @return The 64-bit hash.
+         */
+        uint64_t GetHash() const;
+
+        template<class Archive>
+        void serialize(Archive& archive, std::uint32_t const version)
+        {
+            archive(CEREAL_NVP(Enabled), CEREAL_NVP(Default), CEREAL_NVP(JointOverrides));
+        }
+    };
+
+    /**
+     * @brief Report of the keyframe optimization of an animation.
+     */
+    struct AnimationOptimizationReport
+    {
+        std::string Name; ///< Name of the animation.
+        uint32_t KeysBefore = 0; ///< Keyframes of the animation as imported.
+        uint32_t KeysAfter = 0; ///< Keyframes of the optimized animation.
+        uint64_t BytesBefore = 0; ///< Runtime size of the animation as imported.
+        uint64_t BytesAfter = 0; ///< Runtime size of the optimized animation.
+        float MaxError = 0.0f; ///< Largest distance between a joint of both animations in model space, in meters.
+    };
+
+    /**
+     * @brief Import-time keyframe optimization of the animations.
+     *
+     * Clips are usually baked at a fixed rate with many redundant keys. The optimizer removes the keys whose
+     * removal keeps the hierarchical error of every joint under its tolerance, which reduces the memory of the
+     * animation and the keys the sampling job walks through.
+     */
+    class AnimationOptimization
+    {
+    public:
+        static constexpr float ErrorSampleRate = 30.0f; ///< Samples per second used to measure the error of an optimized animation.
+        static constexpr float MeasureFailed = -1.0f; ///< Returned by MeasureError when an animation can not be sampled on the skeleton.
+
+        /**
+         * @brief Builds the runtime animation of a raw animation, optimized if the settings enable it.
+         * @param rawAnimation The raw animation, one track per joint of the skeleton.
+         * @param skeleton The skeleton the animation is played on.
+         * @param jointIndices The index of each joint by name, used to resolve the joint overrides.
+         * @param settings The optimization settings.
+         * @param report Receives the sizes and the error of the optimization.
+         * @return The runtime animation, null if the animation could not be built. The animation as imported is returned
+         *         when the optimization fails or its error can not be measured.
+         */
+        static ozz::unique_ptr<ozz::animation::Animation> Build(const ozz::animation::offline::RawAnimation& rawAnimation,
+                                                                 const ozz::animation::Skeleton& skeleton,
+                                                                 const std::map<std::string, int>& jointIndices,
+                                                                 const AnimationOptimizationSettings& settings,
+                                                                 AnimationOptimizationReport& report);
+
+        /**
+         * @brief Measures the largest distance between the joints of two animations, in model space.
+         * @param skeleton The skeleton both animations are played on.
+         * @param reference The reference animation.
+         * @param animation The animation to compare with the reference.
+         * @return The largest distance found, in meters, or MeasureFailed if an animation could not be sampled.
+         */
+        static float MeasureError(const ozz::animation::Skeleton& skeleton, const ozz::animation::Animation& reference,
+                                  const ozz::animation::Animation& animation);
+
+        /**
+         * @brief Counts the keyframes of a raw animation.
+         * @param rawAnimation The raw animation.
+         * @return The translation, rotation and scale keys of every track.
+         */
+        static uint32_t CountKeys(const ozz::animation::offline::RawAnimation& rawAnimation);
+    };
+
+}
+
+CEREAL_CLASS_VERSION(Coffee::AnimationJointTolerance, 0);
+CEREAL_CLASS_VERSION(Coffee::AnimationOptimizationSettings, 0);
@@ -3,24 +3,198 @@
 
 #define BT_NO_SIMD_OPERATOR_OVERLOADS
 
+#include "CoffeeEngine/Animation/AnimationLOD.h"
+#include "CoffeeEngine/Core/Hash.h"
+#include "CoffeeEngine/Core/JobSystem.h"
 #include "CoffeeEngine/Renderer/Model.h"
 #include "CoffeeEngine/IO/ResourceRegistry.h"
 #include "CoffeeEngine/Renderer/Shader.h"
 #include "CoffeeEngine/Scene/Components/AnimatorComponent.h"
 #include "ozz/animation/runtime/skeleton_utils.h"
 
+#include <tracy/Tracy.hpp>
+
+#include <cmath>
+#include <limits>
+
 namespace Coffee {
 
     std::vector<AnimatorComponent*> AnimationSystem::m_Animators;
+    std::vector<AnimationSystem::ScheduledAnimator> AnimationSystem::s_Scheduled;
+    std::vector<uint32_t> AnimationSystem::s_SharedPoseOrder;
+    float AnimationSystem::s_PoseSharingTimeStep = 1.0f / 30.0f;
+    uint64_t AnimationSystem::s_FrameIndex = 0;
+    uint32_t AnimationSystem::s_NextLODPhase = 0;
+    AnimationStats AnimationSystem::s_Stats;
+
+    void AnimationSystem::Update(float deltaTime, AnimatorComponent* animator, bool fullBody)
+    {
+        if (AdvanceTimes(deltaTime, animator))
+            UpdatePartialBlending(animator, fullBody);
+    }
 
-    void AnimationSystem::Update(float deltaTime, AnimatorComponent* animator)
+    void AnimationSystem::UpdateAll(std::span<AnimatorComponent* const> animators, float deltaTime)
     {
-        Ref<Skeleton> animatorSkeleton = animator->GetSkeleton();
+        ZoneScoped;
 
-        UpdateBlending(deltaTime * animator->AnimationSpeed, animator, animator->UpperAnimation.get());
-        UpdateBlending(deltaTime * animator->AnimationSpeed, animator, animator->LowerAnimation.get());
+        s_Stats.Reset();
+        s_Stats.Animators = (uint32_t)animators.size();
+
+        // Scheduled here, in the order of the batch, so the decisions do not depend on the workers
+        s_Scheduled.clear();
+        for (AnimatorComponent* animator : animators)
+        {
+            // Components copied or loaded before their model was assigned have nothing to animate
+            if (!animator->GetSkeleton() || !animator->UpperAnimation || !animator->LowerAnimation)
+                continue;
+
+            AnimationLODState& state = animator->LODState;
+            if (state.Phase == std::numeric_limits<uint32_t>::max())
+                state.Phase = s_NextLODPhase++;
+
+            AnimationLODDecision decision = AnimationLOD::Schedule(animator->LOD, state, s_FrameIndex, deltaTime);
+            if (decision.Evaluate)
+                s_Scheduled.push_back({animator, decision.DeltaTime, decision.FullBody});
+            else if (state.Level == AnimationLODLevel::Paused)
+                s_Stats.Paused++;
+            else
+                s_Stats.Throttled++;
+        }
+
+        s_Stats.Evaluated = (uint32_t)s_Scheduled.size();
+        s_FrameIndex++;
+
+        // A skinned character takes tens of microseconds, a few per range keeps the scheduling overhead small
+        constexpr uint32_t AnimatorsPerJob = 4;
+
+        // The times advance on their own first, the pose keys depend on them
+        JobSystem::ParallelFor((uint32_t)s_Scheduled.size(), AnimatorsPerJob * 4, [](uint32_t begin, uint32_t end) {
+            ZoneScopedN("AnimationSystem::UpdateAll Advance");
+
+            for (uint32_t i = begin; i < end; i++)
+            {
+                ScheduledAnimator& scheduled = s_Scheduled[i];
+                if (!AdvanceTimes(scheduled.DeltaTime, scheduled.Animator))
+                    continue;
+
+                scheduled.PoseSource = i;
+                if (scheduled.Animator->SharePose)
+                {
+                    scheduled.Key = MakePoseKey(scheduled.Animator, scheduled.FullBody);
+                    scheduled.PoseHash = scheduled.Key.GetHash();
+                }
+            }
+        });
+
+        // Sorted by key, the animators with the same pose are next to each other and the first one evaluates it
+        s_SharedPoseOrder.clear();
+        for (uint32_t i = 0; i < s_Scheduled.size(); i++)
+        {
+            if (s_Scheduled[i].PoseSource != InvalidPose && s_Scheduled[i].Animator->SharePose)
+                s_SharedPoseOrder.push_back(i);
+        }
+
+        std::sort(s_SharedPoseOrder.begin(), s_SharedPoseOrder.end(), [](uint32_t a, uint32_t b) {
+            return s_Scheduled[a].PoseHash != s_Scheduled[b].PoseHash ? s_Scheduled[a].PoseHash < s_Scheduled[b].PoseHash : a < b;
+        });
+
+        for (size_t i = 1; i < s_SharedPoseOrder.size(); i++)
+        {
+            const ScheduledAnimator& previous = s_Scheduled[s_SharedPoseOrder[i - 1]];
+            ScheduledAnimator& current = s_Scheduled[s_SharedPoseOrder[i]];
 
-        UpdatePartialBlending(deltaTime, animator);
+            // A hash collision between different keys only costs an evaluation
+            if (current.PoseHash == previous.PoseHash && current.Key == s_Scheduled[previous.PoseSource].Key)
+            {
+                current.PoseSource = previous.PoseSource;
+                s_Stats.PoseCacheHits++;
+            }
+        }
+        s_Stats.PoseCacheLookups = (uint32_t)s_SharedPoseOrder.size();
+
+        JobSystem::ParallelFor((uint32_t)s_Scheduled.size(), AnimatorsPerJob, [](uint32_t begin, uint32_t end) {
+            ZoneScopedN("AnimationSystem::UpdateAll Range");
+
+            for (uint32_t i = begin; i < end; i++)
+            {
+                if (s_Scheduled[i].PoseSource == i)
+                    UpdatePartialBlending(s_Scheduled[i].Animator, s_Scheduled[i].FullBody);
+            }
+        });
+
+        if (s_Stats.PoseCacheHits == 0)
+            return;
+
+        // Same skeleton, same number of joint matrices: the copies do not allocate
+        JobSystem::ParallelFor((uint32_t)s_Scheduled.size(), AnimatorsPerJob * 4, [](uint32_t begin, uint32_t end) {
+            ZoneScopedN("AnimationSystem::UpdateAll Shared Poses");
+
+            for (uint32_t i = begin; i < end; i++)
+            {
+                const ScheduledAnimator& scheduled = s_Scheduled[i];
+                if (scheduled.PoseSource != i && scheduled.PoseSource != InvalidPose)
+                    scheduled.Animator->JointMatrices = s_Scheduled[scheduled.PoseSource].Animator->JointMatrices;
+            }
+        });
+    }
+
+    uint64_t AnimationSystem::PoseKey::GetHash() const
+    {
+        uint64_t hash = Hash::FNV1a(&Skeleton, sizeof(Skeleton));
+        hash = Hash::FNV1a(&Controller, sizeof(Controller), hash);
+        hash = Hash::FNV1a(Animations, sizeof(Animations), hash);
+        hash = Hash::FNV1a(Ticks, sizeof(Ticks), hash);
+        hash = Hash::FNV1a(&UpperBodyRootJoint, sizeof(UpperBodyRootJoint), hash);
+        hash = Hash::FNV1a(&UpperBodyWeight, sizeof(UpperBodyWeight), hash);
+        hash = Hash::FNV1a(&LowerBodyWeight, sizeof(LowerBodyWeight), hash);
+        hash = Hash::FNV1a(&PartialBlendThreshold, sizeof(PartialBlendThreshold), hash);
+        hash = Hash::FNV1a(&BlendDuration, sizeof(BlendDuration), hash);
+        return Hash::FNV1a(&FullBody, sizeof(FullBody), hash);
+    }
+
+    AnimationSystem::PoseKey AnimationSystem::MakePoseKey(const AnimatorComponent* animator, bool fullBody)
+    {
+        auto toTicks = [](float time) { return (int32_t)std::floor(time / s_PoseSharingTimeStep); };
+
+        PoseKey key;
+        key.Skeleton = animator->GetSkeleton().get();
+        key.Controller = animator->GetAnimationController().get();
+
+        const AnimationLayer* layers[2] = { animator->LowerAnimation.get(), animator->UpperAnimation.get() };
+        for (int i = 0; i < 2; i++)
+        {
+            // Without the upper body layer its state does not change the pose
+            if (i == 1 && !fullBody)
+                break;
+
+            const AnimationLayer* layer = layers[i];
+            key.Animations[i * 2] = layer->CurrentAnimation;
+            key.Ticks[i * 3] = toTicks(layer->AnimationTime);
+
+            if (layer->IsBlending)
+            {
+                key.Animations[i * 2 + 1] = layer->NextAnimation;
+                key.Ticks[i * 3 + 1] = toTicks(layer->NextAnimationTime);
+                key.Ticks[i * 3 + 2] = toTicks(layer->BlendTime);
+            }
+            else
+            {
+                key.Animations[i * 2 + 1] = InvalidPose;
+            }
+        }
+
+        key.UpperBodyRootJoint = animator->UpperBodyRootJoint;
+        key.UpperBodyWeight = animator->UpperBodyWeight;
+        key.LowerBodyWeight = animator->LowerBodyWeight;
+        key.PartialBlendThreshold = animator->PartialBlendThreshold;
+        key.BlendDuration = animator->BlendDuration;
+        key.FullBody = fullBody;
+        return key;
+    }
+
+    float AnimationSystem::GetSampleTime(const AnimatorComponent* animator, float time)
+    {
+        return animator->SharePose ? std::floor(time / s_PoseSharingTimeStep) * s_PoseSharingTimeStep : time;
     }
 
     void AnimationSystem::SetupPartialBlending(unsigned int upperBodyAnimIndex, unsigned int lowerBodyAnimIndex, const std::string& upperBodyJointName, AnimatorComponent* animator)
@@ -61,12 +235,15 @@ namespace Coffee {
         animator->LowerAnimation->LocalTransforms.resize(numSoaJoints);
         animator->PartialBlendOutput.resize(numSoaJoints);
 
+        // Scratch of the update, sized once here so a frame does not allocate
+        animator->UpperAnimation->NextTransforms.resize(numSoaJoints);
+        animator->LowerAnimation->NextTransforms.resize(numSoaJoints);
+        animator->ModelSpaceTransforms.resize(skeleton->num_joints());
+
         SetupPerJointWeights(animator, upperBodyRootIndex);
 
-        animator->GetContext().Resize(std::max(
-            animator->GetAnimationController()->GetAnimation(upperBodyAnimIndex)->GetAnimation()->num_tracks(),
-            animator->GetAnimationController()->GetAnimation(lowerBodyAnimIndex)->GetAnimation()->num_tracks()
-        ));
+        // The animations of a skeleton have one track per joint, so the clip changes never resize them
+        animator->ResizeContexts(skeleton->num_joints());
     }
 
     void AnimationSystem::SetupPerJointWeights(const AnimatorComponent* animator, const int upperBodyRootIndex)
@@ -92,7 +269,43 @@ namespace Coffee {
         ozz::animation::IterateJointsDF(*skeleton, setUpperBodyWeights, upperBodyRootIndex);
     }
 
-   void AnimationSystem::UpdatePartialBlending(const float deltaTime, AnimatorComponent* animator)
+    bool AnimationSystem::AdvanceTimes(const float deltaTime, AnimatorComponent* animator)
+    {
+        UpdateBlending(deltaTime * animator->AnimationSpeed, animator, animator->UpperAnimation.get());
+        UpdateBlending(deltaTime * animator->AnimationSpeed, animator, animator->LowerAnimation.get());
+
+        Ref<AnimationController> animController = animator->GetAnimationController();
+        if (!animController) return false;
+
+        Animation* upperBodyCurrentAnim = animController->GetAnimation(animator->UpperAnimation->CurrentAnimation);
+        Animation* lowerBodyCurrentAnim = animController->GetAnimation(animator->LowerAnimation->CurrentAnimation);
+
+        if (!upperBodyCurrentAnim || !lowerBodyCurrentAnim)
+        {
+            COFFEE_CORE_ERROR("OZZ: Invalid animations for partial blending");
+            return false;
+        }
+
+        UpdateLayerTimes(deltaTime, animator, animator->UpperAnimation.get(), upperBodyCurrentAnim);
+        UpdateLayerTimes(deltaTime, animator, animator->LowerAnimation.get(), lowerBodyCurrentAnim);
+
+        // Wrapped here rather than when sampled, an animator reusing a shared pose still gets its times wrapped
+        for (AnimationLayer* layer : { animator->UpperAnimation.get(), animator->LowerAnimation.get() })
+        {
+            if (!layer->IsBlending) continue;
+
+            if (Animation* nextAnim = animController->GetAnimation(layer->NextAnimation))
+            {
+                float nextDuration = nextAnim->GetAnimation()->duration();
+                if (layer->NextAnimationTime > nextDuration)
+                    layer->NextAnimationTime = std::fmod(layer->NextAnimationTime, nextDuration);
+            }
+        }
+
+        return true;
+    }
+
+    void AnimationSystem::UpdatePartialBlending(AnimatorComponent* animator, bool fullBody)
     {
         Ref<AnimationController> animController = animator->GetAnimationController();
         if (!animController) return;
@@ -106,43 +319,70 @@ namespace Coffee {
         Animation* lowerBodyCurrentAnim = animController->GetAnimation(animator->LowerAnimation->CurrentAnimation);
         Animation* lowerBodyNextAnim = animator->LowerAnimation->IsBlending ? animController->GetAnimation(animator->LowerAnimation->NextAnimation) : nullptr;
 
-        if (!upperBodyCurrentAnim || !lowerBodyCurrentAnim)
+        if (!upperBodyCurrentAnim || !lowerBodyCurrentAnim) return;
+
+        SampleAndBlendLayerAnimations(animator, lowerLayer.get(), lowerBodyCurrentAnim, lowerBodyNextAnim, animator->LowerAnimation->LocalTransforms);
+
+        // Without the upper body layer the lower body pose is used for the whole skeleton, the times still advance
+        std::span<const ozz::math::SoaTransform> localTransforms = animator->LowerAnimation->LocalTransforms;
+
+        if (fullBody)
         {
-            COFFEE_CORE_ERROR("OZZ: Invalid animations for partial blending");
-            return;
-        }
+            SampleAndBlendLayerAnimations(animator, upperLayer.get(), upperBodyCurrentAnim, upperBodyNextAnim, animator->UpperAnimation->LocalTransforms);
 
-        UpdateLayerTimes(deltaTime, animator, upperLayer.get(), upperBodyCurrentAnim);
-        UpdateLayerTimes(deltaTime, animator, lowerLayer.get(), lowerBodyCurrentAnim);
+            animator->GetBlendLayers()[0].transform = ozz::make_span(animator->LowerAnimation->LocalTransforms);
+            animator->GetBlendLayers()[0].weight = animator->LowerBodyWeight;
+            animator->GetBlendLayers()[0].joint_weights = ozz::make_span(animator->LowerAnimation->JointWeights);
 
-        SampleAndBlendLayerAnimations(animator, upperLayer.get(), upperBodyCurrentAnim, upperBodyNextAnim, animator->UpperAnimation->LocalTransforms);
-        SampleAndBlendLayerAnimations(animator, lowerLayer.get(), lowerBodyCurrentAnim, lowerBodyNextAnim, animator->LowerAnimation->LocalTransforms);
+            animator->GetBlendLayers()[1].transform = ozz::make_span(animator->UpperAnimation->LocalTransforms);
+            animator->GetBlendLayers()[1].weight = animator->UpperBodyWeight;
+            animator->GetBlendLayers()[1].joint_weights = ozz::make_span(animator->UpperAnimation->JointWeights);
 
-        animator->GetBlendLayers()[0].transform = ozz::make_span(animator->LowerAnimation->LocalTransforms);
-        animator->GetBlendLayers()[0].weight = animator->LowerBodyWeight;
-        animator->GetBlendLayers()[0].joint_weights = ozz::make_span(animator->LowerAnimation->JointWeights);
+            animator->GetBlendJob().threshold = animator->PartialBlendThreshold;
+            animator->GetBlendJob().layers = ozz::span(animator->GetBlendLayers(), 2);
+            animator->GetBlendJob().rest_pose = animator->GetSkeleton()->GetSkeleton()->joint_rest_poses();
+            animator->GetBlendJob().output = ozz::make_span(animator->PartialBlendOutput);
 
-        animator->GetBlendLayers()[1].transform = ozz::make_span(animator->UpperAnimation->LocalTransforms);
-        animator->GetBlendLayers()[1].weight = animator->UpperBodyWeight;
-        animator->GetBlendLayers()[1].joint_weights = ozz::make_span(animator->UpperAnimation->JointWeights);
+            if (!animator->GetBlendJob().Run())
+            {
+                COFFEE_CORE_ERROR("OZZ: Failed to blend partial animations");
 
-        animator->GetBlendJob().threshold = animator->PartialBlendThreshold;
-        animator->GetBlendJob().layers = ozz::span(animator->GetBlendLayers(), 2);
-        animator->GetBlendJob().rest_pose = animator->GetSkeleton()->GetSkeleton()->joint_rest_poses();
-        animator->GetBlendJob().output = ozz::make_span(animator->PartialBlendOutput);
+                return;
+            }
 
-        if (!animator->GetBlendJob().Run())
-        {
-            COFFEE_CORE_ERROR("OZZ: Failed to blend partial animations");
+            localTransforms = animator->PartialBlendOutput;
+        }
 
+        if (!ConvertToModelSpace(animator, localTransforms, animator->ModelSpaceTransforms))
+        {
+            std::fill(animator->JointMatrices.begin(), animator->JointMatrices.end(), glm::mat4(1.0f));
             return;
         }
 
-        std::vector<ozz::math::Float4x4> modelSpaceTransforms = ConvertToModelSpace(animator, animator->PartialBlendOutput);
+        BuildJointPalette(animator->ModelSpaceTransforms, animator->GetSkeleton()->GetInverseBindPoses(), animator->JointMatrices);
+    }
+
+    void AnimationSystem::BuildJointPalette(std::span<const ozz::math::Float4x4> modelSpaceTransforms, std::span<const ozz::math::Float4x4> inverseBindPoses, std::span<glm::mat4> palette)
+    {
+        const size_t count = std::min({ modelSpaceTransforms.size(), inverseBindPoses.size(), palette.size() });
 
-        for (size_t i = 0; i < modelSpaceTransforms.size(); ++i)
+        for (size_t i = 0; i < count; ++i)
         {
-            animator->JointMatrices[i] = OzzToGlmMat4(modelSpaceTransforms[i]) * animator->GetSkeleton()->GetJoints()[i].invBindPose;
+            // Column major on both sides: each column of the product is the model matrix applied to a column of
+            // the inverse bind pose, four multiply-adds of SIMD columns, stored straight into the glm matrix
+            const ozz::math::Float4x4& model = modelSpaceTransforms[i];
+            const ozz::math::Float4x4& inverseBindPose = inverseBindPoses[i];
+            float* output = glm::value_ptr(palette[i]);
+
+            for (int column = 0; column < 4; ++column)
+            {
+                const ozz::math::SimdFloat4 bindColumn = inverseBindPose.cols[column];
+                ozz::math::SimdFloat4 result = ozz::math::MAdd(model.cols[0], ozz::math::SplatX(bindColumn),
+                                               ozz::math::MAdd(model.cols[1], ozz::math::SplatY(bindColumn),
+                                               ozz::math::MAdd(model.cols[2], ozz::math::SplatZ(bindColumn),
+                                                               ozz::math::Mul(model.cols[3], ozz::math::SplatW(bindColumn)))));
+                ozz::math::StorePtrU(result, output + column * 4);
+            }
         }
     }
 
@@ -165,7 +405,7 @@ namespace Coffee {
         }
     }
 
-    void AnimationSystem::SampleAndBlendLayerAnimations(AnimatorComponent* animator, AnimationLayer* layer, const Animation* currentAnim, const Animation* nextAnim, std::vector<ozz::math::SoaTransform>& outputTransforms)
+    void AnimationSystem::SampleAndBlendLayerAnimations(AnimatorComponent* animator, AnimationLayer* layer, const Animation* currentAnim, const Animation* nextAnim, std::span<ozz::math::SoaTransform> outputTransforms)
     {
         float currentDuration = currentAnim->GetAnimation()->duration();
 
@@ -173,9 +413,9 @@ namespace Coffee {
         {
             ozz::animation::SamplingJob currentSamplingJob;
             currentSamplingJob.animation = currentAnim->GetAnimation();
-            currentSamplingJob.context = &animator->GetContext();
-            currentSamplingJob.ratio = layer->AnimationTime / currentDuration;
-            currentSamplingJob.output = ozz::make_span(outputTransforms);
+            currentSamplingJob.context = &animator->GetContext(layer);
+            currentSamplingJob.ratio = GetSampleTime(animator, layer->AnimationTime) / currentDuration;
+            currentSamplingJob.output = ozz::span(outputTransforms.data(), outputTransforms.size());
 
             if (!currentSamplingJob.Run())
             {
@@ -184,14 +424,11 @@ namespace Coffee {
             }
 
             float nextDuration = nextAnim->GetAnimation()->duration();
-            if (layer->NextAnimationTime > nextDuration)
-                layer->NextAnimationTime = std::fmod(layer->NextAnimationTime, nextDuration);
-
-            std::vector<ozz::math::SoaTransform> nextTransforms(outputTransforms.size());
+            std::vector<ozz::math::SoaTransform>& nextTransforms = layer->NextTransforms;
             ozz::animation::SamplingJob nextSamplingJob;
             nextSamplingJob.animation = nextAnim->GetAnimation();
-            nextSamplingJob.context = &animator->GetContext();
-            nextSamplingJob.ratio = layer->NextAnimationTime / nextDuration;
+            nextSamplingJob.context = &animator->GetContext(layer, true);
+            nextSamplingJob.ratio = GetSampleTime(animator, layer->NextAnimationTime) / nextDuration;
             nextSamplingJob.output = ozz::make_span(nextTransforms);
 
             if (!nextSamplingJob.Run())
@@ -200,12 +437,12 @@ namespace Coffee {
                 return;
             }
 
-            float blendRatio = layer->BlendTime / animator->BlendDuration;
+            float blendRatio = GetSampleTime(animator, layer->BlendTime) / animator->BlendDuration;
 
             ozz::animation::BlendingJob transitionBlendJob;
             ozz::animation::BlendingJob::Layer transitionLayers[2];
 
-            transitionLayers[0].transform = ozz::make_span(outputTransforms);
+            transitionLayers[0].transform = ozz::span<const ozz::math::SoaTransform>(outputTransforms.data(), outputTransforms.size());
             transitionLayers[0].weight = 1.0f - blendRatio;
 
             transitionLayers[1].transform = ozz::make_span(nextTransforms);
@@ -213,7 +450,7 @@ namespace Coffee {
 
             transitionBlendJob.layers = ozz::make_span(transitionLayers);
             transitionBlendJob.rest_pose = animator->GetSkeleton()->GetSkeleton()->joint_rest_poses();
-            transitionBlendJob.output = ozz::make_span(outputTransforms);
+            transitionBlendJob.output = ozz::span(outputTransforms.data(), outputTransforms.size());
             transitionBlendJob.threshold = animator->PartialBlendThreshold;
 
             if (!transitionBlendJob.Run())
@@ -226,9 +463,9 @@ namespace Coffee {
         {
             ozz::animation::SamplingJob samplingJob;
             samplingJob.animation = currentAnim->GetAnimation();
-            samplingJob.context = &animator->GetContext();
-            samplingJob.ratio = layer->AnimationTime / currentDuration;
-            samplingJob.output = ozz::make_span(outputTransforms);
+            samplingJob.context = &animator->GetContext(layer);
+            samplingJob.ratio = GetSampleTime(animator, layer->AnimationTime) / currentDuration;
+            samplingJob.output = ozz::span(outputTransforms.data(), outputTransforms.size());
 
             if (!samplingJob.Run())
             {
@@ -238,7 +475,7 @@ namespace Coffee {
         }
     }
 
-    void AnimationSystem::BlendTransforms(std::vector<ozz::math::SoaTransform>& currentTransforms, const std::vector<ozz::math::SoaTransform>& nextTransforms, float blendRatio)
+    void AnimationSystem::BlendTransforms(std::span<ozz::math::SoaTransform> currentTransforms, std::span<const ozz::math::SoaTransform> nextTransforms, float blendRatio)
     {
         if (currentTransforms.size() != nextTransforms.size())
         {
@@ -248,14 +485,14 @@ namespace Coffee {
 
         ozz::animation::BlendingJob blendingJob;
         ozz::animation::BlendingJob::Layer layers[2];
-        layers[0].transform = ozz::make_span(currentTransforms);
+        layers[0].transform = ozz::span<const ozz::math::SoaTransform>(currentTransforms.data(), currentTransforms.size());
         layers[0].weight = 1.0f - blendRatio;
 
-        layers[1].transform = ozz::make_span(nextTransforms);
+        layers[1].transform = ozz::span(nextTransforms.data(), nextTransforms.size());
         layers[1].weight = blendRatio;
 
         blendingJob.layers = ozz::make_span(layers);
-        blendingJob.output = ozz::make_span(currentTransforms);
+        blendingJob.output = ozz::span(currentTransforms.data(), currentTransforms.size());
         blendingJob.threshold = 0.01f;
 
         if (!blendingJob.Run())
@@ -275,6 +512,9 @@ namespace Coffee {
             layer->CurrentAnimation = layer->NextAnimation;
             layer->AnimationTime = layer->NextAnimationTime;
             layer->IsBlending = false;
+
+            // The context that sampled the next animation keeps its cached keyframes as the current one
+            layer->ContextSlot ^= 1;
         }
     }
 
@@ -286,42 +526,37 @@ namespace Coffee {
         animator->JointMatrices = animator->GetSkeleton()->GetJointMatrices();
     }
 
-    std::vector<ozz::math::SoaTransform> AnimationSystem::SampleTransforms(AnimatorComponent* animator, unsigned int animationIndex, float timeRatio)
+    bool AnimationSystem::SampleTransforms(AnimatorComponent* animator, const AnimationLayer* layer, unsigned int animationIndex, float timeRatio, std::span<ozz::math::SoaTransform> output)
     {
-        const int numJoints = animator->GetSkeleton()->GetSkeleton()->num_joints();
-        std::vector<ozz::math::SoaTransform> localTransforms(numJoints);
-
         ozz::animation::SamplingJob samplingJob;
         samplingJob.animation = animator->GetAnimationController()->GetAnimation(animationIndex)->GetAnimation();
-        samplingJob.context = &animator->GetContext();
+        samplingJob.context = &animator->GetContext(layer);
         samplingJob.ratio = timeRatio;
-        samplingJob.output = ozz::make_span(localTransforms);
+        samplingJob.output = ozz::span(output.data(), output.size());
 
         if (!samplingJob.Run())
         {
             COFFEE_CORE_ERROR("OZZ: Failed to sample animation");
+            return false;
         }
 
-        return localTransforms;
+        return true;
     }
 
-    std::vector<ozz::math::Float4x4> AnimationSystem::ConvertToModelSpace(AnimatorComponent* animator, const std::vector<ozz::math::SoaTransform>& localTransforms)
+    bool AnimationSystem::ConvertToModelSpace(const AnimatorComponent* animator, std::span<const ozz::math::SoaTransform> localTransforms, std::span<ozz::math::Float4x4> output)
     {
-        const int numJoints = animator->GetSkeleton()->GetSkeleton()->num_joints();
-        std::vector<ozz::math::Float4x4> modelSpaceTransforms(numJoints);
-
         ozz::animation::LocalToModelJob localToModelJob;
         localToModelJob.skeleton = animator->GetSkeleton()->GetSkeleton();
-        localToModelJob.input = ozz::make_span(localTransforms);
-        localToModelJob.output = ozz::make_span(modelSpaceTransforms);
+        localToModelJob.input = ozz::span(localTransforms.data(), localTransforms.size());
+        localToModelJob.output = ozz::span(output.data(), output.size());
 
         if (!localToModelJob.Run())
         {
             COFFEE_CORE_ERROR("OZZ: Failed to convert local to model transforms");
-            std::fill(animator->JointMatrices.begin(), animator->JointMatrices.end(), glm::mat4(1.0f));
+            return false;
         }
 
-        return modelSpaceTransforms;
+        return true;
     }
 
     void AnimationSystem::SetCurrentAnimation(unsigned int index, AnimatorComponent* animator, AnimationLayer* layer)
@@ -335,14 +570,11 @@ namespace Coffee {
                                     || (layer == animator->LowerAnimation.get() && index == animator->UpperAnimation->CurrentAnimation)
                                     ? (layer == animator->UpperAnimation.get() ? animator->LowerAnimation->AnimationTime : animator->UpperAnimation->AnimationTime)
                                     : 0.0f;
-            animator->GetContext().Resize(animator->GetAnimationController()->GetAnimation(index)->GetAnimation()->num_tracks());
         }
     }
 
     void AnimationSystem::SetBoneTransformations(const Ref<Shader>& shader, const AnimatorComponent* animator)
     {
-        shader->setBool("animated", true);
-
         const std::vector<glm::mat4>& jointMatrices = animator->JointMatrices;
         shader->setMat4v("finalBonesMatrices", jointMatrices);
     }
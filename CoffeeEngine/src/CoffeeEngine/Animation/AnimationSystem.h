@@ -8,6 +8,9 @@
 #include <ozz/animation/runtime/sampling_job.h>
 #include <ozz/animation/runtime/blending_job.h>
 
+#include <algorithm>
+#include <limits>
+#include <span>
 #include <vector>
 
 namespace Coffee {
@@ -16,6 +19,35 @@ namespace Coffee {
     struct AnimatorComponent;
     class Shader;
 
+    /**
+     * @brief Statistics of the animation update of the last frame.
+     */
+    struct AnimationStats
+    {
+        uint32_t Animators = 0; ///< Number of animators.
+        uint32_t Evaluated = 0; ///< Number of animators updated.
+        uint32_t Throttled = 0; ///< Number of animators skipped by their level of detail.
+        uint32_t Paused = 0; ///< Number of animators paused because they are not visible.
+        uint32_t PoseCacheLookups = 0; ///< Number of updated animators that share their pose.
+        uint32_t PoseCacheHits = 0; ///< Number of those that reused the pose of another animator.
+
+        void Reset()
+        {
+            Animators = 0;
+            Evaluated = 0;
+            Throttled = 0;
+            Paused = 0;
+            PoseCacheLookups = 0;
+            PoseCacheHits = 0;
+        }
+
+        /**
+         * @brief Gets the fraction of the pose cache lookups that were hits.
+         * @return The hit rate, between 0 and 1.
+         */
+        float GetPoseCacheHitRate() const { return PoseCacheLookups ? (float)PoseCacheHits / PoseCacheLookups : 0.0f; }
+    };
+
     /**
      * @brief System responsible for handling animations.
      */
@@ -27,8 +59,27 @@ namespace Coffee {
          * @brief Updates the animation system.
          * @param deltaTime The time elapsed since the last update.
          * @param animator The animator component to update.
+         * @param fullBody Whether to blend the upper body layer, otherwise only the lower body layer is sampled.
+         */
+        static void Update(float deltaTime, AnimatorComponent* animator, bool fullBody = true);
+
+        /**
+         * @brief Updates a batch of animators across the job system workers.
+         *
+         * Animators are independent: each one samples with its own context and writes its own joint matrices, so
+         * they can be evaluated in any order. An animator must appear only once in the batch.
+         *
+         * The level of detail of each animator decides whether it is updated this frame, from the inputs in its
+         * LODState. The scheduling runs on the calling thread, in the order of the batch.
+         *
+         * Animators with SharePose set are sampled at times snapped to the pose sharing time step. Those with the
+         * same skeleton, clips, snapped times and blend state in this frame get the same pose: it is evaluated once
+         * and its joint matrices are copied to the others.
+         *
+         * @param animators The animator components to update.
+         * @param deltaTime The time elapsed since the last update.
          */
-        static void Update(float deltaTime, AnimatorComponent* animator);
+        static void UpdateAll(std::span<AnimatorComponent* const> animators, float deltaTime);
 
         /**
          * @brief Sets the bone transformations for the shader.
@@ -55,7 +106,7 @@ namespace Coffee {
          * @brief Gets the list of animators.
          * @return A vector of animator components.
          */
-        static std::vector<AnimatorComponent*> GetAnimators() { return m_Animators; }
+        static const std::vector<AnimatorComponent*>& GetAnimators() { return m_Animators; }
 
         /**
          * @brief Resets the animators vector.
@@ -68,6 +119,24 @@ namespace Coffee {
          */
         static void LoadAnimator(AnimatorComponent* animator);
 
+        /**
+         * @brief Gets the statistics of the last update.
+         * @return The animation statistics.
+         */
+        static const AnimationStats& GetStats() { return s_Stats; }
+
+        /**
+         * @brief Sets the time step the animators sharing their pose are sampled at.
+         * @param timeStep The time step in seconds, larger steps share more poses but play less smoothly.
+         */
+        static void SetPoseSharingTimeStep(float timeStep) { s_PoseSharingTimeStep = std::max(timeStep, 0.001f); }
+
+        /**
+         * @brief Gets the time step the animators sharing their pose are sampled at.
+         * @return The time step in seconds.
+         */
+        static float GetPoseSharingTimeStep() { return s_PoseSharingTimeStep; }
+
         /**
          * @brief Sets up partial blending for upper and lower body animations.
          * @param upperBodyAnimIndex The index of the upper body animation.
@@ -92,14 +161,30 @@ namespace Coffee {
          * @param nextTransforms The next animation transforms.
          * @param blendRatio The ratio for blending between the two animations.
          */
-        static void BlendTransforms(std::vector<ozz::math::SoaTransform>& currentTransforms, const std::vector<ozz::math::SoaTransform>& nextTransforms, float blendRatio);
+        static void BlendTransforms(std::span<ozz::math::SoaTransform> currentTransforms, std::span<const ozz::math::SoaTransform> nextTransforms, float blendRatio);
 
         /**
-         * @brief Updates partial blending for upper and lower body animations.
+         * @brief Advances the blends and the animation times of both layers.
          * @param deltaTime The time elapsed since the last update.
          * @param animator The animator component.
+         * @return True if the animator has valid animations to sample.
+         */
+        static bool AdvanceTimes(float deltaTime, AnimatorComponent* animator);
+
+        /**
+         * @brief Samples and blends the upper and lower body animations into the joint matrices.
+         * @param animator The animator component, its times already advanced.
+         * @param fullBody Whether to blend the upper body layer.
          */
-        static void UpdatePartialBlending(float deltaTime, AnimatorComponent* animator);
+        static void UpdatePartialBlending(AnimatorComponent* animator, bool fullBody);
+
+        /**
+         * @brief Gets the time an animation is sampled at.
+         * @param animator The animator component.
+         * @param time The time of the animation.
+         * @return The time snapped to the pose sharing time step if the animator shares its pose, the time otherwise.
+         */
+        static float GetSampleTime(const AnimatorComponent* animator, float time);
 
         /**
          * @brief Sets up per-joint weights for partial blending.
@@ -123,39 +208,91 @@ namespace Coffee {
          * @param layer The animation layer.
          * @param currentAnim The current animation.
          * @param nextAnim The next animation.
-         * @param outputTransforms The output transforms for the layer.
+         * @param outputTransforms The output transforms for the layer, one per SoA joint.
          */
-        static void SampleAndBlendLayerAnimations(AnimatorComponent* animator, AnimationLayer* layer, const Animation* currentAnim, const Animation* nextAnim, std::vector<ozz::math::SoaTransform>& outputTransforms);
+        static void SampleAndBlendLayerAnimations(AnimatorComponent* animator, AnimationLayer* layer, const Animation* currentAnim, const Animation* nextAnim, std::span<ozz::math::SoaTransform> outputTransforms);
 
         /**
          * @brief Samples the transforms for the animation.
          * @param animator The animator component.
+         * @param layer The layer whose sampling context is used.
          * @param animationIndex The index of the animation.
          * @param timeRatio The time ratio for the animation.
-         * @return A vector of sampled transforms.
+         * @param output Receives the sampled transforms, one per SoA joint.
+         * @return True if the animation was sampled.
          */
-        static std::vector<ozz::math::SoaTransform> SampleTransforms(AnimatorComponent* animator, unsigned int animationIndex, float timeRatio);
+        static bool SampleTransforms(AnimatorComponent* animator, const AnimationLayer* layer, unsigned int animationIndex, float timeRatio, std::span<ozz::math::SoaTransform> output);
 
         /**
          * @brief Converts local transforms to model space.
          * @param animator The animator component.
-         * @param localTransforms The local transforms.
-         * @return A vector of transforms in model space.
+         * @param localTransforms The local transforms, one per SoA joint.
+         * @param output Receives the transforms in model space, one per joint.
+         * @return True if the transforms were converted.
          */
-        static std::vector<ozz::math::Float4x4> ConvertToModelSpace(AnimatorComponent* animator, const std::vector<ozz::math::SoaTransform>& localTransforms);
+        static bool ConvertToModelSpace(const AnimatorComponent* animator, std::span<const ozz::math::SoaTransform> localTransforms, std::span<ozz::math::Float4x4> output);
 
         /**
-         * @brief Converts an Ozz matrix to a GLM matrix.
-         * @param from The Ozz matrix.
-         * @return The GLM matrix.
+         * @brief Builds the skinning matrices of the joints, the model space transforms times the inverse bind poses.
+         *
+         * The product is computed on the SIMD registers and written directly into the palette uploaded to the
+         * shader, without going through intermediate glm matrices.
+         *
+         * @param modelSpaceTransforms The model space transforms of the joints.
+         * @param inverseBindPoses The inverse bind poses of the joints.
+         * @param palette Receives the skinning matrix of each joint.
          */
-        static glm::mat4 OzzToGlmMat4(const ozz::math::Float4x4& from) {
-            glm::mat4 to;
-            memcpy(glm::value_ptr(to), &from.cols[0], sizeof(glm::mat4));
-            return to;
-        }
+        static void BuildJointPalette(std::span<const ozz::math::Float4x4> modelSpaceTransforms, std::span<const ozz::math::Float4x4> inverseBindPoses, std::span<glm::mat4> palette);
 
     private:
         static std::vector<AnimatorComponent*> m_Animators; ///< The list of animator components.
+
+        /**
+         * @brief Everything the pose of an animator depends on, two animators with equal keys have the same pose.
+         */
+        struct PoseKey
+        {
+            const void* Skeleton = nullptr;
+            const void* Controller = nullptr;
+            uint32_t Animations[4] = {}; ///< Current and next animation of the lower and upper layers.
+            int32_t Ticks[6] = {}; ///< Snapped current time, next time and blend time of the lower and upper layers.
+            int32_t UpperBodyRootJoint = 0;
+            float UpperBodyWeight = 0.0f;
+            float LowerBodyWeight = 0.0f;
+            float PartialBlendThreshold = 0.0f;
+            float BlendDuration = 0.0f;
+            bool FullBody = true;
+
+            bool operator==(const PoseKey& other) const = default;
+
+            uint64_t GetHash() const;
+        };
+
+        /**
+         * @brief Builds the pose key of an animator whose times are advanced.
+         * @param animator The animator component.
+         * @param fullBody Whether the upper body layer is blended.
+         * @return The pose key.
+         */
+        static PoseKey MakePoseKey(const AnimatorComponent* animator, bool fullBody);
+
+        static constexpr uint32_t InvalidPose = std::numeric_limits<uint32_t>::max();
+
+        struct ScheduledAnimator
+        {
+            AnimatorComponent* Animator;
+            float DeltaTime;
+            bool FullBody;
+            uint32_t PoseSource = InvalidPose; ///< The scheduled animator whose pose is used, itself if evaluated.
+            uint64_t PoseHash = 0;
+            PoseKey Key;
+        };
+
+        static std::vector<ScheduledAnimator> s_Scheduled; ///< The animators updated this frame, kept to reuse its memory.
+        static std::vector<uint32_t> s_SharedPoseOrder; ///< The scheduled animators sharing their pose, sorted by key.
+        static float s_PoseSharingTimeStep; ///< The time step the animators sharing their pose are sampled at.
+        static uint64_t s_FrameIndex; ///< The number of batches updated, drives the level of detail.
+        static uint32_t s_NextLODPhase; ///< The phase given to the next animator seen.
+        static AnimationStats s_Stats; ///< The statistics of the last update.
     };
 } // namespace Coffee
@@ -1,6 +1,8 @@
 #include "Skeleton.h"
 
 #include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+
+#include <glm/gtc/type_ptr.hpp>
 #include <cereal/types/string.hpp>
 #include <cereal/archives/json.hpp>
 #include <cereal/archives/binary.hpp>
@@ -39,6 +41,15 @@ namespace Coffee {
     void Skeleton::SetJoints(const std::vector<Joint>& joints)
     {
         m_Joints = joints;
+
+        m_InverseBindPoses.resize(m_Joints.size());
+        for (size_t i = 0; i < m_Joints.size(); ++i)
+        {
+            // Both are column major, each glm column loads as one SIMD column
+            const float* invBindPose = glm::value_ptr(m_Joints[i].invBindPose);
+            for (int column = 0; column < 4; ++column)
+                m_InverseBindPoses[i].cols[column] = ozz::math::simd_float4::LoadPtrU(invBindPose + column * 4);
+        }
     }
 
     void Skeleton::Save(ozz::io::OArchive& archive) const
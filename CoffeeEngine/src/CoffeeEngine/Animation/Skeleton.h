@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ozz/animation/runtime/skeleton.h>
+#include <ozz/base/maths/simd_math.h>
 #include <ozz/base/maths/soa_transform.h>
 #include <ozz/base/memory/unique_ptr.h>
 #include <glm/mat4x4.hpp>
@@ -68,6 +69,12 @@ namespace Coffee {
          */
         const std::vector<Joint>& GetJoints() const { return m_Joints; }
 
+        /**
+         * @brief Gets the inverse bind pose of every joint, converted once when the joints are set.
+         * @return The inverse bind poses, in the order of the joints.
+         */
+        const std::vector<ozz::math::Float4x4>& GetInverseBindPoses() const { return m_InverseBindPoses; }
+
         /**
          * @brief Gets the number of joints.
          * @return The number of joints.
@@ -96,6 +103,7 @@ namespace Coffee {
     private:
         ozz::unique_ptr<ozz::animation::Skeleton> m_Skeleton; ///< The skeleton.
         std::vector<Joint> m_Joints; ///< The joints.
+        std::vector<ozz::math::Float4x4> m_InverseBindPoses; ///< The inverse bind poses of the joints, as SIMD matrices.
         unsigned int m_NumJoints = 0; ///< The number of joints.
         std::vector<glm::mat4> m_JointMatrices; ///< The joint matrices.
     };
@@ -3,6 +3,7 @@
 #include "CoffeeEngine/Core/Layer.h"
 #include "CoffeeEngine/Core/Stopwatch.h"
 #include "CoffeeEngine/Core/Input.h"
+#include "CoffeeEngine/Core/JobSystem.h"
 #include "CoffeeEngine/Events/ControllerEvent.h"
 #include "CoffeeEngine/Events/KeyEvent.h"
 #include "CoffeeEngine/Events/MouseEvent.h"
@@ -37,6 +38,7 @@ namespace Coffee
         SetEventCallback(COFFEE_BIND_EVENT_FN(OnEvent));
 
         Input::Init();
+        JobSystem::Init();
         Renderer::Init();
         Audio::Init();
 
@@ -47,6 +49,7 @@ namespace Coffee
     Application::~Application()
     {
         Audio::Shutdown();
+        JobSystem::Shutdown();
     }
 
     void Application::PushLayer(Layer* layer)
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+namespace Coffee {
+
+    /**
+     * @defgroup core Core
+     * @brief Core components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief Stable 64-bit hashing helpers.
+     *
+     * Unlike std::hash, the values produced here are identical across runs, compilers and platforms,
+     * so they can be used as keys for files written to the cache.
+     */
+    namespace Hash {
+
+        constexpr uint64_t FNV1aOffset = 14695981039346656037ull; ///< FNV-1a 64-bit offset basis.
+        constexpr uint64_t FNV1aPrime = 1099511628211ull; ///< FNV-1a 64-bit prime.
+
+        /**
+         * @brief Hashes a block of memory using FNV-1a.
+         * @param data Pointer to the data.
+         * @param size Size of the data in bytes.
+         * @param seed Initial hash value, allows chaining several blocks.
+         * @return The 64-bit hash.
+         */
+        constexpr uint64_t FNV1a(const void* data, size_t size, uint64_t seed = FNV1aOffset)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            uint64_t hash = seed;
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= FNV1aPrime;
+            }
+            return hash;
+        }
+
+        /**
+         * @brief Hashes a string using FNV-1a.
+         * @param str The string to hash.
+         * @param seed Initial hash value, allows chaining several strings.
+         * @return The 64-bit hash.
+         */
+        constexpr uint64_t FNV1a(std::string_view str, uint64_t seed = FNV1aOffset)
+        {
+            uint64_t hash = seed;
+            for (char c : str)
+            {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= FNV1aPrime;
+            }
+            return hash;
+        }
+
+        /**
+         * @brief Combines two hashes into one. The order of the arguments matters.
+         * @param seed The accumulated hash.
+         * @param value The hash to mix in.
+         * @return The combined hash.
+         */
+        constexpr uint64_t Combine(uint64_t seed, uint64_t value)
+        {
+            return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+        }
+
+        /**
+         * @brief Hashes the whole content of a file.
+         * @param path The path of the file.
+         * @return The 64-bit hash of the file content, or 0 if the file could not be read.
+         */
+        inline uint64_t HashFile(const std::filesystem::path& path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+                return 0;
+
+            uint64_t hash = FNV1aOffset;
+            char buffer[64 * 1024];
+            while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+            {
+                hash = FNV1a(buffer, static_cast<size_t>(file.gcount()), hash);
+            }
+            return hash;
+        }
+
+    } // namespace Hash
+
+    /** @} */
+}
@@ -0,0 +1,316 @@
+#include "JobSystem.h"
+
+#include "CoffeeEngine/Core/Log.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Coffee {
+
+    // Shared by the caller of a ParallelFor and its helper jobs. The states are pooled so a ParallelFor does not allocate.
+    struct ParallelForState
+    {
+        const std::function<void(uint32_t, uint32_t)>* Function = nullptr;
+        uint32_t Count = 0;
+        uint32_t GrainSize = 1;
+        uint32_t RangeCount = 0;
+        std::atomic<uint32_t> NextRange = 0;
+        std::atomic<uint32_t> DoneRanges = 0;
+        std::atomic<uint32_t> ActiveHelpers = 0; ///< Helpers taken off the queue that have not returned yet.
+        std::mutex Mutex;
+        std::condition_variable Condition;
+
+        void RunRanges()
+        {
+            uint32_t range;
+            while ((range = NextRange.fetch_add(1)) < RangeCount)
+            {
+                uint32_t begin = range * GrainSize;
+                (*Function)(begin, std::min(begin + GrainSize, Count));
+
+                if (DoneRanges.fetch_add(1) + 1 == RangeCount)
+                {
+                    std::lock_guard<std::mutex> lock(Mutex);
+                    Condition.notify_all();
+                }
+            }
+        }
+
+        void RunHelper()
+        {
+            RunRanges();
+
+            if (ActiveHelpers.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(Mutex);
+                Condition.notify_all();
+            }
+        }
+    };
+
+    // A queued job, either a submitted function or a helper taking the ranges of a ParallelFor
+    struct Job
+    {
+        std::function<void()> Function;
+        ParallelForState* ParallelFor = nullptr;
+    };
+
+    struct JobSystemData
+    {
+        static constexpr size_t InitialQueueCapacity = 256;
+
+        std::vector<std::thread> Workers;
+        std::vector<Job> Queue; ///< Ring of job slots, grows when full and keeps its capacity.
+        size_t QueueHead = 0;
+        size_t QueueSize = 0;
+        std::vector<std::unique_ptr<ParallelForState>> ParallelForStates; ///< Every state, one per ParallelFor running at the same time.
+        std::vector<ParallelForState*> FreeParallelForStates;
+        std::mutex Mutex; ///< Guards the queue, the states and Running.
+        std::condition_variable Condition;
+        bool Running = false;
+        std::atomic<uint32_t> WorkerCount = 0; ///< Read without the lock by GetWorkerCount.
+
+        // Joins the workers if Shutdown was never called, e.g. in tools without an Application
+        ~JobSystemData()
+        {
+            Stop();
+        }
+
+        void Start(uint32_t workerCount)
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            if (Running)
+                return;
+
+            if (workerCount == 0)
+                workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+            if (Queue.empty())
+                Queue.resize(InitialQueueCapacity);
+
+            // One ParallelFor per thread without nesting, deeper nesting adds states on first use
+            while (ParallelForStates.size() < workerCount + 1)
+            {
+                ParallelForStates.push_back(std::make_unique<ParallelForState>());
+                FreeParallelForStates.push_back(ParallelForStates.back().get());
+            }
+
+            Running = true;
+            Workers.reserve(workerCount);
+            for (uint32_t i = 0; i < workerCount; i++)
+                Workers.emplace_back([this, i]() { WorkerLoop(i); });
+            WorkerCount = workerCount;
+        }
+
+        void Stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(Mutex);
+                if (!Running)
+                    return;
+                Running = false;
+                WorkerCount = 0;
+            }
+
+            Condition.notify_all();
+            for (std::thread& worker : Workers)
+                worker.join();
+            Workers.clear();
+        }
+
+        // The functions below are called with Mutex held
+
+        void PushJob(Job&& job)
+        {
+            if (QueueSize == Queue.size())
+            {
+                std::vector<Job> queue(std::max(Queue.size() * 2, InitialQueueCapacity));
+                for (size_t i = 0; i < QueueSize; i++)
+                    queue[i] = std::move(Queue[(QueueHead + i) % Queue.size()]);
+                Queue.swap(queue);
+                QueueHead = 0;
+            }
+
+            Queue[(QueueHead + QueueSize) % Queue.size()] = std::move(job);
+            QueueSize++;
+        }
+
+        Job PopJob()
+        {
+            Job job = std::move(Queue[QueueHead]);
+            Queue[QueueHead] = Job();
+            QueueHead = (QueueHead + 1) % Queue.size();
+            QueueSize--;
+
+            if (job.ParallelFor)
+                job.ParallelFor->ActiveHelpers++;
+            return job;
+        }
+
+        // Empties the queued helpers of a ParallelFor whose ranges were all taken, so they never touch its state
+        void CancelHelpers(const ParallelForState* state)
+        {
+            for (size_t i = 0; i < QueueSize; i++)
+            {
+                Job& job = Queue[(QueueHead + i) % Queue.size()];
+                if (job.ParallelFor == state)
+                    job.ParallelFor = nullptr;
+            }
+
+            // The helpers were pushed last, unless jobs were queued since their slots can be reused right away
+            while (QueueSize > 0)
+            {
+                const Job& last = Queue[(QueueHead + QueueSize - 1) % Queue.size()];
+                if (last.Function || last.ParallelFor)
+                    break;
+                QueueSize--;
+            }
+        }
+
+        ParallelForState* AcquireParallelForState()
+        {
+            if (FreeParallelForStates.empty())
+            {
+                ParallelForStates.push_back(std::make_unique<ParallelForState>());
+                FreeParallelForStates.reserve(ParallelForStates.size());
+                return ParallelForStates.back().get();
+            }
+
+            ParallelForState* state = FreeParallelForStates.back();
+            FreeParallelForStates.pop_back();
+            return state;
+        }
+
+        void WorkerLoop(uint32_t index)
+        {
+#ifdef TRACY_ENABLE
+            std::string name = "Job Worker " + std::to_string(index);
+            tracy::SetThreadName(name.c_str());
+#endif
+
+            while (true)
+            {
+                Job job;
+                {
+                    std::unique_lock<std::mutex> lock(Mutex);
+                    Condition.wait(lock, [this]() { return !Running || QueueSize > 0; });
+
+                    // The queue is drained before stopping so no future is left without a value
+                    if (QueueSize == 0)
+                        return;
+
+                    job = PopJob();
+                }
+
+                if (job.ParallelFor)
+                    job.ParallelFor->RunHelper();
+                else if (job.Function)
+                    job.Function();
+            }
+        }
+    };
+
+    static JobSystemData s_JobSystemData;
+
+    void JobSystem::Init(uint32_t workerCount)
+    {
+        s_JobSystemData.Start(workerCount);
+        COFFEE_CORE_INFO("JobSystem: {0} worker threads", s_JobSystemData.WorkerCount.load());
+    }
+
+    void JobSystem::Shutdown()
+    {
+        s_JobSystemData.Stop();
+    }
+
+    uint32_t JobSystem::GetWorkerCount()
+    {
+        return s_JobSystemData.WorkerCount.load();
+    }
+
+    void JobSystem::Enqueue(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_JobSystemData.Mutex);
+            if (s_JobSystemData.Running)
+            {
+                s_JobSystemData.PushJob({std::move(job), nullptr});
+                s_JobSystemData.Condition.notify_one();
+                return;
+            }
+        }
+
+        // Before Init or after Shutdown there is no worker to take it, running it here keeps its future from breaking
+        COFFEE_CORE_WARN("JobSystem: a job was submitted while the job system is not running, running it on the calling thread");
+        job();
+    }
+
+    void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function)
+    {
+        ZoneScoped;
+
+        if (count == 0)
+            return;
+
+        grainSize = std::max(grainSize, 1u);
+        uint32_t rangeCount = (count + grainSize - 1) / grainSize;
+
+        uint32_t helperCount = std::min(GetWorkerCount(), rangeCount - 1);
+
+        // The helpers only see the state through their queue slots, it is returned to the pool once none can reach it
+        ParallelForState* state = nullptr;
+        if (helperCount > 0)
+        {
+            std::lock_guard<std::mutex> lock(s_JobSystemData.Mutex);
+            if (s_JobSystemData.Running)
+            {
+                state = s_JobSystemData.AcquireParallelForState();
+                state->Function = &function;
+                state->Count = count;
+                state->GrainSize = grainSize;
+                state->RangeCount = rangeCount;
+                state->NextRange = 0;
+                state->DoneRanges = 0;
+
+                for (uint32_t i = 0; i < helperCount; i++)
+                    s_JobSystemData.PushJob({nullptr, state});
+            }
+        }
+
+        // Nothing to share the ranges with, run them here without the shared state
+        if (!state)
+        {
+            for (uint32_t begin = 0; begin < count; begin += grainSize)
+                function(begin, std::min(begin + grainSize, count));
+            return;
+        }
+
+        for (uint32_t i = 0; i < helperCount; i++)
+            s_JobSystemData.Condition.notify_one();
+
+        state->RunRanges();
+
+        // Every range is taken, the helpers still queued have nothing left to do
+        {
+            std::lock_guard<std::mutex> lock(s_JobSystemData.Mutex);
+            s_JobSystemData.CancelHelpers(state);
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(state->Mutex);
+            state->Condition.wait(lock, [state]() { return state->DoneRanges.load() == state->RangeCount && state->ActiveHelpers.load() == 0; });
+        }
+
+        std::lock_guard<std::mutex> lock(s_JobSystemData.Mutex);
+        s_JobSystemData.FreeParallelForStates.push_back(state);
+    }
+
+}
@@ -0,0 +1,83 @@
+/**
+ * @defgroup core Core
+ * @brief Core components of the CoffeeEngine.
+ * @{
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+namespace Coffee {
+
+    /**
+     * @class JobSystem
+     * @brief A pool of worker threads for CPU work that does not touch OpenGL.
+     *
+     * The workers run between Init and Shutdown, which the Application calls. Outside of them, ParallelFor runs on the
+     * calling thread and submitted jobs run inline, so tools and tests work without an Application and a late job never
+     * starts a pool that nobody joins.
+     */
+    class JobSystem
+    {
+    public:
+        /**
+         * @brief Starts the worker threads. Does nothing if they are already running.
+         * @param workerCount The number of workers, 0 to use one less than the hardware threads.
+         */
+        static void Init(uint32_t workerCount = 0);
+
+        /**
+         * @brief Finishes the queued jobs and joins the worker threads.
+         *
+         * Init and Shutdown must be called from the same thread, jobs may be submitted from any thread.
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Gets the number of worker threads.
+         * @return The number of workers, 0 when the job system is not running.
+         */
+        static uint32_t GetWorkerCount();
+
+        /**
+         * @brief Queues a function on the workers.
+         * @param job The function to run.
+         * @return A future with the result of the function. Unlike std::async, destroying it does not wait.
+         *         When the job system is not running, the function runs before this returns.
+         */
+        template<typename F>
+        static std::future<std::invoke_result_t<F>> Submit(F&& job)
+        {
+            using Result = std::invoke_result_t<F>;
+
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+            std::future<Result> future = task->get_future();
+            Enqueue([task]() { (*task)(); });
+            return future;
+        }
+
+        /**
+         * @brief Runs a function over [0, count) split in ranges, on the workers and the calling thread.
+         *
+         * Returns when every range is done. Can be called from a job: the calling thread keeps taking ranges,
+         * so it never waits on workers that are busy. The ranges are shared through pooled state and the slots of
+         * the job queue, so the call does not allocate.
+         *
+         * @param count The number of items.
+         * @param grainSize The number of items per range, at least 1.
+         * @param function Called with the [begin, end) of each range.
+         */
+        static void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function);
+
+    private:
+        static void Enqueue(std::function<void()> job);
+    };
+
+}
+
+/** @} */
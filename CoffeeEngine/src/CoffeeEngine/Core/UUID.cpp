@@ -3,9 +3,10 @@
 
 namespace Coffee {
 
-    static std::random_device s_RandomDevice;
-    static std::mt19937_64 s_Engine(s_RandomDevice());
-    static std::uniform_int_distribution<uint64_t> s_UniformDistribution;
+    // Per thread, resources are also deserialized on the job system workers
+    static thread_local std::random_device s_RandomDevice;
+    static thread_local std::mt19937_64 s_Engine(s_RandomDevice());
+    static thread_local std::uniform_int_distribution<uint64_t> s_UniformDistribution;
 
     UUID::UUID()
         : m_UUID(s_UniformDistribution(s_Engine))
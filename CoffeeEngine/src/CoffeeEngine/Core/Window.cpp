@@ -124,7 +124,7 @@ namespace Coffee {
     void Window::SetIcon(const std::string& path)
     {
         int width, height, channels;
-        stbi_set_flip_vertically_on_load(false);
+        stbi_set_flip_vertically_on_load_thread(false);
         unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
         if (!pixels)
         {
@@ -2,6 +2,8 @@
 #pragma once
 
 const char* lineShaderSource = R"(
+#pragma keywords INSTANCED
+
 #[vertex]
 
 #version 450 core
@@ -9,6 +11,9 @@ const char* lineShaderSource = R"(
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec4 aColor;
 layout (location = 2) in vec3 aEntityID;
+#ifdef INSTANCED
+layout (location = 3) in mat4 aTransform;
+#endif
 
 layout (std140, binding = 0) uniform camera
 {
@@ -24,7 +29,11 @@ layout (location = 0) out flat vec3 entityID;
 void main()
 {
     Color = aColor;
+#ifdef INSTANCED
+    gl_Position = projection * view * aTransform * vec4(aPosition, 1.0);
+#else
     gl_Position = projection * view * vec4(aPosition, 1.0);
+#endif
     entityID = aEntityID;
 }
 
@@ -2,17 +2,19 @@
 #pragma once
 
 inline const char* simpleDepthShaderSource = R"(
+#pragma keywords ANIMATED
+
 #[vertex]
 
 #version 450 core
 layout (location = 0) in vec3 aPosition;
-layout (location = 5) in ivec4 aBoneIDs;
-layout (location = 6) in vec4 aBoneWeights;
+layout (location = 4) in ivec4 aBoneIDs;
+layout (location = 5) in vec4 aBoneWeights;
 
 uniform mat4 projView;
 uniform mat4 model;
 
-uniform bool animated;
+#ifdef ANIMATED
 const int MAX_BONES = 100;
 const int MAX_BONE_INFLUENCE = 4;
 uniform mat4 finalBonesMatrices[MAX_BONES];
@@ -33,19 +35,15 @@ vec4 applyBoneTransform(vec4 pos)
     }
     return result;
 }
+#endif
 
 void main()
 {
-    vec4 totalPosition = vec4(0.0);
-
-    if (animated)
-    {
-        totalPosition = applyBoneTransform(vec4(aPosition, 1.0f));
-    }
-    else
-    {
-        totalPosition = vec4(aPosition, 1.0f);
-    }
+#ifdef ANIMATED
+    vec4 totalPosition = applyBoneTransform(vec4(aPosition, 1.0f));
+#else
+    vec4 totalPosition = vec4(aPosition, 1.0f);
+#endif
 
     gl_Position = projView * model * totalPosition;
 }
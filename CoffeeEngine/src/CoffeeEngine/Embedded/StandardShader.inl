@@ -2,16 +2,18 @@
 #pragma once
 
 const char* standardShaderSource = R""(
+#pragma keywords ANIMATED RECEIVE_SHADOWS
+#pragma keywords HAS_ALBEDO_MAP HAS_NORMAL_MAP HAS_METALLIC_MAP HAS_ROUGHNESS_MAP HAS_AO_MAP HAS_EMISSIVE_MAP
+
 #[vertex]
 
 #version 450 core
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec2 aTexCoord;
-layout (location = 2) in vec3 aNormals;
-layout (location = 3) in vec3 aTangent;
-layout (location = 4) in vec3 aBitangent;
-layout (location = 5) in ivec4 aBoneIDs;
-layout (location = 6) in vec4 aBoneWeights;
+layout (location = 2) in vec2 aNormal;
+layout (location = 3) in uint aTangent;
+layout (location = 4) in ivec4 aBoneIDs;
+layout (location = 5) in vec4 aBoneWeights;
 
 layout (std140, binding = 0) uniform camera
 {
@@ -66,7 +68,22 @@ layout (location = 2) out VertexData Output;
 uniform mat4 model;
 uniform mat3 normalMatrix;
 
-uniform bool animated;
+// Normals and tangents are octahedral encoded, see VertexQuantization
+vec3 octDecode(vec2 e)
+{
+    vec3 v = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+    return normalize(v);
+}
+
+vec4 decodeTangent(uint packed)
+{
+    vec2 e = vec2(packed & 0x7FFFu, (packed >> 15) & 0x7FFFu) / 32767.0 * 2.0 - 1.0;
+    return vec4(octDecode(e), (packed & 0x80000000u) != 0u ? -1.0 : 1.0);
+}
+
+#ifdef ANIMATED
 const int MAX_BONES = 100;
 const int MAX_BONE_INFLUENCE = 4;
 uniform mat4 finalBonesMatrices[MAX_BONES];
@@ -87,22 +104,21 @@ vec4 applyBoneTransform(vec4 pos)
     }
     return result;
 }
+#endif
 
 void main()
 {
-    vec4 totalPosition = vec4(0.0);
-    vec3 totalNormal = vec3(0.0);
-
-    if (animated)
-    {
-        totalPosition = applyBoneTransform(vec4(aPosition, 1.0f));
-        totalNormal = normalize(applyBoneTransform(vec4(aNormals, 0.0))).xyz;
-    }
-    else
-    {
-        totalPosition = vec4(aPosition, 1.0f);
-        totalNormal = aNormals;
-    }
+    vec3 normal = octDecode(aNormal);
+    vec4 tangent = decodeTangent(aTangent);
+    vec3 bitangent = cross(normal, tangent.xyz) * tangent.w;
+
+#ifdef ANIMATED
+    vec4 totalPosition = applyBoneTransform(vec4(aPosition, 1.0f));
+    vec3 totalNormal = normalize(applyBoneTransform(vec4(normal, 0.0))).xyz;
+#else
+    vec4 totalPosition = vec4(aPosition, 1.0f);
+    vec3 totalNormal = normal;
+#endif
 
     Output.WorldPos = vec3(model * totalPosition);
     Output.Normal = normalMatrix * totalNormal;
@@ -122,8 +138,8 @@ void main()
     //and then pass them to the fragment shader. But this way is more simple and easy to understand + for PBR is better to transform
     //the normal map to view space + im lazy to move the lights to the vertex shader
 
-    vec3 T = normalize(vec3(model * vec4(aTangent, 0.0)));
-    vec3 B = normalize(vec3(model * vec4(aBitangent, 0.0)));
+    vec3 T = normalize(vec3(model * vec4(tangent.xyz, 0.0)));
+    vec3 B = normalize(vec3(model * vec4(bitangent, 0.0)));
     vec3 N = normalize(vec3(model * vec4(totalNormal, 0.0)));
 
     Output.TBN = mat3(T, B, N);
@@ -172,13 +188,6 @@ struct Material
     // 1 = alpha
     // 2 = alpha cutoff
     float alphaCutoff;
-
-    int hasAlbedo;
-    int hasNormal;
-    int hasMetallic;
-    int hasRoughness;
-    int hasAO;
-    int hasEmissive;
 };
 
 uniform Material material;
@@ -316,30 +325,57 @@ float ShadowCalculation(int lightIdx)
 
 void main()
 {
-    vec3 albedo = material.hasAlbedo * (texture(material.albedoMap, VertexInput.TexCoords).rgb * material.color.rgb) + (1 - material.hasAlbedo) * material.color.rgb;
+#ifdef HAS_ALBEDO_MAP
+    vec4 albedoSample = texture(material.albedoMap, VertexInput.TexCoords);
+    vec3 albedo = albedoSample.rgb * material.color.rgb;
+    float albedoAlpha = albedoSample.a;
+#else
+    vec3 albedo = material.color.rgb;
+    float albedoAlpha = material.color.a;
+#endif
 
     float alpha = 1.0;
     if (material.transparencyMode == 1) {
-        alpha = material.hasAlbedo * (texture(material.albedoMap, VertexInput.TexCoords).a) + (1 - material.hasAlbedo) * material.color.a;
+        alpha = albedoAlpha;
     }
     else if (material.transparencyMode == 2) {
-        alpha = material.hasAlbedo * (texture(material.albedoMap, VertexInput.TexCoords).a) + (1 - material.hasAlbedo) * material.color.a;
+        alpha = albedoAlpha;
         if (alpha < material.alphaCutoff) {
             discard;
         }
     }
 
-    // Revise this type of conditional assignment (the commented one) because i think can lead to some undefined behavior in the shader!!!!!
-    vec3 normal/*  = material.hasNormal * (VertexInput.TBN * (texture(material.normalMap, VertexInput.TexCoords).rgb * 2.0 - 1.0)) + (1 - material.hasNormal) * VertexInput.Normal */;
-    if (material.hasNormal == 1) {
-        normal = VertexInput.TBN * (texture(material.normalMap, VertexInput.TexCoords).rgb * 2.0 - 1.0);
-    } else {
-        normal = VertexInput.Normal;
-    }
-    float metallic = material.hasMetallic * (texture(material.metallicMap, VertexInput.TexCoords).b * material.metallic) + (1 - material.hasMetallic) * material.metallic;
-    float roughness = material.hasRoughness * (texture(material.roughnessMap, VertexInput.TexCoords).g * material.roughness) + (1 - material.hasRoughness) * material.roughness;
-    float ao = material.hasAO * (texture(material.aoMap, VertexInput.TexCoords).r * material.ao) + (1 - material.hasAO) * material.ao;
-    vec3 emissive = material.hasEmissive * (texture(material.emissiveMap, VertexInput.TexCoords).rgb * material.emissive) + (1 - material.hasEmissive) * material.emissive;
+#ifdef HAS_NORMAL_MAP
+    // Normal maps can be stored with two channels (BC5), the z is rebuilt from the unit length
+    vec2 normalXY = texture(material.normalMap, VertexInput.TexCoords).rg * 2.0 - 1.0;
+    vec3 normal = VertexInput.TBN * vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
+#else
+    vec3 normal = VertexInput.Normal;
+#endif
+
+#ifdef HAS_METALLIC_MAP
+    float metallic = texture(material.metallicMap, VertexInput.TexCoords).b * material.metallic;
+#else
+    float metallic = material.metallic;
+#endif
+
+#ifdef HAS_ROUGHNESS_MAP
+    float roughness = texture(material.roughnessMap, VertexInput.TexCoords).g * material.roughness;
+#else
+    float roughness = material.roughness;
+#endif
+
+#ifdef HAS_AO_MAP
+    float ao = texture(material.aoMap, VertexInput.TexCoords).r * material.ao;
+#else
+    float ao = material.ao;
+#endif
+
+#ifdef HAS_EMISSIVE_MAP
+    vec3 emissive = texture(material.emissiveMap, VertexInput.TexCoords).rgb * material.emissive;
+#else
+    vec3 emissive = material.emissive;
+#endif
 
     vec3 N = normalize(normal);
     vec3 V = normalize(VertexInput.camPos - VertexInput.WorldPos);
@@ -362,8 +398,10 @@ void main()
             L = normalize(-lights[i].direction);
             radiance = lights[i].color * lights[i].intensity;
 
+#ifdef RECEIVE_SHADOWS
             float shadow = ShadowCalculation(i);
             radiance *= (1.0 - shadow);
+#endif
         }
         else if(lights[i].type == 1)
         {
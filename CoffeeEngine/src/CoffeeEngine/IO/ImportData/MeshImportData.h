@@ -14,8 +14,11 @@ namespace Coffee
         std::string name;
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
+        std::vector<uint32_t> lodIndices; ///< Indices of the simplified LODs, one after the other.
+        std::vector<MeshLOD> lods; ///< Simplified LODs, with offsets relative to lodIndices.
         Ref<Material> material;
         AABB aabb;
+        bool quantizePositions = false; ///< Store the positions as unorm16 relative to the mesh bounds.
 
         MeshImportData() : ImportData(ResourceType::Mesh) {}
 
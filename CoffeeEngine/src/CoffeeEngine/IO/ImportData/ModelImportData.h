@@ -1,6 +1,8 @@
 #pragma once
 
+#include "CoffeeEngine/Animation/AnimationOptimization.h"
 #include "CoffeeEngine/IO/ImportData/ImportData.h"
+#include "CoffeeEngine/Renderer/MeshLODGenerator.h"
 #include <cereal/cereal.hpp>
 #include <cereal/types/unordered_map.hpp>
 #include <cereal/types/string.hpp>
@@ -13,16 +15,29 @@ namespace Coffee {
     {
         std::unordered_map<std::string, UUID> meshUUIDs;
         std::unordered_map<std::string, UUID> materialUUIDs;
+        MeshLODSettings lodSettings;
+        bool quantizePositions = false; ///< Store the positions of the static meshes as unorm16 relative to their bounds.
+        AnimationOptimizationSettings animationSettings; ///< Keyframe optimization of the animations.
 
         ModelImportData() : ImportData(ResourceType::Model) {}
 
         template<typename Archive> void serialize(Archive& archive, std::uint32_t const version)
         {
             archive(CEREAL_NVP(meshUUIDs), CEREAL_NVP(materialUUIDs), cereal::base_class<ImportData>(this));
+
+            if (version >= 1)
+                archive(CEREAL_NVP(lodSettings));
+
+            if (version >= 2)
+                archive(CEREAL_NVP(quantizePositions));
+
+            if (version >= 3)
+                archive(CEREAL_NVP(animationSettings));
         }
     };
 
 }
 
+CEREAL_CLASS_VERSION(Coffee::ModelImportData, 3);
 CEREAL_REGISTER_TYPE(Coffee::ModelImportData);
 CEREAL_REGISTER_POLYMORPHIC_RELATION(Coffee::ImportData, Coffee::ModelImportData);
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CoffeeEngine/IO/ImportData/ImportData.h"
+#include "CoffeeEngine/Renderer/TextureCompression.h"
 #include <cereal/cereal.hpp>
 #include <cereal/types/polymorphic.hpp>
 
@@ -10,15 +11,22 @@ namespace Coffee
     struct Texture2DImportData : public ImportData
     {
         bool sRGB = true;
+        TextureUsage usage = TextureUsage::Color; ///< What the texels represent, picks the mip filter and the block format.
+        bool compress = true; ///< Build the mips on import and store them block compressed in the cache.
+        bool highQuality = false; ///< Use BC7 instead of BC1/BC3 for colors and data.
 
         Texture2DImportData() : ImportData(ResourceType::Texture2D) {}
 
         template <typename Archive> void serialize(Archive& archive, std::uint32_t const version)
         {
             archive(cereal::base_class<ImportData>(this), CEREAL_NVP(sRGB));
+
+            if (version >= 1)
+                archive(CEREAL_NVP(usage), CEREAL_NVP(compress), CEREAL_NVP(highQuality));
         }
     };
 
 } // namespace Coffee
+CEREAL_CLASS_VERSION(Coffee::Texture2DImportData, 1);
 CEREAL_REGISTER_TYPE(Coffee::Texture2DImportData);
-CEREAL_REGISTER_POLYMORPHIC_RELATION(Coffee::ImportData, Coffee::Texture2DImportData);
\ No newline at end of file
+CEREAL_REGISTER_POLYMORPHIC_RELATION(Coffee::ImportData, Coffee::Texture2DImportData);
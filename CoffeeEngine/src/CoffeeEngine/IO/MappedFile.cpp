@@ -0,0 +1,116 @@
+#include "MappedFile.h"
+
+#include "CoffeeEngine/Core/Log.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Coffee {
+
+    MappedFile::MappedFile(const std::filesystem::path& path)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file); // The mapping keeps the file open
+        if (!mapping)
+            return;
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data)
+        {
+            CloseHandle(mapping);
+            return;
+        }
+
+        m_Data = static_cast<const uint8_t*>(data);
+        m_Size = static_cast<size_t>(size.QuadPart);
+        m_MappingHandle = mapping;
+#else
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            return;
+
+        struct stat info;
+        if (fstat(file, &info) != 0 || info.st_size == 0)
+        {
+            close(file);
+            return;
+        }
+
+        void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        close(file); // The mapping keeps the file open
+        if (data == MAP_FAILED)
+        {
+            COFFEE_CORE_WARN("MappedFile: Failed to map {0}", path.string());
+            return;
+        }
+
+        m_Data = static_cast<const uint8_t*>(data);
+        m_Size = static_cast<size_t>(info.st_size);
+#endif
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Unmap();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_Data(std::exchange(other.m_Data, nullptr)),
+          m_Size(std::exchange(other.m_Size, 0)),
+          m_MappingHandle(std::exchange(other.m_MappingHandle, nullptr))
+    {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Unmap();
+            m_Data = std::exchange(other.m_Data, nullptr);
+            m_Size = std::exchange(other.m_Size, 0);
+            m_MappingHandle = std::exchange(other.m_MappingHandle, nullptr);
+        }
+        return *this;
+    }
+
+    void MappedFile::Unmap()
+    {
+        if (!m_Data)
+            return;
+
+#ifdef _WIN32
+        UnmapViewOfFile(m_Data);
+        CloseHandle(static_cast<HANDLE>(m_MappingHandle));
+#else
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+
+        m_Data = nullptr;
+        m_Size = 0;
+        m_MappingHandle = nullptr;
+    }
+
+}
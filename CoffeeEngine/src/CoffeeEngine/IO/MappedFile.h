@@ -0,0 +1,68 @@
+/**
+ * @defgroup io IO
+ * @brief IO components of the CoffeeEngine.
+ * @{
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace Coffee {
+
+    /**
+     * @class MappedFile
+     * @brief Read-only memory mapping of a file.
+     *
+     * The content is paged in by the OS on access instead of being copied into a buffer, which makes
+     * it cheap to read large cached blobs that are consumed once (e.g. uploaded straight to the GPU).
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+
+        /**
+         * @brief Maps a file. Use IsValid to check whether it succeeded.
+         * @param path The path of the file to map.
+         */
+        explicit MappedFile(const std::filesystem::path& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        /**
+         * @brief Checks whether the file is mapped.
+         * @return True if the file is mapped and not empty.
+         */
+        bool IsValid() const { return m_Data != nullptr; }
+
+        /**
+         * @brief Gets the mapped content.
+         * @return A pointer to the first byte of the file, or nullptr if it is not mapped.
+         */
+        const uint8_t* GetData() const { return m_Data; }
+
+        /**
+         * @brief Gets the size of the mapped content.
+         * @return The size of the file in bytes.
+         */
+        size_t GetSize() const { return m_Size; }
+
+    private:
+        void Unmap();
+
+        const uint8_t* m_Data = nullptr; ///< The mapped content.
+        size_t m_Size = 0; ///< The size of the mapped content in bytes.
+        void* m_MappingHandle = nullptr; ///< The file mapping handle (Windows only).
+    };
+
+}
+
+/** @} */
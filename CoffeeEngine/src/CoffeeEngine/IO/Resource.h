@@ -108,6 +108,13 @@ namespace Coffee {
          */
         bool IsEmbedded() const { return m_isEmbedded; }
 
+        /**
+         * @brief Drops the CPU copy of data that was uploaded to the GPU, if the residency policy allows it.
+         *
+         * Called by the ResourceLoader once the resource is loaded and cached. See ResourceResidency.
+         */
+        virtual void TrimCPUData() {}
+
     private:
         friend class cereal::access;
 
@@ -1,16 +1,23 @@
 #include "ResourceLoader.h"
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/IO/CacheManager.h"
 #include "CoffeeEngine/IO/ImportData/ImportData.h"
 #include "CoffeeEngine/IO/ImportData/ImportDataUtils.h"
+#include "CoffeeEngine/IO/ImportData/ModelImportData.h"
+#include "CoffeeEngine/IO/ImportData/Texture2DImportData.h"
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/Renderer/Material.h"
 #include "CoffeeEngine/Renderer/Model.h"
 #include "CoffeeEngine/Renderer/Shader.h"
 #include "CoffeeEngine/Renderer/Texture.h"
+#include "CoffeeEngine/Renderer/TextureDecoder.h"
 #include "CoffeeEngine/IO/ResourceRegistry.h"
 #include "CoffeeEngine/IO/ResourceImporter.h"
 #include "CoffeeEngine/IO/ResourceUtils.h"
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
 #include <filesystem>
 #include <string>
 
@@ -151,10 +158,41 @@ namespace Coffee {
             return a < b;
         });
 
+        PrefetchTextures(files);
+
         for (const auto& path : files)
         {
             LoadFile(path);
         }
+
+        // Textures that were never loaded, e.g. imported by a model with other settings
+        TextureDecoder::ClearPrefetched();
+    }
+
+    void ResourceLoader::PrefetchTextures(const std::vector<std::filesystem::path>& files)
+    {
+        ZoneScoped;
+
+        // Models import their own textures with per-slot settings, the raw images are left to them
+        bool hasModels = std::any_of(files.begin(), files.end(), [](const std::filesystem::path& path) {
+            return GetResourceTypeFromExtension(path) == ResourceType::Model;
+        });
+
+        for (const auto& path : files)
+        {
+            if (path.extension() == ".import")
+            {
+                Scope<ImportData> importData = ImportDataUtils::LoadImportData(path);
+                if (importData->type == ResourceType::Texture2D && !ResourceRegistry::Exists(importData->uuid))
+                    Texture2D::Prefetch(static_cast<Texture2DImportData&>(*importData));
+            }
+            else if (!hasModels && GetResourceTypeFromExtension(path) == ResourceType::Texture2D && !ImportDataUtils::HasImportFile(path))
+            {
+                Texture2DImportData importData;
+                importData.originalPath = path;
+                Texture2D::Prefetch(importData);
+            }
+        }
     }
 
     void ResourceLoader::RemoveResource(const Ref<Resource>& resource)
@@ -225,6 +263,17 @@ namespace Coffee {
             }
             case ResourceType::Model:
             {
+                // The meshes are cached on their own, drop them so they are built again with the new settings
+                ModelImportData& modelImportData = static_cast<ModelImportData&>(*importData);
+                for (const auto& [name, meshUUID] : modelImportData.meshUUIDs)
+                {
+                    std::filesystem::path meshCachePath = CacheManager::GetCachedFilePath(meshUUID, ResourceType::Mesh);
+                    if (std::filesystem::exists(meshCachePath))
+                        std::filesystem::remove(meshCachePath);
+
+                    ResourceRegistry::Remove(meshUUID);
+                }
+
                 Load<Model>(*importData);
                 break;
             }
@@ -13,6 +13,7 @@
 #include "ImportData/ImportDataUtils.h"
 
 #include <filesystem>
+#include <vector>
 
 namespace Coffee {
     class ImportData;
@@ -63,6 +64,7 @@ namespace Coffee {
 
                 ImportDataUtils::SaveImportData(newImportData);
                 ResourceRegistry::Add(newImportData->uuid, resource);
+                TrimCPUData(resource);
 
                 return resource;
             }
@@ -79,6 +81,7 @@ namespace Coffee {
             const Ref<T>& resource = s_Importer.Import<T>(importData);
             
             ResourceRegistry::Add(importData.uuid, resource);
+            TrimCPUData(resource);
             return resource;
         }
 
@@ -93,6 +96,7 @@ namespace Coffee {
             const Ref<T>& resource = s_Importer.ImportEmbedded<T>(importData);
 
             ResourceRegistry::Add(importData.uuid, resource);
+            TrimCPUData(resource);
             return resource;
         }
 
@@ -112,6 +116,7 @@ namespace Coffee {
             if (resource)
             {
                 ResourceRegistry::Add(uuid, resource);
+                TrimCPUData(resource);
                 return resource;
             }
 
@@ -126,6 +131,23 @@ namespace Coffee {
     
     private:
         static bool isInternalResource(const std::filesystem::path& path);
+
+        /**
+         * @brief Starts decoding the textures of a directory that are not cached yet, before they are loaded one by one.
+         * @param files The files of the directory.
+         */
+        static void PrefetchTextures(const std::vector<std::filesystem::path>& files);
+
+        /**
+         * @brief Drops the CPU data of a resource that was just uploaded and cached, see ResourceResidency.
+         * @param resource The loaded resource.
+         */
+        template<typename T>
+        static void TrimCPUData(const Ref<T>& resource)
+        {
+            if (resource)
+                resource->TrimCPUData();
+        }
     private:
         static std::filesystem::path s_EngineAssetsDirectory; ///< The directory where the engine Resources are stored.
         static std::filesystem::path s_WorkingDirectory; ///< The working directory of the resource loader.
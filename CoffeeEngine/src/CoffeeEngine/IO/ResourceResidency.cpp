@@ -0,0 +1,52 @@
+#include "ResourceResidency.h"
+
+#include <array>
+#include <atomic>
+
+namespace Coffee {
+
+    static constexpr size_t s_ResourceTypeCount = (size_t)ResourceType::Prefab + 1;
+
+    static std::array<std::atomic<bool>, s_ResourceTypeCount> s_RetainCPUData = {};
+    static std::array<std::atomic<int64_t>, s_ResourceTypeCount> s_ResidentBytes = {};
+
+    static thread_local bool s_LoadingCPUDataOnly = false;
+
+    void ResourceResidency::SetRetainCPUData(ResourceType type, bool retain)
+    {
+        s_RetainCPUData[(size_t)type] = retain;
+    }
+
+    bool ResourceResidency::GetRetainCPUData(ResourceType type)
+    {
+        return s_RetainCPUData[(size_t)type];
+    }
+
+    void ResourceResidency::AddResidentBytes(ResourceType type, int64_t bytes)
+    {
+        s_ResidentBytes[(size_t)type] += bytes;
+    }
+
+    uint64_t ResourceResidency::GetResidentBytes(ResourceType type)
+    {
+        int64_t bytes = s_ResidentBytes[(size_t)type];
+        return bytes > 0 ? (uint64_t)bytes : 0;
+    }
+
+    bool ResourceResidency::IsLoadingCPUDataOnly()
+    {
+        return s_LoadingCPUDataOnly;
+    }
+
+    ResourceResidency::CPUDataLoadScope::CPUDataLoadScope()
+        : m_Previous(s_LoadingCPUDataOnly)
+    {
+        s_LoadingCPUDataOnly = true;
+    }
+
+    ResourceResidency::CPUDataLoadScope::~CPUDataLoadScope()
+    {
+        s_LoadingCPUDataOnly = m_Previous;
+    }
+
+}
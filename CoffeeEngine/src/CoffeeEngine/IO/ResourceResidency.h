@@ -0,0 +1,81 @@
+/**
+ * @defgroup io IO
+ * @brief IO components of the CoffeeEngine.
+ * @{
+ */
+
+#pragma once
+
+#include "CoffeeEngine/IO/Resource.h"
+
+#include <cstdint>
+
+namespace Coffee {
+
+    /**
+     * @class ResourceResidency
+     * @brief Decides which resources keep a CPU copy of their data once it is uploaded to the GPU.
+     *
+     * By default meshes and textures drop their vertices and pixels after the upload and the cache write.
+     * A user that needs them (navmesh baking, picking, ...) acquires them on the resource, which reloads
+     * them from the cache if they were dropped. The resident CPU bytes are tracked per resource type.
+     */
+    class ResourceResidency
+    {
+    public:
+        /**
+         * @brief Sets whether the resources of a type keep their CPU data after the upload.
+         * @param type The resource type.
+         * @param retain True to keep the CPU data of every resource of the type resident.
+         */
+        static void SetRetainCPUData(ResourceType type, bool retain);
+
+        /**
+         * @brief Gets whether the resources of a type keep their CPU data after the upload.
+         * @param type The resource type.
+         * @return True if the CPU data is kept resident.
+         */
+        static bool GetRetainCPUData(ResourceType type);
+
+        /**
+         * @brief Adds to the resident CPU bytes of a resource type. Called by the resources when they load or drop data.
+         * @param type The resource type.
+         * @param bytes The number of bytes, negative when the data is dropped.
+         */
+        static void AddResidentBytes(ResourceType type, int64_t bytes);
+
+        /**
+         * @brief Gets the CPU bytes held by the resources of a type.
+         * @param type The resource type.
+         * @return The resident CPU bytes.
+         */
+        static uint64_t GetResidentBytes(ResourceType type);
+
+        /**
+         * @brief Checks whether the resources deserialized on this thread must skip their GPU upload.
+         * @return True while a CPUDataLoadScope is alive on this thread.
+         */
+        static bool IsLoadingCPUDataOnly();
+
+        /**
+         * @brief While alive, resources deserialized on this thread only load their CPU data.
+         *
+         * Used to reload dropped CPU data from the cache without creating GPU objects.
+         */
+        class CPUDataLoadScope
+        {
+        public:
+            CPUDataLoadScope();
+            ~CPUDataLoadScope();
+
+            CPUDataLoadScope(const CPUDataLoadScope&) = delete;
+            CPUDataLoadScope& operator=(const CPUDataLoadScope&) = delete;
+
+        private:
+            bool m_Previous;
+        };
+    };
+
+}
+
+/** @} */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/Log.h"
 #include "CoffeeEngine/IO/ResourceUtils.h"
 #include "CoffeeEngine/IO/CacheManager.h"
 #include <cereal/archives/json.hpp>
@@ -30,6 +31,24 @@ namespace Coffee
         template<typename T>
         static void Save(const std::filesystem::path& path, const Ref<T>& resource)
         {
+            // Resources that drop their CPU data after the upload reload it from the cache for the write. This must
+            // happen before the file is opened, the cache being written may be the one the data is reloaded from.
+            bool reloadCPUData = false;
+            if constexpr (requires { resource->IsCPUDataResident(); resource->AcquireCPUData(); resource->ReleaseCPUData(); })
+            {
+                reloadCPUData = !resource->IsCPUDataResident();
+                if (reloadCPUData)
+                {
+                    resource->AcquireCPUData();
+                    if (!resource->IsCPUDataResident())
+                    {
+                        COFFEE_CORE_ERROR("ResourceSaver::Save: Could not reload the CPU data of {0}, {1} was not written", resource->GetName(), path.string());
+                        resource->ReleaseCPUData();
+                        return;
+                    }
+                }
+            }
+
             std::filesystem::create_directories(path.parent_path());
             ResourceFormat format = GetResourceSaveFormatFromType(GetResourceType<T>());
             switch (format)
@@ -44,6 +63,12 @@ namespace Coffee
             default:
                 break;
             }
+
+            if constexpr (requires { resource->ReleaseCPUData(); })
+            {
+                if (reloadCPUData)
+                    resource->ReleaseCPUData();
+            }
         }
 
         /**
@@ -25,7 +25,10 @@ namespace Coffee
     {
         m_Triangles.clear();
 
+        // The CPU copy of the mesh is dropped after the upload, hold it while the triangles are built
+        mesh->AcquireCPUData();
         ProcessMesh(mesh->GetVertices(), mesh->GetIndices(), worldTransform);
+        mesh->ReleaseCPUData();
 
         CalculateNeighbors();
 
@@ -27,4 +27,8 @@ namespace Coffee {
     const CollisionCallback::CollisionFunction& CollisionCallback::GetOnCollisionExit() const {
         return m_OnCollisionExit;
     }
+
+    bool CollisionCallback::HasAny() const {
+        return m_OnCollisionEnter || m_OnCollisionStay || m_OnCollisionExit;
+    }
 }
\ No newline at end of file
@@ -27,6 +27,8 @@ namespace Coffee {
         const CollisionFunction& GetOnCollisionStay() const;
         const CollisionFunction& GetOnCollisionExit() const;
 
+        bool HasAny() const;
+
     private:
         CollisionFunction m_OnCollisionEnter;
         CollisionFunction m_OnCollisionStay;
@@ -4,93 +4,150 @@
 #include <BulletCollision/NarrowPhaseCollision/btPersistentManifold.h>
 #include <tracy/Tracy.hpp>
 
+#include <algorithm>
+#include <utility>
+
 namespace Coffee {
 
     Scene* CollisionSystem::s_Scene = nullptr;
-    std::unordered_set<std::pair<btCollisionObject*, btCollisionObject*>, PairHash> CollisionSystem::s_ActiveCollisions;
+    std::vector<CollisionSystem::CollisionPair> CollisionSystem::s_ActivePairs;
+    std::vector<CollisionSystem::CollisionPair> CollisionSystem::s_CurrentPairs;
+    std::vector<CollisionSystem::PendingEvent> CollisionSystem::s_Events;
 
     void CollisionSystem::Initialize(Scene* scene) {
         s_Scene = scene;
+        s_ActivePairs.clear();
+    }
+
+    bool CollisionSystem::isTracked(entt::entity entityA, entt::entity entityB) {
+        auto& registry = s_Scene->m_Registry;
+        if (!registry.valid(entityA) || !registry.valid(entityB))
+            return false;
+
+        auto* rbA = registry.try_get<RigidbodyComponent>(entityA);
+        auto* rbB = registry.try_get<RigidbodyComponent>(entityB);
+
+        return rbA && rbB && (rbA->callback.HasAny() || rbB->callback.HasAny());
     }
 
     void CollisionSystem::checkCollisions(const PhysicsWorld& world) {
 
         ZoneScoped;
 
-        std::unordered_set<std::pair<btCollisionObject*, btCollisionObject*>, PairHash> currentCollisions;
+        if (!s_Scene)
+            return;
+
+        btDispatcher* dispatcher = world.getDynamicsWorld()->getDispatcher();
 
-        int numManifolds = world.getDynamicsWorld()->getDispatcher()->getNumManifolds();
+        s_CurrentPairs.clear();
+
+        int numManifolds = dispatcher->getNumManifolds();
         for (int i = 0; i < numManifolds; i++) {
-            ::btPersistentManifold* contactManifold = world.getDynamicsWorld()->getDispatcher()->getManifoldByIndexInternal(i);
-            auto objA = const_cast<btCollisionObject*>(contactManifold->getBody0());
-            auto objB = const_cast<btCollisionObject*>(contactManifold->getBody1());
-
-            // Get entities from collision objects
-            Entity entityA(static_cast<entt::entity>(reinterpret_cast<size_t>(objA->getUserPointer())), s_Scene);
-            Entity entityB(static_cast<entt::entity>(reinterpret_cast<size_t>(objB->getUserPointer())), s_Scene);
-
-            if (contactManifold->getNumContacts() > 0) {
-                auto pair = std::make_pair(objA, objB);
-                currentCollisions.insert(pair);
-
-                // CollisionInfo info = { entityA, entityB, contactManifold };
-                CollisionInfo info{entityA, entityB, contactManifold};
-
-                // Handle collision enter
-                if (s_ActiveCollisions.find(pair) == s_ActiveCollisions.end()) {
-                    if (entityA.HasComponent<RigidbodyComponent>() && entityB.HasComponent<RigidbodyComponent>()) {
-                        auto& rbA = entityA.GetComponent<RigidbodyComponent>();
-                        auto& rbB = entityB.GetComponent<RigidbodyComponent>();
-
-                        if (rbA.callback.GetOnCollisionEnter())
-                            rbA.callback.GetOnCollisionEnter()(info);
-                        if (rbB.callback.GetOnCollisionEnter())
-                            rbB.callback.GetOnCollisionEnter()(info);
-                    }
-                }
-                // Handle collision stay
-                else {
-                    if (entityA.HasComponent<RigidbodyComponent>() && entityB.HasComponent<RigidbodyComponent>())
-                    {
-                        auto& rbA = entityA.GetComponent<RigidbodyComponent>();
-                        auto& rbB = entityB.GetComponent<RigidbodyComponent>();
-
-                        if (rbA.callback.GetOnCollisionStay())
-                            rbA.callback.GetOnCollisionStay()(info);
-                        if (rbB.callback.GetOnCollisionStay())
-                            rbB.callback.GetOnCollisionStay()(info);
-                    }
-                }
-            }
+            ::btPersistentManifold* contactManifold = dispatcher->getManifoldByIndexInternal(i);
+            if (contactManifold->getNumContacts() <= 0)
+                continue;
+
+            CollisionPair pair;
+            pair.objA = contactManifold->getBody0();
+            pair.objB = contactManifold->getBody1();
+            pair.manifold = contactManifold;
+
+            // Order the objects so the pair is found in the previous step whichever body Bullet reports first
+            if (pair.objB < pair.objA)
+                std::swap(pair.objA, pair.objB);
+
+            pair.entityA = static_cast<entt::entity>(reinterpret_cast<size_t>(pair.objA->getUserPointer()));
+            pair.entityB = static_cast<entt::entity>(reinterpret_cast<size_t>(pair.objB->getUserPointer()));
+
+            if (isTracked(pair.entityA, pair.entityB))
+                s_CurrentPairs.push_back(pair);
         }
 
-        // Handle collision exit
-        for (const auto& pair : s_ActiveCollisions) {
-            if (currentCollisions.find(pair) == currentCollisions.end()) {
-                Entity entityA(static_cast<entt::entity>(reinterpret_cast<size_t>(pair.first->getUserPointer())), s_Scene);
-                Entity entityB(static_cast<entt::entity>(reinterpret_cast<size_t>(pair.second->getUserPointer())), s_Scene);
+        std::sort(s_CurrentPairs.begin(), s_CurrentPairs.end());
 
-                CollisionInfo info = { entityA, entityB, nullptr };
+        // Compound shapes can report several manifolds for the same pair, keep the first one
+        s_CurrentPairs.erase(std::unique(s_CurrentPairs.begin(), s_CurrentPairs.end(),
+                                         [](const CollisionPair& a, const CollisionPair& b) { return a.sameObjects(b); }),
+                             s_CurrentPairs.end());
 
-                if (entityA.HasComponent<RigidbodyComponent>() && entityB.HasComponent<RigidbodyComponent>())
-                {
-                    auto& rbA = entityA.GetComponent<RigidbodyComponent>();
-                    auto& rbB = entityB.GetComponent<RigidbodyComponent>();
+        // Merge both sorted arrays, a pair is in the current step, the previous one or both
+        s_Events.clear();
 
-                    if (rbA.callback.GetOnCollisionExit())
-                        rbA.callback.GetOnCollisionExit()(info);
-                    if (rbB.callback.GetOnCollisionExit())
-                        rbB.callback.GetOnCollisionExit()(info);
-                }
+        size_t current = 0, active = 0;
+        while (current < s_CurrentPairs.size() || active < s_ActivePairs.size()) {
+            if (active == s_ActivePairs.size() ||
+                (current < s_CurrentPairs.size() && s_CurrentPairs[current] < s_ActivePairs[active])) {
+                s_Events.push_back({s_CurrentPairs[current++], CollisionEvent::Enter});
+            }
+            else if (current == s_CurrentPairs.size() || s_ActivePairs[active] < s_CurrentPairs[current]) {
+                PendingEvent event{s_ActivePairs[active++], CollisionEvent::Exit};
+                event.pair.manifold = nullptr;
+                s_Events.push_back(event);
+            }
+            else {
+                s_Events.push_back({s_CurrentPairs[current++], CollisionEvent::Stay});
+                active++;
             }
         }
 
-        s_ActiveCollisions = currentCollisions;
+        std::swap(s_ActivePairs, s_CurrentPairs);
+
+        for (const PendingEvent& event : s_Events)
+            deliver(event);
+    }
+
+    void CollisionSystem::deliver(const PendingEvent& event) {
+        auto& registry = s_Scene->m_Registry;
+
+        // A callback earlier in the batch may have destroyed one of the entities
+        if (!registry.valid(event.pair.entityA) || !registry.valid(event.pair.entityB))
+            return;
+
+        auto* rbA = registry.try_get<RigidbodyComponent>(event.pair.entityA);
+        auto* rbB = registry.try_get<RigidbodyComponent>(event.pair.entityB);
+        if (!rbA || !rbB)
+            return;
+
+        Entity entityA(event.pair.entityA, s_Scene);
+        Entity entityB(event.pair.entityB, s_Scene);
+
+        CollisionInfo info{entityA, entityB, event.pair.manifold};
+
+        auto raise = [&info, &event](const CollisionCallback& callback) {
+            const CollisionCallback::CollisionFunction* fn = nullptr;
+            switch (event.type) {
+                case CollisionEvent::Enter: fn = &callback.GetOnCollisionEnter(); break;
+                case CollisionEvent::Stay: fn = &callback.GetOnCollisionStay(); break;
+                case CollisionEvent::Exit: fn = &callback.GetOnCollisionExit(); break;
+            }
+            if (*fn)
+                (*fn)(info);
+        };
+
+        raise(rbA->callback);
+
+        // The callback of A may have removed a body, which cleared the manifold of the event
+        info.manifold = event.pair.manifold;
+
+        // Look the rigidbody of B up again, the callback of A may have destroyed it or moved its storage
+        if (registry.valid(event.pair.entityB))
+            if (auto* rb = registry.try_get<RigidbodyComponent>(event.pair.entityB))
+                raise(rb->callback);
+    }
+
+    void CollisionSystem::onCollisionObjectRemoved(const btCollisionObject* object) {
+        // Only the events hold manifolds past the step, the active pairs get fresh ones from the next step
+        for (PendingEvent& event : s_Events) {
+            if (event.pair.objA == object || event.pair.objB == object)
+                event.pair.manifold = nullptr;
+        }
     }
 
     void CollisionSystem::Shutdown() {
-        s_ActiveCollisions.clear();
+        s_ActivePairs.clear();
+        s_CurrentPairs.clear();
+        s_Events.clear();
         s_Scene = nullptr;
     }
 
-}
\ No newline at end of file
+}
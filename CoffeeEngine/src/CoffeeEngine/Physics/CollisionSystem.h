@@ -2,34 +2,93 @@
 
 #define BT_NO_SIMD_OPERATOR_OVERLOADS
 
-#include <unordered_set>
 #include <btBulletDynamicsCommon.h>
+#include <entt/entity/entity.hpp>
+
+#include <cstdint>
+#include <vector>
 
 namespace Coffee {
-    
+
     class Scene;
     class PhysicsWorld;
 }
 
 namespace Coffee {
 
-    // Helper struct to hash collision pair
-    struct PairHash {
-        template <class T1, class T2>
-        std::size_t operator()(const std::pair<T1, T2>& p) const {
-            return std::hash<T1>{}(p.first) ^ std::hash<T2>{}(p.second);
-        }
-    };
-
+    /**
+     * @brief Tracks the contacts between rigidbodies and raises their collision callbacks.
+     *
+     * The touching pairs of each step are kept in a flat array sorted by collision objects. The array of the
+     * previous step is diffed against the current one in a single merge pass: pairs only in the current one
+     * enter, pairs in both stay and pairs only in the previous one exit. Both arrays and the event list are
+     * reused across steps, so tracking the contacts does not allocate once they have grown to the working set.
+     *
+     * Only pairs where both objects belong to rigidbodies, and at least one of them has a collision callback,
+     * are tracked. The events are delivered in a batch after the diff, so a callback can add or remove
+     * rigidbodies while the dispatcher is not walking its manifolds. Bullet frees the manifolds of a removed
+     * body: the events of the batch still to deliver for it keep their entities but get a null manifold.
+     */
     class CollisionSystem {
     public:
         static void Initialize(Scene* scene);
         static void checkCollisions(const PhysicsWorld& world);
         static void Shutdown();
 
+        /**
+         * @brief Clears the manifolds of the pending events of a body removed from the world, which freed them.
+         * @param object The collision object of the removed body.
+         */
+        static void onCollisionObjectRemoved(const btCollisionObject* object);
+
       private:
+        /**
+         * @brief Two collision objects in contact, ordered by address so a pair has a single representation.
+         */
+        struct CollisionPair
+        {
+            const btCollisionObject* objA = nullptr;
+            const btCollisionObject* objB = nullptr;
+            entt::entity entityA = entt::null;
+            entt::entity entityB = entt::null;
+            btPersistentManifold* manifold = nullptr; ///< The manifold of the current step, null once the pair or one of its bodies is gone.
+
+            bool operator<(const CollisionPair& other) const
+            {
+                return objA != other.objA ? objA < other.objA : objB < other.objB;
+            }
+
+            bool sameObjects(const CollisionPair& other) const { return objA == other.objA && objB == other.objB; }
+        };
+
+        enum class CollisionEvent : uint8_t
+        {
+            Enter,
+            Stay,
+            Exit
+        };
+
+        struct PendingEvent
+        {
+            CollisionPair pair;
+            CollisionEvent type;
+        };
+
+        /**
+         * @brief Checks whether a pair of entities should be tracked.
+         * @return True if both have a rigidbody and at least one of them has a collision callback.
+         */
+        static bool isTracked(entt::entity entityA, entt::entity entityB);
+
+        /**
+         * @brief Raises the callbacks of both entities of a pair for an event.
+         */
+        static void deliver(const PendingEvent& event);
+
         static Scene* s_Scene;
-        static std::unordered_set<std::pair<btCollisionObject*, btCollisionObject*>, PairHash> s_ActiveCollisions;
+        static std::vector<CollisionPair> s_ActivePairs; ///< The pairs touching in the last step, sorted.
+        static std::vector<CollisionPair> s_CurrentPairs; ///< The pairs touching in this step, kept to reuse its memory.
+        static std::vector<PendingEvent> s_Events; ///< The events of this step, kept to reuse its memory.
     };
 
-}
\ No newline at end of file
+}
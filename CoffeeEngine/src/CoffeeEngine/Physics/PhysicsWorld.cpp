@@ -1,21 +1,169 @@
 #include "CoffeeEngine/Physics/PhysicsWorld.h"
+#include "CoffeeEngine/Core/JobSystem.h"
+#include "CoffeeEngine/Core/Log.h"
 #include "CoffeeEngine/Physics/CollisionSystem.h"
 #include "CoffeeEngine/Renderer/Renderer2D.h"
 #include "CoffeeEngine/Scene/SceneManager.h"
 #include "CoffeeEngine/Scene/Entity.h"
 
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <LinearMath/btThreads.h>
+
 #include <glm/fwd.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
 #include <tracy/Tracy.hpp>
 
 namespace Coffee {
 
-    PhysicsWorld::PhysicsWorld() {
-        collisionConfig = new btDefaultCollisionConfiguration();
-        dispatcher = new btCollisionDispatcher(collisionConfig);
-        broadphase = new btDbvtBroadphase();
-        solver = new btSequentialImpulseConstraintSolver();
-        dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfig);
+    /**
+     * @brief Runs the parallel loops of Bullet on the job system, so physics shares the workers of the engine.
+     *
+     * The thread count follows the running job system, it is read again on every query instead of being kept from
+     * when the scheduler was installed.
+     */
+    class JobSystemTaskScheduler : public btITaskScheduler {
+    public:
+        JobSystemTaskScheduler() : btITaskScheduler("JobSystem") {}
+
+        int getMaxNumThreads() const override {
+            // The workers and the thread stepping the world, each one gets a thread index from Bullet
+            return std::min<int>(JobSystem::GetWorkerCount() + 1, BT_MAX_THREAD_COUNT);
+        }
+
+        int getNumThreads() const override { return getMaxNumThreads(); }
+
+        // The job system decides how many threads take the ranges, every worker helps
+        void setNumThreads(int) override {}
+
+        void parallelFor(int begin, int end, int grainSize, const btIParallelForBody& body) override {
+            // Tells Bullet to lock its shared state, e.g. the manifold and algorithm pools, while the loop runs
+            btPushThreadsAreRunning();
+            JobSystem::ParallelFor(uint32_t(end - begin), uint32_t(std::max(grainSize, 1)), [&](uint32_t rangeBegin, uint32_t rangeEnd) {
+                body.forLoop(begin + int(rangeBegin), begin + int(rangeEnd));
+            });
+            btPopThreadsAreRunning();
+        }
+
+        btScalar parallelSum(int begin, int end, int grainSize, const btIParallelSumBody& body) override {
+            std::mutex mutex;
+            btScalar sum = 0;
+            btPushThreadsAreRunning();
+            JobSystem::ParallelFor(uint32_t(end - begin), uint32_t(std::max(grainSize, 1)), [&](uint32_t rangeBegin, uint32_t rangeEnd) {
+                const btScalar rangeSum = body.sumLoop(begin + int(rangeBegin), begin + int(rangeEnd));
+                std::lock_guard lock(mutex);
+                sum += rangeSum;
+            });
+            btPopThreadsAreRunning();
+            return sum;
+        }
+
+        void sleepWorkerThreadsHint() override {}
+    };
+
+    /**
+     * @brief Adds a Tracy zone around each phase of a step of a Bullet world.
+     */
+    template<typename World>
+    class ProfiledDynamicsWorld : public World {
+    public:
+        using World::World;
+
+        void updateAabbs() override {
+            ZoneScopedN("Physics Update AABBs");
+            World::updateAabbs();
+        }
+
+        void computeOverlappingPairs() override {
+            ZoneScopedN("Physics Broadphase");
+            World::computeOverlappingPairs();
+        }
+
+        void performDiscreteCollisionDetection() override {
+            ZoneScopedN("Physics Collision Detection");
+            World::performDiscreteCollisionDetection();
+        }
+
+    protected:
+        void predictUnconstraintMotion(btScalar timeStep) override {
+            ZoneScopedN("Physics Predict Motion");
+            World::predictUnconstraintMotion(timeStep);
+        }
+
+        void calculateSimulationIslands() override {
+            ZoneScopedN("Physics Islands");
+            World::calculateSimulationIslands();
+        }
+
+        void solveConstraints(btContactSolverInfo& solverInfo) override {
+            ZoneScopedN("Physics Solver");
+            World::solveConstraints(solverInfo);
+        }
+
+        void integrateTransforms(btScalar timeStep) override {
+            ZoneScopedN("Physics Integrate");
+            World::integrateTransforms(timeStep);
+        }
+
+        void updateActivationState(btScalar timeStep) override {
+            ZoneScopedN("Physics Activation");
+            World::updateActivationState(timeStep);
+        }
+    };
+
+    PhysicsWorld::PhysicsWorld() : PhysicsWorld(s_Multithreaded) {}
+
+    PhysicsWorld::PhysicsWorld(bool multithreaded) {
+#if !BT_THREADSAFE
+        // Without it Bullet does not lock its pools, its parallel loops would corrupt them
+        if (multithreaded) {
+            COFFEE_CORE_WARN("PhysicsWorld: Bullet was built without multithreading (BT_THREADSAFE), creating a single-threaded world");
+            multithreaded = false;
+        }
+#endif
+
+        // The per-thread storage of Bullet is sized when the world is created, workers started later would overflow it
+        if (multithreaded && JobSystem::GetWorkerCount() == 0) {
+            COFFEE_CORE_WARN("PhysicsWorld: the job system is not running, creating a single-threaded world");
+            multithreaded = false;
+        }
+
+        if (multithreaded) {
+            // Bullet keeps a single global scheduler, installed with the first multithreaded world
+            static JobSystemTaskScheduler taskScheduler;
+            if (btGetTaskScheduler() != &taskScheduler) {
+                // Bullet numbers the threads as they first ask, the thread stepping the worlds must be number 0
+                btGetCurrentThreadIndex();
+                btSetTaskScheduler(&taskScheduler);
+            }
+
+            // The pools are shared by the narrowphase threads, larger ones avoid falling back to the heap
+            btDefaultCollisionConstructionInfo constructionInfo;
+            constructionInfo.m_defaultMaxPersistentManifoldPoolSize = 8192;
+            constructionInfo.m_defaultMaxCollisionAlgorithmPoolSize = 8192;
+            collisionConfig = new btDefaultCollisionConfiguration(constructionInfo);
+
+            constexpr int pairsPerJob = 40;
+            dispatcher = new btCollisionDispatcherMt(collisionConfig, pairsPerJob);
+            broadphase = new btDbvtBroadphase();
+            // Bullet picks the solver of an island from the index of the thread solving it, with one solver per
+            // possible index two threads never wait on the same one, whatever threads were given indices before
+            solverPool = new btConstraintSolverPoolMt(BT_MAX_THREAD_COUNT);
+            solver = new btSequentialImpulseConstraintSolverMt();
+            dynamicsWorld = new ProfiledDynamicsWorld<btDiscreteDynamicsWorldMt>(dispatcher, broadphase, solverPool, solver, collisionConfig);
+        } else {
+            collisionConfig = new btDefaultCollisionConfiguration();
+            dispatcher = new btCollisionDispatcher(collisionConfig);
+            broadphase = new btDbvtBroadphase();
+            solver = new btSequentialImpulseConstraintSolver();
+            dynamicsWorld = new ProfiledDynamicsWorld<btDiscreteDynamicsWorld>(dispatcher, broadphase, solver, collisionConfig);
+        }
+
         dynamicsWorld->setGravity(btVector3(0, GRAVITY, 0));
 
         dynamicsWorld->getDispatchInfo().m_allowedCcdPenetration = 0.0001f;
@@ -34,6 +182,7 @@ namespace Coffee {
 
         delete dynamicsWorld;
         delete solver;
+        delete solverPool;
         delete broadphase;
         delete dispatcher;
         delete collisionConfig;
@@ -45,12 +194,70 @@ namespace Coffee {
 
     void PhysicsWorld::removeRigidBody(btRigidBody* body) const {
         dynamicsWorld->removeRigidBody(body);
+        CollisionSystem::onCollisionObjectRemoved(body);
     }
 
-    void PhysicsWorld::stepSimulation(const float dt) const {
+    void PhysicsWorld::stepSimulation(const float dt) {
         ZoneScoped;
-        dynamicsWorld->stepSimulation(dt);
-        CollisionSystem::checkCollisions(*this);
+
+        stepStats = PhysicsStepStats();
+
+        if (!timestepSettings.fixedTimestep) {
+            dynamicsWorld->stepSimulation(dt);
+            CollisionSystem::checkCollisions(*this);
+            previousTransforms.clear();
+            return;
+        }
+
+        const double fixedDeltaTime = std::max(timestepSettings.fixedDeltaTime, 0.001f);
+
+        // Spiral of death: a slow frame must not schedule more work than the next frame can do
+        const float frameTime = std::min(dt, timestepSettings.maxFrameTime);
+        stepStats.droppedTime = dt - frameTime;
+        accumulator += frameTime;
+
+        while (accumulator >= fixedDeltaTime && stepStats.subSteps < timestepSettings.maxSubSteps) {
+            ZoneScopedN("PhysicsWorld Substep");
+
+            if (timestepSettings.interpolate) {
+                const btCollisionObjectArray& objects = dynamicsWorld->getCollisionObjectArray();
+                previousTransforms.resize(objects.size());
+                for (int i = 0; i < objects.size(); i++)
+                    previousTransforms[i] = { objects[i], objects[i]->getWorldTransform() };
+            }
+
+            // No substeps on Bullet's side, it steps by exactly fixedDeltaTime
+            dynamicsWorld->stepSimulation(btScalar(fixedDeltaTime), 0);
+            CollisionSystem::checkCollisions(*this);
+
+            accumulator -= fixedDeltaTime;
+            stepStats.subSteps++;
+        }
+
+        if (accumulator >= fixedDeltaTime) {
+            const double leftOver = std::fmod(accumulator, fixedDeltaTime);
+            stepStats.droppedTime += float(accumulator - leftOver);
+            accumulator = leftOver;
+        }
+
+        stepStats.interpolationAlpha = timestepSettings.interpolate ? float(accumulator / fixedDeltaTime) : 1.0f;
+    }
+
+    btTransform PhysicsWorld::getInterpolatedTransform(const btCollisionObject* object) const {
+        const btTransform& current = object->getWorldTransform();
+
+        const int index = object->getWorldArrayIndex();
+        if (!timestepSettings.fixedTimestep || !timestepSettings.interpolate ||
+            index < 0 || index >= previousTransforms.size() || previousTransforms[index].first != object)
+            return current;
+
+        const btTransform& previous = previousTransforms[index].second;
+        const btScalar alpha = stepStats.interpolationAlpha;
+
+        btTransform interpolated;
+        interpolated.setOrigin(previous.getOrigin().lerp(current.getOrigin(), alpha));
+        interpolated.setRotation(previous.getRotation().slerp(current.getRotation(), alpha));
+        return interpolated;
     }
 
     void PhysicsWorld::setGravity(const float gravity) const {
@@ -5,10 +5,13 @@
 #include "CoffeeEngine/Core/Base.h"
 
 #include <btBulletDynamicsCommon.h>
+#include <cereal/cereal.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <vector>
 
+class btConstraintSolverPoolMt;
+
 namespace Coffee {
 
     constexpr float GRAVITY = -9.81f;
@@ -23,15 +26,86 @@ namespace Coffee {
         float hitFraction = 1.0f;  // Fraction of the ray where the hit occurred
     };
 
+    /**
+     * @brief How the simulation advances with the frame time.
+     *
+     * The fixed timestep is opt-in per scene: the scenes saved before it existed keep stepping with the frame time.
+     */
+    struct PhysicsTimestepSettings {
+        bool fixedTimestep = false; ///< Step by fixedDeltaTime, otherwise the frame time is forwarded to Bullet as it is.
+        float fixedDeltaTime = 1.0f / 60.0f; ///< The duration of a substep, in seconds.
+        int maxSubSteps = 8; ///< The most substeps a frame can run, the time left over is dropped.
+        float maxFrameTime = 0.25f; ///< Longer frames are clamped to this, so a spike cannot trigger ever more substeps.
+        bool interpolate = true; ///< Blend the rendered transforms between the last two substeps.
+
+        template <class Archive> void serialize(Archive& archive, const std::uint32_t version) {
+            archive(cereal::make_nvp("FixedTimestep", fixedTimestep),
+                    cereal::make_nvp("FixedDeltaTime", fixedDeltaTime),
+                    cereal::make_nvp("MaxSubSteps", maxSubSteps),
+                    cereal::make_nvp("MaxFrameTime", maxFrameTime),
+                    cereal::make_nvp("Interpolate", interpolate));
+        }
+    };
+
+    /**
+     * @brief What the last call to stepSimulation did.
+     */
+    struct PhysicsStepStats {
+        int subSteps = 0; ///< The substeps run.
+        float droppedTime = 0.0f; ///< The simulation time lost to the clamp and the substep budget.
+        float interpolationAlpha = 1.0f; ///< How far the rendered transforms are from the previous substep to the last one.
+    };
+
     class PhysicsWorld {
 
     public:
+        /**
+         * @brief Creates a world, multithreaded if selected with setMultithreaded.
+         */
         PhysicsWorld();
+
+        /**
+         * @brief Creates a world.
+         * @param multithreaded Run the narrowphase, the solver and the integration on the job system workers. Ignored
+         *        when the job system is not running.
+         */
+        explicit PhysicsWorld(bool multithreaded);
         ~PhysicsWorld();
 
+        /**
+         * @brief Selects the kind of the worlds created from now on, the existing ones are unchanged.
+         *
+         * Set from the project settings when a project is loaded.
+         * @param multithreaded Whether to create multithreaded worlds.
+         */
+        static void setMultithreaded(bool multithreaded) { s_Multithreaded = multithreaded; }
+        static bool getMultithreaded() { return s_Multithreaded; }
+
+        bool isMultithreaded() const { return solverPool != nullptr; }
+
         void addRigidBody(btRigidBody* body) const;
         void removeRigidBody(btRigidBody* body) const;
-        void stepSimulation(float dt) const;
+
+        /**
+         * @brief Advances the simulation by the frame time.
+         *
+         * With a fixed timestep the frame time is accumulated and consumed in substeps of the same duration, so
+         * the simulation does not depend on the frame rate. The collision callbacks run after every substep.
+         *
+         * @param dt The frame time, in seconds.
+         */
+        void stepSimulation(float dt);
+
+        void setTimestepSettings(const PhysicsTimestepSettings& settings) { timestepSettings = settings; }
+        const PhysicsTimestepSettings& getTimestepSettings() const { return timestepSettings; }
+        const PhysicsStepStats& getStepStats() const { return stepStats; }
+
+        /**
+         * @brief Gets the transform of a body to render, between its last two substeps.
+         * @param object The body.
+         * @return The interpolated transform, or the world transform when there is nothing to interpolate.
+         */
+        btTransform getInterpolatedTransform(const btCollisionObject* object) const;
 
         void setGravity(float gravity) const;
         void setGravity(const btVector3& gravity) const;
@@ -57,8 +131,20 @@ namespace Coffee {
         btDefaultCollisionConfiguration* collisionConfig;
         btCollisionDispatcher* dispatcher;
         btBroadphaseInterface* broadphase;
-        btSequentialImpulseConstraintSolver* solver;
+        btConstraintSolver* solver;
+        btConstraintSolverPoolMt* solverPool = nullptr; ///< The solvers of the islands, one per Bullet thread index, only in multithreaded worlds.
         btDiscreteDynamicsWorld* dynamicsWorld;
+
+        inline static bool s_Multithreaded = false;
+
+        PhysicsTimestepSettings timestepSettings;
+        PhysicsStepStats stepStats;
+        double accumulator = 0.0; ///< The frame time not simulated yet, always less than a substep.
+
+        /// The transforms before the last substep, in the order of the collision object array.
+        btAlignedObjectArray<std::pair<const btCollisionObject*, btTransform>> previousTransforms;
     };
 
-}
\ No newline at end of file
+}
+
+CEREAL_CLASS_VERSION(Coffee::PhysicsTimestepSettings, 0);
@@ -113,7 +113,11 @@ namespace Coffee {
     }
 
     glm::vec3 RigidBody::GetPosition() const {
-        btVector3 pos = m_Body->getWorldTransform().getOrigin();
+        return GetPosition(m_Body->getWorldTransform());
+    }
+
+    glm::vec3 RigidBody::GetPosition(const btTransform& transform) const {
+        btVector3 pos = transform.getOrigin();
         const glm::vec3& offset = m_Collider->getOffset();
         return {pos.x() - offset.x, pos.y() - offset.y, pos.z() - offset.z};
     }
@@ -138,7 +142,11 @@ namespace Coffee {
 
     glm::vec3 RigidBody::GetRotation() const
     {
-        const btTransform transform = m_Body->getWorldTransform();
+        return GetRotation(m_Body->getWorldTransform());
+    }
+
+    glm::vec3 RigidBody::GetRotation(const btTransform& transform) const
+    {
         const btQuaternion quat = transform.getRotation();
         btScalar x, y, z;
         quat.getEulerZYX(z, y, x);
@@ -103,6 +103,8 @@ namespace Coffee {
         void AddVelocity(const glm::vec3& deltaVelocity) const;
         glm::vec3 GetPosition() const;
         glm::vec3 GetRotation() const;
+        glm::vec3 GetPosition(const btTransform& transform) const; ///< The position of the entity for a world transform of the body.
+        glm::vec3 GetRotation(const btTransform& transform) const; ///< The rotation of the entity for a world transform of the body.
         glm::vec3 GetVelocity() const;
 
         // Angular movement functions
@@ -4,6 +4,7 @@
 #include "CoffeeEngine/IO/CacheManager.h"
 #include "CoffeeEngine/IO/ResourceRegistry.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
+#include "CoffeeEngine/Physics/PhysicsWorld.h"
 #include "CoffeeEngine/Scene/SceneManager.h"
 #include "CoffeeEngine/Scripting/ScriptManager.h"
 #include "CoffeeEngine/Audio/Audio.h"
@@ -31,6 +32,11 @@ namespace Coffee {
         {
             m_AudioFolderPath = "";
         }
+
+        if (version >= 2)
+        {
+            archive(cereal::make_nvp("MultithreadedPhysics", m_MultithreadedPhysics));
+        }
     }
 
     static Ref<Project> s_ActiveProject;
@@ -49,6 +55,7 @@ namespace Coffee {
         CacheManager::SetCachePath(s_ActiveProject->m_ProjectDirectory / s_ActiveProject->m_CacheDirectory);
         ResourceLoader::SetWorkingDirectory(s_ActiveProject->m_ProjectDirectory);
         SceneManager::SetWorkingDirectory(s_ActiveProject->m_ProjectDirectory);
+        PhysicsWorld::setMultithreaded(s_ActiveProject->m_MultithreadedPhysics);
 
         return s_ActiveProject;
     }
@@ -75,10 +82,17 @@ namespace Coffee {
         ScriptManager::SetWorkingDirectory(s_ActiveProject->m_ProjectDirectory);
         Input::Load();
         Audio::OnProjectLoad();
+        PhysicsWorld::setMultithreaded(project->m_MultithreadedPhysics);
 
         return project;
     }
 
+    void Project::SetMultithreadedPhysics(bool multithreaded)
+    {
+        s_ActiveProject->m_MultithreadedPhysics = multithreaded;
+        PhysicsWorld::setMultithreaded(multithreaded);
+    }
+
     void Project::SaveActive()
     {
         if (s_ActiveProject)
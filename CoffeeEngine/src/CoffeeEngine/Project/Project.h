@@ -93,6 +93,18 @@ namespace Coffee {
          */
         static void SetRelativeAudioDirectory(const std::filesystem::path& path) { GetActive()->m_AudioFolderPath = path; }
 
+        /**
+         * @brief Checks whether the scenes of the active project step their physics on the job system workers.
+         * @return True if the physics worlds are multithreaded.
+         */
+        static bool GetMultithreadedPhysics() { return s_ActiveProject->m_MultithreadedPhysics; }
+
+        /**
+         * @brief Selects multithreaded physics for the active project. Applies to the scenes loaded from now on.
+         * @param multithreaded Whether the physics worlds are multithreaded.
+         */
+        static void SetMultithreadedPhysics(bool multithreaded);
+
         /**
          * @brief Serializes the project data.
          * @tparam Archive The type of the archive.
@@ -107,10 +119,11 @@ namespace Coffee {
 
         std::filesystem::path m_StartScenePath; ///< The path to the start scene.
         std::filesystem::path m_AudioFolderPath; ///< The path to the audio folder
+        bool m_MultithreadedPhysics = false; ///< Whether the physics worlds of the scenes are multithreaded.
 
         inline static Ref<Project> s_ActiveProject; ///< The active project.
     };
 
     /** @} */
 }
-CEREAL_CLASS_VERSION(Coffee::Project, 1)
\ No newline at end of file
+CEREAL_CLASS_VERSION(Coffee::Project, 2)
\ No newline at end of file
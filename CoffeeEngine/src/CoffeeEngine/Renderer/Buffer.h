@@ -16,10 +16,14 @@ namespace Coffee {
 
     /**
      * @brief Enum class representing different shader data types.
+     *
+     * Half2, Short2, UShort4 and UByte4 are compact vertex formats. They are read as floats by the shader,
+     * converted to [-1, 1] or [0, 1] when the attribute is normalized. A UByte4 that is not normalized and
+     * a UInt are read as integers.
      */
     enum class ShaderDataType
     {
-        None = 0, Bool, Int, Float, Vec2, Vec3, Vec4, IVec4, Mat2, Mat3, Mat4
+        None = 0, Bool, Int, Float, Vec2, Vec3, Vec4, IVec4, Mat2, Mat3, Mat4, Half2, Short2, UShort4, UByte4, UInt
     };
 
     /**
@@ -41,6 +45,11 @@ namespace Coffee {
             case ShaderDataType::Mat2:     return 4 * 2 * 2;
             case ShaderDataType::Mat3:     return 4 * 3 * 3;
             case ShaderDataType::Mat4:     return 4 * 4 * 4;
+            case ShaderDataType::Half2:    return 2 * 2;
+            case ShaderDataType::Short2:   return 2 * 2;
+            case ShaderDataType::UShort4:  return 2 * 4;
+            case ShaderDataType::UByte4:   return 4;
+            case ShaderDataType::UInt:     return 4;
         }
 
         COFFEE_CORE_ASSERT(false, "Unknown ShaderDataType!");
@@ -57,6 +66,7 @@ namespace Coffee {
         uint32_t Size; ///< The size of the attribute.
         size_t Offset; ///< The offset of the attribute.
         bool Normalized; ///< Whether the attribute is normalized.
+        bool Instanced = false; ///< Whether the attribute advances once per instance instead of once per vertex.
 
         /**
          * @brief Default constructor for BufferAttribute.
@@ -68,9 +78,10 @@ namespace Coffee {
          * @param type The type of the attribute.
          * @param name The name of the attribute.
          * @param normalized Whether the attribute is normalized.
+         * @param instanced Whether the attribute advances once per instance. Matrix attributes are always per instance.
          */
-        BufferAttribute(ShaderDataType type, const std::string& name, bool normalized = false)
-            : Name(name), Type(type), Size(ShaderDataTypeSize(type)), Offset(0), Normalized(normalized)
+        BufferAttribute(ShaderDataType type, const std::string& name, bool normalized = false, bool instanced = false)
+            : Name(name), Type(type), Size(ShaderDataTypeSize(type)), Offset(0), Normalized(normalized), Instanced(instanced)
         {
         }
 
@@ -92,6 +103,11 @@ namespace Coffee {
                 case ShaderDataType::Mat2:    return 2;
                 case ShaderDataType::Mat3:    return 3; // 3* float3
                 case ShaderDataType::Mat4:    return 4; // 4* float4
+                case ShaderDataType::Half2:   return 2;
+                case ShaderDataType::Short2:  return 2;
+                case ShaderDataType::UShort4: return 4;
+                case ShaderDataType::UByte4:  return 4;
+                case ShaderDataType::UInt:    return 1;
             }
 
             COFFEE_CORE_ASSERT(false, "Unknown ShaderDataType!");
@@ -1,18 +1,203 @@
 #include "Font.h"
+#include "CoffeeEngine/Core/Hash.h"
+#include "CoffeeEngine/IO/CacheManager.h"
+#include "CoffeeEngine/IO/MappedFile.h"
 #include "CoffeeEngine/Renderer/Texture.h"
 
 #undef INFINITE
+#include <msdf-atlas-gen/msdf-atlas-gen.h>
 #include <msdf-atlas-gen/FontGeometry.h>
 #include <msdf-atlas-gen/GlyphGeometry.h>
 
 #include "MSDFData.h"
 
+#include <tracy/Tracy.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
 namespace Coffee {
 
+	// Everything that changes the generated atlas. Bump Version when the generation code changes.
+	struct FontAtlasParams
+	{
+		uint32_t Version = 1;
+		uint32_t CharsetBegin = 0x0020;
+		uint32_t CharsetEnd = 0x00FF;
+		double FontScale = 1.0;
+		double EmSize = 40.0;
+		double PixelRange = 2.0;
+		double MiterLimit = 1.0;
+		double AngleThreshold = 3.0;
+		uint64_t ColoringSeed = 0;
+		uint32_t ExpensiveColoring = 0;
+		uint32_t Channels = 3; // msdfGenerator, RGB8
+	};
+
+	static const FontAtlasParams s_AtlasParams;
+
+	struct FontAtlasCacheHeader
+	{
+		uint32_t Magic = 0x43414643; // "CFAC"
+		uint32_t Version = 1;
+		uint64_t Key = 0;
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t GlyphCount = 0;
+		uint32_t KerningCount = 0;
+		MSDFFontMetrics Metrics;
+	};
+
+	static_assert(std::is_trivially_copyable_v<MSDFGlyphMetrics> && std::is_trivially_copyable_v<MSDFKerningPair>,
+				  "Font cache entries are written as raw bytes");
+
+	static uint64_t GetAtlasCacheKey(const std::filesystem::path& fontPath)
+	{
+		uint64_t fileHash = Hash::HashFile(fontPath);
+		if (fileHash == 0)
+			return 0;
+
+		// Hashed field by field, the padding bytes of the struct are not initialized
+		const FontAtlasParams& p = s_AtlasParams;
+		uint64_t key = fileHash;
+		key = Hash::FNV1a(&p.Version, sizeof(p.Version), key);
+		key = Hash::FNV1a(&p.CharsetBegin, sizeof(p.CharsetBegin), key);
+		key = Hash::FNV1a(&p.CharsetEnd, sizeof(p.CharsetEnd), key);
+		key = Hash::FNV1a(&p.FontScale, sizeof(p.FontScale), key);
+		key = Hash::FNV1a(&p.EmSize, sizeof(p.EmSize), key);
+		key = Hash::FNV1a(&p.PixelRange, sizeof(p.PixelRange), key);
+		key = Hash::FNV1a(&p.MiterLimit, sizeof(p.MiterLimit), key);
+		key = Hash::FNV1a(&p.AngleThreshold, sizeof(p.AngleThreshold), key);
+		key = Hash::FNV1a(&p.ColoringSeed, sizeof(p.ColoringSeed), key);
+		key = Hash::FNV1a(&p.ExpensiveColoring, sizeof(p.ExpensiveColoring), key);
+		key = Hash::FNV1a(&p.Channels, sizeof(p.Channels), key);
+		return key;
+	}
+
+	static std::filesystem::path GetAtlasCachePath(uint64_t key)
+	{
+		std::filesystem::path directory = CacheManager::GetCachePath() / "Fonts";
+		std::filesystem::create_directories(directory);
+		return directory / (std::to_string(key) + ".fontatlas");
+	}
+
+	static bool LoadAtlasFromCache(uint64_t key, MSDFData& data, const Font::AtlasPixelsFunction& onPixels)
+	{
+		ZoneScoped;
+
+		MappedFile file(GetAtlasCachePath(key));
+		if (!file.IsValid() || file.GetSize() < sizeof(FontAtlasCacheHeader))
+			return false;
+
+		FontAtlasCacheHeader expected;
+		FontAtlasCacheHeader header;
+		std::memcpy(&header, file.GetData(), sizeof(header));
+
+		if (header.Magic != expected.Magic || header.Version != expected.Version || header.Key != key)
+			return false;
+
+		const size_t glyphsSize = size_t(header.GlyphCount) * sizeof(MSDFGlyphMetrics);
+		const size_t kerningSize = size_t(header.KerningCount) * sizeof(MSDFKerningPair);
+		const size_t pixelsSize = size_t(header.Width) * header.Height * s_AtlasParams.Channels;
+
+		// A truncated or corrupted file is regenerated
+		if (file.GetSize() != sizeof(header) + glyphsSize + kerningSize + pixelsSize || header.Width == 0 || header.Height == 0)
+		{
+			COFFEE_CORE_WARN("Font atlas cache {0} is corrupted, regenerating it", key);
+			return false;
+		}
+
+		const uint8_t* cursor = file.GetData() + sizeof(header);
+
+		data.Metrics = header.Metrics;
+
+		data.Glyphs.resize(header.GlyphCount);
+		std::memcpy(data.Glyphs.data(), cursor, glyphsSize);
+		cursor += glyphsSize;
+
+		data.Kerning.resize(header.KerningCount);
+		std::memcpy(data.Kerning.data(), cursor, kerningSize);
+		cursor += kerningSize;
+
+		data.BuildLookups();
+
+		// The pixels are handed straight from the mapping
+		onPixels(cursor, header.Width, header.Height);
+
+		return true;
+	}
+
+	static void SaveAtlasToCache(uint64_t key, const MSDFData& data, const void* pixels, uint32_t width, uint32_t height)
+	{
+		ZoneScoped;
+
+		FontAtlasCacheHeader header;
+		header.Key = key;
+		header.Width = width;
+		header.Height = height;
+		header.GlyphCount = static_cast<uint32_t>(data.Glyphs.size());
+		header.KerningCount = static_cast<uint32_t>(data.Kerning.size());
+		header.Metrics = data.Metrics;
+
+		// Written to a temporary file first so an interrupted write never leaves a truncated cache entry
+		std::filesystem::path cachePath = GetAtlasCachePath(key);
+		std::filesystem::path tempPath = cachePath;
+		tempPath += ".tmp";
+
+		{
+			std::ofstream file(tempPath, std::ios::binary);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(data.Glyphs.data()), data.Glyphs.size() * sizeof(MSDFGlyphMetrics));
+			file.write(reinterpret_cast<const char*>(data.Kerning.data()), data.Kerning.size() * sizeof(MSDFKerningPair));
+			file.write(reinterpret_cast<const char*>(pixels), size_t(width) * height * s_AtlasParams.Channels);
+
+			if (!file)
+			{
+				COFFEE_CORE_WARN("Failed to write font atlas cache {0}", cachePath.string());
+				file.close();
+				std::filesystem::remove(tempPath);
+				return;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, cachePath, ec);
+		if (ec)
+			std::filesystem::remove(tempPath, ec);
+	}
+
+	static void ExtractMetrics(const msdf_atlas::FontGeometry& fontGeometry, MSDFData& data)
+	{
+		const auto& metrics = fontGeometry.getMetrics();
+		data.Metrics.AscenderY = metrics.ascenderY;
+		data.Metrics.DescenderY = metrics.descenderY;
+		data.Metrics.LineHeight = metrics.lineHeight;
+
+		for (const msdf_atlas::GlyphGeometry& glyph : fontGeometry.getGlyphs())
+		{
+			MSDFGlyphMetrics& glyphMetrics = data.Glyphs.emplace_back();
+			glyphMetrics.Codepoint = glyph.getCodepoint();
+			glyphMetrics.Index = glyph.getIndex();
+			glyphMetrics.Advance = glyph.getAdvance();
+			glyph.getQuadPlaneBounds(glyphMetrics.PlaneLeft, glyphMetrics.PlaneBottom, glyphMetrics.PlaneRight, glyphMetrics.PlaneTop);
+			glyph.getQuadAtlasBounds(glyphMetrics.AtlasLeft, glyphMetrics.AtlasBottom, glyphMetrics.AtlasRight, glyphMetrics.AtlasTop);
+		}
+
+		for (const auto& [pair, value] : fontGeometry.getKerning())
+		{
+			data.Kerning.push_back({ pair.first, pair.second, value });
+		}
+
+		data.BuildLookups();
+	}
+
     template<typename T, typename S, int N, msdf_atlas::GeneratorFunction<S, N> GenFunc>
-	static Ref<Texture2D> CreateAndCacheAtlas(const std::string& fontName, float fontSize, const std::vector<msdf_atlas::GlyphGeometry>& glyphs,
-		const msdf_atlas::FontGeometry& fontGeometry, uint32_t width, uint32_t height)
+	static void GenerateAndCacheAtlas(uint64_t cacheKey, const MSDFData& data, const std::vector<msdf_atlas::GlyphGeometry>& glyphs,
+		uint32_t width, uint32_t height, const Font::AtlasPixelsFunction& onPixels)
 	{
+		ZoneScoped;
+
 		msdf_atlas::GeneratorAttributes attributes;
 		attributes.config.overlapSupport = true;
 		attributes.scanlinePass = true;
@@ -24,117 +209,101 @@ namespace Coffee {
 
 		msdfgen::BitmapConstRef<T, N> bitmap = (msdfgen::BitmapConstRef<T, N>)generator.atlasStorage();
 
-		TextureProperties properties;
-        properties.Width = bitmap.width;
-        properties.Height = bitmap.height;
-        properties.Format = ImageFormat::RGB8;
-        properties.GenerateMipmaps = false;
+		onPixels(bitmap.pixels, bitmap.width, bitmap.height);
 
-		Ref<Texture2D> texture = Texture2D::Create(bitmap.width, bitmap.height, ImageFormat::RGB8);
-		texture->SetData((void*)bitmap.pixels, bitmap.width * bitmap.height * 3);
-		return texture;
+		if (cacheKey != 0)
+			SaveAtlasToCache(cacheKey, data, bitmap.pixels, bitmap.width, bitmap.height);
 	}
 
     Font::Font(const std::filesystem::path& filepath)
 		: m_Data(new MSDFData())
 	{
+		ZoneScoped;
+
+		BuildAtlas(filepath, *m_Data, [this](const uint8_t* pixels, uint32_t width, uint32_t height) {
+			m_AtlasTexture = Texture2D::Create(width, height, ImageFormat::RGB8);
+			m_AtlasTexture->SetData(const_cast<uint8_t*>(pixels), width * height * s_AtlasParams.Channels);
+		});
+	}
+
+	Font::AtlasSource Font::BuildAtlas(const std::filesystem::path& filepath, MSDFData& data, const AtlasPixelsFunction& onPixels, bool readCache)
+	{
+		ZoneScoped;
+
+		std::string fileString = filepath.string();
+
+		uint64_t cacheKey = GetAtlasCacheKey(filepath);
+		if (readCache && cacheKey != 0 && LoadAtlasFromCache(cacheKey, data, onPixels))
+		{
+			COFFEE_CORE_TRACE("Loaded the atlas of font {} from the cache", fileString);
+			return AtlasSource::Cache;
+		}
+
 		msdfgen::FreetypeHandle* ft = msdfgen::initializeFreetype();
 		COFFEE_CORE_ASSERT(ft);
-		
-		std::string fileString = filepath.string();
 
 		msdfgen::FontHandle* font = msdfgen::loadFont(ft, fileString.c_str());
 		if (!font)
 		{
 			COFFEE_CORE_ERROR("Failed to load font: {}", fileString);
-			return;
+			msdfgen::deinitializeFreetype(ft);
+			return AtlasSource::None;
 		}
 
-		struct CharsetRange
-		{
-			uint32_t Begin, End;
-		};
-
-		// From imgui_draw.cpp
-		static const CharsetRange charsetRanges[] =
-		{
-			{ 0x0020, 0x00FF }
-		};
-
 		msdf_atlas::Charset charset;
-		for (CharsetRange range : charsetRanges)
-		{
-			for (uint32_t c = range.Begin; c <= range.End; c++)
-				charset.add(c);
-		}
-		
-		double fontScale = 1.0;
-		m_Data->FontGeometry = msdf_atlas::FontGeometry(&m_Data->Glyphs);
-		int glyphsLoaded = m_Data->FontGeometry.loadCharset(font, fontScale, charset);
-		COFFEE_CORE_INFO("Loaded {} glyphs from font (out of {})", glyphsLoaded, charset.size());
+		for (uint32_t c = s_AtlasParams.CharsetBegin; c <= s_AtlasParams.CharsetEnd; c++)
+			charset.add(c);
 
-
-		double emSize = 40.0;
+		std::vector<msdf_atlas::GlyphGeometry> glyphs;
+		msdf_atlas::FontGeometry fontGeometry(&glyphs);
+		int glyphsLoaded = fontGeometry.loadCharset(font, s_AtlasParams.FontScale, charset);
+		COFFEE_CORE_INFO("Loaded {} glyphs from font (out of {})", glyphsLoaded, charset.size());
 
 		msdf_atlas::TightAtlasPacker atlasPacker;
 		// atlasPacker.setDimensionsConstraint()
-		atlasPacker.setPixelRange(2.0);
-		atlasPacker.setMiterLimit(1.0);
+		atlasPacker.setPixelRange(s_AtlasParams.PixelRange);
+		atlasPacker.setMiterLimit(s_AtlasParams.MiterLimit);
 		//atlasPacker.setPadding(0);
-		atlasPacker.setScale(emSize);
-		int remaining = atlasPacker.pack(m_Data->Glyphs.data(), (int)m_Data->Glyphs.size());
+		atlasPacker.setScale(s_AtlasParams.EmSize);
+		int remaining = atlasPacker.pack(glyphs.data(), (int)glyphs.size());
 		COFFEE_CORE_ASSERT(remaining == 0);
 
 		int width, height;
 		atlasPacker.getDimensions(width, height);
-		emSize = atlasPacker.getScale();
 
-#define DEFAULT_ANGLE_THRESHOLD 3.0
 #define LCG_MULTIPLIER 6364136223846793005ull
 #define LCG_INCREMENT 1442695040888963407ull
 #define THREAD_COUNT 8
 		// if MSDF || MTSDF
 
-		uint64_t coloringSeed = 0;
-		bool expensiveColoring = false;
+		uint64_t coloringSeed = s_AtlasParams.ColoringSeed;
+		bool expensiveColoring = s_AtlasParams.ExpensiveColoring != 0;
 		if (expensiveColoring)
 		{
-			msdf_atlas::Workload([&glyphs = m_Data->Glyphs, &coloringSeed](int i, int threadNo) -> bool {
+			msdf_atlas::Workload([&glyphs, &coloringSeed](int i, int threadNo) -> bool {
 				unsigned long long glyphSeed = (LCG_MULTIPLIER * (coloringSeed ^ i) + LCG_INCREMENT) * !!coloringSeed;
-				glyphs[i].edgeColoring(msdfgen::edgeColoringInkTrap, DEFAULT_ANGLE_THRESHOLD, glyphSeed);
+				glyphs[i].edgeColoring(msdfgen::edgeColoringInkTrap, s_AtlasParams.AngleThreshold, glyphSeed);
 				return true;
-				}, m_Data->Glyphs.size()).finish(THREAD_COUNT);
+				}, glyphs.size()).finish(THREAD_COUNT);
 		}
 		else {
 			unsigned long long glyphSeed = coloringSeed;
-			for (msdf_atlas::GlyphGeometry& glyph : m_Data->Glyphs)
+			for (msdf_atlas::GlyphGeometry& glyph : glyphs)
 			{
 				glyphSeed *= LCG_MULTIPLIER;
-				glyph.edgeColoring(msdfgen::edgeColoringInkTrap, DEFAULT_ANGLE_THRESHOLD, glyphSeed);
+				glyph.edgeColoring(msdfgen::edgeColoringInkTrap, s_AtlasParams.AngleThreshold, glyphSeed);
 			}
 		}
 
+		ExtractMetrics(fontGeometry, data);
 
-		m_AtlasTexture = CreateAndCacheAtlas<uint8_t, float, 3, msdf_atlas::msdfGenerator>("Test", (float)emSize, m_Data->Glyphs, m_Data->FontGeometry, width, height);
-
-
-#if 0
-		msdfgen::Shape shape;
-		if (msdfgen::loadGlyph(shape, font, 'C'))
-		{
-			shape.normalize();
-			//                      max. angle
-			msdfgen::edgeColoringSimple(shape, 3.0);
-			//           image width, height
-			msdfgen::Bitmap<float, 3> msdf(32, 32);
-			//                     range, scale, translation
-			msdfgen::generateMSDF(msdf, shape, 4.0, 1.0, msdfgen::Vector2(4.0, 4.0));
-			msdfgen::savePng(msdf, "output.png");
-		}
-#endif
+		GenerateAndCacheAtlas<uint8_t, float, 3, msdf_atlas::msdfGenerator>(cacheKey, data, glyphs, width, height, onPixels);
 
 		msdfgen::destroyFont(font);
 		msdfgen::deinitializeFreetype(ft);
+
+		COFFEE_CORE_TRACE("Generated the atlas of font {}", fileString);
+		return AtlasSource::Generated;
 	}
 
 	Font::~Font()
@@ -152,4 +321,4 @@ namespace Coffee {
 		return DefaultFont;
 	}
 
-}
\ No newline at end of file
+}
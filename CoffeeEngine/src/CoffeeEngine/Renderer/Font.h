@@ -2,7 +2,9 @@
 
 #include "CoffeeEngine/Core/Base.h"
 
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 
 namespace Coffee {
 
@@ -19,6 +21,26 @@ namespace Coffee {
         Ref<Texture2D> GetAtlasTexture() const { return m_AtlasTexture; }
 
         static Ref<Font> GetDefault();
+
+        /// Receives the RGB8 pixels of an atlas, only valid during the call.
+        using AtlasPixelsFunction = std::function<void(const uint8_t* pixels, uint32_t width, uint32_t height)>;
+
+        enum class AtlasSource
+        {
+            None, ///< The font could not be loaded.
+            Cache, ///< The atlas was read from the cache.
+            Generated ///< The atlas was generated and stored in the cache.
+        };
+
+        /**
+         * @brief Builds the glyph metrics and the atlas pixels of a font, without uploading them.
+         * @param path The font file.
+         * @param data Receives the glyph metrics.
+         * @param onPixels Receives the atlas pixels.
+         * @param readCache Whether to look the atlas up in the cache first, a generated atlas is always stored.
+         * @return Where the atlas comes from.
+         */
+        static AtlasSource BuildAtlas(const std::filesystem::path& path, MSDFData& data, const AtlasPixelsFunction& onPixels, bool readCache = true);
     private:
         MSDFData* m_Data;
         Ref<Texture2D> m_AtlasTexture;
@@ -0,0 +1,776 @@
+#include "IBLBaker.h"
+
+#include "CoffeeEngine/Core/Hash.h"
+#include "CoffeeEngine/Core/JobSystem.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/IO/CacheManager.h"
+#include "CoffeeEngine/IO/MappedFile.h"
+
+#include <glm/geometric.hpp>
+#include <stb_image.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <string>
+
+namespace Coffee {
+
+    static constexpr float PI = 3.14159265359f;
+
+    struct IBLCacheHeader
+    {
+        uint32_t Magic = 0x4C424943; // "CIBL"
+        uint32_t Version = 1;
+        uint64_t Key = 0;
+        uint32_t FaceSize = 0;
+        uint32_t IrradianceSize = 0;
+        uint32_t PrefilteredSize = 0;
+        uint32_t PrefilteredMipCount = 0;
+        float IrradianceSH[27] = {};
+    };
+
+    struct BRDFLUTCacheHeader
+    {
+        uint32_t Magic = 0x4C424243; // "CBBL"
+        uint32_t Version = 1;
+        uint64_t Key = 0;
+        uint32_t Size = 0;
+        uint32_t Padding = 0;
+    };
+
+    // The mips of a cubemap, each one with its six faces of RGB floats
+    struct CubemapMips
+    {
+        uint32_t Size = 0;
+        std::vector<std::vector<float>> Mips;
+
+        uint32_t GetMipSize(uint32_t mip) const { return std::max(Size >> mip, 1u); }
+    };
+
+    static size_t GetCubemapFloatCount(uint32_t faceSize)
+    {
+        return size_t(faceSize) * faceSize * 3 * 6;
+    }
+
+    static void DirectionToCubemapFace(const glm::vec3& direction, uint32_t& face, float& s, float& t)
+    {
+        // Face selection and projection from the OpenGL specification
+        glm::vec3 a = glm::abs(direction);
+        float sc, tc, ma;
+
+        if (a.x >= a.y && a.x >= a.z)
+        {
+            face = direction.x > 0.0f ? 0 : 1;
+            sc = direction.x > 0.0f ? -direction.z : direction.z;
+            tc = -direction.y;
+            ma = a.x;
+        }
+        else if (a.y >= a.z)
+        {
+            face = direction.y > 0.0f ? 2 : 3;
+            sc = direction.x;
+            tc = direction.y > 0.0f ? direction.z : -direction.z;
+            ma = a.y;
+        }
+        else
+        {
+            face = direction.z > 0.0f ? 4 : 5;
+            sc = direction.z > 0.0f ? direction.x : -direction.x;
+            tc = -direction.y;
+            ma = a.z;
+        }
+
+        s = 0.5f * (sc / ma + 1.0f);
+        t = 0.5f * (tc / ma + 1.0f);
+    }
+
+    static glm::vec3 SampleFaceBilinear(const float* face, uint32_t size, float s, float t)
+    {
+        // Clamped to the face, seams are hidden by the filtering of the coarser mips
+        float x = std::clamp(s * size - 0.5f, 0.0f, float(size - 1));
+        float y = std::clamp(t * size - 0.5f, 0.0f, float(size - 1));
+
+        uint32_t x0 = uint32_t(x), y0 = uint32_t(y);
+        uint32_t x1 = std::min(x0 + 1, size - 1), y1 = std::min(y0 + 1, size - 1);
+        float fx = x - x0, fy = y - y0;
+
+        auto texel = [face, size](uint32_t tx, uint32_t ty) {
+            const float* p = face + (size_t(ty) * size + tx) * 3;
+            return glm::vec3(p[0], p[1], p[2]);
+        };
+
+        glm::vec3 bottom = glm::mix(texel(x0, y0), texel(x1, y0), fx);
+        glm::vec3 top = glm::mix(texel(x0, y1), texel(x1, y1), fx);
+        return glm::mix(bottom, top, fy);
+    }
+
+    static glm::vec3 SampleCubemap(const CubemapMips& cubemap, const glm::vec3& direction, float lod)
+    {
+        uint32_t face;
+        float s, t;
+        DirectionToCubemapFace(direction, face, s, t);
+
+        lod = std::clamp(lod, 0.0f, float(cubemap.Mips.size() - 1));
+        uint32_t mip0 = uint32_t(lod);
+        uint32_t mip1 = std::min(mip0 + 1, uint32_t(cubemap.Mips.size() - 1));
+
+        auto sampleMip = [&](uint32_t mip) {
+            uint32_t size = cubemap.GetMipSize(mip);
+            return SampleFaceBilinear(cubemap.Mips[mip].data() + size_t(face) * size * size * 3, size, s, t);
+        };
+
+        glm::vec3 color = sampleMip(mip0);
+        if (mip1 != mip0 && lod > mip0)
+            color = glm::mix(color, sampleMip(mip1), lod - mip0);
+
+        return color;
+    }
+
+    static glm::vec3 SampleEquirectangular(const float* pixels, uint32_t width, uint32_t height, const glm::vec3& direction)
+    {
+        // Same mapping as the equirectangular shader, wrapped horizontally across the seam
+        float u = std::atan2(direction.z, direction.x) * (0.5f / PI) + 0.5f;
+        float v = std::asin(std::clamp(direction.y, -1.0f, 1.0f)) / PI + 0.5f;
+
+        float x = u * width - 0.5f;
+        float y = std::clamp(v * height - 0.5f, 0.0f, float(height - 1));
+
+        float xFloor = std::floor(x);
+        int32_t x0 = (int32_t(xFloor) % int32_t(width) + int32_t(width)) % int32_t(width);
+        uint32_t x1 = (uint32_t(x0) + 1) % width;
+        uint32_t y0 = uint32_t(y);
+        uint32_t y1 = std::min(y0 + 1, height - 1);
+        float fx = x - xFloor, fy = y - y0;
+
+        auto texel = [pixels, width](uint32_t tx, uint32_t ty) {
+            const float* p = pixels + (size_t(ty) * width + tx) * 3;
+            return glm::vec3(p[0], p[1], p[2]);
+        };
+
+        glm::vec3 bottom = glm::mix(texel(x0, y0), texel(x1, y0), fx);
+        glm::vec3 top = glm::mix(texel(x0, y1), texel(x1, y1), fx);
+        return glm::mix(bottom, top, fy);
+    }
+
+    // Calls function(face, row) for every row of the six faces, on the job system
+    template<typename F>
+    static void ForEachFaceRow(uint32_t size, F&& function)
+    {
+        JobSystem::ParallelFor(6 * size, std::max(1024u / size, 1u), [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+                function(i / size, i % size);
+        });
+    }
+
+    static std::vector<float> EquirectangularToCubemap(const float* pixels, uint32_t width, uint32_t height, uint32_t faceSize)
+    {
+        ZoneScoped;
+
+        std::vector<float> faces(GetCubemapFloatCount(faceSize));
+
+        ForEachFaceRow(faceSize, [&](uint32_t face, uint32_t row) {
+            float* out = faces.data() + (size_t(face) * faceSize + row) * faceSize * 3;
+            float t = (row + 0.5f) / faceSize;
+
+            for (uint32_t x = 0; x < faceSize; x++)
+            {
+                glm::vec3 color = SampleEquirectangular(pixels, width, height, IBLBaker::CubemapDirection(face, (x + 0.5f) / faceSize, t));
+                out[x * 3 + 0] = color.r;
+                out[x * 3 + 1] = color.g;
+                out[x * 3 + 2] = color.b;
+            }
+        });
+
+        return faces;
+    }
+
+    static CubemapMips BuildCubemapMips(std::vector<float> faces, uint32_t faceSize)
+    {
+        ZoneScoped;
+
+        CubemapMips cubemap;
+        cubemap.Size = faceSize;
+        cubemap.Mips.push_back(std::move(faces));
+
+        // Box filtered like glGenerateMipmap, odd sizes clamp the last column and row
+        while (cubemap.GetMipSize(uint32_t(cubemap.Mips.size() - 1)) > 1)
+        {
+            uint32_t srcMip = uint32_t(cubemap.Mips.size() - 1);
+            uint32_t srcSize = cubemap.GetMipSize(srcMip);
+            uint32_t dstSize = cubemap.GetMipSize(srcMip + 1);
+
+            const std::vector<float>& src = cubemap.Mips[srcMip];
+            std::vector<float> dst(GetCubemapFloatCount(dstSize));
+
+            ForEachFaceRow(dstSize, [&](uint32_t face, uint32_t row) {
+                const float* srcFace = src.data() + size_t(face) * srcSize * srcSize * 3;
+                float* out = dst.data() + (size_t(face) * dstSize + row) * dstSize * 3;
+
+                uint32_t sy0 = std::min(row * 2, srcSize - 1), sy1 = std::min(row * 2 + 1, srcSize - 1);
+                for (uint32_t x = 0; x < dstSize; x++)
+                {
+                    uint32_t sx0 = std::min(x * 2, srcSize - 1), sx1 = std::min(x * 2 + 1, srcSize - 1);
+                    for (uint32_t c = 0; c < 3; c++)
+                    {
+                        out[x * 3 + c] = 0.25f * (srcFace[(size_t(sy0) * srcSize + sx0) * 3 + c] + srcFace[(size_t(sy0) * srcSize + sx1) * 3 + c] +
+                                                  srcFace[(size_t(sy1) * srcSize + sx0) * 3 + c] + srcFace[(size_t(sy1) * srcSize + sx1) * 3 + c]);
+                    }
+                }
+            });
+
+            cubemap.Mips.push_back(std::move(dst));
+        }
+
+        return cubemap;
+    }
+
+    static float RadicalInverseVdC(uint32_t bits)
+    {
+        bits = (bits << 16u) | (bits >> 16u);
+        bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+        bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+        bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+        bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+        return float(bits) * 2.3283064365386963e-10f; // / 0x100000000
+    }
+
+    // The GGX half vector of a Hammersley sample, in tangent space around +Z
+    static glm::vec3 ImportanceSampleGGX(uint32_t i, uint32_t sampleCount, float roughness)
+    {
+        float a = roughness * roughness;
+        float xi0 = float(i) / float(sampleCount);
+        float xi1 = RadicalInverseVdC(i);
+
+        float phi = 2.0f * PI * xi0;
+        float cosTheta = std::sqrt((1.0f - xi1) / (1.0f + (a * a - 1.0f) * xi1));
+        float sinTheta = std::sqrt(std::max(1.0f - cosTheta * cosTheta, 0.0f));
+
+        return glm::vec3(std::cos(phi) * sinTheta, std::sin(phi) * sinTheta, cosTheta);
+    }
+
+    static float DistributionGGX(float NdotH, float roughness)
+    {
+        float a = roughness * roughness;
+        float a2 = a * a;
+        float denom = NdotH * NdotH * (a2 - 1.0f) + 1.0f;
+        return a2 / (PI * denom * denom);
+    }
+
+    struct PrefilterSample
+    {
+        glm::vec3 L; // In tangent space around +Z
+        float NdotL;
+        float Lod;
+    };
+
+    // With N = V = R the samples do not depend on the texel, so they are computed once per mip
+    static std::vector<PrefilterSample> GetPrefilterSamples(float roughness, uint32_t sampleCount, uint32_t sourceSize)
+    {
+        std::vector<PrefilterSample> samples;
+        samples.reserve(sampleCount);
+
+        float saTexel = 4.0f * PI / (6.0f * sourceSize * sourceSize);
+
+        for (uint32_t i = 0; i < sampleCount; i++)
+        {
+            glm::vec3 H = ImportanceSampleGGX(i, sampleCount, roughness);
+            glm::vec3 L = 2.0f * H.z * H - glm::vec3(0.0f, 0.0f, 1.0f);
+
+            if (L.z <= 0.0f)
+                continue;
+
+            // Samples with a low pdf read a blurrier mip of the source, which removes the fireflies of bright spots
+            float pdf = DistributionGGX(H.z, roughness) * 0.25f + 0.0001f;
+            float saSample = 1.0f / (float(sampleCount) * pdf + 0.0001f);
+            float lod = std::max(0.5f * std::log2(saSample / saTexel), 0.0f);
+
+            samples.push_back({glm::normalize(L), L.z, lod});
+        }
+
+        return samples;
+    }
+
+    static std::vector<float> PrefilterCubemap(const CubemapMips& source, const IBLBakeSettings& settings)
+    {
+        ZoneScoped;
+
+        uint32_t mipCount = std::max(settings.PrefilteredMipCount, 1u);
+
+        std::vector<std::vector<PrefilterSample>> mipSamples(mipCount);
+        std::vector<size_t> mipOffsets(mipCount);
+        size_t floatCount = 0;
+        for (uint32_t mip = 0; mip < mipCount; mip++)
+        {
+            float roughness = mipCount > 1 ? float(mip) / float(mipCount - 1) : 0.0f;
+            if (mip > 0)
+                mipSamples[mip] = GetPrefilterSamples(roughness, settings.PrefilteredSampleCount, source.Size);
+
+            mipOffsets[mip] = floatCount;
+            floatCount += GetCubemapFloatCount(std::max(settings.PrefilteredSize >> mip, 1u));
+        }
+
+        // Every row of every face of every mip is a work item, so the small mips do not leave workers idle
+        struct Row { uint32_t Mip, Face, Y; };
+        std::vector<Row> rows;
+        for (uint32_t mip = 0; mip < mipCount; mip++)
+        {
+            uint32_t size = std::max(settings.PrefilteredSize >> mip, 1u);
+            for (uint32_t face = 0; face < 6; face++)
+                for (uint32_t y = 0; y < size; y++)
+                    rows.push_back({mip, face, y});
+        }
+
+        std::vector<float> prefiltered(floatCount);
+
+        JobSystem::ParallelFor(uint32_t(rows.size()), 4, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t r = begin; r < end; r++)
+            {
+                const Row& row = rows[r];
+                uint32_t size = std::max(settings.PrefilteredSize >> row.Mip, 1u);
+                float* out = prefiltered.data() + mipOffsets[row.Mip] + (size_t(row.Face) * size + row.Y) * size * 3;
+                const std::vector<PrefilterSample>& samples = mipSamples[row.Mip];
+
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    glm::vec3 N = IBLBaker::CubemapDirection(row.Face, (x + 0.5f) / size, (row.Y + 0.5f) / size);
+                    glm::vec3 color(0.0f);
+
+                    // A roughness of 0 reflects the environment as is
+                    if (row.Mip == 0)
+                    {
+                        color = SampleCubemap(source, N, 0.0f);
+                    }
+                    else
+                    {
+                        glm::vec3 up = std::abs(N.z) < 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+                        glm::vec3 tangent = glm::normalize(glm::cross(up, N));
+                        glm::vec3 bitangent = glm::cross(N, tangent);
+
+                        float totalWeight = 0.0f;
+                        for (const PrefilterSample& sample : samples)
+                        {
+                            glm::vec3 L = tangent * sample.L.x + bitangent * sample.L.y + N * sample.L.z;
+                            color += SampleCubemap(source, L, sample.Lod) * sample.NdotL;
+                            totalWeight += sample.NdotL;
+                        }
+
+                        if (totalWeight > 0.0f)
+                            color /= totalWeight;
+                    }
+
+                    out[x * 3 + 0] = color.r;
+                    out[x * 3 + 1] = color.g;
+                    out[x * 3 + 2] = color.b;
+                }
+            }
+        });
+
+        return prefiltered;
+    }
+
+    static void EvaluateSH9Basis(const glm::vec3& d, float basis[9])
+    {
+        basis[0] = 0.282095f;
+        basis[1] = 0.488603f * d.y;
+        basis[2] = 0.488603f * d.z;
+        basis[3] = 0.488603f * d.x;
+        basis[4] = 1.092548f * d.x * d.y;
+        basis[5] = 1.092548f * d.y * d.z;
+        basis[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+        basis[7] = 1.092548f * d.x * d.z;
+        basis[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+    }
+
+    glm::vec3 IBLBaker::CubemapDirection(uint32_t face, float s, float t)
+    {
+        float a = 2.0f * s - 1.0f;
+        float b = 2.0f * t - 1.0f;
+
+        glm::vec3 direction;
+        switch (face)
+        {
+            case 0: direction = glm::vec3(1.0f, -b, -a); break;
+            case 1: direction = glm::vec3(-1.0f, -b, a); break;
+            case 2: direction = glm::vec3(a, 1.0f, b); break;
+            case 3: direction = glm::vec3(a, -1.0f, -b); break;
+            case 4: direction = glm::vec3(a, -b, 1.0f); break;
+            default: direction = glm::vec3(-a, -b, -1.0f); break;
+        }
+
+        return glm::normalize(direction);
+    }
+
+    std::array<glm::vec3, 9> IBLBaker::ProjectSH9(const float* faces, uint32_t faceSize)
+    {
+        ZoneScoped;
+
+        // One partial sum per face, added in order so the result does not depend on the scheduling
+        double partials[6][9][3] = {};
+        double weights[6] = {};
+
+        JobSystem::ParallelFor(6, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t face = begin; face < end; face++)
+            {
+                const float* texels = faces + size_t(face) * faceSize * faceSize * 3;
+
+                for (uint32_t y = 0; y < faceSize; y++)
+                {
+                    for (uint32_t x = 0; x < faceSize; x++)
+                    {
+                        float u = 2.0f * (x + 0.5f) / faceSize - 1.0f;
+                        float v = 2.0f * (y + 0.5f) / faceSize - 1.0f;
+
+                        // Solid angle of the texel, the faces are denser towards their corners
+                        float dist2 = 1.0f + u * u + v * v;
+                        double solidAngle = 4.0 / (double(faceSize) * faceSize * dist2 * std::sqrt(dist2));
+
+                        float basis[9];
+                        EvaluateSH9Basis(CubemapDirection(face, (x + 0.5f) / faceSize, (y + 0.5f) / faceSize), basis);
+
+                        const float* texel = texels + (size_t(y) * faceSize + x) * 3;
+                        for (uint32_t i = 0; i < 9; i++)
+                            for (uint32_t c = 0; c < 3; c++)
+                                partials[face][i][c] += texel[c] * basis[i] * solidAngle;
+
+                        weights[face] += solidAngle;
+                    }
+                }
+            }
+        });
+
+        double totalWeight = 0.0;
+        for (uint32_t face = 0; face < 6; face++)
+            totalWeight += weights[face];
+
+        // The texel solid angles only approximate the sphere, rescale them to 4 pi
+        double normalization = 4.0 * PI / totalWeight;
+
+        std::array<glm::vec3, 9> sh;
+        for (uint32_t i = 0; i < 9; i++)
+        {
+            glm::dvec3 sum(0.0);
+            for (uint32_t face = 0; face < 6; face++)
+                sum += glm::dvec3(partials[face][i][0], partials[face][i][1], partials[face][i][2]);
+
+            sh[i] = glm::vec3(sum * normalization);
+        }
+
+        return sh;
+    }
+
+    glm::vec3 IBLBaker::EvaluateIrradianceSH9(const std::array<glm::vec3, 9>& sh, const glm::vec3& normal)
+    {
+        // Cosine lobe convolution per band (pi, 2pi/3, pi/4), divided by pi
+        static constexpr float bandFactors[9] = {1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f};
+
+        float basis[9];
+        EvaluateSH9Basis(normal, basis);
+
+        glm::vec3 irradiance(0.0f);
+        for (uint32_t i = 0; i < 9; i++)
+            irradiance += sh[i] * (basis[i] * bandFactors[i]);
+
+        // The ringing of very bright lights can go below zero
+        return glm::max(irradiance, glm::vec3(0.0f));
+    }
+
+    BakedEnvironment IBLBaker::Bake(const float* pixels, uint32_t width, uint32_t height, const IBLBakeSettings& settings)
+    {
+        ZoneScoped;
+
+        BakedEnvironment environment;
+
+        // Same face size as the GPU conversion used, a quarter of the width covers the horizon
+        uint32_t faceSize = width / 4;
+        if (!pixels || faceSize == 0 || height == 0)
+            return environment;
+
+        CubemapMips cubemap = BuildCubemapMips(EquirectangularToCubemap(pixels, width, height, faceSize), faceSize);
+
+        // The SH are low frequency, a small mip gives the same coefficients for a fraction of the work
+        uint32_t shMip = 0;
+        while (cubemap.GetMipSize(shMip) > 64 && shMip + 1 < cubemap.Mips.size())
+            shMip++;
+
+        environment.IrradianceSH = ProjectSH9(cubemap.Mips[shMip].data(), cubemap.GetMipSize(shMip));
+
+        environment.IrradianceSize = settings.IrradianceSize;
+        environment.Irradiance.resize(GetCubemapFloatCount(settings.IrradianceSize));
+        ForEachFaceRow(settings.IrradianceSize, [&](uint32_t face, uint32_t row) {
+            uint32_t size = settings.IrradianceSize;
+            float* out = environment.Irradiance.data() + (size_t(face) * size + row) * size * 3;
+
+            for (uint32_t x = 0; x < size; x++)
+            {
+                glm::vec3 irradiance = EvaluateIrradianceSH9(environment.IrradianceSH, CubemapDirection(face, (x + 0.5f) / size, (row + 0.5f) / size));
+                out[x * 3 + 0] = irradiance.r;
+                out[x * 3 + 1] = irradiance.g;
+                out[x * 3 + 2] = irradiance.b;
+            }
+        });
+
+        environment.PrefilteredSize = settings.PrefilteredSize;
+        environment.PrefilteredMipCount = std::max(settings.PrefilteredMipCount, 1u);
+        environment.Prefiltered = PrefilterCubemap(cubemap, settings);
+
+        // Only the first mip is kept, the others are rebuilt on upload
+        environment.FaceSize = faceSize;
+        environment.Environment = std::move(cubemap.Mips[0]);
+
+        return environment;
+    }
+
+    BakedEnvironment IBLBaker::BakeFile(const std::filesystem::path& path, const IBLBakeSettings& settings)
+    {
+        ZoneScoped;
+
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load_thread(true);
+        float* pixels = stbi_loadf(path.string().c_str(), &width, &height, &channels, 3);
+        if (!pixels)
+        {
+            COFFEE_CORE_ERROR("Failed to load environment: {0} (REASON: {1})", path.string(), stbi_failure_reason());
+            return {};
+        }
+
+        BakedEnvironment environment = Bake(pixels, uint32_t(width), uint32_t(height), settings);
+        stbi_image_free(pixels);
+
+        return environment;
+    }
+
+    uint64_t IBLBaker::GetCacheKey(const std::filesystem::path& path, const IBLBakeSettings& settings)
+    {
+        uint64_t fileHash = Hash::HashFile(path);
+        if (fileHash == 0)
+            return 0;
+
+        uint64_t key = fileHash;
+        key = Hash::FNV1a(&settings.Version, sizeof(settings.Version), key);
+        key = Hash::FNV1a(&settings.IrradianceSize, sizeof(settings.IrradianceSize), key);
+        key = Hash::FNV1a(&settings.PrefilteredSize, sizeof(settings.PrefilteredSize), key);
+        key = Hash::FNV1a(&settings.PrefilteredMipCount, sizeof(settings.PrefilteredMipCount), key);
+        key = Hash::FNV1a(&settings.PrefilteredSampleCount, sizeof(settings.PrefilteredSampleCount), key);
+        return key;
+    }
+
+    static std::filesystem::path GetIBLCachePath(const std::string& name)
+    {
+        std::filesystem::path directory = CacheManager::GetCachePath() / "IBL";
+        std::filesystem::create_directories(directory);
+        return directory / name;
+    }
+
+    // Written to a temporary file first so an interrupted write never leaves a truncated cache entry
+    static void WriteCacheFile(const std::filesystem::path& cachePath, const void* header, size_t headerSize,
+                               std::initializer_list<const std::vector<float>*> blocks)
+    {
+        std::filesystem::path tempPath = cachePath;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream file(tempPath, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(header), headerSize);
+            for (const std::vector<float>* block : blocks)
+                file.write(reinterpret_cast<const char*>(block->data()), block->size() * sizeof(float));
+
+            if (!file)
+            {
+                COFFEE_CORE_WARN("Failed to write IBL cache {0}", cachePath.string());
+                file.close();
+                std::filesystem::remove(tempPath);
+                return;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec)
+            std::filesystem::remove(tempPath, ec);
+    }
+
+    static size_t GetPrefilteredFloatCount(uint32_t size, uint32_t mipCount)
+    {
+        size_t count = 0;
+        for (uint32_t mip = 0; mip < mipCount; mip++)
+            count += GetCubemapFloatCount(std::max(size >> mip, 1u));
+        return count;
+    }
+
+    bool IBLBaker::LoadFromCache(uint64_t key, BakedEnvironment& environment)
+    {
+        ZoneScoped;
+
+        MappedFile file(GetIBLCachePath(std::to_string(key) + ".ibl"));
+        if (!file.IsValid() || file.GetSize() < sizeof(IBLCacheHeader))
+            return false;
+
+        IBLCacheHeader expected;
+        IBLCacheHeader header;
+        std::memcpy(&header, file.GetData(), sizeof(header));
+
+        if (header.Magic != expected.Magic || header.Version != expected.Version || header.Key != key)
+            return false;
+
+        const size_t environmentCount = GetCubemapFloatCount(header.FaceSize);
+        const size_t irradianceCount = GetCubemapFloatCount(header.IrradianceSize);
+        const size_t prefilteredCount = GetPrefilteredFloatCount(header.PrefilteredSize, header.PrefilteredMipCount);
+
+        // A truncated or corrupted file is baked again
+        if (header.FaceSize == 0 || file.GetSize() != sizeof(header) + (environmentCount + irradianceCount + prefilteredCount) * sizeof(float))
+        {
+            COFFEE_CORE_WARN("IBL cache {0} is corrupted, baking it again", key);
+            return false;
+        }
+
+        const float* cursor = reinterpret_cast<const float*>(file.GetData() + sizeof(header));
+
+        environment.FaceSize = header.FaceSize;
+        environment.Environment.assign(cursor, cursor + environmentCount);
+        cursor += environmentCount;
+
+        for (uint32_t i = 0; i < 9; i++)
+            environment.IrradianceSH[i] = glm::vec3(header.IrradianceSH[i * 3 + 0], header.IrradianceSH[i * 3 + 1], header.IrradianceSH[i * 3 + 2]);
+
+        environment.IrradianceSize = header.IrradianceSize;
+        environment.Irradiance.assign(cursor, cursor + irradianceCount);
+        cursor += irradianceCount;
+
+        environment.PrefilteredSize = header.PrefilteredSize;
+        environment.PrefilteredMipCount = header.PrefilteredMipCount;
+        environment.Prefiltered.assign(cursor, cursor + prefilteredCount);
+
+        return true;
+    }
+
+    void IBLBaker::SaveToCache(uint64_t key, const BakedEnvironment& environment)
+    {
+        ZoneScoped;
+
+        IBLCacheHeader header;
+        header.Key = key;
+        header.FaceSize = environment.FaceSize;
+        header.IrradianceSize = environment.IrradianceSize;
+        header.PrefilteredSize = environment.PrefilteredSize;
+        header.PrefilteredMipCount = environment.PrefilteredMipCount;
+        for (uint32_t i = 0; i < 9; i++)
+        {
+            header.IrradianceSH[i * 3 + 0] = environment.IrradianceSH[i].r;
+            header.IrradianceSH[i * 3 + 1] = environment.IrradianceSH[i].g;
+            header.IrradianceSH[i * 3 + 2] = environment.IrradianceSH[i].b;
+        }
+
+        WriteCacheFile(GetIBLCachePath(std::to_string(key) + ".ibl"), &header, sizeof(header),
+                       {&environment.Environment, &environment.Irradiance, &environment.Prefiltered});
+    }
+
+    BakedEnvironment IBLBaker::LoadOrBake(const std::filesystem::path& path, uint64_t& key, const IBLBakeSettings& settings)
+    {
+        ZoneScoped;
+
+        BakedEnvironment environment;
+
+        key = GetCacheKey(path, settings);
+        if (key != 0 && LoadFromCache(key, environment))
+            return environment;
+
+        environment = BakeFile(path, settings);
+        if (key != 0 && environment.IsValid())
+            SaveToCache(key, environment);
+
+        return environment;
+    }
+
+    std::vector<float> IBLBaker::IntegrateBRDFLUT(uint32_t size, uint32_t sampleCount)
+    {
+        ZoneScoped;
+
+        std::vector<float> lut(size_t(size) * size * 2);
+
+        // Rows are roughness, bottom to top as the texture is sampled
+        JobSystem::ParallelFor(size, 8, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t y = begin; y < end; y++)
+            {
+                float roughness = (y + 0.5f) / size;
+                float k = roughness * roughness / 2.0f;
+
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    float NdotV = (x + 0.5f) / size;
+                    glm::vec3 V(std::sqrt(1.0f - NdotV * NdotV), 0.0f, NdotV);
+
+                    float A = 0.0f;
+                    float B = 0.0f;
+                    for (uint32_t i = 0; i < sampleCount; i++)
+                    {
+                        glm::vec3 H = ImportanceSampleGGX(i, sampleCount, roughness);
+                        glm::vec3 L = glm::normalize(2.0f * glm::dot(V, H) * H - V);
+
+                        float NdotL = std::max(L.z, 0.0f);
+                        float NdotH = std::max(H.z, 0.0f);
+                        float VdotH = std::max(glm::dot(V, H), 0.0f);
+
+                        if (NdotL > 0.0f)
+                        {
+                            float G = (NdotV / (NdotV * (1.0f - k) + k)) * (NdotL / (NdotL * (1.0f - k) + k));
+                            float GVis = (G * VdotH) / (NdotH * NdotV);
+                            float Fc = std::pow(1.0f - VdotH, 5.0f);
+
+                            A += (1.0f - Fc) * GVis;
+                            B += Fc * GVis;
+                        }
+                    }
+
+                    float* out = lut.data() + (size_t(y) * size + x) * 2;
+                    out[0] = A / float(sampleCount);
+                    out[1] = B / float(sampleCount);
+                }
+            }
+        });
+
+        return lut;
+    }
+
+    std::vector<float> IBLBaker::LoadOrBakeBRDFLUT(const IBLBakeSettings& settings)
+    {
+        ZoneScoped;
+
+        // The table only depends on the settings
+        uint64_t key = Hash::FNV1a(&settings.Version, sizeof(settings.Version));
+        key = Hash::FNV1a(&settings.BRDFLUTSize, sizeof(settings.BRDFLUTSize), key);
+        key = Hash::FNV1a(&settings.BRDFLUTSampleCount, sizeof(settings.BRDFLUTSampleCount), key);
+
+        std::filesystem::path cachePath = GetIBLCachePath(std::to_string(key) + ".brdflut");
+        const size_t floatCount = size_t(settings.BRDFLUTSize) * settings.BRDFLUTSize * 2;
+
+        {
+            MappedFile file(cachePath);
+            BRDFLUTCacheHeader expected;
+            BRDFLUTCacheHeader header;
+
+            if (file.IsValid() && file.GetSize() == sizeof(header) + floatCount * sizeof(float))
+            {
+                std::memcpy(&header, file.GetData(), sizeof(header));
+                if (header.Magic == expected.Magic && header.Version == expected.Version && header.Key == key && header.Size == settings.BRDFLUTSize)
+                {
+                    const float* texels = reinterpret_cast<const float*>(file.GetData() + sizeof(header));
+                    return std::vector<float>(texels, texels + floatCount);
+                }
+            }
+        }
+
+        std::vector<float> lut = IntegrateBRDFLUT(settings.BRDFLUTSize, settings.BRDFLUTSampleCount);
+
+        BRDFLUTCacheHeader header;
+        header.Key = key;
+        header.Size = settings.BRDFLUTSize;
+        WriteCacheFile(cachePath, &header, sizeof(header), {&lut});
+
+        return lut;
+    }
+
+}
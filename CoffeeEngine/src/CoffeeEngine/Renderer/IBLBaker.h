@@ -0,0 +1,156 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief Everything that changes the baked image based lighting. Bump Version when the baking code changes.
+     */
+    struct IBLBakeSettings
+    {
+        uint32_t Version = 1; ///< The version of the baking code, part of the cache key.
+        uint32_t IrradianceSize = 32; ///< The face size of the irradiance cubemap.
+        uint32_t PrefilteredSize = 128; ///< The face size of the first mip of the prefiltered cubemap.
+        uint32_t PrefilteredMipCount = 5; ///< The number of prefiltered mips, from roughness 0 to 1.
+        uint32_t PrefilteredSampleCount = 1024; ///< The GGX samples per prefiltered texel.
+        uint32_t BRDFLUTSize = 512; ///< The size of the split-sum BRDF lookup table.
+        uint32_t BRDFLUTSampleCount = 1024; ///< The GGX samples per lookup table texel.
+    };
+
+    /**
+     * @brief The image based lighting of an environment, baked on the CPU.
+     *
+     * The cubemaps are RGB floats with the faces in the OpenGL order (+X, -X, +Y, -Y, +Z, -Z), each one with its
+     * rows starting at t = 0, so every face uploads straight to its layer.
+     */
+    struct BakedEnvironment
+    {
+        uint32_t FaceSize = 0; ///< The face size of the environment cubemap.
+        std::vector<float> Environment; ///< The first mip of the environment cubemap.
+        std::array<glm::vec3, 9> IrradianceSH = {}; ///< The radiance of the environment as order 2 spherical harmonics.
+        uint32_t IrradianceSize = 0; ///< The face size of the irradiance cubemap.
+        std::vector<float> Irradiance; ///< The irradiance cubemap evaluated from IrradianceSH.
+        uint32_t PrefilteredSize = 0; ///< The face size of the first prefiltered mip.
+        uint32_t PrefilteredMipCount = 0; ///< The number of prefiltered mips.
+        std::vector<float> Prefiltered; ///< The prefiltered mips, each one with its six faces.
+
+        bool IsValid() const { return FaceSize > 0 && !Environment.empty(); }
+    };
+
+    /**
+     * @class IBLBaker
+     * @brief Bakes the image based lighting of equirectangular environments without a GPU.
+     *
+     * The environment cubemap, the irradiance, the GGX prefiltered mips and the split-sum BRDF lookup table are
+     * computed on the job system and cached by the hash of their source and settings. Every texel is computed on its
+     * own with a fixed sample sequence, so a bake gives the same result on every run no matter how the work is split.
+     * Nothing here touches OpenGL, so environments can be baked offline on build machines.
+     */
+    class IBLBaker
+    {
+    public:
+        /**
+         * @brief Bakes an equirectangular environment.
+         * @param pixels The RGB float pixels, the first row being the bottom of the image.
+         * @param width The width of the image.
+         * @param height The height of the image.
+         * @param settings What to bake.
+         * @return The baked environment, invalid if the image is empty.
+         */
+        static BakedEnvironment Bake(const float* pixels, uint32_t width, uint32_t height, const IBLBakeSettings& settings = {});
+
+        /**
+         * @brief Decodes and bakes an equirectangular image file.
+         * @param path The path of the image, usually HDR.
+         * @param settings What to bake.
+         * @return The baked environment, invalid if the file could not be decoded.
+         */
+        static BakedEnvironment BakeFile(const std::filesystem::path& path, const IBLBakeSettings& settings = {});
+
+        /**
+         * @brief Gets the cache key of an environment from the hash of its file and the settings.
+         * @param path The path of the image.
+         * @param settings What to bake.
+         * @return The key, 0 if the file could not be read.
+         */
+        static uint64_t GetCacheKey(const std::filesystem::path& path, const IBLBakeSettings& settings = {});
+
+        /**
+         * @brief Reads a baked environment from the cache.
+         * @param key The cache key.
+         * @param environment The environment to fill.
+         * @return Whether a complete entry was found.
+         */
+        static bool LoadFromCache(uint64_t key, BakedEnvironment& environment);
+
+        /**
+         * @brief Writes a baked environment to the cache.
+         * @param key The cache key.
+         * @param environment The environment to write.
+         */
+        static void SaveToCache(uint64_t key, const BakedEnvironment& environment);
+
+        /**
+         * @brief Reads an environment from the cache, baking and caching it on a miss.
+         * @param path The path of the image.
+         * @param key Receives the cache key, 0 if the file could not be read.
+         * @param settings What to bake.
+         * @return The baked environment, invalid if the file could not be decoded.
+         */
+        static BakedEnvironment LoadOrBake(const std::filesystem::path& path, uint64_t& key, const IBLBakeSettings& settings = {});
+
+        /**
+         * @brief Integrates the split-sum BRDF lookup table, indexed by NdotV in x and roughness in y.
+         * @param size The width and height of the table.
+         * @param sampleCount The GGX samples per texel.
+         * @return The RG float texels, the scale and bias to apply to F0.
+         */
+        static std::vector<float> IntegrateBRDFLUT(uint32_t size, uint32_t sampleCount);
+
+        /**
+         * @brief Reads the BRDF lookup table from the cache, integrating and caching it on a miss.
+         * @param settings The size and sample count of the table.
+         * @return The RG float texels.
+         */
+        static std::vector<float> LoadOrBakeBRDFLUT(const IBLBakeSettings& settings = {});
+
+        /**
+         * @brief Gets the direction through a point of a cubemap face.
+         * @param face The face, in the OpenGL order.
+         * @param s The horizontal texture coordinate, from 0 to 1.
+         * @param t The vertical texture coordinate, from 0 to 1.
+         * @return The normalized direction.
+         */
+        static glm::vec3 CubemapDirection(uint32_t face, float s, float t);
+
+        /**
+         * @brief Projects a cubemap onto order 2 spherical harmonics, weighting each texel by its solid angle.
+         * @param faces The six RGB float faces.
+         * @param faceSize The size of a face.
+         * @return The nine RGB coefficients.
+         */
+        static std::array<glm::vec3, 9> ProjectSH9(const float* faces, uint32_t faceSize);
+
+        /**
+         * @brief Evaluates the irradiance of spherical harmonics radiance around a normal.
+         * @param sh The radiance coefficients.
+         * @param normal The normalized normal.
+         * @return The irradiance divided by pi, what a white lambertian surface reflects.
+         */
+        static glm::vec3 EvaluateIrradianceSH9(const std::array<glm::vec3, 9>& sh, const glm::vec3& normal);
+    };
+
+    /** @} */
+}
@@ -1,17 +1,104 @@
 #pragma once
 
-#include "msdf-atlas-gen/GlyphGeometry.h"
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
-#undef INFINITE
-#include <msdf-atlas-gen/msdf-atlas-gen.h>
-
 namespace Coffee {
-    
+
+    /**
+     * @brief Layout data of a glyph in the font atlas.
+     */
+    struct MSDFGlyphMetrics
+    {
+        uint32_t Codepoint = 0;
+        int32_t Index = 0; ///< Glyph index in the font, used by the kerning pairs.
+        double Advance = 0.0;
+        double PlaneLeft = 0.0, PlaneBottom = 0.0, PlaneRight = 0.0, PlaneTop = 0.0;
+        double AtlasLeft = 0.0, AtlasBottom = 0.0, AtlasRight = 0.0, AtlasTop = 0.0;
+    };
+
+    struct MSDFKerningPair
+    {
+        int32_t First = 0; ///< Glyph index of the first glyph.
+        int32_t Second = 0; ///< Glyph index of the second glyph.
+        double Value = 0.0;
+    };
+
+    struct MSDFFontMetrics
+    {
+        double AscenderY = 0.0;
+        double DescenderY = 0.0;
+        double LineHeight = 0.0;
+    };
+
+    /**
+     * @brief Glyph metrics of a font, extracted from msdf-atlas-gen.
+     *
+     * Plain data so it can be written to and read from the font cache without loading the font again.
+     */
     struct MSDFData
     {
-        std::vector<msdf_atlas::GlyphGeometry> Glyphs;
-        msdf_atlas::FontGeometry FontGeometry;
+        MSDFFontMetrics Metrics;
+        std::vector<MSDFGlyphMetrics> Glyphs;
+        std::vector<MSDFKerningPair> Kerning;
+
+        /**
+         * @brief Gets the metrics of a glyph.
+         * @param codepoint The unicode codepoint.
+         * @return The glyph metrics, or nullptr if the font has no glyph for the codepoint.
+         */
+        const MSDFGlyphMetrics* GetGlyph(uint32_t codepoint) const
+        {
+            auto it = m_GlyphLookup.find(codepoint);
+            return it != m_GlyphLookup.end() ? &Glyphs[it->second] : nullptr;
+        }
+
+        /**
+         * @brief Gets the advance between two glyphs, kerning included. Same behavior as msdf_atlas::FontGeometry::getAdvance.
+         * @param advance Receives the advance. Left untouched if either glyph is missing.
+         * @param codepoint1 The codepoint of the first glyph.
+         * @param codepoint2 The codepoint of the second glyph.
+         * @return True if both glyphs exist.
+         */
+        bool GetAdvance(double& advance, uint32_t codepoint1, uint32_t codepoint2) const
+        {
+            const MSDFGlyphMetrics* glyph1 = GetGlyph(codepoint1);
+            const MSDFGlyphMetrics* glyph2 = GetGlyph(codepoint2);
+            if (!glyph1 || !glyph2)
+                return false;
+
+            advance = glyph1->Advance;
+            auto it = m_KerningLookup.find(KerningKey(glyph1->Index, glyph2->Index));
+            if (it != m_KerningLookup.end())
+                advance += it->second;
+            return true;
+        }
+
+        /**
+         * @brief Rebuilds the lookup tables. Must be called after Glyphs or Kerning change.
+         */
+        void BuildLookups()
+        {
+            m_GlyphLookup.clear();
+            m_GlyphLookup.reserve(Glyphs.size());
+            for (uint32_t i = 0; i < Glyphs.size(); ++i)
+                m_GlyphLookup[Glyphs[i].Codepoint] = i;
+
+            m_KerningLookup.clear();
+            m_KerningLookup.reserve(Kerning.size());
+            for (const MSDFKerningPair& pair : Kerning)
+                m_KerningLookup[KerningKey(pair.First, pair.Second)] = pair.Value;
+        }
+
+    private:
+        static uint64_t KerningKey(int32_t first, int32_t second)
+        {
+            return (uint64_t(uint32_t(first)) << 32) | uint32_t(second);
+        }
+
+        std::unordered_map<uint32_t, uint32_t> m_GlyphLookup; ///< Codepoint to index in Glyphs.
+        std::unordered_map<uint64_t, double> m_KerningLookup; ///< Glyph index pair to kerning.
     };
 
-}
\ No newline at end of file
+}
@@ -7,6 +7,7 @@
 #include "CoffeeEngine/IO/ResourceLoader.h"
 #include "CoffeeEngine/Renderer/Shader.h"
 #include "CoffeeEngine/Renderer/Texture.h"
+#include "CoffeeEngine/Renderer/TextureStreaming.h"
 #include "CoffeeEngine/Project/Project.h"
 #include "CoffeeEngine/Embedded/StandardShader.inl"
 #include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
@@ -235,11 +236,6 @@ namespace Coffee {
         m_TextureFlags.hasAlbedo = true;
 
         m_Shader = s_StandardShader;
-
-        m_Shader->Bind();
-        m_Textures.albedo->Bind(0);
-        m_Shader->setInt("material.albedoMap", 0);
-        m_Shader->Unbind();
     }
 
     PBRMaterial::PBRMaterial(const std::string& name, Ref<Shader> shader) 
@@ -270,15 +266,6 @@ namespace Coffee {
         if(m_TextureFlags.hasEmissive) m_Properties.emissive = glm::vec3(1.0f);
 
         m_Shader = s_StandardShader;
-
-        m_Shader->Bind();
-        m_Shader->setInt("material.albedoMap", 0);
-        m_Shader->setInt("material.normalMap", 1);
-        m_Shader->setInt("material.metallicMap", 2);
-        m_Shader->setInt("material.roughnessMap", 3);
-        m_Shader->setInt("material.aoMap", 4);
-        m_Shader->setInt("material.emissiveMap", 5);
-        m_Shader->Unbind();
     }
 
     PBRMaterial::PBRMaterial(ImportData& importData)
@@ -311,15 +298,23 @@ namespace Coffee {
         m_TextureFlags.hasAO = (m_Textures.ao != nullptr);
         m_TextureFlags.hasEmissive = (m_Textures.emissive != nullptr);
 
+        // Select the shader variant, the texture flags are compiled in instead of branching per fragment
+        m_Shader->SetKeyword("HAS_ALBEDO_MAP", m_TextureFlags.hasAlbedo);
+        m_Shader->SetKeyword("HAS_NORMAL_MAP", m_TextureFlags.hasNormal);
+        m_Shader->SetKeyword("HAS_METALLIC_MAP", m_TextureFlags.hasMetallic);
+        m_Shader->SetKeyword("HAS_ROUGHNESS_MAP", m_TextureFlags.hasRoughness);
+        m_Shader->SetKeyword("HAS_AO_MAP", m_TextureFlags.hasAO);
+        m_Shader->SetKeyword("HAS_EMISSIVE_MAP", m_TextureFlags.hasEmissive);
+
         m_Shader->Bind();
 
-        // Bind Textures
-        if(m_TextureFlags.hasAlbedo) m_Textures.albedo->Bind(0);
-        if(m_TextureFlags.hasNormal) m_Textures.normal->Bind(1);
-        if(m_TextureFlags.hasMetallic) m_Textures.metallic->Bind(2);
-        if(m_TextureFlags.hasRoughness) m_Textures.roughness->Bind(3);
-        if(m_TextureFlags.hasAO) m_Textures.ao->Bind(4);
-        if(m_TextureFlags.hasEmissive) m_Textures.emissive->Bind(5);
+        // Bind Textures (each variant is its own program, so the sampler units are set here)
+        if(m_TextureFlags.hasAlbedo) { m_Textures.albedo->Bind(0); m_Shader->setInt("material.albedoMap", 0); }
+        if(m_TextureFlags.hasNormal) { m_Textures.normal->Bind(1); m_Shader->setInt("material.normalMap", 1); }
+        if(m_TextureFlags.hasMetallic) { m_Textures.metallic->Bind(2); m_Shader->setInt("material.metallicMap", 2); }
+        if(m_TextureFlags.hasRoughness) { m_Textures.roughness->Bind(3); m_Shader->setInt("material.roughnessMap", 3); }
+        if(m_TextureFlags.hasAO) { m_Textures.ao->Bind(4); m_Shader->setInt("material.aoMap", 4); }
+        if(m_TextureFlags.hasEmissive) { m_Textures.emissive->Bind(5); m_Shader->setInt("material.emissiveMap", 5); }
 
         // Set Material Properties
         m_Shader->setVec4("material.color", m_Properties.color);
@@ -328,18 +323,20 @@ namespace Coffee {
         m_Shader->setFloat("material.ao", m_Properties.ao);
         m_Shader->setVec3("material.emissive", m_Properties.emissive);
 
-        // Set Material Texture Flags
-        m_Shader->setInt("material.hasAlbedo", m_TextureFlags.hasAlbedo);
-        m_Shader->setInt("material.hasNormal", m_TextureFlags.hasNormal);
-        m_Shader->setInt("material.hasMetallic", m_TextureFlags.hasMetallic);
-        m_Shader->setInt("material.hasRoughness", m_TextureFlags.hasRoughness);
-        m_Shader->setInt("material.hasAO", m_TextureFlags.hasAO);
-        m_Shader->setInt("material.hasEmissive", m_TextureFlags.hasEmissive);
-
         m_Shader->setInt("material.transparencyMode", m_RenderSettings.transparencyMode);
         m_Shader->setFloat("material.alphaCutoff", m_RenderSettings.alphaCutoff);
     }
 
+    void PBRMaterial::RequestTextureMips(float screenSize)
+    {
+        for (const Ref<Texture2D>& texture : { m_Textures.albedo, m_Textures.normal, m_Textures.metallic,
+                                               m_Textures.roughness, m_Textures.ao, m_Textures.emissive })
+        {
+            if (texture)
+                TextureStreaming::Request(*texture, screenSize);
+        }
+    }
+
     PBRMaterialTextures& PBRMaterial::GetTextures() 
     { 
         return m_Textures; 
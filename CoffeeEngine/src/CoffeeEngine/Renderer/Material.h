@@ -85,6 +85,12 @@ namespace Coffee {
 
         virtual void Use() = 0;
 
+        /**
+         * @brief Requests the texture mips needed to draw the material at a size on screen.
+         * @param screenSize The size in pixels the mesh covers on screen.
+         */
+        virtual void RequestTextureMips(float screenSize) {}
+
     private:
         friend class cereal::access;
         template<class Archive>
@@ -204,6 +210,7 @@ namespace Coffee {
         PBRMaterial(ImportData& importData);
 
         void Use() override;
+        void RequestTextureMips(float screenSize) override;
 
         PBRMaterialTextures& GetTextures();
         PBRMaterialProperties& GetProperties();
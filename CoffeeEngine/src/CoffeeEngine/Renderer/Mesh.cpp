@@ -2,11 +2,15 @@
 
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/IO/ImportData/ImportData.h"
+#include "CoffeeEngine/IO/CacheManager.h"
 #include "CoffeeEngine/IO/ImportData/MeshImportData.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
+#include "CoffeeEngine/IO/ResourceResidency.h"
 #include "CoffeeEngine/Renderer/Buffer.h"
 #include "CoffeeEngine/Renderer/Material.h"
+#include "CoffeeEngine/Renderer/MeshLODGenerator.h"
 #include "CoffeeEngine/Renderer/VertexArray.h"
+#include "CoffeeEngine/Renderer/VertexQuantization.h"
 #include "CoffeeEngine/Math/BoundingBox.h"
 #include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
 #include <cereal/access.hpp>
@@ -19,6 +23,7 @@
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <tracy/Tracy.hpp>
 
 namespace Coffee {
@@ -29,32 +34,29 @@ namespace Coffee {
         archive(Position, TexCoords, Normals, Tangent, Bitangent, BoneIDs, BoneWeights);
     }
 
+    template<class Archive>
+    void MeshLOD::serialize(Archive& archive)
+    {
+        archive(IndexOffset, IndexCount, Error);
+    }
+
     // Mesh implementation
     Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+        : Mesh(vertices, indices, {}, {})
+    {
+    }
+
+    Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+               const std::vector<uint32_t>& lodIndices, const std::vector<MeshLOD>& lods, bool quantizePositions)
         : Resource(ResourceType::Mesh)
         , m_Vertices(vertices)
         , m_Indices(indices)
+        , m_LODIndices(lodIndices)
+        , m_QuantizePositions(quantizePositions)
     {
         ZoneScoped;
 
-        m_VertexBuffer = VertexBuffer::Create((float*)m_Vertices.data(), m_Vertices.size() * sizeof(Vertex));
-        m_IndexBuffer = IndexBuffer::Create(m_Indices.data(), m_Indices.size());
-
-        BufferLayout layout = {
-            {ShaderDataType::Vec3, "a_Position"},
-            {ShaderDataType::Vec2, "a_TexCoords"},
-            {ShaderDataType::Vec3, "a_Normals"},
-            {ShaderDataType::Vec3, "a_Tangent"},
-            {ShaderDataType::Vec3, "a_Bitangent"},
-            {ShaderDataType::IVec4, "a_BoneIDs"},
-            {ShaderDataType::Vec4, "a_BoneWeights"}
-        };
-
-        m_VertexBuffer->SetLayout(layout);
-
-        m_VertexArray = VertexArray::Create();
-        m_VertexArray->AddVertexBuffer(m_VertexBuffer);
-        m_VertexArray->SetIndexBuffer(m_IndexBuffer);
+        Initialize(lods);
     }
 
     Mesh::Mesh(const ImportData& importData)
@@ -64,7 +66,12 @@ namespace Coffee {
 
         const MeshImportData& meshImportData = dynamic_cast<const MeshImportData&>(importData);
 
-        *this = Mesh(meshImportData.vertices, meshImportData.indices);
+        m_Vertices = meshImportData.vertices;
+        m_Indices = meshImportData.indices;
+        m_LODIndices = meshImportData.lodIndices;
+        m_QuantizePositions = meshImportData.quantizePositions;
+        Initialize(meshImportData.lods);
+
         m_Name = meshImportData.name;
         m_UUID = meshImportData.uuid;
         m_Material = meshImportData.material;
@@ -72,6 +79,103 @@ namespace Coffee {
         m_FilePath = meshImportData.cachedPath;
     }
 
+    Mesh::~Mesh()
+    {
+        ResourceResidency::AddResidentBytes(ResourceType::Mesh, -(int64_t)m_ResidentBytes);
+    }
+
+    void Mesh::Initialize(const std::vector<MeshLOD>& lods)
+    {
+        m_VertexCount = (uint32_t)m_Vertices.size();
+
+        m_LODs.clear();
+        m_LODs.reserve(lods.size() + 1);
+        m_LODs.push_back({0, (uint32_t)m_Indices.size(), 0.0f});
+
+        // The simplified LODs are stored after the full detail indices
+        for (MeshLOD lod : lods)
+        {
+            lod.IndexOffset += (uint32_t)m_Indices.size();
+            m_LODs.push_back(lod);
+        }
+
+        // Reloading dropped CPU data from the cache must not create GPU objects again
+        if (!ResourceResidency::IsLoadingCPUDataOnly())
+            CreateBuffers();
+
+        UpdateResidentBytes();
+    }
+
+    void Mesh::CreateBuffers()
+    {
+        ZoneScoped;
+
+        // Skinned meshes are transformed by the bones before the model matrix, so their positions can't be quantized
+        m_Skinned = VertexQuantization::IsSkinned(m_Vertices);
+        m_PositionTransform = glm::mat4(1.0f);
+
+        BufferLayout layout;
+        if (m_Skinned)
+        {
+            std::vector<SkinnedVertex> vertices = VertexQuantization::EncodeSkinned(m_Vertices);
+            m_VertexBuffer = VertexBuffer::Create((float*)vertices.data(), vertices.size() * sizeof(SkinnedVertex));
+            layout = {
+                {ShaderDataType::Vec3, "a_Position"},
+                {ShaderDataType::Half2, "a_TexCoords"},
+                {ShaderDataType::Short2, "a_Normal", true},
+                {ShaderDataType::UInt, "a_Tangent"},
+                {ShaderDataType::UByte4, "a_BoneIDs"},
+                {ShaderDataType::UByte4, "a_BoneWeights", true}
+            };
+        }
+        else if (m_QuantizePositions)
+        {
+            glm::vec3 offset;
+            float scale;
+            VertexQuantization::GetPositionBounds(m_Vertices, offset, scale);
+            m_PositionTransform = glm::scale(glm::translate(glm::mat4(1.0f), offset), glm::vec3(scale));
+
+            std::vector<QuantizedStaticVertex> vertices = VertexQuantization::EncodeQuantizedStatic(m_Vertices, offset, scale);
+            m_VertexBuffer = VertexBuffer::Create((float*)vertices.data(), vertices.size() * sizeof(QuantizedStaticVertex));
+            layout = {
+                {ShaderDataType::UShort4, "a_Position", true},
+                {ShaderDataType::Half2, "a_TexCoords"},
+                {ShaderDataType::Short2, "a_Normal", true},
+                {ShaderDataType::UInt, "a_Tangent"}
+            };
+        }
+        else
+        {
+            std::vector<StaticVertex> vertices = VertexQuantization::EncodeStatic(m_Vertices);
+            m_VertexBuffer = VertexBuffer::Create((float*)vertices.data(), vertices.size() * sizeof(StaticVertex));
+            layout = {
+                {ShaderDataType::Vec3, "a_Position"},
+                {ShaderDataType::Half2, "a_TexCoords"},
+                {ShaderDataType::Short2, "a_Normal", true},
+                {ShaderDataType::UInt, "a_Tangent"}
+            };
+        }
+
+        if (m_LODIndices.empty())
+        {
+            m_IndexBuffer = IndexBuffer::Create(m_Indices.data(), m_Indices.size());
+        }
+        else
+        {
+            std::vector<uint32_t> indices;
+            indices.reserve(m_Indices.size() + m_LODIndices.size());
+            indices.insert(indices.end(), m_Indices.begin(), m_Indices.end());
+            indices.insert(indices.end(), m_LODIndices.begin(), m_LODIndices.end());
+            m_IndexBuffer = IndexBuffer::Create(indices.data(), indices.size());
+        }
+
+        m_VertexBuffer->SetLayout(layout);
+
+        m_VertexArray = VertexArray::Create();
+        m_VertexArray->AddVertexBuffer(m_VertexBuffer);
+        m_VertexArray->SetIndexBuffer(m_IndexBuffer);
+    }
+
     const Ref<VertexArray>& Mesh::GetVertexArray() const
     {
         return m_VertexArray;
@@ -112,48 +216,175 @@ namespace Coffee {
         return m_Material;
     }
 
-    const std::vector<Vertex>& Mesh::GetVertices() const
+    const std::vector<Vertex>& Mesh::GetVertices()
     {
+        if (!IsCPUDataResident())
+            LoadCPUData();
+
         return m_Vertices;
     }
 
-    const std::vector<uint32_t>& Mesh::GetIndices() const
+    const std::vector<uint32_t>& Mesh::GetIndices()
     {
+        if (!IsCPUDataResident())
+            LoadCPUData();
+
         return m_Indices;
     }
 
+    void Mesh::AcquireCPUData()
+    {
+        m_CPUDataUsers++;
+
+        if (!IsCPUDataResident())
+            LoadCPUData();
+    }
+
+    void Mesh::ReleaseCPUData()
+    {
+        COFFEE_CORE_ASSERT(m_CPUDataUsers > 0, "Mesh::ReleaseCPUData called without a matching AcquireCPUData!");
+
+        if (m_CPUDataUsers > 0 && --m_CPUDataUsers == 0)
+            TrimCPUData();
+    }
+
+    void Mesh::TrimCPUData()
+    {
+        if (m_CPUDataUsers > 0 || m_Vertices.empty() || ResourceResidency::GetRetainCPUData(ResourceType::Mesh))
+            return;
+
+        // Without a cache file the data could not be reloaded
+        if (!std::filesystem::exists(CacheManager::GetCachedFilePath(m_UUID, ResourceType::Mesh)))
+            return;
+
+        std::vector<Vertex>().swap(m_Vertices);
+        std::vector<uint32_t>().swap(m_Indices);
+        std::vector<uint32_t>().swap(m_LODIndices);
+        UpdateResidentBytes();
+    }
+
+    void Mesh::LoadCPUData()
+    {
+        ZoneScoped;
+
+        Ref<Mesh> cached;
+        {
+            ResourceResidency::CPUDataLoadScope scope;
+            cached = ResourceImporter().ImportFromCache<Mesh>(m_UUID);
+        }
+
+        if (!cached)
+        {
+            COFFEE_CORE_ERROR("Mesh::LoadCPUData: Could not reload the data of mesh {0} from the cache", m_Name);
+            return;
+        }
+
+        m_Vertices = std::move(cached->m_Vertices);
+        m_Indices = std::move(cached->m_Indices);
+        m_LODIndices = std::move(cached->m_LODIndices);
+        UpdateResidentBytes();
+    }
+
+    void Mesh::GenerateLODs(const MeshLODSettings& settings)
+    {
+        ZoneScoped;
+
+        COFFEE_CORE_ASSERT(IsCPUDataResident(), "Mesh::GenerateLODs: The CPU data of the mesh was dropped, acquire it first!");
+
+        std::vector<MeshLOD> lods;
+        m_LODIndices.clear();
+        if (m_Indices.size() % 3 == 0)
+            MeshLODGenerator::Generate(m_Vertices, m_Indices, settings, m_LODIndices, lods);
+
+        Initialize(lods);
+        m_LegacyCache = false;
+    }
+
+    void Mesh::UpdateResidentBytes()
+    {
+        size_t bytes = m_Vertices.capacity() * sizeof(Vertex) + (m_Indices.capacity() + m_LODIndices.capacity()) * sizeof(uint32_t);
+        ResourceResidency::AddResidentBytes(ResourceType::Mesh, (int64_t)bytes - (int64_t)m_ResidentBytes);
+        m_ResidentBytes = bytes;
+    }
+
+    // The simplified LODs are serialized with offsets relative to the LOD indices, as the constructor takes them
+    static std::vector<MeshLOD> GetSimplifiedLODs(const std::vector<MeshLOD>& lods, uint32_t baseIndexCount)
+    {
+        std::vector<MeshLOD> simplifiedLODs(lods.begin() + std::min<size_t>(1, lods.size()), lods.end());
+        for (MeshLOD& lod : simplifiedLODs)
+            lod.IndexOffset -= baseIndexCount;
+        return simplifiedLODs;
+    }
+
+    // Reads the geometry of any version of the mesh cache. Version 0 caches predate the LODs and the position
+    // quantization, version 1 adds both. The packed GPU formats are built from the full precision vertices at upload,
+    // so older caches only miss the flag and load unquantized.
     template<class Archive>
-    void Mesh::save(Archive& archive) const
+    static void LoadGeometry(Archive& archive, std::uint32_t const version, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                             std::vector<uint32_t>& lodIndices, std::vector<MeshLOD>& lods, bool& quantizePositions)
     {
+        archive(vertices, indices);
+
+        quantizePositions = false;
+
+        // Older caches load without LODs, the model builds them with its import settings and writes the cache again
+        if (version >= 1)
+            archive(lodIndices, lods, quantizePositions);
+    }
+
+    template<class Archive>
+    void Mesh::save(Archive& archive, std::uint32_t const version) const
+    {
+        // ResourceSaver reloads dropped CPU data before writing, archiving a mesh directly needs a hold on it
+        COFFEE_CORE_ASSERT(IsCPUDataResident(), "Mesh::save: The CPU data of the mesh was dropped, acquire it before saving!");
+
         UUID materialUUID = m_Material ? m_Material->GetUUID() : UUID::null;
-        archive(m_Vertices, m_Indices, m_AABB, materialUUID, cereal::base_class<Resource>(this));
+        std::vector<MeshLOD> lods = GetSimplifiedLODs(m_LODs, m_LODs[0].IndexCount);
+        archive(m_Vertices, m_Indices, m_LODIndices, lods, m_QuantizePositions, m_AABB, materialUUID, cereal::base_class<Resource>(this));
     }
 
     template<class Archive>
-    void Mesh::load(Archive& archive)
+    void Mesh::load(Archive& archive, std::uint32_t const version)
     {
         UUID materialUUID;
-        archive(m_Vertices, m_Indices, m_AABB, materialUUID, cereal::base_class<Resource>(this));
+        std::vector<MeshLOD> lods;
+        LoadGeometry(archive, version, m_Vertices, m_Indices, m_LODIndices, lods, m_QuantizePositions);
+        archive(m_AABB, materialUUID, cereal::base_class<Resource>(this));
+        m_LegacyCache = version < 1;
+
+        m_LODs.clear();
+        m_LODs.push_back({0, (uint32_t)m_Indices.size(), 0.0f});
+        for (MeshLOD lod : lods)
+        {
+            lod.IndexOffset += (uint32_t)m_Indices.size();
+            m_LODs.push_back(lod);
+        }
+
+        m_VertexCount = (uint32_t)m_Vertices.size();
+        UpdateResidentBytes();
 
-        if (materialUUID != UUID::null)
+        // A CPU data reload only needs the vertices and indices, the material would be uploaded for nothing
+        if (materialUUID != UUID::null && !ResourceResidency::IsLoadingCPUDataOnly())
             m_Material = ResourceLoader::GetResource<PBRMaterial>(materialUUID);
     }
 
     template<class Archive>
-    void Mesh::load_and_construct(Archive& data, cereal::construct<Mesh>& construct)
+    void Mesh::load_and_construct(Archive& data, cereal::construct<Mesh>& construct, std::uint32_t const version)
     {
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
-        data(vertices, indices);
-        construct(vertices, indices);
+        std::vector<uint32_t> lodIndices;
+        std::vector<MeshLOD> lods;
+        bool quantizePositions = false;
+        LoadGeometry(data, version, vertices, indices, lodIndices, lods, quantizePositions);
+        construct(vertices, indices, lodIndices, lods, quantizePositions);
 
         UUID materialUUID;
         data(construct->m_AABB, materialUUID, cereal::base_class<Resource>(construct.ptr()));
+        construct->m_LegacyCache = version < 1;
         
-        construct->m_Vertices = vertices;
-        construct->m_Indices = indices;
-        
-        if (materialUUID != UUID::null)
+        // A CPU data reload only needs the vertices and indices, the material would be uploaded for nothing
+        if (materialUUID != UUID::null && !ResourceResidency::IsLoadingCPUDataOnly())
             construct->m_Material = ResourceLoader::GetResource<PBRMaterial>(materialUUID);
     }
 
@@ -163,14 +394,20 @@ namespace Coffee {
     template void Vertex::serialize<cereal::BinaryInputArchive>(cereal::BinaryInputArchive&);
     template void Vertex::serialize<cereal::BinaryOutputArchive>(cereal::BinaryOutputArchive&);
 
+    // Explicit template instantiations for MeshLOD
+    template void MeshLOD::serialize<cereal::JSONInputArchive>(cereal::JSONInputArchive&);
+    template void MeshLOD::serialize<cereal::JSONOutputArchive>(cereal::JSONOutputArchive&);
+    template void MeshLOD::serialize<cereal::BinaryInputArchive>(cereal::BinaryInputArchive&);
+    template void MeshLOD::serialize<cereal::BinaryOutputArchive>(cereal::BinaryOutputArchive&);
+
     // Explicit template instantiations for Mesh
-    template void Mesh::save<cereal::JSONOutputArchive>(cereal::JSONOutputArchive&) const;
-    template void Mesh::save<cereal::BinaryOutputArchive>(cereal::BinaryOutputArchive&) const;
-    template void Mesh::load<cereal::JSONInputArchive>(cereal::JSONInputArchive&);
-    template void Mesh::load<cereal::BinaryInputArchive>(cereal::BinaryInputArchive&);
+    template void Mesh::save<cereal::JSONOutputArchive>(cereal::JSONOutputArchive&, std::uint32_t const) const;
+    template void Mesh::save<cereal::BinaryOutputArchive>(cereal::BinaryOutputArchive&, std::uint32_t const) const;
+    template void Mesh::load<cereal::JSONInputArchive>(cereal::JSONInputArchive&, std::uint32_t const);
+    template void Mesh::load<cereal::BinaryInputArchive>(cereal::BinaryInputArchive&, std::uint32_t const);
 
-    template void Mesh::load_and_construct<cereal::JSONInputArchive>(cereal::JSONInputArchive&, cereal::construct<Mesh>&);
-    template void Mesh::load_and_construct<cereal::BinaryInputArchive>(cereal::BinaryInputArchive&, cereal::construct<Mesh>&);
+    template void Mesh::load_and_construct<cereal::JSONInputArchive>(cereal::JSONInputArchive&, cereal::construct<Mesh>&, std::uint32_t const);
+    template void Mesh::load_and_construct<cereal::BinaryInputArchive>(cereal::BinaryInputArchive&, cereal::construct<Mesh>&, std::uint32_t const);
 
 } // namespace Coffee
 
@@ -4,8 +4,10 @@
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/Math/BoundingBox.h"
 
+#include <cereal/cereal.hpp>
 #include <glm/glm.hpp>
 
+#include <algorithm>
 #include <stdint.h>
 #include <vector>
 
@@ -19,6 +21,7 @@ namespace Coffee {
     class ResourceLoader;
     struct ImportData;
     struct MeshImportData;
+    struct MeshLODSettings;
     struct AABB;
     struct OBB;
     struct UUID;
@@ -34,6 +37,9 @@ namespace Coffee {
 
     /**
      * @brief Structure representing a vertex in a mesh.
+     *
+     * This is the full precision format used on the CPU and in the mesh cache. The GPU buffers use the
+     * compact formats of VertexQuantization.
      */
     struct Vertex {
         glm::vec3 Position = glm::vec3(0.0f); ///< The position of the vertex.
@@ -50,6 +56,20 @@ namespace Coffee {
         void serialize(Archive& archive);
     };
 
+    /**
+     * @brief Index range of one level of detail of a mesh.
+     */
+    struct MeshLOD {
+        uint32_t IndexOffset = 0; ///< The first index of the LOD in the index buffer.
+        uint32_t IndexCount = 0; ///< The number of indices of the LOD.
+        float Error = 0.0f; ///< The simplification error of the LOD, in object space units.
+
+    private:
+        friend class cereal::access;
+        template<class Archive>
+        void serialize(Archive& archive);
+    };
+
     /**
      * @brief Class representing a mesh.
      */
@@ -62,6 +82,17 @@ namespace Coffee {
          * @param indices The indices of the mesh.
          */
         Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+
+        /**
+         * @brief Constructs a Mesh with simplified levels of detail.
+         * @param vertices The vertices of the mesh, shared by every LOD.
+         * @param indices The indices of the full detail mesh.
+         * @param lodIndices The indices of the simplified LODs, one after the other.
+         * @param lods The simplified LODs, with offsets relative to lodIndices.
+         * @param quantizePositions Store the positions as unorm16 relative to the mesh bounds. Ignored for skinned meshes.
+         */
+        Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+             const std::vector<uint32_t>& lodIndices, const std::vector<MeshLOD>& lods, bool quantizePositions = false);
         
         /**
          * @brief Constructs a Mesh from import data.
@@ -69,6 +100,12 @@ namespace Coffee {
          */
         Mesh(const ImportData& importData);
 
+        ~Mesh();
+
+        // A copy would report the resident bytes of the mesh a second time and share its vertex array
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
+
         /**
          * @brief Gets the vertex array of the mesh.
          * @return A reference to the vertex array.
@@ -119,28 +156,119 @@ namespace Coffee {
         const Ref<Material>& GetMaterial() const;
 
         /**
-         * @brief Gets the vertices of the mesh.
+         * @brief Gets the vertices of the mesh. They are reloaded from the cache if they were dropped.
+         *
+         * Users that need the vertices for longer than a call should hold them with AcquireCPUData.
          * @return A reference to the vector of vertices.
          */
-        const std::vector<Vertex>& GetVertices() const;
+        const std::vector<Vertex>& GetVertices();
 
         /**
-         * @brief Gets the indices of the mesh.
+         * @brief Gets the indices of the full detail mesh. They are reloaded from the cache if they were dropped.
          * @return A reference to the vector of indices.
          */
-        const std::vector<uint32_t>& GetIndices() const;
+        const std::vector<uint32_t>& GetIndices();
+
+        /**
+         * @brief Gets the number of vertices, without reloading them.
+         * @return The vertex count.
+         */
+        uint32_t GetVertexCount() const { return m_VertexCount; }
+
+        /**
+         * @brief Keeps the vertices and indices in memory until ReleaseCPUData, reloading them from the cache if needed.
+         */
+        void AcquireCPUData();
+
+        /**
+         * @brief Releases a hold taken with AcquireCPUData. The data is dropped when no hold is left.
+         */
+        void ReleaseCPUData();
+
+        /**
+         * @brief Drops the vertices and indices if nothing holds them and the residency policy allows it.
+         */
+        void TrimCPUData() override;
+
+        /**
+         * @brief Checks whether the vertices and indices are in memory.
+         * @return True if the CPU data is resident.
+         */
+        bool IsCPUDataResident() const { return m_VertexCount == 0 || !m_Vertices.empty(); }
+
+        /**
+         * @brief Gets the number of levels of detail, the full detail mesh included.
+         * @return The number of LODs, at least 1.
+         */
+        uint32_t GetLODCount() const { return (uint32_t)m_LODs.size(); }
+
+        /**
+         * @brief Gets a level of detail. LOD 0 is the full detail mesh.
+         * @param level The LOD level, clamped to the last LOD.
+         * @return The index range of the LOD in the index buffer.
+         */
+        const MeshLOD& GetLOD(uint32_t level) const { return m_LODs[std::min(level, GetLODCount() - 1)]; }
+
+        /**
+         * @brief Checks whether the mesh was read from a cache written before the LODs, which has to be upgraded.
+         * @return True until GenerateLODs is called.
+         */
+        bool HasLegacyCache() const { return m_LegacyCache; }
+
+        /**
+         * @brief Replaces the simplified LODs and uploads the index buffer again. The CPU data must be held.
+         * @param settings The LOD settings of the model the mesh was imported with.
+         */
+        void GenerateLODs(const MeshLODSettings& settings);
+
+        /**
+         * @brief Checks whether the vertex buffer uses the skinned vertex format.
+         * @return True if the vertices carry bone indices and weights.
+         */
+        bool IsSkinned() const { return m_Skinned; }
+
+        /**
+         * @brief Gets the transform that maps the positions of the vertex buffer to object space.
+         *
+         * It is the identity unless the positions are quantized, the renderer applies it before the model matrix.
+         * It is a translation and a uniform scale, so directions transformed by it stay valid once normalized.
+         * @return The dequantization transform.
+         */
+        const glm::mat4& GetPositionTransform() const { return m_PositionTransform; }
+
+    private:
+        /**
+         * @brief Builds the LOD ranges and uploads the data to the GPU.
+         * @param lods The simplified LODs, with offsets relative to the LOD indices.
+         */
+        void Initialize(const std::vector<MeshLOD>& lods);
+
+        /**
+         * @brief Creates the GPU buffers. The index buffer holds every LOD after the full detail indices.
+         */
+        void CreateBuffers();
+
+        /**
+         * @brief Reloads the vertices and indices from the mesh cache.
+         */
+        void LoadCPUData();
+
+        /**
+         * @brief Reports the size of the CPU data to the ResourceResidency statistics.
+         */
+        void UpdateResidentBytes();
 
     private:
         friend class cereal::access;
 
         template<class Archive>
-        void save(Archive& archive) const;
+        void save(Archive& archive, std::uint32_t const version) const;
 
         template<class Archive>
-        void load(Archive& archive);
+        void load(Archive& archive, std::uint32_t const version);
 
         template<class Archive>
-        static void load_and_construct(Archive& data, cereal::construct<Mesh>& construct);
+        static void load_and_construct(Archive& data, cereal::construct<Mesh>& construct, std::uint32_t const version);
 
     private:
         Ref<VertexArray> m_VertexArray; ///< The vertex array of the mesh.
@@ -152,7 +280,19 @@ namespace Coffee {
 
         std::vector<uint32_t> m_Indices; ///< The indices of the mesh.
         std::vector<Vertex> m_Vertices; ///< The vertices of the mesh.
+        std::vector<uint32_t> m_LODIndices; ///< The indices of the simplified LODs.
+        std::vector<MeshLOD> m_LODs; ///< The LODs of the mesh, LOD 0 being the full detail mesh.
+
+        bool m_Skinned = false; ///< Whether the vertex buffer uses the skinned vertex format.
+        bool m_QuantizePositions = false; ///< Whether the positions are quantized to the mesh bounds.
+        glm::mat4 m_PositionTransform = glm::mat4(1.0f); ///< Maps the quantized positions to object space.
+
+        uint32_t m_VertexCount = 0; ///< The number of vertices, kept when the CPU data is dropped.
+        uint32_t m_CPUDataUsers = 0; ///< The number of holds on the CPU data.
+        size_t m_ResidentBytes = 0; ///< The CPU bytes reported to ResourceResidency.
+        bool m_LegacyCache = false; ///< Whether the mesh was read from a version 0 cache, without LODs.
     };
 
     /** @} */
-}
\ No newline at end of file
+}
+CEREAL_CLASS_VERSION(Coffee::Mesh, 1);
@@ -0,0 +1,78 @@
+#include "MeshLODGenerator.h"
+
+#include "CoffeeEngine/Renderer/Mesh.h"
+#include "CoffeeEngine/Renderer/MeshOptimization.h"
+
+#include <meshoptimizer.h>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace Coffee {
+
+    // Texture coordinates and normals are adjacent in Vertex, so they are passed as one attribute stream
+    static_assert(offsetof(Vertex, Normals) == offsetof(Vertex, TexCoords) + sizeof(glm::vec2), "Vertex attributes used for simplification must be contiguous");
+
+    static constexpr float s_AttributeWeights[] = {
+        0.5f, 0.5f,      // TexCoords
+        1.0f, 1.0f, 1.0f // Normals
+    };
+
+    // A LOD that removes less than this fraction of the previous one is not worth its memory
+    static constexpr float s_MinReduction = 0.1f;
+
+    void MeshLODGenerator::Generate(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const MeshLODSettings& settings,
+                                    std::vector<uint32_t>& lodIndices, std::vector<MeshLOD>& lods)
+    {
+        ZoneScoped;
+
+        lodIndices.clear();
+        lods.clear();
+
+        if (!settings.Enabled || settings.MaxLODCount <= 1 || vertices.empty() || indices.size() / 3 <= settings.MinTriangleCount)
+            return;
+
+        const float* positions = &vertices[0].Position.x;
+        const float* attributes = &vertices[0].TexCoords.x;
+        const size_t attributeCount = sizeof(s_AttributeWeights) / sizeof(float);
+
+        // Errors are returned relative to the mesh extents, the renderer needs them in object space
+        float meshScale = meshopt_simplifyScale(positions, vertices.size(), sizeof(Vertex));
+
+        std::vector<uint32_t> simplified(indices.size());
+        size_t previousIndexCount = indices.size();
+        float previousError = 0.0f;
+
+        for (uint32_t level = 1; level < settings.MaxLODCount; level++)
+        {
+            size_t targetIndexCount = size_t(previousIndexCount * settings.Reduction) / 3 * 3;
+            if (targetIndexCount / 3 < settings.MinTriangleCount)
+                break;
+
+            // Every LOD is simplified from the full detail mesh to avoid accumulating error
+            float error = 0.0f;
+            size_t indexCount = meshopt_simplifyWithAttributes(simplified.data(), indices.data(), indices.size(),
+                                                               positions, vertices.size(), sizeof(Vertex),
+                                                               attributes, sizeof(Vertex), s_AttributeWeights, attributeCount,
+                                                               nullptr, targetIndexCount, settings.MaxError, 0, &error);
+
+            if (indexCount == 0 || indexCount > previousIndexCount * (1.0f - s_MinReduction))
+                break;
+
+            MeshOptimization::OptimizeVertexCache(simplified.data(), indexCount, vertices.size());
+
+            MeshLOD lod;
+            lod.IndexOffset = (uint32_t)lodIndices.size();
+            lod.IndexCount = (uint32_t)indexCount;
+            lod.Error = std::max(error * meshScale, previousError);
+            lods.push_back(lod);
+
+            lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.begin() + indexCount);
+
+            previousIndexCount = indexCount;
+            previousError = lod.Error;
+        }
+    }
+
+}
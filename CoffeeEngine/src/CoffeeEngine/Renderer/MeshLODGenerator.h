@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cereal/cereal.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    struct Vertex;
+    struct MeshLOD;
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief Settings of the LOD chain generated when a model is imported.
+     */
+    struct MeshLODSettings
+    {
+        bool Enabled = true; ///< Generate LODs for the meshes of the model.
+        uint32_t MaxLODCount = 4; ///< Maximum number of LODs, the full detail mesh included.
+        float Reduction = 0.5f; ///< Triangle ratio of each LOD relative to the previous one.
+        float MaxError = 0.05f; ///< Maximum simplification error, relative to the mesh size.
+        uint32_t MinTriangleCount = 64; ///< Meshes and LODs below this triangle count are not simplified further.
+
+        template<class Archive>
+        void serialize(Archive& archive, std::uint32_t const version)
+        {
+            archive(CEREAL_NVP(Enabled), CEREAL_NVP(MaxLODCount), CEREAL_NVP(Reduction), CEREAL_NVP(MaxError), CEREAL_NVP(MinTriangleCount));
+        }
+    };
+
+    /**
+     * @brief Builds the LOD chain of a mesh with attribute-aware quadric edge-collapse simplification.
+     *
+     * The LODs share the vertices of the full detail mesh and only add index ranges, so a mesh keeps a
+     * single vertex buffer. Runs on the CPU only.
+     */
+    class MeshLODGenerator
+    {
+    public:
+        /**
+         * @brief Generates the simplified LODs of a mesh.
+         * @param vertices The vertices of the mesh.
+         * @param indices The triangle indices of the full detail mesh.
+         * @param settings The LOD settings.
+         * @param lodIndices Receives the indices of every generated LOD, one after the other.
+         * @param lods Receives one entry per generated LOD, the full detail mesh excluded. Offsets are relative to lodIndices.
+         */
+        static void Generate(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const MeshLODSettings& settings,
+                             std::vector<uint32_t>& lodIndices, std::vector<MeshLOD>& lods);
+    };
+
+    /** @} */
+}
+
+CEREAL_CLASS_VERSION(Coffee::MeshLODSettings, 0);
@@ -0,0 +1,73 @@
+#include "MeshOptimization.h"
+
+#include "CoffeeEngine/Renderer/Mesh.h"
+
+#include <meshoptimizer.h>
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    // Vertices are compared byte by byte when deduplicating, padding would make equal vertices differ
+    static_assert(sizeof(Vertex) == 22 * sizeof(float), "Vertex must not contain padding");
+
+    // Typical post-transform cache size used to measure ACMR/ATVR
+    static constexpr uint32_t s_AnalyzeCacheSize = 16;
+
+    MeshOptimizationReport MeshOptimization::Optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+    {
+        ZoneScoped;
+
+        MeshOptimizationReport report;
+        report.Before = Analyze(vertices, indices);
+
+        if (vertices.empty() || indices.empty() || indices.size() % 3 != 0)
+        {
+            report.After = report.Before;
+            return report;
+        }
+
+        // Deduplicate the vertices, assimp emits one vertex per triangle corner
+        std::vector<uint32_t> remap(vertices.size());
+        size_t uniqueVertexCount = meshopt_generateVertexRemap(remap.data(), indices.data(), indices.size(), vertices.data(), vertices.size(), sizeof(Vertex));
+
+        std::vector<Vertex> uniqueVertices(uniqueVertexCount);
+        meshopt_remapVertexBuffer(uniqueVertices.data(), vertices.data(), vertices.size(), sizeof(Vertex), remap.data());
+        meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+
+        // Reorder the triangles for the vertex cache, then trade a bit of it for less overdraw
+        meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), uniqueVertexCount);
+        meshopt_optimizeOverdraw(indices.data(), indices.data(), indices.size(), &uniqueVertices[0].Position.x, uniqueVertexCount, sizeof(Vertex), OverdrawThreshold);
+
+        // Store the vertices in the order they are first used
+        vertices.resize(uniqueVertexCount);
+        size_t vertexCount = meshopt_optimizeVertexFetch(vertices.data(), indices.data(), indices.size(), uniqueVertices.data(), uniqueVertexCount, sizeof(Vertex));
+        vertices.resize(vertexCount);
+
+        report.After = Analyze(vertices, indices);
+        return report;
+    }
+
+    void MeshOptimization::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+    {
+        meshopt_optimizeVertexCache(indices, indices, indexCount, vertexCount);
+    }
+
+    MeshEfficiency MeshOptimization::Analyze(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+    {
+        MeshEfficiency efficiency;
+        efficiency.VertexCount = (uint32_t)vertices.size();
+
+        if (vertices.empty() || indices.empty() || indices.size() % 3 != 0)
+            return efficiency;
+
+        meshopt_VertexCacheStatistics cacheStatistics = meshopt_analyzeVertexCache(indices.data(), indices.size(), vertices.size(), s_AnalyzeCacheSize, 0, 0);
+        efficiency.ACMR = cacheStatistics.acmr;
+        efficiency.ATVR = cacheStatistics.atvr;
+
+        meshopt_OverdrawStatistics overdrawStatistics = meshopt_analyzeOverdraw(indices.data(), indices.size(), &vertices[0].Position.x, vertices.size(), sizeof(Vertex));
+        efficiency.Overdraw = overdrawStatistics.overdraw;
+
+        return efficiency;
+    }
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    struct Vertex;
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief GPU efficiency metrics of an indexed triangle mesh.
+     */
+    struct MeshEfficiency
+    {
+        uint32_t VertexCount = 0; ///< Number of vertices.
+        float ACMR = 0.0f; ///< Average cache miss ratio, transformed vertices per triangle (0.5 at best, 3 at worst).
+        float ATVR = 0.0f; ///< Average transformed vertex ratio, transformed vertices per vertex (1 at best).
+        float Overdraw = 0.0f; ///< Shaded pixels per covered pixel (1 at best).
+    };
+
+    /**
+     * @brief Report of an optimization pass.
+     */
+    struct MeshOptimizationReport
+    {
+        MeshEfficiency Before; ///< Metrics of the mesh as imported.
+        MeshEfficiency After; ///< Metrics of the optimized mesh.
+    };
+
+    /**
+     * @brief Import-time optimization of the vertex and index data of a mesh.
+     *
+     * Deduplicates the vertices, then reorders the triangles for the post-transform vertex cache and for
+     * overdraw, and finally reorders the vertices in the order they are fetched. The result is deterministic,
+     * so the same source always produces the same cached mesh.
+     */
+    class MeshOptimization
+    {
+    public:
+        static constexpr float OverdrawThreshold = 1.05f; ///< Vertex cache efficiency that can be traded for less overdraw.
+
+        /**
+         * @brief Optimizes a triangle list in place.
+         * @param vertices The vertices of the mesh.
+         * @param indices The triangle indices of the mesh.
+         * @return The metrics before and after the optimization.
+         */
+        static MeshOptimizationReport Optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+        /**
+         * @brief Reorders a triangle list for the post-transform vertex cache without touching the vertices.
+         * @param indices The triangle indices to reorder.
+         * @param indexCount The number of indices.
+         * @param vertexCount The number of vertices referenced by the indices.
+         */
+        static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+        /**
+         * @brief Measures the GPU efficiency of a triangle list.
+         * @param vertices The vertices of the mesh.
+         * @param indices The triangle indices of the mesh.
+         * @return The mesh metrics.
+         */
+        static MeshEfficiency Analyze(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+    };
+
+    /** @} */
+}
@@ -3,12 +3,15 @@
 // Core engine includes
 #include "CoffeeEngine/Animation/Animation.h"
 #include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/Hash.h"
 #include "CoffeeEngine/Core/Log.h"
 #include "CoffeeEngine/Core/UUID.h"
 #include "CoffeeEngine/IO/CacheManager.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
+#include "CoffeeEngine/IO/ResourceSaver.h"
 
 // Import data includes
+#include "CoffeeEngine/IO/ImportData/ImportDataUtils.h"
 #include "CoffeeEngine/IO/ImportData/MaterialImportData.h"
 #include "CoffeeEngine/IO/ImportData/MeshImportData.h"
 #include "CoffeeEngine/IO/ImportData/ModelImportData.h"
@@ -17,6 +20,8 @@
 // Renderer includes
 #include "CoffeeEngine/Renderer/Material.h"
 #include "CoffeeEngine/Renderer/Mesh.h"
+#include "CoffeeEngine/Renderer/MeshLODGenerator.h"
+#include "CoffeeEngine/Renderer/MeshOptimization.h"
 #include "CoffeeEngine/Renderer/Texture.h"
 #include "CoffeeEngine/Animation/AnimationSystem.h"
 
@@ -36,6 +41,7 @@
 #include <tracy/Tracy.hpp>
 
 #include <stdint.h>
+#include <unordered_set>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -45,6 +51,37 @@
 
 namespace Coffee {
 
+    // Meshes read from a cache written before the LODs get them with the import settings of the model. The cache is
+    // written again so it only happens once.
+    static void UpgradeLegacyMeshCache(const Ref<Mesh>& mesh, const MeshLODSettings& settings)
+    {
+        if (!mesh || !mesh->HasLegacyCache())
+            return;
+
+        mesh->AcquireCPUData();
+        mesh->GenerateLODs(settings);
+        ResourceSaver::Save<Mesh>(CacheManager::GetCachedFilePath(mesh->GetUUID(), ResourceType::Mesh), mesh);
+        mesh->ReleaseCPUData();
+
+        COFFEE_CORE_INFO("Upgraded the cache of mesh {0} with {1} LODs", mesh->GetName(), mesh->GetLODCount());
+    }
+
+    // Reads the LOD settings a model was imported with, the defaults if it has no import file
+    static MeshLODSettings LoadModelLODSettings(const std::filesystem::path& modelPath)
+    {
+        if (!ImportDataUtils::HasImportFile(modelPath))
+            return MeshLODSettings();
+
+        std::filesystem::path importFilePath = modelPath;
+        importFilePath += ".import";
+
+        Scope<ImportData> importData = ImportDataUtils::LoadImportData(importFilePath);
+        if (!importData || importData->type != ResourceType::Model)
+            return MeshLODSettings();
+
+        return static_cast<ModelImportData&>(*importData).lodSettings;
+    }
+
     // Template implementations moved from header
     template<class Archive>
     void Model::save(Archive& archive) const
@@ -68,6 +105,13 @@ namespace Coffee {
         {
             m_Meshes.push_back(ResourceLoader::GetResource<Mesh>(data));
         }
+
+        if (std::any_of(m_Meshes.begin(), m_Meshes.end(), [](const Ref<Mesh>& mesh) { return mesh && mesh->HasLegacyCache(); }))
+        {
+            MeshLODSettings lodSettings = LoadModelLODSettings(m_FilePath);
+            for (const Ref<Mesh>& mesh : m_Meshes)
+                UpgradeLegacyMeshCache(mesh, lodSettings);
+        }
         ImportAnimations(m_UUID);
     }
 
@@ -106,6 +150,11 @@ namespace Coffee {
 
     static std::unordered_map<std::string, UUID> s_ModelMeshesUUIDs;
     static std::unordered_map<std::string, UUID> s_ModelMaterialsUUIDs;
+    static MeshLODSettings s_ModelLODSettings;
+    static bool s_ModelQuantizePositions = false;
+    static AnimationOptimizationSettings s_ModelAnimationSettings;
+
+    static constexpr uint32_t AnimationCacheVersion = 1; ///< Bumped when the layout of the animation cache changes.
 
     Model::Model(const std::filesystem::path& path)
         : Resource(ResourceType::Model)
@@ -122,11 +171,17 @@ namespace Coffee {
         {
             s_ModelMeshesUUIDs = modelImportData.meshUUIDs;
             s_ModelMaterialsUUIDs = modelImportData.materialUUIDs;
+            s_ModelLODSettings = modelImportData.lodSettings;
+            s_ModelQuantizePositions = modelImportData.quantizePositions;
+            s_ModelAnimationSettings = modelImportData.animationSettings;
             LoadFromFilePath(modelImportData.originalPath);
             m_UUID = modelImportData.uuid;
         }
         else
         {
+            s_ModelLODSettings = modelImportData.lodSettings;
+            s_ModelQuantizePositions = modelImportData.quantizePositions;
+            s_ModelAnimationSettings = modelImportData.animationSettings;
             LoadFromFilePath(modelImportData.originalPath);
             modelImportData.uuid = m_UUID;
             modelImportData.meshUUIDs = s_ModelMeshesUUIDs;
@@ -135,6 +190,9 @@ namespace Coffee {
 
         s_ModelMeshesUUIDs.clear();
         s_ModelMaterialsUUIDs.clear();
+        s_ModelLODSettings = MeshLODSettings();
+        s_ModelQuantizePositions = false;
+        s_ModelAnimationSettings = AnimationOptimizationSettings();
     }
 
     void Model::LoadFromFilePath(const std::filesystem::path& path)
@@ -161,11 +219,25 @@ namespace Coffee {
         {
             m_hasAnimations = true;
 
-            if(!ExtractSkeleton(scene, joints, boneMap))
-                std::cerr << "Error extracting skeleton" << std::endl;
+            ExtractJoints(scene->mRootNode, -1, joints, boneMap);
+
+            // The skeleton and the optimized animations are only built again when the source or the settings change
+            std::filesystem::path animationCachePath = GetAnimationCachePath(m_FilePath, s_ModelAnimationSettings);
+            if (!LoadAnimationCache(animationCachePath, joints))
+            {
+                bool extracted = ExtractSkeleton(joints);
+                if(!extracted)
+                    std::cerr << "Error extracting skeleton" << std::endl;
 
-            if(!ExtractAnimations(scene, boneMap))
-                std::cerr << "Error extracting animations" << std::endl;
+                if(extracted && !ExtractAnimations(scene, boneMap, s_ModelAnimationSettings))
+                {
+                    std::cerr << "Error extracting animations" << std::endl;
+                    extracted = false;
+                }
+
+                if (extracted)
+                    SaveAnimationCache(animationCachePath);
+            }
 
             if (m_Skeleton && m_AnimationController && m_AnimationController->GetAnimationCount() > 0)
             {
@@ -178,6 +250,9 @@ namespace Coffee {
             }
         }
 
+        // The textures of every material are decoded in parallel while the meshes are processed
+        PrefetchTextures(scene);
+
         processNode(scene->mRootNode, scene, joints, boneMap);
 
         m_Joints = joints;
@@ -353,14 +428,30 @@ namespace Coffee {
         MeshImportData meshImportData;
         meshImportData.name = nameReference;
         meshImportData.uuid = meshUUID;
-        meshImportData.vertices = vertices;
-        meshImportData.indices = indices;
         meshImportData.material = meshMaterial;
         meshImportData.aabb = aabb;
+        meshImportData.quantizePositions = s_ModelQuantizePositions;
         // Think if this is the most comfortable way to do this
         meshImportData.cachedPath = CacheManager::GetCachedFilePath(meshUUID, ResourceType::Mesh);
 
+        // The optimized vertices and the LODs are stored in the mesh cache, they are only built when the mesh is imported
+        bool isTriangleMesh = mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE;
+        if (isTriangleMesh && !std::filesystem::exists(meshImportData.cachedPath))
+        {
+            MeshOptimizationReport report = MeshOptimization::Optimize(vertices, indices);
+            COFFEE_CORE_INFO("Optimized mesh {0}: vertices {1} -> {2}, ACMR {3:.3f} -> {4:.3f}, ATVR {5:.3f} -> {6:.3f}, overdraw {7:.3f} -> {8:.3f}",
+                             nameReference, report.Before.VertexCount, report.After.VertexCount,
+                             report.Before.ACMR, report.After.ACMR, report.Before.ATVR, report.After.ATVR,
+                             report.Before.Overdraw, report.After.Overdraw);
+
+            MeshLODGenerator::Generate(vertices, indices, s_ModelLODSettings, meshImportData.lodIndices, meshImportData.lods);
+        }
+
+        meshImportData.vertices = std::move(vertices);
+        meshImportData.indices = std::move(indices);
+
         Ref<Mesh> resultMesh = ResourceLoader::LoadEmbedded<Mesh>(meshImportData);
+        UpgradeLegacyMeshCache(resultMesh, s_ModelLODSettings);
 
         return resultMesh;
     }
@@ -401,32 +492,49 @@ namespace Coffee {
         }
     }
 
-    Ref<Texture2D> Model::LoadTexture2D(aiMaterial* material, aiTextureType type)
+    std::filesystem::path Model::GetTexturePath(aiMaterial* material, aiTextureType type) const
     {
         aiString textureName;
         material->GetTexture(type, 0, &textureName);
 
         if(textureName.length == 0)
         {
-            return nullptr;
+            return {};
         }
 
         std::string directory = m_FilePath.parent_path().string();
-        std::string texturePath = directory + "/" + std::string(textureName.C_Str());
+        return directory + "/" + std::string(textureName.C_Str());
+    }
 
-        if (!std::filesystem::exists(texturePath))
+    static Texture2DImportData CreateTextureImportData(const std::filesystem::path& texturePath, aiTextureType type)
+    {
+        bool srgb = (type == aiTextureType_DIFFUSE || type == aiTextureType_EMISSIVE);
+
+        Texture2DImportData importData;
+        importData.originalPath = texturePath;
+        importData.sRGB = srgb;
+        importData.usage = srgb ? TextureUsage::Color : (type == aiTextureType_NORMALS ? TextureUsage::Normal : TextureUsage::Data);
+        return importData;
+    }
+
+    Ref<Texture2D> Model::LoadTexture2D(aiMaterial* material, aiTextureType type)
+    {
+        std::filesystem::path texturePath = GetTexturePath(material, type);
+
+        if(texturePath.empty())
         {
-            COFFEE_CORE_WARN("The texture is embedded: {0}", texturePath);
             return nullptr;
         }
 
-        bool srgb = (type == aiTextureType_DIFFUSE || type == aiTextureType_EMISSIVE);
+        if (!std::filesystem::exists(texturePath))
+        {
+            COFFEE_CORE_WARN("The texture is embedded: {0}", texturePath.string());
+            return nullptr;
+        }
 
         if(!ImportDataUtils::HasImportFile(texturePath))
         {
-            Texture2DImportData importData;
-            importData.originalPath = texturePath;
-            importData.sRGB = srgb;
+            Texture2DImportData importData = CreateTextureImportData(texturePath, type);
             importData.uuid = UUID();
             importData.cachedPath = CacheManager::GetCachedFilePath(importData.uuid, ResourceType::Texture2D);
             Scope<ImportData> importDataPtr = CreateScope<Texture2DImportData>(importData);
@@ -437,6 +545,49 @@ namespace Coffee {
         return Texture2D::Load(texturePath);
     }
 
+    void Model::PrefetchTextures(const aiScene* scene)
+    {
+        ZoneScoped;
+
+        std::unordered_set<std::string> prefetched;
+
+        auto prefetch = [&](aiMaterial* material, aiTextureType type) {
+            std::filesystem::path texturePath = GetTexturePath(material, type);
+            if (texturePath.empty() || !std::filesystem::exists(texturePath) || !prefetched.insert(texturePath.string()).second)
+                return false;
+
+            if (!ImportDataUtils::HasImportFile(texturePath))
+            {
+                Texture2D::Prefetch(CreateTextureImportData(texturePath, type));
+                return true;
+            }
+
+            std::filesystem::path importPath = texturePath;
+            importPath += ".import";
+            Scope<ImportData> importData = ImportDataUtils::LoadImportData(importPath);
+            if (importData->type == ResourceType::Texture2D && !ResourceRegistry::Exists(importData->uuid))
+                Texture2D::Prefetch(static_cast<Texture2DImportData&>(*importData));
+            return true;
+        };
+
+        // Same textures, in the same order, as LoadMaterialTextures
+        for (uint32_t i = 0; i < scene->mNumMaterials; i++)
+        {
+            aiMaterial* material = scene->mMaterials[i];
+
+            prefetch(material, aiTextureType_DIFFUSE);
+            prefetch(material, aiTextureType_NORMALS);
+            prefetch(material, aiTextureType_METALNESS);
+            prefetch(material, aiTextureType_DIFFUSE_ROUGHNESS);
+
+            std::filesystem::path aoPath = GetTexturePath(material, aiTextureType_AMBIENT);
+            if (!prefetch(material, aiTextureType_AMBIENT) && (aoPath.empty() || !std::filesystem::exists(aoPath)))
+                prefetch(material, aiTextureType_LIGHTMAP);
+
+            prefetch(material, aiTextureType_EMISSIVE);
+        }
+    }
+
     PBRMaterialTextures Model::LoadMaterialTextures(aiMaterial* material)
     {
         PBRMaterialTextures matTextures;
@@ -454,10 +605,8 @@ namespace Coffee {
         return matTextures;
     }
 
-    bool Model::ExtractSkeleton(const aiScene* pScene, std::vector<Joint>& joints, std::map<std::string, int>& boneMap)
+    bool Model::ExtractSkeleton(const std::vector<Joint>& joints)
     {
-        ExtractJoints(pScene->mRootNode, -1, joints, boneMap);
-
         if(joints.empty())
         {
             COFFEE_CORE_ERROR("OZZ: Failed to extract joints");
@@ -506,9 +655,15 @@ namespace Coffee {
         return true;
     }
 
-    bool Model::ExtractAnimations(const aiScene* scene, const std::map<std::string, int>& boneMap)
+    bool Model::ExtractAnimations(const aiScene* scene, const std::map<std::string, int>& boneMap, const AnimationOptimizationSettings& settings)
     {
+        ZoneScoped;
+
+        if (!m_Skeleton)
+            return false;
+
         auto animController = CreateRef<AnimationController>();
+        m_AnimationReports.clear();
 
         for (unsigned int animIndex = 0; animIndex < scene->mNumAnimations; ++animIndex)
         {
@@ -537,9 +692,21 @@ namespace Coffee {
                 continue;
             }
 
-            ozz::animation::offline::AnimationBuilder animBuilder;
-            animController->AddAnimation(aiAnim->mName.C_Str(), std::move(animBuilder(rawAnimation)));
+            AnimationOptimizationReport report;
+            auto animation = AnimationOptimization::Build(rawAnimation, *m_Skeleton->GetSkeleton(), boneMap, settings, report);
+            if (!animation)
+            {
+                COFFEE_CORE_ERROR("OZZ: Failed to build animation {0}", aiAnim->mName.C_Str());
+                continue;
+            }
+
+            COFFEE_CORE_INFO("Optimized animation {0}: keys {1} -> {2}, size {3:.1f} KB -> {4:.1f} KB, max error {5:.3f} mm",
+                             report.Name, report.KeysBefore, report.KeysAfter, report.BytesBefore / 1024.0f, report.BytesAfter / 1024.0f,
+                             report.MaxError * 1000.0f);
+
+            animController->AddAnimation(aiAnim->mName.C_Str(), std::move(animation));
             m_AnimationsNames.push_back(aiAnim->mName.C_Str());
+            m_AnimationReports.push_back(std::move(report));
         }
 
         m_AnimationController = animController;
@@ -606,6 +773,98 @@ namespace Coffee {
             ExtractJoints(node->mChildren[i], jointIndex, joints, boneMap);
     }
 
+    std::filesystem::path Model::GetAnimationCachePath(const std::filesystem::path& source, const AnimationOptimizationSettings& settings)
+    {
+        uint64_t hash = Hash::Combine(Hash::HashFile(source), settings.GetHash());
+        hash = Hash::Combine(hash, AnimationCacheVersion);
+        return CacheManager::GetCachedFilePath("animations_" + std::to_string(hash) + ".ozz");
+    }
+
+    bool Model::LoadAnimationCache(const std::filesystem::path& cachePath, const std::vector<Joint>& joints)
+    {
+        ZoneScoped;
+
+        ozz::io::File file(cachePath.string().c_str(), "rb");
+        if (!file.opened())
+            return false;
+
+        ozz::io::IArchive archive(&file);
+
+        uint32_t version = 0, animationCount = 0;
+        archive >> version >> animationCount;
+        if (version != AnimationCacheVersion || !archive.TestTag<ozz::animation::Skeleton>())
+            return false;
+
+        auto ozzSkeleton = ozz::make_unique<ozz::animation::Skeleton>();
+        archive >> *ozzSkeleton;
+        if (ozzSkeleton->num_joints() != (int)joints.size())
+            return false;
+
+        auto animController = CreateRef<AnimationController>();
+        std::vector<std::string> animationsNames;
+        std::vector<AnimationOptimizationReport> reports(animationCount);
+
+        for (AnimationOptimizationReport& report : reports)
+        {
+            if (!archive.TestTag<ozz::animation::Animation>())
+                return false;
+
+            auto animation = ozz::make_unique<ozz::animation::Animation>();
+            archive >> *animation;
+            archive >> report.KeysBefore >> report.KeysAfter >> report.BytesBefore >> report.BytesAfter >> report.MaxError;
+
+            report.Name = animation->name();
+            animationsNames.push_back(report.Name);
+            animController->AddAnimation(report.Name, std::move(animation));
+        }
+
+        m_Skeleton = CreateRef<Skeleton>();
+        m_Skeleton->SetSkeleton(std::move(ozzSkeleton));
+        m_Skeleton->SetJoints(joints);
+        m_AnimationController = animController;
+        m_AnimationsNames = std::move(animationsNames);
+        m_AnimationReports = std::move(reports);
+
+        return true;
+    }
+
+    void Model::SaveAnimationCache(const std::filesystem::path& cachePath) const
+    {
+        ZoneScoped;
+
+        // Written to a temporary file first so an interrupted write never leaves a truncated cache entry
+        std::filesystem::path tempPath = cachePath;
+        tempPath += ".tmp";
+
+        {
+            ozz::io::File file(tempPath.string().c_str(), "wb");
+            if (!file.opened())
+            {
+                COFFEE_CORE_WARN("Failed to write the animation cache {0}", cachePath.string());
+                return;
+            }
+
+            ozz::io::OArchive archive(&file);
+            archive << AnimationCacheVersion << (uint32_t)m_AnimationReports.size();
+            archive << *m_Skeleton->GetSkeleton();
+
+            for (size_t i = 0; i < m_AnimationReports.size(); i++)
+            {
+                const AnimationOptimizationReport& report = m_AnimationReports[i];
+                archive << *m_AnimationController->GetAnimation((unsigned int)i)->GetAnimation();
+                archive << report.KeysBefore << report.KeysAfter << report.BytesBefore << report.BytesAfter << report.MaxError;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec)
+        {
+            COFFEE_CORE_WARN("Failed to write the animation cache {0}", cachePath.string());
+            std::filesystem::remove(tempPath, ec);
+        }
+    }
+
     void Model::SaveAnimations(const UUID uuid) const
     {
         if (HasAnimations() && m_Skeleton && m_AnimationController)
@@ -3,6 +3,7 @@
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/IO/Serialization/GLMSerialization.h"
+#include "CoffeeEngine/Animation/AnimationOptimization.h"
 #include "CoffeeEngine/Animation/Skeleton.h"
 
 #include <assimp/material.h>
@@ -125,6 +126,12 @@ namespace Coffee {
          */
         const Ref<AnimationController>& GetAnimationController() const { return m_AnimationController; };
 
+        /**
+         * @brief Gets the keyframe optimization report of each animation, filled when the model is imported.
+         * @return The reports, in the order of the animations.
+         */
+        const std::vector<AnimationOptimizationReport>& GetAnimationReports() const { return m_AnimationReports; }
+
         /**
          * @brief Saves the animations of the model.
          * @param uuid The UUID of the model.
@@ -158,6 +165,20 @@ namespace Coffee {
          */
         void processNode(aiNode* node, const aiScene* scene, std::vector<Joint>& joints, std::map<std::string, int>& boneMap);
 
+        /**
+         * @brief Gets the path of a texture of an Assimp material.
+         * @param material The Assimp material.
+         * @param type The Assimp texture type.
+         * @return The path of the texture next to the model, empty if the material has no texture of that type.
+         */
+        std::filesystem::path GetTexturePath(aiMaterial* material, aiTextureType type) const;
+
+        /**
+         * @brief Starts decoding the textures of every material of the scene on the job system.
+         * @param scene The Assimp scene.
+         */
+        void PrefetchTextures(const aiScene* scene);
+
         /**
          * @brief Loads a texture from the Assimp material and texture type.
          * @param material The Assimp material.
@@ -197,21 +218,42 @@ namespace Coffee {
         unsigned int MAX_BONE_INFLUENCE = 4;
 
         /**
-         * @brief Extracts the skeleton from the Assimp scene.
-         * @param pScene The Assimp scene.
-         * @param joints The joints.
-         * @param boneMap The bone map.
-         * @return True if the skeleton was extracted successfully, false otherwise.
+         * @brief Builds the skeleton from the joints of the Assimp scene.
+         * @param joints The joints, extracted with ExtractJoints.
+         * @return True if the skeleton was built successfully, false otherwise.
          */
-        bool ExtractSkeleton(const aiScene* pScene, std::vector<Joint>& joints, std::map<std::string, int>& boneMap);
+        bool ExtractSkeleton(const std::vector<Joint>& joints);
 
         /**
-         * @brief Extracts animations from the Assimp scene.
+         * @brief Extracts animations from the Assimp scene and optimizes their keyframes.
          * @param scene The Assimp scene.
          * @param boneMap The bone map.
+         * @param settings The keyframe optimization settings.
          * @return True if the animations were extracted successfully, false otherwise.
          */
-        bool ExtractAnimations(const aiScene* scene, const std::map<std::string, int>& boneMap);
+        bool ExtractAnimations(const aiScene* scene, const std::map<std::string, int>& boneMap, const AnimationOptimizationSettings& settings);
+
+        /**
+         * @brief Gets the path of the cached skeleton and animations of a source file.
+         * @param source The path of the source file.
+         * @param settings The keyframe optimization settings.
+         * @return The path, which changes with the content of the source and the settings.
+         */
+        static std::filesystem::path GetAnimationCachePath(const std::filesystem::path& source, const AnimationOptimizationSettings& settings);
+
+        /**
+         * @brief Loads the skeleton, the animations and their reports from the cache.
+         * @param cachePath The path returned by GetAnimationCachePath.
+         * @param joints The joints of the skeleton.
+         * @return True if the cache exists and was loaded, false otherwise.
+         */
+        bool LoadAnimationCache(const std::filesystem::path& cachePath, const std::vector<Joint>& joints);
+
+        /**
+         * @brief Saves the skeleton, the animations and their reports to the cache.
+         * @param cachePath The path returned by GetAnimationCachePath.
+         */
+        void SaveAnimationCache(const std::filesystem::path& cachePath) const;
 
         /**
          * @brief Extracts joints from the Assimp node.
@@ -245,6 +287,7 @@ namespace Coffee {
         Ref<AnimationController> m_AnimationController; ///< The animation controller of the model.
 
         std::vector<std::string> m_AnimationsNames; ///< The names of the animations.
+        std::vector<AnimationOptimizationReport> m_AnimationReports; ///< The keyframe optimization report of each animation.
         std::vector<Joint> m_Joints; ///< The joints of the model.
     };
 
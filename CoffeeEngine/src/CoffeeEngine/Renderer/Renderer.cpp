@@ -4,6 +4,7 @@
 #include "Renderer2D.h"
 #include "CoffeeEngine/Renderer/RendererAPI.h"
 #include "CoffeeEngine/Scene/PrimitiveMesh.h"
+#include "CoffeeEngine/Renderer/TextureStreaming.h"
 #include "CoffeeEngine/Renderer/UniformBuffer.h"
 
 #include <glm/matrix.hpp>
@@ -23,6 +24,9 @@ namespace Coffee {
 
         RendererAPI::Init();
 
+        // Before any texture is uploaded, so the engine textures are streamed too
+        TextureStreaming::Init();
+
         Renderer2D::Init();
         Renderer3D::Init();
 
@@ -75,11 +79,18 @@ namespace Coffee {
 
         // TODO: Think if this should be done here or inside each target?
         Renderer3D::ResetCalls();
+
+        // The passes above requested the mips of the frame
+        TextureStreaming::Update();
     }
 
     void Renderer::Shutdown()
     {
         Renderer3D::Shutdown();
+        TextureStreaming::Shutdown();
+
+        // The cached primitives own GPU buffers, they are released while the context is alive
+        PrimitiveMesh::ClearCache();
     }
 
     void Renderer::AddRenderTarget(const Ref<RenderTarget>& renderTarget)
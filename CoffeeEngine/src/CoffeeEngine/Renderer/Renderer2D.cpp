@@ -9,7 +9,7 @@
 #include "CoffeeEngine/Renderer/Framebuffer.h"
 #include "CoffeeEngine/Renderer/RenderTarget.h"
 #include "CoffeeEngine/Renderer/Font.h"
-#include "CoffeeEngine/Renderer/MSDFData.h"
+#include "CoffeeEngine/Renderer/TextLayoutCache.h"
 
 #include "CoffeeEngine/Embedded/QuadShader.inl"
 #include "CoffeeEngine/Embedded/TextShader.inl"
@@ -24,8 +24,8 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
 
+#include <algorithm>
 #include <stdint.h>
-#include <queue>
 #include <vector>
 
 namespace Coffee {
@@ -59,33 +59,135 @@ namespace Coffee {
         glm::vec3 EntityID;
     };
 
+    struct LineInstance
+    {
+        glm::vec4 Color;
+        glm::vec3 EntityID;
+        glm::mat4 Transform;
+    };
+
+    static_assert(offsetof(LineInstance, Transform) == sizeof(glm::vec4) + sizeof(glm::vec3), "LineInstance must match the instance buffer layout");
+
+    constexpr size_t DebugShapeCount = 5;
+
     struct Batch
     {
         static const uint32_t MaxQuadCount = 20000; // Think of increasing this number to 20000
         static const uint32_t MaxVertices = MaxQuadCount * 4;
         static const uint32_t MaxIndices = MaxQuadCount * 6;
         static const uint32_t MaxTextureSlots = 64;
+        static const uint32_t TextureSlotTableSize = MaxTextureSlots * 2; // Power of two, kept half empty so probes stay short
+        static const uint32_t InitialQuadReserve = 1024;
+        static const uint32_t MaxShapeInstances = 10000;
 
         std::vector<QuadVertex> QuadVertices;
         uint32_t QuadIndexCount = 0;
 
         std::vector<LineVertex> LineVertices;
 
+        std::array<std::vector<LineInstance>, DebugShapeCount> ShapeInstances;
+
         std::vector<TextVertex> TextVertices;
         uint32_t TextIndexCount = 0;
 
         std::array<Ref<Texture2D>, MaxTextureSlots> TextureSlots;
         uint32_t TextureSlotIndex = 1; // 0 is reserved for white texture
 
+        // Open addressing texture -> slot table, so finding the slot of a texture does not scan TextureSlots
+        std::array<const Texture2D*, TextureSlotTableSize> TextureSlotKeys = {};
+        std::array<uint8_t, TextureSlotTableSize> TextureSlotValues = {};
+
         Ref<Texture2D> FontAtlasTexture;
 
         float LineWidth = 1.5f;
+
+        Batch()
+        {
+            QuadVertices.reserve(InitialQuadReserve * 4);
+            LineVertices.reserve(InitialQuadReserve * 2);
+            TextVertices.reserve(InitialQuadReserve * 4);
+        }
+
+        // Returns the slot of the texture, 0 if it is not in the batch yet
+        uint32_t FindTextureSlot(const Texture2D* texture) const
+        {
+            for (uint32_t i = HashTexture(texture);; i = (i + 1) & (TextureSlotTableSize - 1))
+            {
+                if (TextureSlotKeys[i] == texture)
+                    return TextureSlotValues[i];
+                if (TextureSlotKeys[i] == nullptr)
+                    return 0;
+            }
+        }
+
+        // Assumes the texture is not in the batch and there is a free slot left
+        uint32_t AddTextureSlot(const Ref<Texture2D>& texture)
+        {
+            uint32_t slot = TextureSlotIndex++;
+            TextureSlots[slot] = texture;
+
+            uint32_t i = HashTexture(texture.get());
+            while (TextureSlotKeys[i] != nullptr)
+                i = (i + 1) & (TextureSlotTableSize - 1);
+
+            TextureSlotKeys[i] = texture.get();
+            TextureSlotValues[i] = static_cast<uint8_t>(slot);
+            return slot;
+        }
+
+        // Clears the batch for reuse, the vertex vectors keep their capacity
+        void Reset()
+        {
+            QuadVertices.clear();
+            QuadIndexCount = 0;
+
+            LineVertices.clear();
+
+            for (std::vector<LineInstance>& instances : ShapeInstances)
+                instances.clear();
+
+            TextVertices.clear();
+            TextIndexCount = 0;
+
+            for (uint32_t i = 1; i < TextureSlotIndex; i++)
+                TextureSlots[i] = nullptr;
+            TextureSlotIndex = 1;
+            TextureSlotKeys.fill(nullptr);
+
+            FontAtlasTexture = nullptr;
+
+            LineWidth = 1.5f;
+        }
+
+    private:
+        static uint32_t HashTexture(const Texture2D* texture)
+        {
+            uintptr_t key = reinterpret_cast<uintptr_t>(texture);
+            key ^= key >> 17;
+            key *= 0x9E3779B1u;
+            return static_cast<uint32_t>(key >> 8) & (TextureSlotTableSize - 1);
+        }
+    };
+
+    // Batches are kept alive between frames and reset instead of being destroyed,
+    // so once the pool has grown to the frame's workload drawing does not allocate.
+    struct BatchPool
+    {
+        std::vector<Batch> Batches;
+        uint32_t ActiveCount = 0;
+    };
+
+    struct DebugShapeGeometry
+    {
+        Ref<VertexArray> ShapeVertexArray;
+        Ref<VertexBuffer> ShapeVertexBuffer;
+        uint32_t VertexCount = 0;
     };
 
     struct Renderer2DData
     {
-        std::queue<Batch> WorldBatches;
-        std::queue<Batch> ScreenBatches;
+        BatchPool WorldBatches;
+        BatchPool ScreenBatches;
 
         Ref<VertexArray> QuadVertexArray;
         Ref<VertexBuffer> QuadVertexBuffer;
@@ -96,6 +198,11 @@ namespace Coffee {
         Ref<VertexArray> TextVertexArray;
         Ref<VertexBuffer> TextVertexBuffer;
 
+        // Unit debug shapes, drawn instanced with one transform per shape
+        std::array<DebugShapeGeometry, DebugShapeCount> DebugShapes;
+        Ref<VertexBuffer> LineInstanceBuffer;
+        uint32_t DebugShapeSegments = 32;
+
         Ref<Shader> QuadShader;
         Ref<Shader> LineShader;
         Ref<Shader> TextShader;
@@ -175,6 +282,17 @@ namespace Coffee {
         s_Renderer2DData.TextVertexArray->AddVertexBuffer(s_Renderer2DData.TextVertexBuffer);
         s_Renderer2DData.TextVertexArray->SetIndexBuffer(quadIB);
 
+        // Debug shapes
+        s_Renderer2DData.LineInstanceBuffer = VertexBuffer::Create(Batch::MaxShapeInstances * sizeof(LineInstance));
+        BufferLayout lineInstanceLayout = {
+            {ShaderDataType::Vec4, "a_Color", false, true},
+            {ShaderDataType::Vec3, "a_EntityID", false, true},
+            {ShaderDataType::Mat4, "a_Transform"}
+        };
+        s_Renderer2DData.LineInstanceBuffer->SetLayout(lineInstanceLayout);
+
+        BuildDebugShapes(s_Renderer2DData.DebugShapeSegments);
+
         s_Renderer2DData.WhiteTexture = Texture2D::Create(1, 1, ImageFormat::RGBA8);
         uint32_t whiteTextureData = 0xffffffff;
         s_Renderer2DData.WhiteTexture->SetData(&whiteTextureData, sizeof(uint32_t));
@@ -184,16 +302,11 @@ namespace Coffee {
         s_Renderer2DData.TextShader = CreateRef<Shader>("TextShader", std::string(textShaderSource));
     }
 
-    void Renderer2D::WorldPass(const Ref<RenderTarget>& target)
+    static void DrawBatches(BatchPool& pool)
     {
-        const Ref<Framebuffer>& forwardBuffer = target->GetFramebuffer("Forward");
-
-        forwardBuffer->Bind();
-        //forwardBuffer->SetDrawBuffers({0, 1}); //TODO: This should only be done in the editor
-
-        while (!s_Renderer2DData.WorldBatches.empty())
+        for (uint32_t b = 0; b < pool.ActiveCount; b++)
         {
-            Batch& batch = s_Renderer2DData.WorldBatches.front();
+            Batch& batch = pool.Batches[b];
 
             if(batch.QuadIndexCount > 0)
             {
@@ -214,10 +327,26 @@ namespace Coffee {
             {
                 s_Renderer2DData.LineVertexBuffer->SetData(batch.LineVertices.data(), batch.LineVertices.size() * sizeof(LineVertex));
 
+                s_Renderer2DData.LineShader->SetKeyword("INSTANCED", false);
                 s_Renderer2DData.LineShader->Bind();
                 RendererAPI::DrawLines(s_Renderer2DData.LineVertexArray, batch.LineVertices.size(), batch.LineWidth);
             }
 
+            for (size_t shape = 0; shape < DebugShapeCount; shape++)
+            {
+                const std::vector<LineInstance>& instances = batch.ShapeInstances[shape];
+                if (instances.empty())
+                    continue;
+
+                const DebugShapeGeometry& geometry = s_Renderer2DData.DebugShapes[shape];
+
+                s_Renderer2DData.LineInstanceBuffer->SetData((void*)instances.data(), instances.size() * sizeof(LineInstance));
+
+                s_Renderer2DData.LineShader->SetKeyword("INSTANCED", true);
+                s_Renderer2DData.LineShader->Bind();
+                RendererAPI::DrawLinesInstanced(geometry.ShapeVertexArray, geometry.VertexCount, instances.size(), batch.LineWidth);
+            }
+
             if(batch.TextIndexCount > 0)
             {
                 s_Renderer2DData.TextVertexBuffer->SetData(batch.TextVertices.data(), batch.TextVertices.size() * sizeof(TextVertex));
@@ -228,65 +357,46 @@ namespace Coffee {
                 RendererAPI::DrawIndexed(s_Renderer2DData.TextVertexArray, batch.TextIndexCount);
             }
 
-            s_Renderer2DData.WorldBatches.pop();
+            batch.Reset();
         }
 
-        forwardBuffer->UnBind();
+        pool.ActiveCount = 0;
     }
 
-    void Renderer2D::ScreenPass(const Ref<RenderTarget>& target)
+    void Renderer2D::WorldPass(const Ref<RenderTarget>& target)
     {
-        // TODO: Modify the target to have a framebuffer for 2D elements
         const Ref<Framebuffer>& forwardBuffer = target->GetFramebuffer("Forward");
 
         forwardBuffer->Bind();
         //forwardBuffer->SetDrawBuffers({0, 1}); //TODO: This should only be done in the editor
 
-        while (!s_Renderer2DData.ScreenBatches.empty())
-        {
-            Batch& batch = s_Renderer2DData.ScreenBatches.front();
+        DrawBatches(s_Renderer2DData.WorldBatches);
 
-            if(batch.QuadIndexCount > 0)
-            {
-                s_Renderer2DData.QuadVertexBuffer->SetData(batch.QuadVertices.data(), batch.QuadVertices.size() * sizeof(QuadVertex));
-
-                batch.TextureSlots[0] = s_Renderer2DData.WhiteTexture;
-
-                for(uint32_t i = 0; i < batch.TextureSlotIndex; i++)
-                {
-                    batch.TextureSlots[i]->Bind(i);
-                }
-
-                s_Renderer2DData.QuadShader->Bind();
-                RendererAPI::DrawIndexed(s_Renderer2DData.QuadVertexArray, batch.QuadIndexCount);
-            }
-
-            if(batch.LineVertices.size() > 0)
-            {
-                s_Renderer2DData.LineVertexBuffer->SetData(batch.LineVertices.data(), batch.LineVertices.size() * sizeof(LineVertex));
-
-                s_Renderer2DData.LineShader->Bind();
-                RendererAPI::DrawLines(s_Renderer2DData.LineVertexArray, batch.LineVertices.size(), batch.LineWidth);
-            }
-
-            if(batch.TextIndexCount > 0)
-            {
-                s_Renderer2DData.TextVertexBuffer->SetData(batch.TextVertices.data(), batch.TextVertices.size() * sizeof(TextVertex));
+        forwardBuffer->UnBind();
+    }
 
-                batch.FontAtlasTexture->Bind(0);
+    void Renderer2D::ScreenPass(const Ref<RenderTarget>& target)
+    {
+        // TODO: Modify the target to have a framebuffer for 2D elements
+        const Ref<Framebuffer>& forwardBuffer = target->GetFramebuffer("Forward");
 
-                s_Renderer2DData.TextShader->Bind();
-                RendererAPI::DrawIndexed(s_Renderer2DData.TextVertexArray, batch.TextIndexCount);
-            }
+        forwardBuffer->Bind();
+        //forwardBuffer->SetDrawBuffers({0, 1}); //TODO: This should only be done in the editor
 
-            s_Renderer2DData.ScreenBatches.pop();
-        }
+        DrawBatches(s_Renderer2DData.ScreenBatches);
 
         forwardBuffer->UnBind();
     }
 
     void Renderer2D::Shutdown()
     {
+        s_Renderer2DData.WorldBatches = {};
+        s_Renderer2DData.ScreenBatches = {};
+
+        s_Renderer2DData.DebugShapes = {};
+        s_Renderer2DData.LineInstanceBuffer = nullptr;
+
+        TextLayoutCache::Clear();
     }
 
     void Renderer2D::DrawRect(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, uint32_t entityID)
@@ -324,12 +434,11 @@ namespace Coffee {
             {0.0f, 1.0f}
         };
 
-        Batch& batch = GetBatch(mode);
+        Batch* batch = &GetBatch(mode);
 
-        if(batch.QuadIndexCount >= Batch::MaxIndices)
+        if(batch->QuadIndexCount >= Batch::MaxIndices)
         {
-            NextBatch(mode);
-            batch = GetBatch(mode);
+            batch = &NextBatch(mode);
         }
 
         // Convert entityID to vec3
@@ -340,7 +449,7 @@ namespace Coffee {
 
         for(size_t i = 0; i < quadVertexCount; i++)
         {
-            batch.QuadVertices.push_back(
+            batch->QuadVertices.push_back(
             {
                 transform * s_Renderer2DData.QuadVertexPositions[i], 
                 color, 
@@ -351,7 +460,7 @@ namespace Coffee {
                 });
         }
 
-        batch.QuadIndexCount += 6;
+        batch->QuadIndexCount += 6;
     }
 
     void Renderer2D::DrawQuad(const glm::vec2& position, const glm::vec2& size, const Ref<Texture2D>& texture, float tilingFactor, const glm::vec4& tintColor)
@@ -389,37 +498,27 @@ namespace Coffee {
             {uvRect.x, uvRect.y + uvRect.w}
         };
 
-        Batch& batch = GetBatch(mode);
+        Batch* batch = &GetBatch(mode);
 
-        if(batch.QuadIndexCount >= Batch::MaxIndices)
+        if(batch->QuadIndexCount >= Batch::MaxIndices)
         {
-            NextBatch(mode);
-            batch = GetBatch(mode);
+            batch = &NextBatch(mode);
         }
 
-        float textureIndex = 0.0f;
-        for(uint32_t i = 1; i < batch.TextureSlotIndex; i++)
-        {
-            if(batch.TextureSlots[i] == texture)
-            {
-                textureIndex = (float)i;
-                break;
-            }
-        }
+        uint32_t textureSlot = batch->FindTextureSlot(texture.get());
 
-        if(textureIndex == 0.0f)
+        if(textureSlot == 0)
         {
-            if(batch.TextureSlotIndex >= Batch::MaxTextureSlots)
+            if(batch->TextureSlotIndex >= Batch::MaxTextureSlots)
             {
-                NextBatch(mode);
-                batch = GetBatch(mode);
+                batch = &NextBatch(mode);
             }
 
-            textureIndex = (float)batch.TextureSlotIndex;
-            batch.TextureSlots[batch.TextureSlotIndex] = texture;
-            batch.TextureSlotIndex++;
+            textureSlot = batch->AddTextureSlot(texture);
         }
 
+        float textureIndex = (float)textureSlot;
+
         // Convert entityID to vec3
         uint32_t r = (entityID & 0x000000FF) >> 0;
         uint32_t g = (entityID & 0x0000FF00) >> 8;
@@ -438,7 +537,7 @@ namespace Coffee {
 
         for(size_t i = 0; i < quadVertexCount; i++)
         {
-            batch.QuadVertices.push_back(
+            batch->QuadVertices.push_back(
             {
                 transform * quadVerts[i],
                 tintColor, 
@@ -449,17 +548,16 @@ namespace Coffee {
                 });
         }
 
-        batch.QuadIndexCount += 6;
+        batch->QuadIndexCount += 6;
     }
 
     void Renderer2D::DrawLine(const glm::vec2& start, const glm::vec2& end, const glm::vec4& color, float linewidth)
     {
-        Batch& batch = GetBatch(RenderMode::Screen);
+        Batch* batch = &GetBatch(RenderMode::Screen);
 
-        if(batch.LineVertices.size() >= Batch::MaxVertices)
+        if(batch->LineVertices.size() >= Batch::MaxVertices)
         {
-            NextBatch(RenderMode::Screen);
-            batch = GetBatch(RenderMode::Screen);
+            batch = &NextBatch(RenderMode::Screen);
         }
 
 /*         // Convert entityID to vec3
@@ -470,18 +568,17 @@ namespace Coffee {
 
         glm::vec3 entityIDVec3 = glm::vec3(1.0f, 1.0f, 1.0f);
 
-        batch.LineVertices.push_back({glm::vec3(start, 0.0f), color, entityIDVec3});
-        batch.LineVertices.push_back({glm::vec3(end, 0.0f), color, entityIDVec3});
+        batch->LineVertices.push_back({glm::vec3(start, 0.0f), color, entityIDVec3});
+        batch->LineVertices.push_back({glm::vec3(end, 0.0f), color, entityIDVec3});
     }
 
     void Renderer2D::DrawLine(const glm::vec3& start, const glm::vec3& end, const glm::vec4& color , float linewidth)
     {
-        Batch& batch = GetBatch(RenderMode::World);
+        Batch* batch = &GetBatch(RenderMode::World);
 
-        if(batch.LineVertices.size() >= Batch::MaxVertices)
+        if(batch->LineVertices.size() >= Batch::MaxVertices)
         {
-            NextBatch(RenderMode::World);
-            batch = GetBatch(RenderMode::World);
+            batch = &NextBatch(RenderMode::World);
         }
 
 /*         // entt::null is 4294967295
@@ -492,133 +589,50 @@ namespace Coffee {
 
         glm::vec3 entityIDVec3 = glm::vec3(1.0f, 1.0f, 1.0f);
 
-        batch.LineVertices.push_back({start, color, entityIDVec3});
-        batch.LineVertices.push_back({end, color, entityIDVec3});
+        batch->LineVertices.push_back({start, color, entityIDVec3});
+        batch->LineVertices.push_back({end, color, entityIDVec3});
     }
 
-    void Renderer2D::DrawCircle(const glm::vec2& position, float radius, const glm::vec4& color , float linewidth)
+    static glm::mat4 ComposeTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
     {
-        Batch& batch = GetBatch(RenderMode::Screen);
-
-        if(batch.LineVertices.size() >= Batch::MaxVertices)
-        {
-            NextBatch(RenderMode::Screen);
-            batch = GetBatch(RenderMode::Screen);
-        }
-
-        glm::vec3 entityIDVec3 = glm::vec3(1.0f, 1.0f, 1.0f);
-
-        const uint32_t segments = 32;
-        const float increment = glm::two_pi<float>() / segments;
-
-        for(uint32_t i = 0; i < segments; i++)
-        {
-            float angle0 = increment * i;
-            float angle1 = increment * (i + 1);
-
-            glm::vec2 start = position + glm::vec2(glm::cos(angle0), glm::sin(angle0)) * radius;
-            glm::vec2 end = position + glm::vec2(glm::cos(angle1), glm::sin(angle1)) * radius;
-
-            batch.LineVertices.push_back({glm::vec3(start, 0.0f), color, entityIDVec3});
-            batch.LineVertices.push_back({glm::vec3(end, 0.0f), color, entityIDVec3});
+        glm::mat3 rotationMatrix = glm::toMat3(rotation);
+        return glm::mat4(glm::vec4(rotationMatrix[0] * scale.x, 0.0f),
+                         glm::vec4(rotationMatrix[1] * scale.y, 0.0f),
+                         glm::vec4(rotationMatrix[2] * scale.z, 0.0f),
+                         glm::vec4(position, 1.0f));
+    }
 
-            
-        }
+    void Renderer2D::DrawCircle(const glm::vec2& position, float radius, const glm::vec4& color , float linewidth)
+    {
+        glm::mat4 transform = ComposeTransform(glm::vec3(position, 0.0f), glm::identity<glm::quat>(), glm::vec3(radius));
+        DrawDebugShape(DebugShape::Circle, transform, color, RenderMode::Screen);
     }
+
     void Renderer2D::DrawCircle(const glm::vec3& position, float radius, const glm::quat& rotation, const glm::vec4& color , float linewidth)
     {
-        Batch& batch = GetBatch(RenderMode::World);
-
-        if(batch.LineVertices.size() >= Batch::MaxVertices)
-        {
-            NextBatch(RenderMode::World);
-            batch = GetBatch(RenderMode::World);
-        }
-
-        glm::vec3 entityIDVec3 = glm::vec3(1.0f, 1.0f, 1.0f);
-
-        const uint32_t segments = 32;
-        const float increment = glm::two_pi<float>() / segments;
-
-        for(uint32_t i = 0; i < segments; i++)
-        {
-            float angle0 = increment * i;
-            float angle1 = increment * (i + 1);
-
-            glm::vec3 start = position + glm::toMat3(rotation) * glm::vec3(glm::cos(angle0), glm::sin(angle0), 0.0f) * radius;
-            glm::vec3 end = position + glm::toMat3(rotation) * glm::vec3(glm::cos(angle1), glm::sin(angle1), 0.0f) * radius;
-
-            batch.LineVertices.push_back({start, color, entityIDVec3});
-            batch.LineVertices.push_back({end, color, entityIDVec3});
-
-            
-        }
+        DrawDebugShape(DebugShape::Circle, ComposeTransform(position, rotation, glm::vec3(radius)), color, RenderMode::World);
     }
 
     void Renderer2D::DrawSphere(const glm::vec3& position, float radius, const glm::quat& rotation, const glm::vec4& color , float linewidth)
     {
-        DrawCircle(position, radius, rotation, color, linewidth);
-        DrawCircle(position, radius, rotation * glm::angleAxis(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)), color, linewidth);
-        DrawCircle(position, radius, rotation * glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)), color, linewidth);
+        DrawDebugShape(DebugShape::Sphere, ComposeTransform(position, rotation, glm::vec3(radius)), color, RenderMode::World);
     }
 
     void Renderer2D::DrawBox(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& size, const glm::vec4& color , const bool& isCentered, float linewidth)
     {
-        glm::vec3 halfSize = size * 0.5f;
-        glm::vec3 vertices[8];
-
-        if (isCentered) {
-            vertices[0] = position + rotation * glm::vec3(-halfSize.x, -halfSize.y, -halfSize.z);
-            vertices[1] = position + rotation * glm::vec3(halfSize.x, -halfSize.y, -halfSize.z);
-            vertices[2] = position + rotation * glm::vec3(halfSize.x, halfSize.y, -halfSize.z);
-            vertices[3] = position + rotation * glm::vec3(-halfSize.x, halfSize.y, -halfSize.z);
-            vertices[4] = position + rotation * glm::vec3(-halfSize.x, -halfSize.y, halfSize.z);
-            vertices[5] = position + rotation * glm::vec3(halfSize.x, -halfSize.y, halfSize.z);
-            vertices[6] = position + rotation * glm::vec3(halfSize.x, halfSize.y, halfSize.z);
-            vertices[7] = position + rotation * glm::vec3(-halfSize.x, halfSize.y, halfSize.z);
-        } else {
-            vertices[0] = position + rotation * glm::vec3(0.0f, 0.0f, 0.0f);
-            vertices[1] = position + rotation * glm::vec3(size.x, 0.0f, 0.0f);
-            vertices[2] = position + rotation * glm::vec3(size.x, size.y, 0.0f);
-            vertices[3] = position + rotation * glm::vec3(0.0f, size.y, 0.0f);
-            vertices[4] = position + rotation * glm::vec3(0.0f, 0.0f, size.z);
-            vertices[5] = position + rotation * glm::vec3(size.x, 0.0f, size.z);
-            vertices[6] = position + rotation * glm::vec3(size.x, size.y, size.z);
-            vertices[7] = position + rotation * glm::vec3(0.0f, size.y, size.z);
-        }
-
-        DrawLine(vertices[0], vertices[1], color, linewidth);
-        DrawLine(vertices[1], vertices[2], color, linewidth);
-        DrawLine(vertices[2], vertices[3], color, linewidth);
-        DrawLine(vertices[3], vertices[0], color, linewidth);
+        glm::mat4 transform = ComposeTransform(position, rotation, size);
 
-        DrawLine(vertices[4], vertices[5], color, linewidth);
-        DrawLine(vertices[5], vertices[6], color, linewidth);
-        DrawLine(vertices[6], vertices[7], color, linewidth);
-        DrawLine(vertices[7], vertices[4], color, linewidth);
+        // The unit box is centered, move it so its minimum corner sits at the position
+        if (!isCentered)
+            transform[3] += transform * glm::vec4(0.5f, 0.5f, 0.5f, 0.0f);
 
-        DrawLine(vertices[0], vertices[4], color, linewidth);
-        DrawLine(vertices[1], vertices[5], color, linewidth);
-        DrawLine(vertices[2], vertices[6], color, linewidth);
-        DrawLine(vertices[3], vertices[7], color, linewidth);
+        DrawDebugShape(DebugShape::Box, transform, color, RenderMode::World);
     }
 
     void Renderer2D::DrawBox(const glm::vec3& min, const glm::vec3& max, const glm::vec4& color , float linewidth)
     {
-        DrawLine(glm::vec3(min.x, min.y, min.z), glm::vec3(max.x, min.y, min.z), color, linewidth);
-        DrawLine(glm::vec3(max.x, min.y, min.z), glm::vec3(max.x, max.y, min.z), color, linewidth);
-        DrawLine(glm::vec3(max.x, max.y, min.z), glm::vec3(min.x, max.y, min.z), color, linewidth);
-        DrawLine(glm::vec3(min.x, max.y, min.z), glm::vec3(min.x, min.y, min.z), color, linewidth);
-
-        DrawLine(glm::vec3(min.x, min.y, max.z), glm::vec3(max.x, min.y, max.z), color, linewidth);
-        DrawLine(glm::vec3(max.x, min.y, max.z), glm::vec3(max.x, max.y, max.z), color, linewidth);
-        DrawLine(glm::vec3(max.x, max.y, max.z), glm::vec3(min.x, max.y, max.z), color, linewidth);
-        DrawLine(glm::vec3(min.x, max.y, max.z), glm::vec3(min.x, min.y, max.z), color, linewidth);
-
-        DrawLine(glm::vec3(min.x, min.y, min.z), glm::vec3(min.x, min.y, max.z), color, linewidth);
-        DrawLine(glm::vec3(max.x, min.y, min.z), glm::vec3(max.x, min.y, max.z), color, linewidth);
-        DrawLine(glm::vec3(max.x, max.y, min.z), glm::vec3(max.x, max.y, max.z), color, linewidth);
-        DrawLine(glm::vec3(min.x, max.y, min.z), glm::vec3(min.x, max.y, max.z), color, linewidth);
+        glm::mat4 transform = ComposeTransform((min + max) * 0.5f, glm::identity<glm::quat>(), max - min);
+        DrawDebugShape(DebugShape::Box, transform, color, RenderMode::World);
     }
 
     void Renderer2D::DrawBox(const AABB& aabb, const glm::vec4& color , float linewidth)
@@ -637,12 +651,11 @@ namespace Coffee {
     
     void Renderer2D::DrawArrow(const glm::vec3& start, const glm::vec3& end, bool fixedLength, glm::vec4 color , float linewidth)
     {
-        Batch& batch = GetBatch(RenderMode::World);
+        Batch* batch = &GetBatch(RenderMode::World);
 
-        if(batch.LineVertices.size() >= Batch::MaxVertices)
+        if(batch->LineVertices.size() >= Batch::MaxVertices)
         {
-            NextBatch(RenderMode::World);
-            batch = GetBatch(RenderMode::World);
+            batch = &NextBatch(RenderMode::World);
         }
 
         glm::vec3 entityIDVec3 = glm::vec3(1.0f, 1.0f, 1.0f);
@@ -678,10 +691,9 @@ namespace Coffee {
 
         for (int i = 0; i < arrow_sides; i++) {
             for (int j = 0; j < arrow_points; j++) {
-                if(batch.LineVertices.size() >= Batch::MaxVertices)
+                if(batch->LineVertices.size() >= Batch::MaxVertices)
                 {
-                    NextBatch(RenderMode::World);
-                    batch = GetBatch(RenderMode::World);
+                    batch = &NextBatch(RenderMode::World);
                 }
 
                 glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::pi<float>() * i / arrow_sides, glm::vec3(0, 0, 1));
@@ -692,8 +704,8 @@ namespace Coffee {
                 glm::vec3 transformed_v1 = glm::vec3(transform * rotation * glm::vec4(v1, 1.0f));
                 glm::vec3 transformed_v2 = glm::vec3(transform * rotation * glm::vec4(v2, 1.0f));
 
-                batch.LineVertices.push_back({transformed_v1, color, entityIDVec3});
-                batch.LineVertices.push_back({transformed_v2, color, entityIDVec3});
+                batch->LineVertices.push_back({transformed_v1, color, entityIDVec3});
+                batch->LineVertices.push_back({transformed_v2, color, entityIDVec3});
 
                 
             }
@@ -781,113 +793,22 @@ namespace Coffee {
     
     void Renderer2D::DrawCylinder(const glm::vec3& position, const glm::quat& rotation, float radius, float height, const glm::vec4& color)
     {
-        const int segments = 24;
-        const float angleStep = 2.0f * glm::pi<float>() / segments;
-        
-        glm::vec3 topPoints[25]; 
-        glm::vec3 bottomPoints[25];
-        
-        float halfHeight = height * 0.5f;
-        for (int i = 0; i <= segments; i++)
-        {
-            float angle = i * angleStep;
-            float x = radius * cos(angle);
-            float z = radius * sin(angle);
-            glm::vec3 localTop(x, halfHeight, z);
-            glm::vec3 localBottom(x, -halfHeight, z);
-            
-            glm::vec3 worldTop = position + rotation * localTop;
-            glm::vec3 worldBottom = position + rotation * localBottom;
-            
-            topPoints[i] = worldTop;
-            bottomPoints[i] = worldBottom;
-        }
-        
-        for (int i = 0; i < segments; i++)
-        {
-            DrawLine(topPoints[i], topPoints[i + 1], color);
-            
-            DrawLine(bottomPoints[i], bottomPoints[i + 1], color);
-            
-            if (i % 4 == 0) {
-                DrawLine(topPoints[i], bottomPoints[i], color);
-            }
-        }
+        DrawDebugShape(DebugShape::Cylinder, ComposeTransform(position, rotation, glm::vec3(radius, height, radius)), color, RenderMode::World);
     }
 
     void Renderer2D::DrawCone(glm::vec3 position, glm::quat rotation, float radius, float height, glm::vec4 color)
     {
-        Batch& batch = GetBatch(RenderMode::World);
-
-        if(batch.LineVertices.size() >= Batch::MaxVertices)
-        {
-            NextBatch(RenderMode::World);
-            batch = GetBatch(RenderMode::World);
-        }
-
-        glm::vec3 entityIDVec3 = glm::vec3(1.0f, 1.0f, 1.0f);
-    
-        // Calculate the apex position (top of the cone)
-        glm::vec3 upVector = rotation * glm::vec3(0.0f, 1.0f, 0.0f);
-        glm::vec3 apex = position + upVector * height;
-        
-        // Draw base circle
-        const uint32_t segments = 24;
-        const float angleStep = 2.0f * glm::pi<float>() / segments;
-        
-        glm::vec3 basePoints[25]; // One extra for connecting back to the start
-        
-        // Calculate points around the base circle
-        for (int i = 0; i <= segments; i++)
-        {
-            float angle = i * angleStep;
-            float x = radius * cos(angle);
-            float z = radius * sin(angle);
-            
-            glm::vec3 localPoint(x, 0.0f, z);
-            glm::vec3 worldPoint = position + rotation * localPoint;
-            
-            basePoints[i] = worldPoint;
-        }
-        
-        // Draw the base circle
-        for (int i = 0; i < segments; i++)
-        {
-            if(batch.LineVertices.size() >= Batch::MaxVertices)
-            {
-                NextBatch(RenderMode::World);
-                batch = GetBatch(RenderMode::World);
-            }
-            
-            batch.LineVertices.push_back({basePoints[i], color, entityIDVec3});
-            batch.LineVertices.push_back({basePoints[i + 1], color, entityIDVec3});
-            
-        }
-        
-        // Draw lines from the base to the apex (every few segments for clarity)
-        for (int i = 0; i < segments; i += 3)
-        {
-            if(batch.LineVertices.size() >= Batch::MaxVertices)
-            {
-                NextBatch(RenderMode::World);
-                batch = GetBatch(RenderMode::World);
-            }
-            
-            batch.LineVertices.push_back({basePoints[i], color, entityIDVec3});
-            batch.LineVertices.push_back({apex, color, entityIDVec3});
-            
-        }
+        DrawDebugShape(DebugShape::Cone, ComposeTransform(position, rotation, glm::vec3(radius, height, radius)), color, RenderMode::World);
     }
 
     void Renderer2D::DrawTruncatedCone(glm::vec3 position, glm::quat rotation, float baseRadius, float topRadius,
                                        float height, glm::vec4 color)
     {
-        Batch& batch = GetBatch(RenderMode::World);
+        Batch* batch = &GetBatch(RenderMode::World);
 
-        if (batch.LineVertices.size() >= Batch::MaxVertices)
+        if (batch->LineVertices.size() >= Batch::MaxVertices)
         {
-            NextBatch(RenderMode::World);
-            batch = GetBatch(RenderMode::World);
+            batch = &NextBatch(RenderMode::World);
         }
 
         glm::vec3 entityIDVec3 = glm::vec3(1.0f, 1.0f, 1.0f);
@@ -926,235 +847,254 @@ namespace Coffee {
         // Draw the base circle
         for (int i = 0; i < segments; i++)
         {
-            if (batch.LineVertices.size() >= Batch::MaxVertices)
+            if (batch->LineVertices.size() >= Batch::MaxVertices)
             {
-                NextBatch(RenderMode::World);
-                batch = GetBatch(RenderMode::World);
+                batch = &NextBatch(RenderMode::World);
             }
 
-            batch.LineVertices.push_back({basePoints[i], color, entityIDVec3});
-            batch.LineVertices.push_back({basePoints[i + 1], color, entityIDVec3});
+            batch->LineVertices.push_back({basePoints[i], color, entityIDVec3});
+            batch->LineVertices.push_back({basePoints[i + 1], color, entityIDVec3});
         }
 
         // Draw the top circle
         for (int i = 0; i < segments; i++)
         {
-            if (batch.LineVertices.size() >= Batch::MaxVertices)
+            if (batch->LineVertices.size() >= Batch::MaxVertices)
             {
-                NextBatch(RenderMode::World);
-                batch = GetBatch(RenderMode::World);
+                batch = &NextBatch(RenderMode::World);
             }
 
-            batch.LineVertices.push_back({topPoints[i], color, entityIDVec3});
-            batch.LineVertices.push_back({topPoints[i + 1], color, entityIDVec3});
+            batch->LineVertices.push_back({topPoints[i], color, entityIDVec3});
+            batch->LineVertices.push_back({topPoints[i + 1], color, entityIDVec3});
         }
 
         // Draw lines from the base to the top (side edges of the truncated cone)
         for (int i = 0; i < segments; i++)
         {
-            if (batch.LineVertices.size() >= Batch::MaxVertices)
+            if (batch->LineVertices.size() >= Batch::MaxVertices)
             {
-                NextBatch(RenderMode::World);
-                batch = GetBatch(RenderMode::World);
+                batch = &NextBatch(RenderMode::World);
             }
 
-            batch.LineVertices.push_back({basePoints[i], color, entityIDVec3});
-            batch.LineVertices.push_back({topPoints[i], color, entityIDVec3});
+            batch->LineVertices.push_back({basePoints[i], color, entityIDVec3});
+            batch->LineVertices.push_back({topPoints[i], color, entityIDVec3});
         }
     }
 
 
     void Renderer2D::DrawTextString(const std::string &text, Ref<Font> font, const glm::mat4 &transform, const TextParams &textParams, RenderMode mode, uint32_t entityID)
     {
+        const TextLayout& layout = TextLayoutCache::GetLayout(text, font, textParams);
 
-        Batch& batch = GetBatch(mode);
+        if (layout.Quads.empty())
+            return;
 
-        if(batch.TextIndexCount >= Batch::MaxIndices)
+        Ref<Texture2D> fontAtlas = font->GetAtlasTexture();
+
+        Batch* batch = &GetBatch(mode);
+
+        // A batch samples a single font atlas
+        if(batch->TextIndexCount >= Batch::MaxIndices || (batch->TextIndexCount > 0 && batch->FontAtlasTexture != fontAtlas))
         {
-            NextBatch(mode);
-            batch = GetBatch(mode);
+            batch = &NextBatch(mode);
         }
 
-        const auto& fontGeometry = font->GetMSDFData()->FontGeometry;
-        const auto& metrics = fontGeometry.getMetrics();
-        Ref<Texture2D> fontAtlas = font->GetAtlasTexture();
-        
-        // TODO: Skip to the next batch if the font is different
-        batch.FontAtlasTexture = fontAtlas;
-
-        double fsScale = textParams.Size / (metrics.ascenderY - metrics.descenderY);
-        const float spaceGlyphAdvance = fontGeometry.getGlyph(' ')->getAdvance();
+        batch->FontAtlasTexture = fontAtlas;
 
-        std::vector<std::string> lines;
-        std::string currentLine;
+        // Convert entityID to vec3
+        uint32_t r = (entityID & 0x000000FF) >> 0;
+        uint32_t g = (entityID & 0x0000FF00) >> 8;
+        uint32_t b = (entityID & 0x00FF0000) >> 16;
+        glm::vec3 entityIDVec3 = glm::vec3(r / 255.0f, g / 255.0f, b / 255.0f);
 
-        for (size_t i = 0; i < text.size(); i++) {
-            if (text[i] == '\n') {
-                lines.push_back(currentLine);
-                currentLine.clear();
-            } else if (text[i] != '\r') {
-                currentLine += text[i];
+        for (const TextGlyphQuad& quad : layout.Quads)
+        {
+            if(batch->TextIndexCount >= Batch::MaxIndices)
+            {
+                batch = &NextBatch(mode);
+                batch->FontAtlasTexture = fontAtlas;
             }
-        }
 
-        if (!currentLine.empty())
-            lines.push_back(currentLine);
+            batch->TextVertices.push_back({
+                transform * glm::vec4(quad.QuadMin, 0.0f, 1.0f),
+                textParams.Color,
+                quad.TexCoordMin,
+                entityIDVec3
+            });
 
-        if (lines.empty())
-            lines.push_back("");
+            batch->TextVertices.push_back({
+                transform * glm::vec4(quad.QuadMin.x, quad.QuadMax.y, 0.0f, 1.0f),
+                textParams.Color,
+                { quad.TexCoordMin.x, quad.TexCoordMax.y },
+                entityIDVec3
+            });
 
-		double y = 0.0;
+            batch->TextVertices.push_back({
+                transform * glm::vec4(quad.QuadMax, 0.0f, 1.0f),
+                textParams.Color,
+                quad.TexCoordMax,
+                entityIDVec3
+            });
 
-		for (const auto& line : lines) {
-            double lineWidth = 0.0;
+            batch->TextVertices.push_back({
+                transform * glm::vec4(quad.QuadMax.x, quad.QuadMin.y, 0.0f, 1.0f),
+                textParams.Color,
+                { quad.TexCoordMax.x, quad.TexCoordMin.y },
+                entityIDVec3
+            });
 
-            if (textParams.Alignment != TextAlignment::Left) {
-                for (size_t i = 0; i < line.size(); i++) {
-                    char character = line[i];
+            batch->TextIndexCount += 6;
+        }
+    }
 
-                    if (character == ' ') {
-                        lineWidth += fsScale * spaceGlyphAdvance + textParams.Kerning;
-                        continue;
-                    }
+    void Renderer2D::DrawDebugShape(DebugShape shape, const glm::mat4& transform, const glm::vec4& color, RenderMode mode)
+    {
+        Batch* batch = &GetBatch(mode);
 
-                    if (character == '\t') {
-                        lineWidth += 4.0f * (fsScale * spaceGlyphAdvance + textParams.Kerning);
-                        continue;
-                    }
+        if(batch->ShapeInstances[(size_t)shape].size() >= Batch::MaxShapeInstances)
+        {
+            batch = &NextBatch(mode);
+        }
 
-                    auto glyph = fontGeometry.getGlyph(character);
-                    if (!glyph)
-                        glyph = fontGeometry.getGlyph('?');
-                    if (!glyph)
-                        continue;
+        glm::vec3 entityIDVec3 = glm::vec3(1.0f, 1.0f, 1.0f);
 
-                    double advance = glyph->getAdvance();
-                    if (i < line.size() - 1) {
-                        char nextCharacter = line[i + 1];
-                        fontGeometry.getAdvance(advance, character, nextCharacter);
-                    }
+        batch->ShapeInstances[(size_t)shape].push_back({color, entityIDVec3, transform});
+    }
 
-                    lineWidth += fsScale * advance + textParams.Kerning;
-                }
+    void Renderer2D::SetDebugShapeSegments(uint32_t segments)
+    {
+        segments = std::max(segments, 8u);
+        if (segments == s_Renderer2DData.DebugShapeSegments)
+            return;
 
-                if (!line.empty())
-                    lineWidth -= textParams.Kerning;
-            }
+        s_Renderer2DData.DebugShapeSegments = segments;
 
-            double x = 0.0;
-            if (textParams.Alignment == TextAlignment::Center)
-                x = -lineWidth / 2.0;
-            else if (textParams.Alignment == TextAlignment::Right)
-                x = -lineWidth;
-
-            for (size_t i = 0; i < line.size(); i++) {
-                char character = line[i];
-
-                if (character == ' ') {
-                    float advance = spaceGlyphAdvance;
-                    if (i < line.size() - 1) {
-                        char nextCharacter = line[i + 1];
-                        double dAdvance;
-                        fontGeometry.getAdvance(dAdvance, character, nextCharacter);
-                        advance = (float)dAdvance;
-                    }
-
-                    x += fsScale * advance + textParams.Kerning;
-                    continue;
-                }
+        // Before Init the shapes are built with the stored segment count
+        if (s_Renderer2DData.LineInstanceBuffer)
+            BuildDebugShapes(segments);
+    }
 
-                if (character == '\t') {
-                    x += 4.0f * (fsScale * spaceGlyphAdvance + textParams.Kerning);
-                    continue;
-                }
+    uint32_t Renderer2D::GetDebugShapeSegments()
+    {
+        return s_Renderer2DData.DebugShapeSegments;
+    }
 
-                auto glyph = fontGeometry.getGlyph(character);
-                if (!glyph)
-                    glyph = fontGeometry.getGlyph('?');
-                if (!glyph)
-                    continue;
+    void Renderer2D::BuildDebugShapes(uint32_t segments)
+    {
+        static_assert((size_t)DebugShape::Count == DebugShapeCount);
 
-                double al, ab, ar, at;
-                glyph->getQuadAtlasBounds(al, ab, ar, at);
-                glm::vec2 texCoordMin((float)al, (float)ab);
-                glm::vec2 texCoordMax((float)ar, (float)at);
-
-                double pl, pb, pr, pt;
-                glyph->getQuadPlaneBounds(pl, pb, pr, pt);
-                glm::vec2 quadMin((float)pl, (float)pb);
-                glm::vec2 quadMax((float)pr, (float)pt);
-
-                quadMin *= fsScale, quadMax *= fsScale;
-                quadMin += glm::vec2(x, y);
-                quadMax += glm::vec2(x, y);
-
-                float texelWidth = 1.0f / fontAtlas->GetWidth();
-                float texelHeight = 1.0f / fontAtlas->GetHeight();
-                texCoordMin *= glm::vec2(texelWidth, texelHeight);
-                texCoordMax *= glm::vec2(texelWidth, texelHeight);
-
-                // Convert entityID to vec3
-                uint32_t r = (entityID & 0x000000FF) >> 0;
-                uint32_t g = (entityID & 0x0000FF00) >> 8;
-                uint32_t b = (entityID & 0x00FF0000) >> 16;
-                glm::vec3 entityIDVec3 = glm::vec3(r / 255.0f, g / 255.0f, b / 255.0f);
-
-                batch.TextVertices.push_back({
-                    transform * glm::vec4(quadMin, 0.0f, 1.0f),
-                    textParams.Color,
-                    texCoordMin,
-                    entityIDVec3
-                });
+        std::vector<glm::vec2> ring(segments + 1);
+        for (uint32_t i = 0; i <= segments; i++)
+        {
+            float angle = glm::two_pi<float>() * i / segments;
+            ring[i] = {glm::cos(angle), glm::sin(angle)};
+        }
 
-                batch.TextVertices.push_back({
-                    transform * glm::vec4(quadMin.x, quadMax.y, 0.0f, 1.0f),
-                    textParams.Color,
-                    { texCoordMin.x, texCoordMax.y },
-                    entityIDVec3
-                });
+        std::array<std::vector<glm::vec3>, DebugShapeCount> shapes;
 
-                batch.TextVertices.push_back({
-                    transform * glm::vec4(quadMax, 0.0f, 1.0f),
-                    textParams.Color,
-                    texCoordMax,
-                    entityIDVec3
-                });
+        // Circle of radius 1 in the XY plane
+        std::vector<glm::vec3>& circle = shapes[(size_t)DebugShape::Circle];
+        for (uint32_t i = 0; i < segments; i++)
+        {
+            circle.push_back({ring[i].x, ring[i].y, 0.0f});
+            circle.push_back({ring[i + 1].x, ring[i + 1].y, 0.0f});
+        }
 
-                batch.TextVertices.push_back({
-                    transform * glm::vec4(quadMax.x, quadMin.y, 0.0f, 1.0f),
-                    textParams.Color,
-                    { texCoordMax.x, texCoordMin.y },
-                    entityIDVec3
-                });
+        // Sphere of radius 1, one circle per axis plane
+        std::vector<glm::vec3>& sphere = shapes[(size_t)DebugShape::Sphere];
+        for (uint32_t i = 0; i < segments; i++)
+        {
+            sphere.push_back({ring[i].x, ring[i].y, 0.0f});
+            sphere.push_back({ring[i + 1].x, ring[i + 1].y, 0.0f});
+            sphere.push_back({ring[i].x, 0.0f, ring[i].y});
+            sphere.push_back({ring[i + 1].x, 0.0f, ring[i + 1].y});
+            sphere.push_back({0.0f, ring[i].x, ring[i].y});
+            sphere.push_back({0.0f, ring[i + 1].x, ring[i + 1].y});
+        }
 
-                batch.TextIndexCount += 6;
+        // Cylinder of radius 1 and height 1 centered on the origin along Y
+        const uint32_t cylinderSideLines = 6;
+        std::vector<glm::vec3>& cylinder = shapes[(size_t)DebugShape::Cylinder];
+        for (uint32_t i = 0; i < segments; i++)
+        {
+            cylinder.push_back({ring[i].x, 0.5f, ring[i].y});
+            cylinder.push_back({ring[i + 1].x, 0.5f, ring[i + 1].y});
+            cylinder.push_back({ring[i].x, -0.5f, ring[i].y});
+            cylinder.push_back({ring[i + 1].x, -0.5f, ring[i + 1].y});
+        }
+        for (uint32_t side = 0; side < cylinderSideLines; side++)
+        {
+            const glm::vec2& point = ring[side * segments / cylinderSideLines];
+            cylinder.push_back({point.x, 0.5f, point.y});
+            cylinder.push_back({point.x, -0.5f, point.y});
+        }
 
-                if (i < line.size() - 1) {
-                    double advance = glyph->getAdvance();
-                    char nextCharacter = line[i + 1];
-                    fontGeometry.getAdvance(advance, character, nextCharacter);
+        // Cone with a base of radius 1 on the XZ plane and the apex at (0, 1, 0)
+        const uint32_t coneSideLines = 8;
+        std::vector<glm::vec3>& cone = shapes[(size_t)DebugShape::Cone];
+        for (uint32_t i = 0; i < segments; i++)
+        {
+            cone.push_back({ring[i].x, 0.0f, ring[i].y});
+            cone.push_back({ring[i + 1].x, 0.0f, ring[i + 1].y});
+        }
+        for (uint32_t side = 0; side < coneSideLines; side++)
+        {
+            const glm::vec2& point = ring[side * segments / coneSideLines];
+            cone.push_back({point.x, 0.0f, point.y});
+            cone.push_back({0.0f, 1.0f, 0.0f});
+        }
 
-                    x += fsScale * advance + textParams.Kerning;
-                }
-            }
+        // Box of size 1 centered on the origin
+        std::vector<glm::vec3>& box = shapes[(size_t)DebugShape::Box];
+        for (int i = 0; i < 4; i++)
+        {
+            glm::vec2 corner0 = {(i == 1 || i == 2) ? 0.5f : -0.5f, (i >= 2) ? 0.5f : -0.5f};
+            glm::vec2 corner1 = {(i == 0 || i == 1) ? 0.5f : -0.5f, (i == 1 || i == 2) ? 0.5f : -0.5f};
+
+            box.push_back({corner0, -0.5f});
+            box.push_back({corner1, -0.5f});
+            box.push_back({corner0, 0.5f});
+            box.push_back({corner1, 0.5f});
+            box.push_back({corner0, -0.5f});
+            box.push_back({corner0, 0.5f});
+        }
 
-            y -= fsScale * metrics.lineHeight + textParams.LineSpacing;
+        BufferLayout shapeLayout = {
+            {ShaderDataType::Vec3, "a_Position"}
+        };
+
+        for (size_t shape = 0; shape < DebugShapeCount; shape++)
+        {
+            std::vector<glm::vec3>& vertices = shapes[shape];
+            DebugShapeGeometry& geometry = s_Renderer2DData.DebugShapes[shape];
+
+            geometry.VertexCount = (uint32_t)vertices.size();
+            geometry.ShapeVertexBuffer = VertexBuffer::Create((float*)vertices.data(), vertices.size() * sizeof(glm::vec3));
+            geometry.ShapeVertexBuffer->SetLayout(shapeLayout);
+
+            geometry.ShapeVertexArray = VertexArray::Create();
+            geometry.ShapeVertexArray->AddVertexBuffer(geometry.ShapeVertexBuffer);
+            geometry.ShapeVertexArray->AddVertexBuffer(s_Renderer2DData.LineInstanceBuffer);
         }
     }
 
     Batch& Renderer2D::GetBatch(RenderMode mode)
     {
-        auto& batches = (mode == RenderMode::World) ? s_Renderer2DData.WorldBatches : s_Renderer2DData.ScreenBatches;
-        if (batches.empty())
+        BatchPool& pool = (mode == RenderMode::World) ? s_Renderer2DData.WorldBatches : s_Renderer2DData.ScreenBatches;
+        if (pool.ActiveCount == 0)
         {
-            batches.emplace();
+            return NextBatch(mode);
         }
-        return batches.back();
+        return pool.Batches[pool.ActiveCount - 1];
     }
     
-    void Renderer2D::NextBatch(RenderMode mode)
+    Batch& Renderer2D::NextBatch(RenderMode mode)
     {
-        auto& batches = (mode == RenderMode::World) ? s_Renderer2DData.WorldBatches : s_Renderer2DData.ScreenBatches;
-        batches.emplace();
+        BatchPool& pool = (mode == RenderMode::World) ? s_Renderer2DData.WorldBatches : s_Renderer2DData.ScreenBatches;
+        if (pool.ActiveCount == pool.Batches.size())
+        {
+            pool.Batches.emplace_back();
+        }
+        return pool.Batches[pool.ActiveCount++];
     }
-}
\ No newline at end of file
+}
@@ -106,9 +106,26 @@ namespace Coffee {
 		};
 
         static void DrawTextString(const std::string& text, Ref<Font> font, const glm::mat4& transform, const TextParams& textParams, RenderMode mode, uint32_t entityID = 4294967295);
+
+        // Circles, spheres, cylinders, cones and boxes are drawn as instances of unit shapes built once
+        static void SetDebugShapeSegments(uint32_t segments);
+        static uint32_t GetDebugShapeSegments();
     private:
+        enum class DebugShape
+        {
+            Circle,
+            Sphere,
+            Cylinder,
+            Cone,
+            Box,
+            Count
+        };
+
+        static void DrawDebugShape(DebugShape shape, const glm::mat4& transform, const glm::vec4& color, RenderMode mode);
+        static void BuildDebugShapes(uint32_t segments);
+
         static Batch& GetBatch(RenderMode mode);
-        static void NextBatch(RenderMode mode);
+        static Batch& NextBatch(RenderMode mode);
     };
 
 }
\ No newline at end of file
@@ -2,11 +2,14 @@
 #include "CoffeeEngine/Renderer/Material.h"
 #include "CoffeeEngine/Scene/PrimitiveMesh.h"
 #include "CoffeeEngine/Renderer/Framebuffer.h"
+#include "CoffeeEngine/Renderer/IBLBaker.h"
 #include "CoffeeEngine/Renderer/Mesh.h"
 #include "CoffeeEngine/Renderer/Model.h"
+#include "CoffeeEngine/Renderer/Renderer.h"
 #include "CoffeeEngine/Renderer/RendererAPI.h"
 #include "CoffeeEngine/Renderer/Shader.h"
 #include "CoffeeEngine/Renderer/Texture.h"
+#include "CoffeeEngine/Renderer/TextureStreaming.h"
 #include "CoffeeEngine/Renderer/UniformBuffer.h"
 #include "CoffeeEngine/Renderer/RenderTarget.h"
 #include "CoffeeEngine/Renderer/VertexArray.h"
@@ -16,8 +19,8 @@
 #include "CoffeeEngine/Embedded/FinalPassShader.inl"
 #include "CoffeeEngine/Embedded/MissingShader.inl"
 #include "CoffeeEngine/Embedded/SimpleDepthShader.inl"
-#include "CoffeeEngine/Embedded/BRDFLUTShader.inl"
 
+#include <algorithm>
 #include <stdint.h>
 #include <glm/fwd.hpp>
 #include <glm/matrix.hpp>
@@ -38,7 +41,6 @@ namespace Coffee {
     Ref<Shader> Renderer3D::s_FinalPassShader;
     Ref<Shader> Renderer3D::s_SkyboxShader;
     Ref<Shader> Renderer3D::depthShader;
-    Ref<Shader> Renderer3D::brdfShader;
     Ref<Shader> Renderer3D::s_BloomShader;
 
     Ref<Framebuffer> Renderer3D::s_BloomFramebuffer;
@@ -55,8 +57,6 @@ namespace Coffee {
 
         depthShader = CreateRef<Shader>("DepthShader", std::string(simpleDepthShaderSource));
 
-        brdfShader = CreateRef<Shader>("BRDFLUTShader", std::string(BRDFLUTSource));
-
         // Shadow map
         TextureProperties shadowMapProperties;
         shadowMapProperties.srgb = false;
@@ -143,6 +143,73 @@ namespace Coffee {
         }
     }
 
+    bool Renderer3D::SelectLOD(const Mesh& mesh, const glm::mat4& transform, uint32_t& lodLevel)
+    {
+        RenderTarget* target = Renderer::GetCurrentRenderTarget();
+        bool useLOD = s_RenderSettings.MeshLOD && mesh.GetLODCount() > 1;
+
+        if (!target || (!useLOD && s_RenderSettings.MinScreenSize <= 0.0f))
+        {
+            lodLevel = 0;
+            return true;
+        }
+
+        // Bounding sphere of the mesh in world space
+        const AABB& aabb = mesh.GetAABB();
+        float scale = std::max({glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))});
+        glm::vec3 center = glm::vec3(transform * glm::vec4(aabb.GetCenter(), 1.0f));
+        float radius = glm::length(aabb.GetHalfSize()) * scale;
+
+        // World space length to fraction of the screen height, perspective projections also divide by the distance
+        const glm::mat4& projection = target->GetCamera().GetProjection();
+        float screenScale = projection[1][1] * 0.5f;
+
+        if (projection[3][3] == 0.0f)
+        {
+            glm::vec3 cameraPosition = glm::vec3(target->GetCameraTransform()[3]);
+            float distance = glm::length(center - cameraPosition) - radius;
+
+            // The camera is inside the bounds
+            if (distance <= 0.0f)
+            {
+                lodLevel = 0;
+                return true;
+            }
+
+            screenScale /= distance;
+        }
+
+        if (s_RenderSettings.MinScreenSize > 0.0f && 2.0f * radius * screenScale < s_RenderSettings.MinScreenSize)
+            return false;
+
+        if (!useLOD)
+        {
+            lodLevel = 0;
+            return true;
+        }
+
+        // LOD errors are in object space
+        float pixelsPerUnit = screenScale * scale * target->GetSize().y;
+        float threshold = s_RenderSettings.LODErrorThreshold;
+
+        uint32_t selected = 0;
+        for (uint32_t level = 1; level < mesh.GetLODCount(); level++)
+        {
+            if (mesh.GetLOD(level).Error * pixelsPerUnit > threshold)
+                break;
+
+            selected = level;
+        }
+
+        // Switching to a finer LOD is immediate, switching to a coarser one needs some margin under the threshold
+        float coarserThreshold = threshold * (1.0f - s_RenderSettings.LODHysteresis);
+        while (selected > lodLevel && mesh.GetLOD(selected).Error * pixelsPerUnit > coarserThreshold)
+            selected--;
+
+        lodLevel = selected;
+        return true;
+    }
+
     // Temporal, this should be removed because this is rendering immediately.
     void Renderer3D::Submit(const Ref<Shader>& shader, const Ref<VertexArray>& vertexArray, const glm::mat4& transform, uint32_t entityID)
     {
@@ -226,20 +293,17 @@ namespace Coffee {
                 // Store the light space matrix for use in forward pass
                 s_RendererData.RenderData.LightSpaceMatrices[directionalLightCount] = lightSpaceMatrix;
 
-                depthShader->Bind();
-                depthShader->setMat4("projView", lightSpaceMatrix);
-
                 RendererAPI::SetCullFace(CullFace::Front);
     
                 for (const auto& command : s_RendererData.opaqueRenderQueue)
                 {
+                    // Skinned and static meshes use different variants of the depth shader
+                    depthShader->SetKeyword("ANIMATED", command.animator != nullptr);
+                    depthShader->Bind();
+                    depthShader->setMat4("projView", lightSpaceMatrix);
+
                     if (command.animator)
                         AnimationSystem::SetBoneTransformations(depthShader, command.animator);
-                    else
-                        depthShader->setBool("animated", false);
-
-                    // Set the model matrix
-                    depthShader->setMat4("model", command.transform);
 
                     Mesh* mesh = command.mesh.get();
                     
@@ -247,8 +311,12 @@ namespace Coffee {
                     {
                         mesh = s_RendererData.MissingMesh.get();
                     }
+
+                    // Set the model matrix
+                    depthShader->setMat4("model", command.transform * mesh->GetPositionTransform());
                     
-                    RendererAPI::DrawIndexed(mesh->GetVertexArray());
+                    const MeshLOD& lod = mesh->GetLOD(command.lodLevel);
+                    RendererAPI::DrawIndexed(mesh->GetVertexArray(), lod.IndexCount, lod.IndexOffset);
                 }
 
                 RendererAPI::SetCullFace(CullFace::Back);
@@ -263,6 +331,8 @@ namespace Coffee {
             }
         }
 
+        s_RendererData.DirectionalShadowCount = directionalLightCount;
+
         // Update the uniform buffer with the light data
         s_RendererData.SceneRenderDataUniformBuffer->SetData(&s_RendererData.RenderData, sizeof(Renderer3DData::RenderData));
     }
@@ -313,10 +383,17 @@ namespace Coffee {
                 material = s_RendererData.DefaultMaterial.get();
             }
             
-            material->Use();
-
             const Ref<Shader>& shader = material->GetShader();
 
+            // Keywords must be set before the material binds the shader variant
+            shader->SetKeyword("ANIMATED", command.animator != nullptr);
+            shader->SetKeyword("RECEIVE_SHADOWS", s_RendererData.DirectionalShadowCount > 0);
+
+            if (TextureStreaming::IsEnabled() && command.mesh)
+                material->RequestTextureMips(ComputeScreenSize(*command.mesh, command.transform, *target));
+
+            material->Use();
+
             shader->Bind();
 
             // Set the irradiance map, is 6 because the first 6 slots are used by the material
@@ -332,10 +409,16 @@ namespace Coffee {
 
             if (command.animator)
                 AnimationSystem::SetBoneTransformations(shader, command.animator);
-            else
-                shader->setBool("animated", false);
 
-            shader->setMat4("model", command.transform);
+            Mesh* mesh = command.mesh.get();
+            
+            if(mesh == nullptr)
+            {
+                mesh = s_RendererData.MissingMesh.get();
+            }
+
+            // Quantized positions are mapped to object space before the model matrix, normals are not affected
+            shader->setMat4("model", command.transform * mesh->GetPositionTransform());
             shader->setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(command.transform))));
 
             //REMOVE: This is for the first release of the engine it should be handled differently
@@ -349,13 +432,6 @@ namespace Coffee {
 
             shader->setVec3("entityID", entityIDVec3);
 
-            Mesh* mesh = command.mesh.get();
-            
-            if(mesh == nullptr)
-            {
-                mesh = s_RendererData.MissingMesh.get();
-            }
-
             // Apply material settings
             const MaterialRenderSettings& settings = material->GetRenderSettings();
             switch (settings.cullMode)
@@ -389,13 +465,14 @@ namespace Coffee {
                 RendererAPI::SetPolygonMode(PolygonMode::Fill);
             }
 
-            RendererAPI::DrawIndexed(mesh->GetVertexArray());
+            const MeshLOD& lod = mesh->GetLOD(command.lodLevel);
+            RendererAPI::DrawIndexed(mesh->GetVertexArray(), lod.IndexCount, lod.IndexOffset);
 
             
             s_Stats.DrawCalls++;
 
-            s_Stats.VertexCount += mesh->GetVertices().size();
-            s_Stats.IndexCount += mesh->GetIndices().size();
+            s_Stats.VertexCount += mesh->GetVertexCount();
+            s_Stats.IndexCount += lod.IndexCount;
         }
 
         forwardBuffer->UnBind();
@@ -462,10 +539,17 @@ namespace Coffee {
                 material = s_RendererData.DefaultMaterial.get();
             }
 
-            material->Use();
-
             const Ref<Shader>& shader = material->GetShader();
 
+            // Keywords must be set before the material binds the shader variant
+            shader->SetKeyword("ANIMATED", command.animator != nullptr);
+            shader->SetKeyword("RECEIVE_SHADOWS", s_RendererData.DirectionalShadowCount > 0);
+
+            if (TextureStreaming::IsEnabled() && command.mesh)
+                material->RequestTextureMips(ComputeScreenSize(*command.mesh, command.transform, *target));
+
+            material->Use();
+
             shader->Bind();
 
             // Set the irradiance map, is 6 because the first 6 slots are used by the material
@@ -475,10 +559,16 @@ namespace Coffee {
 
             if (command.animator)
                 AnimationSystem::SetBoneTransformations(shader, command.animator);
-            else
-                shader->setBool("animated", false);
 
-            shader->setMat4("model", command.transform);
+            Mesh* mesh = command.mesh.get();
+            
+            if(mesh == nullptr)
+            {
+                mesh = s_RendererData.MissingMesh.get();
+            }
+
+            // Quantized positions are mapped to object space before the model matrix, normals are not affected
+            shader->setMat4("model", command.transform * mesh->GetPositionTransform());
             shader->setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(command.transform))));
 
             //REMOVE: This is for the first release of the engine it should be handled differently
@@ -492,13 +582,6 @@ namespace Coffee {
 
             shader->setVec3("entityID", entityIDVec3);
 
-            Mesh* mesh = command.mesh.get();
-            
-            if(mesh == nullptr)
-            {
-                mesh = s_RendererData.MissingMesh.get();
-            }
-
                 // Apply material settings
                 const MaterialRenderSettings& settings = material->GetRenderSettings();
                 switch (settings.cullMode)
@@ -523,7 +606,8 @@ namespace Coffee {
                     RendererAPI::SetPolygonMode(PolygonMode::Fill);
                 }
 
-            RendererAPI::DrawIndexed(mesh->GetVertexArray());
+            const MeshLOD& lod = mesh->GetLOD(command.lodLevel);
+            RendererAPI::DrawIndexed(mesh->GetVertexArray(), lod.IndexCount, lod.IndexOffset);
         }
 
         RendererAPI::SetDepthMask(true);
@@ -772,32 +856,22 @@ namespace Coffee {
 
     void Renderer3D::GenerateBRDFLUT()
     {
+        ZoneScoped;
+
+        // The table never changes, it is integrated once on the CPU and read from the IBL cache afterwards
+        IBLBakeSettings settings;
+        std::vector<float> lut = IBLBaker::LoadOrBakeBRDFLUT(settings);
+
         TextureProperties properties;
-        properties.Format = ImageFormat::RGBA16F;
-        properties.Width = 512;
-        properties.Height = 512;
+        properties.Format = ImageFormat::RG16F;
+        properties.Width = settings.BRDFLUTSize;
+        properties.Height = settings.BRDFLUTSize;
         properties.GenerateMipmaps = false;
         properties.Wrapping = TextureWrap::ClampToEdge;
         properties.MinFilter = TextureFilter::Linear;
         properties.MagFilter = TextureFilter::Linear;
 
         s_RendererData.BRDFLUT = Texture2D::Create(properties);
-        
-        Framebuffer framebuffer = Framebuffer(properties.Width, properties.Height);
-        framebuffer.AttachColorTexture(0, s_RendererData.BRDFLUT);
-        framebuffer.Bind();
-        framebuffer.SetDrawBuffers({0});
-
-        RendererAPI::SetViewport(0, 0, properties.Width, properties.Height);
-
-        brdfShader->Bind();
-
-        RendererAPI::SetClearColor({0.0f, 0.0f, 0.0f, 1.0f});
-        RendererAPI::Clear();
-
-        s_ScreenQuad->GetVertexArray()->Bind();
-        RendererAPI::DrawIndexed(s_ScreenQuad->GetVertexArray());
-
-        framebuffer.UnBind();
+        s_RendererData.BRDFLUT->SetData(lut.data(), static_cast<uint32_t>(lut.size() * sizeof(float)));
     }
 }
\ No newline at end of file
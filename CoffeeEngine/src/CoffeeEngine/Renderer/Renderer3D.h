@@ -34,6 +34,7 @@ namespace Coffee {
         Ref<Material> material;
         uint32_t entityID = 4294967295;
         AnimatorComponent* animator;
+        uint32_t lodLevel = 0; ///< Level of detail of the mesh to draw.
     };
 
     /**
@@ -69,6 +70,7 @@ namespace Coffee {
 
         Ref<Framebuffer> ShadowMapFramebuffer;
         Ref<Texture2D> DirectionalShadowMapTextures[4];
+        int DirectionalShadowCount = 0; ///< Number of shadow maps rendered this frame.
 
         Ref<Cubemap> EnvironmentMap;
 
@@ -113,6 +115,11 @@ namespace Coffee {
 
         bool FXAA = true; ///< Enable or disable FXAA.
 
+        bool MeshLOD = true; ///< Enable or disable mesh LOD selection.
+        float LODErrorThreshold = 1.0f; ///< Maximum projected simplification error of the selected LOD, in pixels.
+        float LODHysteresis = 0.25f; ///< Margin under the threshold required to switch to a coarser LOD, as a fraction of it.
+        float MinScreenSize = 0.0f; ///< Meshes covering less than this fraction of the screen height are culled, 0 disables it.
+
         float Exposure = 1.0f; ///< Exposure value.
         float EnvironmentExposure = 1.0f; ///< Environment exposure value.
 
@@ -138,6 +145,15 @@ namespace Coffee {
 
         static void Submit(const RenderCommand& command);
 
+        /**
+         * @brief Selects the level of detail of a mesh from its projected size on the current render target.
+         * @param mesh The mesh to draw.
+         * @param transform The world transform of the mesh.
+         * @param lodLevel The LOD used last frame, receives the LOD to draw. Keeping it per instance avoids LOD popping.
+         * @return False if the mesh is smaller than the minimum screen size and should not be drawn.
+         */
+        static bool SelectLOD(const Mesh& mesh, const glm::mat4& transform, uint32_t& lodLevel);
+
         static void Submit(const Ref<Shader>& shader, const Ref<VertexArray>& vertexArray, const glm::mat4& transform = glm::mat4(1.0f), uint32_t entityID = 4294967295);
 
         /**
@@ -201,7 +217,6 @@ namespace Coffee {
         static Ref<Shader> s_FinalPassShader; ///< Final pass shader.
         static Ref<Shader> s_SkyboxShader; ///< Skybox shader.
         static Ref<Shader> depthShader; ///< Depth shader.
-        static Ref<Shader> brdfShader; ///< BRDF shader.
         static Ref<Shader> s_BloomShader; ///< Bloom downsample shader.
 
         static Ref<Framebuffer> s_BloomFramebuffer; ///< Bloom framebuffer.
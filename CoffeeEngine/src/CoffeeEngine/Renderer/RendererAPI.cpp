@@ -203,7 +203,7 @@ namespace Coffee {
 		}
 	}
 
-    void RendererAPI::DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount)
+    void RendererAPI::DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t firstIndex)
     {
         ZoneScoped;
 
@@ -213,7 +213,7 @@ namespace Coffee {
 		uint32_t count = indexCount ? indexCount : vertexArray->GetIndexBuffer()->GetCount();
 		vertexArray->GetIndexBuffer()->Bind();
 		
-        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (const void*)(firstIndex * sizeof(uint32_t)));
     }
 
 	void RendererAPI::DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, float lineWidth)
@@ -225,6 +225,15 @@ namespace Coffee {
 		glDrawArrays(GL_LINES, 0, vertexCount);
 	}
 
+	void RendererAPI::DrawLinesInstanced(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, uint32_t instanceCount, float lineWidth)
+	{
+		ZoneScoped;
+
+		vertexArray->Bind();
+		glLineWidth(lineWidth);
+		glDrawArraysInstanced(GL_LINES, 0, vertexCount, instanceCount);
+	}
+
     Scope<RendererAPI> RendererAPI::Create()
     {
         return CreateScope<RendererAPI>();
@@ -123,8 +123,10 @@ namespace Coffee {
         /**
          * @brief Draws the indexed vertices from the specified vertex array.
          * @param vertexArray The vertex array containing the vertices to draw.
+         * @param indexCount The number of indices to draw, 0 to draw the whole index buffer.
+         * @param firstIndex The first index to draw from the index buffer.
          */
-        static void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount = 0);
+        static void DrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount = 0, uint32_t firstIndex = 0);
 
         /**
          * @brief Draws lines from the specified vertex array.
@@ -134,6 +136,15 @@ namespace Coffee {
          */
         static void DrawLines(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, float lineWidth = 1.0f);
 
+        /**
+         * @brief Draws several instances of the lines of the specified vertex array.
+         * @param vertexArray The vertex array containing the per vertex and per instance attributes.
+         * @param vertexCount The number of vertices of one instance.
+         * @param instanceCount The number of instances to draw.
+         * @param lineWidth The width of the lines.
+         */
+        static void DrawLinesInstanced(const Ref<VertexArray>& vertexArray, uint32_t vertexCount, uint32_t instanceCount, float lineWidth = 1.0f);
+
         /**
          * @brief Creates a new Renderer API instance.
          * @return A scope pointer to the created Renderer API instance.
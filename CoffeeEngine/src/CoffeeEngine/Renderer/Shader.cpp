@@ -2,6 +2,8 @@
 #include "CoffeeEngine/IO/ImportData/ImportData.h"
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
+#include "CoffeeEngine/IO/CacheManager.h"
+#include "CoffeeEngine/Core/Hash.h"
 
 #include <glad/glad.h>
 #include <glm/vec2.hpp>
@@ -52,13 +54,18 @@ namespace Coffee {
     {
         ZoneScoped;
 
-        glDeleteProgram(m_ShaderID);
+        DeleteVariants();
     }
 
     void Shader::Bind()
     {
         ZoneScoped;
 
+        if (!m_Keywords.empty())
+        {
+            m_ShaderID = GetVariant(m_ActiveKeywords);
+        }
+
         glUseProgram(m_ShaderID);
     }
 
@@ -157,6 +164,42 @@ namespace Coffee {
         CompileShader(shaderCode);
     }
 
+    void Shader::SetKeyword(const std::string& keyword, bool enabled)
+    {
+        auto it = std::lower_bound(m_Keywords.begin(), m_Keywords.end(), keyword);
+        if (it == m_Keywords.end() || *it != keyword)
+            return;
+
+        const ShaderKeywordMask bit = ShaderKeywordMask(1) << (it - m_Keywords.begin());
+
+        if (enabled)
+            m_ActiveKeywords |= bit;
+        else
+            m_ActiveKeywords &= ~bit;
+    }
+
+    bool Shader::HasKeyword(const std::string& keyword) const
+    {
+        return std::binary_search(m_Keywords.begin(), m_Keywords.end(), keyword);
+    }
+
+    void Shader::PrecompileVariants()
+    {
+        ZoneScoped;
+
+        PrecompileVariants(ShaderPermutation::EnumerateVariants(m_Keywords));
+    }
+
+    void Shader::PrecompileVariants(const std::vector<ShaderKeywordMask>& masks)
+    {
+        ZoneScoped;
+
+        for (ShaderKeywordMask mask : masks)
+        {
+            GetVariant(mask);
+        }
+    }
+
     Ref<Shader> Shader::Create(const std::filesystem::path& shaderPath)
     {
         ZoneScoped;
@@ -232,8 +275,56 @@ namespace Coffee {
             return;
         }
 
-        std::string vertexCode = shaderSource.substr(vertexPos + vertexDelimiter.length(), fragmentPos - vertexPos - vertexDelimiter.length());
-        std::string fragmentCode = shaderSource.substr(fragmentPos + fragmentDelimiter.length(), shaderSource.length() - fragmentPos - fragmentDelimiter.length());
+        DeleteVariants();
+
+        m_VertexSource = shaderSource.substr(vertexPos + vertexDelimiter.length(), fragmentPos - vertexPos - vertexDelimiter.length());
+        m_FragmentSource = shaderSource.substr(fragmentPos + fragmentDelimiter.length(), shaderSource.length() - fragmentPos - fragmentDelimiter.length());
+        m_SourceHash = Hash::FNV1a(shaderSource);
+
+        m_Keywords = ShaderPermutation::ParseKeywords(shaderSource);
+        m_ActiveKeywords = 0;
+
+        // The variant without keywords is always needed, the rest are created on demand
+        m_ShaderID = GetVariant(0);
+    }
+
+    void Shader::DeleteVariants()
+    {
+        for (const auto& [mask, program] : m_Variants)
+        {
+            glDeleteProgram(program);
+        }
+        m_Variants.clear();
+        m_ShaderID = 0;
+    }
+
+    unsigned int Shader::GetVariant(ShaderKeywordMask mask)
+    {
+        auto it = m_Variants.find(mask);
+        if (it != m_Variants.end())
+            return it->second;
+
+        ZoneScoped;
+
+        std::vector<std::string> defines = ShaderPermutation::GetDefines(m_Keywords, mask);
+        uint64_t variantHash = ShaderPermutation::HashVariant(m_SourceHash, defines);
+
+        unsigned int program = LoadProgramBinary(variantHash);
+        if (program == 0)
+        {
+            program = CompileVariant(defines, variantHash);
+        }
+
+        m_Variants[mask] = program;
+        return program;
+    }
+
+    unsigned int Shader::CompileVariant(const std::vector<std::string>& defines, uint64_t variantHash)
+    {
+        ZoneScoped;
+
+        std::string vertexCode = ShaderPermutation::InjectDefines(m_VertexSource, defines);
+        std::string fragmentCode = ShaderPermutation::InjectDefines(m_FragmentSource, defines);
 
         const char* vShaderCode = vertexCode.c_str();
         const char * fShaderCode = fragmentCode.c_str();
@@ -250,14 +341,125 @@ namespace Coffee {
         glCompileShader(fragment);
         checkCompileErrors(fragment, "FRAGMENT");
         // shader Program
-        m_ShaderID = glCreateProgram();
-        glAttachShader(m_ShaderID, vertex);
-        glAttachShader(m_ShaderID, fragment);
-        glLinkProgram(m_ShaderID);
-        checkCompileErrors(m_ShaderID, "PROGRAM");
+        unsigned int program = glCreateProgram();
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        glLinkProgram(program);
+        checkCompileErrors(program, "PROGRAM");
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+
+        SaveProgramBinary(program, variantHash);
+
+        return program;
+    }
+
+    // Program binaries are only valid for the driver that produced them
+    static uint64_t GetDriverHash()
+    {
+        static uint64_t driverHash = 0;
+        if (driverHash == 0)
+        {
+            const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+            const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+            const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+
+            driverHash = Hash::FNV1a(vendor ? vendor : "");
+            driverHash = Hash::FNV1a(renderer ? renderer : "", driverHash);
+            driverHash = Hash::FNV1a(version ? version : "", driverHash);
+        }
+        return driverHash;
+    }
+
+    struct ProgramBinaryHeader
+    {
+        uint32_t magic = 0x42505343; // "CSPB"
+        uint32_t version = 1;
+        uint64_t driverHash = 0;
+        uint32_t format = 0;
+        uint32_t size = 0;
+    };
+
+    static std::filesystem::path GetProgramBinaryPath(uint64_t variantHash)
+    {
+        return CacheManager::GetCachePath() / "Shaders" / (std::to_string(variantHash) + ".bin");
+    }
+
+    unsigned int Shader::LoadProgramBinary(uint64_t variantHash)
+    {
+        ZoneScoped;
+
+        std::filesystem::path binaryPath = GetProgramBinaryPath(variantHash);
+
+        std::ifstream file(binaryPath, std::ios::binary);
+        if (!file)
+            return 0;
+
+        ProgramBinaryHeader expected;
+        ProgramBinaryHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!file || header.magic != expected.magic || header.version != expected.version || header.driverHash != GetDriverHash())
+            return 0;
+
+        std::vector<char> binary(header.size);
+        file.read(binary.data(), header.size);
+        if (!file)
+            return 0;
+
+        unsigned int program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), header.size);
+
+        // The driver can reject a binary at any time (e.g. after an update), fall back to compiling
+        GLint success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            glDeleteProgram(program);
+            std::filesystem::remove(binaryPath);
+            return 0;
+        }
+
+        return program;
+    }
+
+    void Shader::SaveProgramBinary(unsigned int program, uint64_t variantHash)
+    {
+        ZoneScoped;
+
+        GLint success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+            return;
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+        ProgramBinaryHeader header;
+        header.driverHash = GetDriverHash();
+        header.format = format;
+        header.size = static_cast<uint32_t>(length);
+
+        // Only the writes need the directory, created once per cache path, the lookups of a missing one simply fail
+        std::filesystem::path binaryPath = GetProgramBinaryPath(variantHash);
+        static std::filesystem::path s_CreatedDirectory;
+        if (binaryPath.parent_path() != s_CreatedDirectory)
+        {
+            std::filesystem::create_directories(binaryPath.parent_path());
+            s_CreatedDirectory = binaryPath.parent_path();
+        }
+
+        std::ofstream file(binaryPath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), length);
     }
 
     void Shader::InitializeShader(const std::filesystem::path& shaderPath)
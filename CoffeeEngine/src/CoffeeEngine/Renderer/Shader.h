@@ -2,6 +2,9 @@
 
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/IO/Resource.h"
+#include "CoffeeEngine/Renderer/ShaderPermutation.h"
+
+#include <unordered_map>
 
 namespace Coffee {
     class ImportData;
@@ -39,6 +42,9 @@ namespace Coffee {
 
         /**
          * @brief Binds the shader program for use.
+         *
+         * If the shader declares keywords, the variant matching the enabled keywords is bound,
+         * compiling it (or loading it from the program binary cache) the first time it is requested.
          */
         void Bind();
 
@@ -114,6 +120,49 @@ namespace Coffee {
 
         void Recompile();
 
+        /**
+         * @brief Enables or disables a keyword for the next Bind.
+         *
+         * Keywords not declared by the shader with `#pragma keywords` are ignored, so the same
+         * call can be made on any shader.
+         * @param keyword The name of the keyword.
+         * @param enabled Whether the keyword is enabled.
+         */
+        void SetKeyword(const std::string& keyword, bool enabled);
+
+        /**
+         * @brief Checks if the shader declares a keyword.
+         * @param keyword The name of the keyword.
+         * @return True if the keyword is declared, false otherwise.
+         */
+        bool HasKeyword(const std::string& keyword) const;
+
+        /**
+         * @brief Gets the keywords declared by the shader.
+         * @return The declared keywords, sorted.
+         */
+        const std::vector<std::string>& GetKeywords() const { return m_Keywords; }
+
+        /**
+         * @brief Gets the number of variants compiled or loaded so far.
+         * @return The number of variants.
+         */
+        size_t GetVariantCount() const { return m_Variants.size(); }
+
+        /**
+         * @brief Compiles every variant of the shader up front, filling the program binary cache.
+         *
+         * Shaders with more than ShaderPermutation::MaxEnumeratedKeywords keywords only precompile the variant
+         * without keywords, the others are compiled when first bound or with the overload taking the masks.
+         */
+        void PrecompileVariants();
+
+        /**
+         * @brief Compiles the given variants of the shader up front, e.g. the ones the materials of a scene use.
+         * @param masks The keyword masks of the variants.
+         */
+        void PrecompileVariants(const std::vector<ShaderKeywordMask>& masks);
+
         /**
          * @brief Creates a shader from the specified vertex and fragment shader paths.
          * @param vertexPath The file path to the vertex shader.
@@ -134,9 +183,23 @@ namespace Coffee {
         std::string ReadShaderFile(const std::filesystem::path& shaderPath);
         void CompileShader(const std::string& shaderSource);
         void InitializeShader(const std::filesystem::path& shaderPath);
+        void DeleteVariants();
+
+        unsigned int GetVariant(ShaderKeywordMask mask);
+        unsigned int CompileVariant(const std::vector<std::string>& defines, uint64_t variantHash);
+        unsigned int LoadProgramBinary(uint64_t variantHash);
+        void SaveProgramBinary(unsigned int program, uint64_t variantHash);
 
     private:
-        unsigned int m_ShaderID; ///< The ID of the shader program.
+        unsigned int m_ShaderID = 0; ///< The ID of the currently selected shader program.
+
+        std::string m_VertexSource; ///< The vertex stage source, without keyword defines.
+        std::string m_FragmentSource; ///< The fragment stage source, without keyword defines.
+        uint64_t m_SourceHash = 0; ///< Hash of the shader source, part of every variant key.
+
+        std::vector<std::string> m_Keywords; ///< The keywords declared by the shader.
+        ShaderKeywordMask m_ActiveKeywords = 0; ///< The keywords enabled for the next Bind.
+        std::unordered_map<ShaderKeywordMask, unsigned int> m_Variants; ///< The compiled programs by keyword mask.
     };
 
     /** @} */
@@ -0,0 +1,138 @@
+#include "ShaderPermutation.h"
+
+#include "CoffeeEngine/Core/Hash.h"
+#include "CoffeeEngine/Core/Log.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace Coffee {
+
+    std::vector<std::string> ShaderPermutation::ParseKeywords(const std::string& source)
+    {
+        const std::string pragma = "#pragma keywords";
+
+        std::vector<std::string> keywords;
+
+        size_t pos = source.find(pragma);
+        while (pos != std::string::npos)
+        {
+            size_t lineEnd = source.find('\n', pos);
+            std::istringstream line(source.substr(pos + pragma.length(), lineEnd == std::string::npos ? std::string::npos : lineEnd - pos - pragma.length()));
+
+            std::string keyword;
+            while (line >> keyword)
+            {
+                keywords.push_back(keyword);
+            }
+
+            pos = source.find(pragma, lineEnd);
+        }
+
+        std::sort(keywords.begin(), keywords.end());
+        keywords.erase(std::unique(keywords.begin(), keywords.end()), keywords.end());
+
+        if (keywords.size() > MaxKeywords)
+        {
+            COFFEE_CORE_WARN("ShaderPermutation::ParseKeywords: {0} keywords declared, only the first {1} will be used", keywords.size(), MaxKeywords);
+            keywords.resize(MaxKeywords);
+        }
+
+        return keywords;
+    }
+
+    ShaderKeywordMask ShaderPermutation::GetMask(const std::vector<std::string>& keywords, const std::vector<std::string>& defines)
+    {
+        ShaderKeywordMask mask = 0;
+
+        for (const std::string& define : defines)
+        {
+            auto it = std::lower_bound(keywords.begin(), keywords.end(), define);
+            if (it != keywords.end() && *it == define)
+            {
+                mask |= ShaderKeywordMask(1) << (it - keywords.begin());
+            }
+        }
+
+        return mask;
+    }
+
+    std::vector<std::string> ShaderPermutation::GetDefines(const std::vector<std::string>& keywords, ShaderKeywordMask mask)
+    {
+        std::vector<std::string> defines;
+
+        for (size_t i = 0; i < keywords.size(); ++i)
+        {
+            if (mask & (ShaderKeywordMask(1) << i))
+            {
+                defines.push_back(keywords[i]);
+            }
+        }
+
+        return defines;
+    }
+
+    std::vector<ShaderKeywordMask> ShaderPermutation::EnumerateVariants(const std::vector<std::string>& keywords)
+    {
+        if (keywords.size() > MaxEnumeratedKeywords)
+        {
+            COFFEE_CORE_WARN("ShaderPermutation::EnumerateVariants: {0} keywords make {1} variants, only the one without keywords is enumerated",
+                             keywords.size(), uint64_t(1) << keywords.size());
+            return {0};
+        }
+
+        std::vector<ShaderKeywordMask> variants;
+
+        const ShaderKeywordMask count = ShaderKeywordMask(1) << keywords.size();
+        variants.reserve(count);
+
+        for (ShaderKeywordMask mask = 0; mask < count; ++mask)
+        {
+            variants.push_back(mask);
+        }
+
+        return variants;
+    }
+
+    uint64_t ShaderPermutation::HashVariant(uint64_t sourceHash, const std::vector<std::string>& defines)
+    {
+        std::vector<std::string> sortedDefines = defines;
+        std::sort(sortedDefines.begin(), sortedDefines.end());
+        sortedDefines.erase(std::unique(sortedDefines.begin(), sortedDefines.end()), sortedDefines.end());
+
+        uint64_t hash = sourceHash;
+        for (const std::string& define : sortedDefines)
+        {
+            // Hash the terminator too so {"AB"} and {"A", "B"} don't collide
+            hash = Hash::Combine(hash, Hash::FNV1a(define.c_str(), define.size() + 1));
+        }
+
+        return hash;
+    }
+
+    std::string ShaderPermutation::InjectDefines(const std::string& stageSource, const std::vector<std::string>& defines)
+    {
+        if (defines.empty())
+            return stageSource;
+
+        std::string defineBlock;
+        for (const std::string& define : defines)
+        {
+            defineBlock += "#define " + define + "\n";
+        }
+
+        // The #version directive must stay the first statement of the stage
+        size_t versionPos = stageSource.find("#version");
+        if (versionPos == std::string::npos)
+            return defineBlock + stageSource;
+
+        size_t lineEnd = stageSource.find('\n', versionPos);
+        if (lineEnd == std::string::npos)
+            return stageSource + "\n" + defineBlock;
+
+        std::string result = stageSource;
+        result.insert(lineEnd + 1, defineBlock);
+        return result;
+    }
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    using ShaderKeywordMask = uint32_t; ///< Bit i is set when the i-th declared keyword is enabled.
+
+    /**
+     * @brief Helpers to enumerate and identify the compile-time variants of a shader.
+     *
+     * A shader declares its keywords with a `#pragma keywords A B C` line. Every combination of enabled
+     * keywords is a variant, compiled with a `#define` per enabled keyword. This class does not touch the
+     * GPU, so the variant logic can be exercised without a GL context.
+     */
+    class ShaderPermutation
+    {
+    public:
+        static constexpr uint32_t MaxKeywords = 32; ///< Maximum number of keywords a shader can declare.
+        static constexpr uint32_t MaxEnumeratedKeywords = 10; ///< Maximum number of keywords whose combinations are enumerated.
+
+        /**
+         * @brief Parses the `#pragma keywords` lines of a shader source.
+         * @param source The full shader source.
+         * @return The declared keywords, sorted and without duplicates.
+         */
+        static std::vector<std::string> ParseKeywords(const std::string& source);
+
+        /**
+         * @brief Builds the mask for a set of defines. Defines that are not declared keywords are ignored.
+         * @param keywords The declared keywords, as returned by ParseKeywords.
+         * @param defines The defines to enable, in any order.
+         * @return The keyword mask.
+         */
+        static ShaderKeywordMask GetMask(const std::vector<std::string>& keywords, const std::vector<std::string>& defines);
+
+        /**
+         * @brief Gets the defines enabled by a mask.
+         * @param keywords The declared keywords, as returned by ParseKeywords.
+         * @param mask The keyword mask.
+         * @return The enabled keywords, sorted.
+         */
+        static std::vector<std::string> GetDefines(const std::vector<std::string>& keywords, ShaderKeywordMask mask);
+
+        /**
+         * @brief Enumerates every variant of a shader.
+         *
+         * The variants double with each keyword, past MaxEnumeratedKeywords only the empty mask is returned and
+         * the other variants are left to be compiled when they are first used.
+         * @param keywords The declared keywords, as returned by ParseKeywords.
+         * @return The masks of all the keyword combinations, starting with the empty one.
+         */
+        static std::vector<ShaderKeywordMask> EnumerateVariants(const std::vector<std::string>& keywords);
+
+        /**
+         * @brief Computes the stable hash identifying a variant.
+         * @param sourceHash The hash of the shader source.
+         * @param defines The enabled defines, in any order.
+         * @return The variant hash, independent of the order and duplicates of the defines.
+         */
+        static uint64_t HashVariant(uint64_t sourceHash, const std::vector<std::string>& defines);
+
+        /**
+         * @brief Inserts a `#define` per keyword right after the `#version` directive of a shader stage.
+         * @param stageSource The source of a single shader stage.
+         * @param defines The defines to insert.
+         * @return The stage source with the defines.
+         */
+        static std::string InjectDefines(const std::string& stageSource, const std::vector<std::string>& defines);
+    };
+
+    /** @} */
+}
@@ -0,0 +1,246 @@
+#include "TextLayoutCache.h"
+#include "CoffeeEngine/Core/Hash.h"
+#include "CoffeeEngine/Renderer/Font.h"
+#include "CoffeeEngine/Renderer/MSDFData.h"
+#include "CoffeeEngine/Renderer/Texture.h"
+
+#include <tracy/Tracy.hpp>
+
+namespace Coffee {
+
+    TextLayoutCache::EntryList TextLayoutCache::s_Entries;
+    std::unordered_map<uint64_t, TextLayoutCache::EntryList::iterator> TextLayoutCache::s_Lookup;
+    size_t TextLayoutCache::s_MemoryBudget = TextLayoutCache::DefaultMemoryBudget;
+    size_t TextLayoutCache::s_MemoryUsage = 0;
+    TextLayoutCacheStats TextLayoutCache::s_Stats;
+
+    bool TextLayoutCache::Entry::Matches(const std::string& text, const Ref<Font>& font, const Renderer2D::TextParams& textParams) const
+    {
+        return FontPtr == font.get() && !FontRef.expired() &&
+               Size == textParams.Size && Kerning == textParams.Kerning && LineSpacing == textParams.LineSpacing &&
+               Alignment == textParams.Alignment && Text == text;
+    }
+
+    uint64_t TextLayoutCache::HashKey(const std::string& text, const Font* font, const Renderer2D::TextParams& textParams)
+    {
+        uint64_t hash = Hash::FNV1a(text);
+        hash = Hash::Combine(hash, reinterpret_cast<uintptr_t>(font));
+        hash = Hash::FNV1a(&textParams.Size, sizeof(float), hash);
+        hash = Hash::FNV1a(&textParams.Kerning, sizeof(float), hash);
+        hash = Hash::FNV1a(&textParams.LineSpacing, sizeof(float), hash);
+        hash = Hash::FNV1a(&textParams.Alignment, sizeof(Renderer2D::TextAlignment), hash);
+        return hash;
+    }
+
+    const TextLayout& TextLayoutCache::GetLayout(const std::string& text, const Ref<Font>& font, const Renderer2D::TextParams& textParams)
+    {
+        ZoneScoped;
+
+        uint64_t hash = HashKey(text, font.get(), textParams);
+
+        auto lookupIt = s_Lookup.find(hash);
+        if (lookupIt != s_Lookup.end())
+        {
+            EntryList::iterator entryIt = lookupIt->second;
+            if (entryIt->Matches(text, font, textParams))
+            {
+                s_Stats.Hits++;
+                s_Entries.splice(s_Entries.begin(), s_Entries, entryIt);
+                return entryIt->Layout;
+            }
+
+            // Hash collision or stale font, the new layout replaces the old one
+            Erase(entryIt);
+        }
+
+        s_Stats.Misses++;
+
+        Entry& entry = s_Entries.emplace_front();
+        entry.Hash = hash;
+        entry.FontRef = font;
+        entry.FontPtr = font.get();
+        entry.Text = text;
+        entry.Size = textParams.Size;
+        entry.Kerning = textParams.Kerning;
+        entry.LineSpacing = textParams.LineSpacing;
+        entry.Alignment = textParams.Alignment;
+
+        BuildLayout(text, *font, textParams, entry.Layout);
+        entry.Layout.Quads.shrink_to_fit();
+
+        entry.MemoryUsage = sizeof(Entry) + entry.Text.capacity() + entry.Layout.Quads.capacity() * sizeof(TextGlyphQuad);
+        s_MemoryUsage += entry.MemoryUsage;
+
+        s_Lookup[hash] = s_Entries.begin();
+
+        EvictToBudget();
+
+        return entry.Layout;
+    }
+
+    void TextLayoutCache::BuildLayout(const std::string& text, const Font& font, const Renderer2D::TextParams& textParams, TextLayout& layout)
+    {
+        layout.Quads.clear();
+
+        const MSDFData& fontData = *font.GetMSDFData();
+        const MSDFFontMetrics& metrics = fontData.Metrics;
+        Ref<Texture2D> fontAtlas = font.GetAtlasTexture();
+
+        // The font failed to load
+        if (!fontAtlas || !fontData.GetGlyph(' '))
+            return;
+
+        double fsScale = textParams.Size / (metrics.AscenderY - metrics.DescenderY);
+        const float spaceGlyphAdvance = fontData.GetGlyph(' ')->Advance;
+
+        const float texelWidth = 1.0f / fontAtlas->GetWidth();
+        const float texelHeight = 1.0f / fontAtlas->GetHeight();
+
+        std::vector<std::string> lines;
+        std::string currentLine;
+
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '\n') {
+                lines.push_back(currentLine);
+                currentLine.clear();
+            } else if (text[i] != '\r') {
+                currentLine += text[i];
+            }
+        }
+
+        if (!currentLine.empty())
+            lines.push_back(currentLine);
+
+        if (lines.empty())
+            lines.push_back("");
+
+        double y = 0.0;
+
+        for (const auto& line : lines) {
+            double lineWidth = 0.0;
+
+            if (textParams.Alignment != Renderer2D::TextAlignment::Left) {
+                for (size_t i = 0; i < line.size(); i++) {
+                    char character = line[i];
+
+                    if (character == ' ') {
+                        lineWidth += fsScale * spaceGlyphAdvance + textParams.Kerning;
+                        continue;
+                    }
+
+                    if (character == '\t') {
+                        lineWidth += 4.0f * (fsScale * spaceGlyphAdvance + textParams.Kerning);
+                        continue;
+                    }
+
+                    auto glyph = fontData.GetGlyph(character);
+                    if (!glyph)
+                        glyph = fontData.GetGlyph('?');
+                    if (!glyph)
+                        continue;
+
+                    double advance = glyph->Advance;
+                    if (i < line.size() - 1) {
+                        char nextCharacter = line[i + 1];
+                        fontData.GetAdvance(advance, character, nextCharacter);
+                    }
+
+                    lineWidth += fsScale * advance + textParams.Kerning;
+                }
+
+                if (!line.empty())
+                    lineWidth -= textParams.Kerning;
+            }
+
+            double x = 0.0;
+            if (textParams.Alignment == Renderer2D::TextAlignment::Center)
+                x = -lineWidth / 2.0;
+            else if (textParams.Alignment == Renderer2D::TextAlignment::Right)
+                x = -lineWidth;
+
+            for (size_t i = 0; i < line.size(); i++) {
+                char character = line[i];
+
+                if (character == ' ') {
+                    float advance = spaceGlyphAdvance;
+                    if (i < line.size() - 1) {
+                        char nextCharacter = line[i + 1];
+                        double dAdvance = spaceGlyphAdvance;
+                        fontData.GetAdvance(dAdvance, character, nextCharacter);
+                        advance = (float)dAdvance;
+                    }
+
+                    x += fsScale * advance + textParams.Kerning;
+                    continue;
+                }
+
+                if (character == '\t') {
+                    x += 4.0f * (fsScale * spaceGlyphAdvance + textParams.Kerning);
+                    continue;
+                }
+
+                auto glyph = fontData.GetGlyph(character);
+                if (!glyph)
+                    glyph = fontData.GetGlyph('?');
+                if (!glyph)
+                    continue;
+
+                glm::vec2 texCoordMin((float)glyph->AtlasLeft, (float)glyph->AtlasBottom);
+                glm::vec2 texCoordMax((float)glyph->AtlasRight, (float)glyph->AtlasTop);
+
+                glm::vec2 quadMin((float)glyph->PlaneLeft, (float)glyph->PlaneBottom);
+                glm::vec2 quadMax((float)glyph->PlaneRight, (float)glyph->PlaneTop);
+
+                quadMin *= fsScale, quadMax *= fsScale;
+                quadMin += glm::vec2(x, y);
+                quadMax += glm::vec2(x, y);
+
+                texCoordMin *= glm::vec2(texelWidth, texelHeight);
+                texCoordMax *= glm::vec2(texelWidth, texelHeight);
+
+                layout.Quads.push_back({ quadMin, quadMax, texCoordMin, texCoordMax });
+
+                if (i < line.size() - 1) {
+                    double advance = glyph->Advance;
+                    char nextCharacter = line[i + 1];
+                    fontData.GetAdvance(advance, character, nextCharacter);
+
+                    x += fsScale * advance + textParams.Kerning;
+                }
+            }
+
+            y -= fsScale * metrics.LineHeight + textParams.LineSpacing;
+        }
+    }
+
+    void TextLayoutCache::SetMemoryBudget(size_t bytes)
+    {
+        s_MemoryBudget = bytes;
+        EvictToBudget();
+    }
+
+    void TextLayoutCache::Clear()
+    {
+        s_Entries.clear();
+        s_Lookup.clear();
+        s_MemoryUsage = 0;
+    }
+
+    void TextLayoutCache::EvictToBudget()
+    {
+        // The most recent entry is always kept, it is the one the caller is about to draw
+        while (s_MemoryUsage > s_MemoryBudget && s_Entries.size() > 1)
+        {
+            Erase(std::prev(s_Entries.end()));
+            s_Stats.Evictions++;
+        }
+    }
+
+    void TextLayoutCache::Erase(EntryList::iterator it)
+    {
+        s_MemoryUsage -= it->MemoryUsage;
+        s_Lookup.erase(it->Hash);
+        s_Entries.erase(it);
+    }
+
+}
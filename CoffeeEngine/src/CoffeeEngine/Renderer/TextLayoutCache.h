@@ -0,0 +1,156 @@
+#pragma once
+
+#include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Renderer/Renderer2D.h"
+
+#include <glm/vec2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Coffee {
+
+    class Font;
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief A glyph quad of a laid out text, in text space (before the draw transform is applied).
+     */
+    struct TextGlyphQuad
+    {
+        glm::vec2 QuadMin; ///< Bottom left corner of the quad.
+        glm::vec2 QuadMax; ///< Top right corner of the quad.
+        glm::vec2 TexCoordMin; ///< Atlas texture coordinates of the bottom left corner.
+        glm::vec2 TexCoordMax; ///< Atlas texture coordinates of the top right corner.
+    };
+
+    /**
+     * @brief The glyph quads of a text laid out with a font and a set of text parameters.
+     */
+    struct TextLayout
+    {
+        std::vector<TextGlyphQuad> Quads; ///< One quad per visible glyph.
+    };
+
+    /**
+     * @brief Statistics of the text layout cache.
+     */
+    struct TextLayoutCacheStats
+    {
+        uint64_t Hits = 0; ///< Number of layouts served from the cache.
+        uint64_t Misses = 0; ///< Number of layouts that had to be built.
+        uint64_t Evictions = 0; ///< Number of layouts evicted to stay within the memory budget.
+
+        void Reset()
+        {
+            Hits = 0;
+            Misses = 0;
+            Evictions = 0;
+        }
+    };
+
+    /**
+     * @brief Caches the layout of the texts drawn by Renderer2D.
+     *
+     * Laying out a text walks every character, looks up its glyph and kerning in the font and builds
+     * its quad. Most texts (HUD labels, UI) are identical from one frame to the next, so the resulting
+     * quads are cached by font, string and layout parameters, and only the transform and color are
+     * applied when drawing. The least recently used layouts are evicted when the cache exceeds its
+     * memory budget.
+     */
+    class TextLayoutCache
+    {
+    public:
+        static constexpr size_t DefaultMemoryBudget = 4 * 1024 * 1024; ///< Default memory budget in bytes.
+
+        /**
+         * @brief Gets the layout of a text, building and caching it if needed.
+         * @param text The text to lay out.
+         * @param font The font used to draw the text.
+         * @param textParams The text parameters. The color does not affect the layout and is ignored.
+         * @return The layout. It stays valid until the next call to GetLayout or Clear.
+         */
+        static const TextLayout& GetLayout(const std::string& text, const Ref<Font>& font, const Renderer2D::TextParams& textParams);
+
+        /**
+         * @brief Builds the layout of a text without going through the cache.
+         * @param text The text to lay out.
+         * @param font The font used to draw the text.
+         * @param textParams The text parameters. The color does not affect the layout and is ignored.
+         * @param layout The layout to fill. Its previous quads are discarded.
+         */
+        static void BuildLayout(const std::string& text, const Font& font, const Renderer2D::TextParams& textParams, TextLayout& layout);
+
+        /**
+         * @brief Sets the maximum amount of memory used by the cached layouts, evicting layouts if needed.
+         * @param bytes The memory budget in bytes.
+         */
+        static void SetMemoryBudget(size_t bytes);
+
+        /**
+         * @brief Gets the maximum amount of memory used by the cached layouts.
+         * @return The memory budget in bytes.
+         */
+        static size_t GetMemoryBudget() { return s_MemoryBudget; }
+
+        /**
+         * @brief Gets the amount of memory currently used by the cached layouts.
+         * @return The memory usage in bytes.
+         */
+        static size_t GetMemoryUsage() { return s_MemoryUsage; }
+
+        /**
+         * @brief Gets the number of cached layouts.
+         * @return The number of entries.
+         */
+        static size_t GetEntryCount() { return s_Entries.size(); }
+
+        /**
+         * @brief Removes every cached layout.
+         */
+        static void Clear();
+
+        static const TextLayoutCacheStats& GetStats() { return s_Stats; }
+        static void ResetStats() { s_Stats.Reset(); }
+
+    private:
+        struct Entry
+        {
+            uint64_t Hash = 0;
+            std::weak_ptr<Font> FontRef; // Detects a new font allocated at the address of a destroyed one
+            const Font* FontPtr = nullptr;
+            std::string Text;
+            float Size = 0.0f;
+            float Kerning = 0.0f;
+            float LineSpacing = 0.0f;
+            Renderer2D::TextAlignment Alignment = Renderer2D::TextAlignment::Left;
+            TextLayout Layout;
+            size_t MemoryUsage = 0;
+
+            bool Matches(const std::string& text, const Ref<Font>& font, const Renderer2D::TextParams& textParams) const;
+        };
+
+        using EntryList = std::list<Entry>;
+
+        static uint64_t HashKey(const std::string& text, const Font* font, const Renderer2D::TextParams& textParams);
+        static void EvictToBudget();
+        static void Erase(EntryList::iterator it);
+
+        static EntryList s_Entries; ///< Cached layouts, most recently used first.
+        static std::unordered_map<uint64_t, EntryList::iterator> s_Lookup;
+        static size_t s_MemoryBudget;
+        static size_t s_MemoryUsage;
+        static TextLayoutCacheStats s_Stats;
+    };
+
+    /** @} */
+}
@@ -4,23 +4,32 @@
 #include "CoffeeEngine/IO/ImportData/Texture2DImportData.h"
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
-#include "CoffeeEngine/Renderer/Mesh.h"
-#include "CoffeeEngine/Renderer/Shader.h"
-#include "CoffeeEngine/Embedded/EquirectToCubemap.inl"
-#include "CoffeeEngine/Embedded/IrradianceConvolution.inl"
-#include "CoffeeEngine/Embedded/PreFilterConvolutionShader.inl"
-#include "CoffeeEngine/Renderer/VertexArray.h"
-#include "CoffeeEngine/Renderer/Buffer.h"
-#include "CoffeeEngine/Scene/PrimitiveMesh.h"
-
-#include <glm/ext/matrix_clip_space.hpp>
-#include <glm/ext/matrix_transform.hpp>
+#include "CoffeeEngine/Renderer/IBLBaker.h"
+#include "CoffeeEngine/Renderer/TextureDecoder.h"
+#include "CoffeeEngine/Renderer/TextureStreaming.h"
+
 #include <stdint.h>
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
 #include <glad/glad.h>
 #include <stb_image.h>
 #include <tracy/Tracy.hpp>
 
+// glad is generated for the core profile, which lacks the S3TC formats of EXT_texture_compression_s3tc and EXT_texture_sRGB
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
 namespace Coffee {
 
     GLenum ImageFormatToOpenGLInternalFormat(ImageFormat format)
@@ -41,6 +50,14 @@ namespace Coffee {
             case ImageFormat::RGB32F: return GL_RGB32F; break;
             case ImageFormat::RGBA32F: return GL_RGBA32F; break;
             case ImageFormat::DEPTH24STENCIL8: return GL_DEPTH24_STENCIL8; break;
+            case ImageFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
+            case ImageFormat::BC1_SRGB: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT; break;
+            case ImageFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+            case ImageFormat::BC3_SRGB: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+            case ImageFormat::BC4: return GL_COMPRESSED_RED_RGTC1; break;
+            case ImageFormat::BC5: return GL_COMPRESSED_RG_RGTC2; break;
+            case ImageFormat::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+            case ImageFormat::BC7_SRGB: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; break;
         }
     }
 
@@ -62,6 +79,14 @@ namespace Coffee {
             case ImageFormat::RGB32F: return GL_RGB; break;
             case ImageFormat::RGBA32F: return GL_RGBA; break;
             case ImageFormat::DEPTH24STENCIL8: return GL_DEPTH_STENCIL; break;
+            case ImageFormat::BC1: return GL_RGB; break;
+            case ImageFormat::BC1_SRGB: return GL_RGB; break;
+            case ImageFormat::BC3: return GL_RGBA; break;
+            case ImageFormat::BC3_SRGB: return GL_RGBA; break;
+            case ImageFormat::BC4: return GL_RED; break;
+            case ImageFormat::BC5: return GL_RG; break;
+            case ImageFormat::BC7: return GL_RGBA; break;
+            case ImageFormat::BC7_SRGB: return GL_RGBA; break;
         }
     }
 
@@ -83,6 +108,44 @@ namespace Coffee {
             case ImageFormat::RGB32F: return 3; break;
             case ImageFormat::RGBA32F: return 4; break;
             case ImageFormat::DEPTH24STENCIL8: return 1; break;
+            case ImageFormat::BC1: return 3; break;
+            case ImageFormat::BC1_SRGB: return 3; break;
+            case ImageFormat::BC3: return 4; break;
+            case ImageFormat::BC3_SRGB: return 4; break;
+            case ImageFormat::BC4: return 1; break;
+            case ImageFormat::BC5: return 2; break;
+            case ImageFormat::BC7: return 4; break;
+            case ImageFormat::BC7_SRGB: return 4; break;
+        }
+    }
+
+    GLenum ImageFormatToOpenGLType(ImageFormat format)
+    {
+        switch(format)
+        {
+            case ImageFormat::R16F:
+            case ImageFormat::RG16F:
+            case ImageFormat::RGB16F:
+            case ImageFormat::RGBA16F:
+            case ImageFormat::R32F:
+            case ImageFormat::RGB32F:
+            case ImageFormat::RGBA32F:
+                return GL_FLOAT;
+            default:
+                return GL_UNSIGNED_BYTE;
+        }
+    }
+
+    ImageFormat BlockFormatToImageFormat(BlockFormat format, bool srgb)
+    {
+        switch(format)
+        {
+            case BlockFormat::BC1: return srgb ? ImageFormat::BC1_SRGB : ImageFormat::BC1; break;
+            case BlockFormat::BC3: return srgb ? ImageFormat::BC3_SRGB : ImageFormat::BC3; break;
+            case BlockFormat::BC4: return ImageFormat::BC4; break;
+            case BlockFormat::BC5: return ImageFormat::BC5; break;
+            case BlockFormat::BC7: return srgb ? ImageFormat::BC7_SRGB : ImageFormat::BC7; break;
+            case BlockFormat::None: return srgb ? ImageFormat::SRGBA8 : ImageFormat::RGBA8; break;
         }
     }
     
@@ -125,7 +188,9 @@ namespace Coffee {
     {
         ZoneScoped;
 
-        InitializeTexture2D();
+        // Textures deserialized to reload their CPU data have no GPU storage
+        if (!ResourceResidency::IsLoadingCPUDataOnly())
+            InitializeTexture2D();
     }
 
     Texture2D::Texture2D(const std::filesystem::path& path, bool srgb)
@@ -152,7 +217,7 @@ namespace Coffee {
             m_Name = m_FilePath.filename().string();
             m_Properties.srgb = texture2DImportData.sRGB;
 
-            LoadFromFile(m_FilePath);
+            LoadFromFile(m_FilePath, texture2DImportData.usage, texture2DImportData.compress, texture2DImportData.highQuality);
     
             m_UUID = texture2DImportData.uuid;
         }
@@ -162,7 +227,7 @@ namespace Coffee {
             m_Name = m_FilePath.filename().string();
             m_Properties.srgb = texture2DImportData.sRGB;
 
-            LoadFromFile(m_FilePath);
+            LoadFromFile(m_FilePath, texture2DImportData.usage, texture2DImportData.compress, texture2DImportData.highQuality);
 
             texture2DImportData.uuid = m_UUID;
         }
@@ -172,12 +237,18 @@ namespace Coffee {
     {
         ZoneScoped;
 
-        glDeleteTextures(1, &m_textureID);
+        TextureStreaming::Unregister(m_StreamingHandle);
+
+        // Textures deserialized on a job to reload their CPU data never had GPU storage
+        if (m_textureID != 0)
+            glDeleteTextures(1, &m_textureID);
 
         if(m_Data.size() > 0)
         {
             m_Data.clear();
         }
+
+        ResourceResidency::AddResidentBytes(ResourceType::Texture2D, -(int64_t)m_ResidentBytes);
     }
 
     void Texture2D::Bind(uint32_t slot)
@@ -215,10 +286,84 @@ namespace Coffee {
 
         GLenum format = ImageFormatToOpenGLFormat(m_Properties.Format);
         //COFFEE_ASSERT(size == m_Width * m_Height * ImageFormatToChannelCount(m_Properties.Format), "Data must be entire texture!");
-        glTextureSubImage2D(m_textureID, 0, 0, 0, m_Width, m_Height, format, GL_UNSIGNED_BYTE, data);
+        glTextureSubImage2D(m_textureID, 0, 0, 0, m_Width, m_Height, format, ImageFormatToOpenGLType(m_Properties.Format), data);
         glGenerateTextureMipmap(m_textureID);
     }
 
+    const std::vector<unsigned char>& Texture2D::GetData()
+    {
+        if (!IsCPUDataResident())
+            LoadCPUData();
+
+        return m_Data;
+    }
+
+    const CompressedTexture& Texture2D::GetCompressedData()
+    {
+        if (!IsCPUDataResident())
+            LoadCPUData();
+
+        return m_Compressed;
+    }
+
+    void Texture2D::AcquireCPUData()
+    {
+        m_CPUDataUsers++;
+
+        if (!IsCPUDataResident())
+            LoadCPUData();
+    }
+
+    void Texture2D::ReleaseCPUData()
+    {
+        COFFEE_CORE_ASSERT(m_CPUDataUsers > 0, "Texture2D::ReleaseCPUData called without a matching AcquireCPUData!");
+
+        if (m_CPUDataUsers > 0 && --m_CPUDataUsers == 0)
+            TrimCPUData();
+    }
+
+    void Texture2D::TrimCPUData()
+    {
+        if (m_CPUDataUsers > 0 || (m_Data.empty() && m_Compressed.Data.empty()) || ResourceResidency::GetRetainCPUData(ResourceType::Texture2D))
+            return;
+
+        // Without a cache file the pixels could not be reloaded
+        if (!std::filesystem::exists(CacheManager::GetCachedFilePath(m_UUID, ResourceType::Texture2D)))
+            return;
+
+        std::vector<unsigned char>().swap(m_Data);
+        std::vector<uint8_t>().swap(m_Compressed.Data);
+        UpdateResidentBytes();
+    }
+
+    void Texture2D::LoadCPUData()
+    {
+        ZoneScoped;
+
+        Ref<Texture2D> cached;
+        {
+            ResourceResidency::CPUDataLoadScope scope;
+            cached = ResourceImporter().ImportFromCache<Texture2D>(m_UUID);
+        }
+
+        if (!cached)
+        {
+            COFFEE_CORE_ERROR("Texture2D::LoadCPUData: Could not reload the data of texture {0} from the cache", m_Name);
+            return;
+        }
+
+        m_Data = std::move(cached->m_Data);
+        m_Compressed.Data = std::move(cached->m_Compressed.Data);
+        UpdateResidentBytes();
+    }
+
+    void Texture2D::UpdateResidentBytes()
+    {
+        size_t bytes = m_Data.capacity() + m_Compressed.Data.capacity();
+        ResourceResidency::AddResidentBytes(ResourceType::Texture2D, (int64_t)bytes - (int64_t)m_ResidentBytes);
+        m_ResidentBytes = bytes;
+    }
+
     Ref<Texture2D> Texture2D::Load(const std::filesystem::path& path)
     {
         return ResourceLoader::Load<Texture2D>(path);
@@ -234,20 +379,38 @@ namespace Coffee {
         return CreateRef<Texture2D>(properties);
     }
 
-    void Texture2D::LoadFromFile(const std::filesystem::path& path)
+    static TextureDecodeSettings MakeDecodeSettings(bool srgb, TextureUsage usage, bool compress, bool highQuality)
+    {
+        TextureDecodeSettings settings;
+        settings.Compress = compress;
+        settings.Usage = usage;
+        settings.SRGB = srgb;
+        settings.HighQuality = highQuality;
+        return settings;
+    }
+
+    void Texture2D::Prefetch(const Texture2DImportData& importData)
+    {
+        // Cached textures are loaded from their blocks, there is nothing to decode
+        if (importData.IsValid() && std::filesystem::exists(importData.cachedPath))
+            return;
+
+        TextureDecoder::Prefetch(importData.originalPath, MakeDecodeSettings(importData.sRGB, importData.usage, importData.compress, importData.highQuality));
+    }
+
+    void Texture2D::LoadFromFile(const std::filesystem::path& path, TextureUsage usage, bool compress, bool highQuality)
     {
-        int nrComponents;
-        stbi_set_flip_vertically_on_load(true);
-        unsigned char* data = stbi_load(m_FilePath.string().c_str(), &m_Width, &m_Height, &nrComponents, 0);
+        TextureDecodeSettings settings = MakeDecodeSettings(m_Properties.srgb, usage, compress, highQuality);
+
+        // Uses the decode prefetched by the importer if there is one, the mips are already compressed there
+        DecodedTexture decoded = TextureDecoder::Acquire(m_FilePath, settings);
 
+        m_Width = decoded.Width, m_Height = decoded.Height;
         m_Properties.Width = m_Width, m_Properties.Height = m_Height;
 
-        if(data)
+        if(decoded.IsValid())
         {
-            m_Data = std::vector<unsigned char>(data, data + m_Width * m_Height * nrComponents);
-            stbi_image_free(data);
-
-            switch (nrComponents)
+            switch (decoded.Channels)
             {
                 case 1:
                     m_Properties.Format = ImageFormat::R8;
@@ -260,25 +423,79 @@ namespace Coffee {
                 break;
             }
 
+            if (decoded.Compressed.Format != BlockFormat::None)
+            {
+                m_Compressed = std::move(decoded.Compressed);
+                m_Properties.Format = BlockFormatToImageFormat(m_Compressed.Format, m_Properties.srgb);
+            }
+            else
+            {
+                m_Data = std::move(decoded.Pixels);
+            }
+
+            m_DataSize = m_Data.size() + m_Compressed.Data.size();
+            UpdateResidentBytes();
+
             InitializeTexture2D();
-            SetData(m_Data.data(), m_Data.size());
+            UploadData();
         }
         else
         {
-            COFFEE_CORE_ERROR("Failed to load texture: {0} (REASON: {1})", m_FilePath.string(), stbi_failure_reason());
+            COFFEE_CORE_ERROR("Failed to load texture: {0} (REASON: {1})", m_FilePath.string(), decoded.Error);
             m_textureID = 0; // Set texture ID to 0 to indicate failure
         }
     }
 
+    void Texture2D::UploadData()
+    {
+        ZoneScoped;
+
+        if (!IsCompressed())
+        {
+            SetData(m_Data.data(), m_Data.size());
+            return;
+        }
+
+        // Streamed textures start with their small mips only, the others are loaded when the renderer needs them
+        if (m_StreamingHandle == InvalidStreamingHandle)
+            m_StreamingHandle = TextureStreaming::Register(*this);
+
+        if (m_StreamingHandle != InvalidStreamingHandle)
+        {
+            // Nothing is resident yet, every mip comes from the CPU data
+            m_FirstResidentMip = m_Compressed.GetMipCount();
+            SetResidentMips(TextureStreaming::GetResidentMip(m_StreamingHandle), &m_Compressed);
+            return;
+        }
+
+        // Every mip comes from the cache, there is nothing left for glGenerateMipmap to do
+        GLenum internalFormat = ImageFormatToOpenGLInternalFormat(m_Properties.Format);
+        for (uint32_t mip = 0; mip < m_Compressed.GetMipCount(); mip++)
+        {
+            uint32_t width = std::max<uint32_t>(m_Compressed.Width >> mip, 1);
+            uint32_t height = std::max<uint32_t>(m_Compressed.Height >> mip, 1);
+            glCompressedTextureSubImage2D(m_textureID, mip, 0, 0, width, height, internalFormat,
+                                          m_Compressed.GetMipSize(mip), m_Compressed.Data.data() + m_Compressed.MipOffsets[mip]);
+        }
+    }
+
     void Texture2D::InitializeTexture2D()
     {
         int mipLevels = m_Properties.GenerateMipmaps ? 1 + floor(log2(std::max(m_Width, m_Height))) : 1;
 
+        // Compressed textures allocate exactly the mips stored in the cache
+        if (IsCompressed())
+            mipLevels = m_Compressed.GetMipCount();
+
+        CreateStorage(mipLevels, m_Width, m_Height);
+    }
+
+    void Texture2D::CreateStorage(uint32_t mipLevels, uint32_t width, uint32_t height)
+    {
         GLenum internalFormat = ImageFormatToOpenGLInternalFormat(m_Properties.Format);
-        GLenum format = ImageFormatToOpenGLFormat(m_Properties.Format);
 
         glCreateTextures(GL_TEXTURE_2D, 1, &m_textureID);
-        glTextureStorage2D(m_textureID, mipLevels, internalFormat, m_Width, m_Height);
+        glTextureStorage2D(m_textureID, mipLevels, internalFormat, width, height);
 
         GLenum wrap = TextureWrapToOpenGL(m_Properties.Wrapping);
         glTextureParameteri(m_textureID, GL_TEXTURE_WRAP_S, wrap);
@@ -295,18 +512,44 @@ namespace Coffee {
         glTextureParameterf(m_textureID, GL_TEXTURE_MAX_ANISOTROPY, 16.0f);
     }
 
-    static glm::mat4 captureProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
-    static glm::mat4 captureViews[] =
+    void Texture2D::SetResidentMips(uint32_t firstMip, const CompressedTexture* source)
     {
-        glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-        glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-        glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f)),
-        glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f)),
-        glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-        glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f))
-        };
+        ZoneScoped;
+
+        uint32_t mipCount = m_Compressed.GetMipCount();
+        firstMip = std::min(firstMip, mipCount - 1);
+        if (firstMip == m_FirstResidentMip)
+            return;
+
+        uint32_t previousID = m_textureID;
+        uint32_t previousFirstMip = m_FirstResidentMip;
+
+        // Immutable storage cannot grow or shrink, the texture is recreated with the new chain
+        CreateStorage(mipCount - firstMip, std::max<uint32_t>(m_Width >> firstMip, 1), std::max<uint32_t>(m_Height >> firstMip, 1));
 
-    Ref<Mesh> Cubemap::m_CubeMesh;
+        GLenum internalFormat = ImageFormatToOpenGLInternalFormat(m_Properties.Format);
+        for (uint32_t mip = firstMip; mip < mipCount; mip++)
+        {
+            uint32_t width = std::max<uint32_t>(m_Width >> mip, 1);
+            uint32_t height = std::max<uint32_t>(m_Height >> mip, 1);
+
+            // Resident mips are copied on the GPU, only the new ones are uploaded
+            if (previousID != 0 && mip >= previousFirstMip)
+            {
+                glCopyImageSubData(previousID, GL_TEXTURE_2D, mip - previousFirstMip, 0, 0, 0,
+                                   m_textureID, GL_TEXTURE_2D, mip - firstMip, 0, 0, 0, width, height, 1);
+            }
+            else
+            {
+                COFFEE_CORE_ASSERT(source && !source->Data.empty(), "Texture2D::SetResidentMips: The mips to load have no data!");
+                glCompressedTextureSubImage2D(m_textureID, mip - firstMip, 0, 0, width, height, internalFormat,
+                                              source->GetMipSize(mip), source->Data.data() + source->MipOffsets[mip]);
+            }
+        }
+
+        glDeleteTextures(1, &previousID);
+        m_FirstResidentMip = firstMip;
+    }
 
     Cubemap::Cubemap()
         : Texture(ResourceType::Cubemap)
@@ -343,6 +586,7 @@ namespace Coffee {
         ZoneScoped;
         glDeleteTextures(1, &m_CubeMapID);
         glDeleteTextures(1, &m_IrradianceMapID);
+        glDeleteTextures(1, &m_PrefilteredMapID);
     }
 
     void Cubemap::Bind(uint32_t slot)
@@ -362,186 +606,71 @@ namespace Coffee {
 
     void Cubemap::LoadFromFile(const std::filesystem::path& path)
     {
+        ZoneScoped;
+
         m_FilePath = path;
         m_Name = path.filename().string();
 
         m_Properties.srgb = false;
 
-        LoadEquirectangularMapFromFile(path);
-        GenerateIrradianceMap();
-        GeneratePrefilteredMap();
-    }
-
-    void Cubemap::LoadEquirectangularMapFromFile(const std::filesystem::path& path)
-    {
-        int nrChannels;
-        int width, height;
-        stbi_set_flip_vertically_on_load(true);
-        float* data = stbi_loadf(path.string().c_str(), &width, &height, &nrChannels, 0);
-        if (!data) {
-            COFFEE_CORE_ERROR("Failed to load cubemap texture: {0} (REASON: {1})", m_FilePath.string(), stbi_failure_reason());
-            return;
-        }
-
-        switch (nrChannels)
+        // Baked on the CPU the first time, then read from the IBL cache
+        BakedEnvironment environment = IBLBaker::LoadOrBake(path, m_BakeKey);
+        if (!environment.IsValid())
         {
-            case 1:
-                m_Properties.Format = ImageFormat::R32F;
-                break;
-            case 3:
-                m_Properties.Format = ImageFormat::RGB32F;
-                break;
-            case 4:
-                m_Properties.Format = ImageFormat::RGBA32F;
-                break;
+            COFFEE_CORE_ERROR("Failed to load cubemap texture: {0}", path.string());
+            return;
         }
 
-        EquirectToCubemap(data, width, height);
-
-        stbi_image_free(data);
+        UploadBakedEnvironment(environment);
     }
 
-    void Cubemap::EquirectToCubemap(float* data, int width, int height)
+    static uint32_t CreateCubemapTexture(uint32_t size, uint32_t mipCount, GLenum minFilter)
     {
-        // Load the equirectangular image to the GPU
-        uint32_t equirectTextureID;
-        glCreateTextures(GL_TEXTURE_2D, 1, &equirectTextureID);
-        glTextureParameteri(equirectTextureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTextureParameteri(equirectTextureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTextureParameteri(equirectTextureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTextureParameteri(equirectTextureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTextureStorage2D(equirectTextureID, 1, GL_RGB32F, width, height);
-        glTextureSubImage2D(equirectTextureID, 0, 0, 0, width, height, GL_RGB, GL_FLOAT, data);
-        
-        // Resolution of the cubemap faces
-        int cubemapFaceSize = width / 4;
-
-        m_Properties.Width = cubemapFaceSize;
-        m_Properties.Height = cubemapFaceSize;
-
-        glCreateFramebuffers(1, &fbo);
-        glCreateRenderbuffers(1, &rbo);
-        glNamedRenderbufferStorage(rbo, GL_DEPTH_COMPONENT24, cubemapFaceSize, cubemapFaceSize);
-        glNamedFramebufferRenderbuffer(fbo, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rbo);
-
-        int mipLevels = 1 + floor(log2(std::max(cubemapFaceSize, cubemapFaceSize)));
-
-        // Create the cubemap texture
-        glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_CubeMapID);
-        glTextureStorage2D(m_CubeMapID, mipLevels, GL_RGB32F, cubemapFaceSize, cubemapFaceSize);
-
-        glTextureParameteri(m_CubeMapID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTextureParameteri(m_CubeMapID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTextureParameteri(m_CubeMapID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTextureParameteri(m_CubeMapID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTextureParameteri(m_CubeMapID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-        static Ref<Shader> shader = CreateRef<Shader>("EquirectangularToCubemap", equirectToCubemapSource);
-        m_CubeMesh = PrimitiveMesh::CreateCube({-1.0f, -1.0f, -1.0f});
-
-        shader->Bind();
-        shader->setMat4("projection", captureProjection);
-        shader->setInt("equirectangularMap", 0);
-        glBindTextureUnit(0, equirectTextureID);
-
-        glViewport(0, 0, cubemapFaceSize, cubemapFaceSize);
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-        for (uint32_t i = 0; i < 6; ++i)
-        {
-            shader->setMat4("view", captureViews[i]);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, m_CubeMapID, 0);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            m_CubeMesh->GetVertexArray()->Bind();
-            glDrawElements(GL_TRIANGLES, m_CubeMesh->GetVertexArray()->GetIndexBuffer()->GetCount(), GL_UNSIGNED_INT, 0);
-        }
-
-        glGenerateTextureMipmap(m_CubeMapID);
-
-        glDeleteTextures(1, &equirectTextureID);
+        uint32_t textureID;
+        glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &textureID);
+        glTextureStorage2D(textureID, mipCount, GL_RGB32F, size, size);
+        glTextureParameteri(textureID, GL_TEXTURE_MIN_FILTER, minFilter);
+        glTextureParameteri(textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(textureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(textureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(textureID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        return textureID;
     }
 
-    void Cubemap::GenerateIrradianceMap()
+    // Uploads the six faces of every mip, stored one mip after the other
+    static void UploadCubemapMips(uint32_t textureID, uint32_t size, uint32_t mipCount, const float* data)
     {
-        glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_IrradianceMapID);
-        glTextureStorage2D(m_IrradianceMapID, 1, GL_RGB32F, m_IrradianceMapResolution, m_IrradianceMapResolution);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-        glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-        glNamedRenderbufferStorage(rbo, GL_DEPTH_COMPONENT24, m_IrradianceMapResolution, m_IrradianceMapResolution);
-
-        static Ref<Shader> irradianceShader = CreateRef<Shader>("IrradianceConvolution", irradianceConvolutionSource);
-
-        irradianceShader->Bind();
-        irradianceShader->setInt("environmentMap", 0);
-        irradianceShader->setMat4("projection", captureProjection);
-        glBindTextureUnit(0, m_CubeMapID);
-
-        glViewport(0, 0, m_IrradianceMapResolution, m_IrradianceMapResolution);
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-        for (uint32_t i = 0; i < 6; ++i)
+        for (uint32_t mip = 0; mip < mipCount; mip++)
         {
-            irradianceShader->setMat4("view", captureViews[i]);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, m_IrradianceMapID, 0);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-            m_CubeMesh->GetVertexArray()->Bind();
-            glDrawElements(GL_TRIANGLES, m_CubeMesh->GetVertexArray()->GetIndexBuffer()->GetCount(), GL_UNSIGNED_INT, 0);
+            uint32_t mipSize = std::max(size >> mip, 1u);
+            glTextureSubImage3D(textureID, mip, 0, 0, 0, mipSize, mipSize, 6, GL_RGB, GL_FLOAT, data);
+            data += size_t(mipSize) * mipSize * 3 * 6;
         }
     }
 
-    void Cubemap::GeneratePrefilteredMap()
+    void Cubemap::UploadBakedEnvironment(const BakedEnvironment& environment)
     {
-        unsigned int maxMipLevels = 5;
-
-        glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_PrefilteredMapID);
-        glTextureStorage2D(m_PrefilteredMapID, maxMipLevels, GL_RGB32F, m_PrefilteredMapResolution, m_PrefilteredMapResolution);
-        glTextureParameteri(m_PrefilteredMapID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTextureParameteri(m_PrefilteredMapID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTextureParameteri(m_PrefilteredMapID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-        glTextureParameteri(m_PrefilteredMapID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTextureParameteri(m_PrefilteredMapID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        ZoneScoped;
 
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-        glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-        glNamedRenderbufferStorage(rbo, GL_DEPTH_COMPONENT24, m_PrefilteredMapResolution, m_PrefilteredMapResolution);
+        glDeleteTextures(1, &m_CubeMapID);
+        glDeleteTextures(1, &m_IrradianceMapID);
+        glDeleteTextures(1, &m_PrefilteredMapID);
 
-        static Ref<Shader> prefilterShader = CreateRef<Shader>("PreFilterConvolution", PreFilterConvolutionSource);
+        m_Properties.Format = ImageFormat::RGB32F;
+        m_Properties.Width = environment.FaceSize;
+        m_Properties.Height = environment.FaceSize;
 
-        prefilterShader->Bind();
-        prefilterShader->setInt("environmentMap", 0);
-        prefilterShader->setMat4("projection", captureProjection);
-        glBindTextureUnit(0, m_CubeMapID);
+        // Only the first mip is baked, the skybox mips are a plain box filter
+        uint32_t mipLevels = 1 + (uint32_t)std::floor(std::log2(environment.FaceSize));
+        m_CubeMapID = CreateCubemapTexture(environment.FaceSize, mipLevels, GL_LINEAR_MIPMAP_LINEAR);
+        UploadCubemapMips(m_CubeMapID, environment.FaceSize, 1, environment.Environment.data());
+        glGenerateTextureMipmap(m_CubeMapID);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-        for (unsigned int mip = 0; mip < maxMipLevels; mip++)
-        {
-            // Resize framebuffer according to mip-level size.
-            unsigned int mipWidth = m_PrefilteredMapResolution * std::pow(0.5, mip);
-            unsigned int mipHeight = m_PrefilteredMapResolution * std::pow(0.5, mip);
-            glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mipWidth, mipHeight);
-            glViewport(0, 0, mipWidth, mipHeight);
-
-            float roughness = (float)mip / (float)(maxMipLevels - 1);
-            prefilterShader->setFloat("roughness", roughness);
-            for (uint32_t i = 0; i < 6; ++i)
-            {
-                prefilterShader->setMat4("view", captureViews[i]);
-                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, m_PrefilteredMapID, mip);
-                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        m_IrradianceMapID = CreateCubemapTexture(environment.IrradianceSize, 1, GL_LINEAR);
+        UploadCubemapMips(m_IrradianceMapID, environment.IrradianceSize, 1, environment.Irradiance.data());
 
-                m_CubeMesh->GetVertexArray()->Bind();
-                glDrawElements(GL_TRIANGLES, m_CubeMesh->GetVertexArray()->GetIndexBuffer()->GetCount(), GL_UNSIGNED_INT, 0);
-            }
-        }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glDeleteFramebuffers(1, &fbo);
-        glDeleteRenderbuffers(1, &rbo);
+        m_PrefilteredMapID = CreateCubemapTexture(environment.PrefilteredSize, environment.PrefilteredMipCount, GL_LINEAR_MIPMAP_LINEAR);
+        UploadCubemapMips(m_PrefilteredMapID, environment.PrefilteredSize, environment.PrefilteredMipCount, environment.Prefiltered.data());
     }
 
     Ref<Cubemap> Cubemap::Load(const std::filesystem::path& path)
@@ -2,7 +2,11 @@
 
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/IO/Resource.h"
+#include "CoffeeEngine/IO/ResourceResidency.h"
 #include "CoffeeEngine/IO/Serialization/FilesystemPathSerialization.h"
+#include "CoffeeEngine/Renderer/IBLBaker.h"
+#include "CoffeeEngine/Renderer/TextureCompression.h"
+#include "CoffeeEngine/Renderer/TextureStreamingPolicy.h"
 
 #include <cereal/access.hpp>
 #include <cereal/types/polymorphic.hpp>
@@ -20,6 +24,7 @@
 namespace Coffee {
 
     class ImportData;
+    struct Texture2DImportData;
 }
 
 namespace Coffee {
@@ -39,7 +44,15 @@ namespace Coffee {
         R32F,
         RGB32F,
         RGBA32F,
-        DEPTH24STENCIL8
+        DEPTH24STENCIL8,
+        BC1,
+        BC1_SRGB,
+        BC3,
+        BC3_SRGB,
+        BC4,
+        BC5,
+        BC7,
+        BC7_SRGB
     };
 
     enum class TextureWrap
@@ -123,6 +136,10 @@ namespace Coffee {
         Texture2D(ImportData& importData);
         ~Texture2D();
 
+        // A copy would report the resident bytes a second time and delete the GL texture twice
+        Texture2D(const Texture2D&) = delete;
+        Texture2D& operator=(const Texture2D&) = delete;
+
         void Bind(uint32_t slot) override;
         void Resize(uint32_t width, uint32_t height);
         std::pair<uint32_t, uint32_t> GetSize() { return std::make_pair(m_Width, m_Height); };
@@ -134,30 +151,107 @@ namespace Coffee {
         void Clear(glm::vec4 color);
         void SetData(void* data, uint32_t size);
 
+        /**
+         * @brief Gets the pixels the texture was loaded from. They are reloaded from the cache if they were dropped.
+         * @return The pixel data, empty for textures created at runtime and for block compressed textures.
+         */
+        const std::vector<unsigned char>& GetData();
+
+        /**
+         * @brief Gets the block compressed mip chain of the texture. It is reloaded from the cache if it was dropped.
+         * @return The compressed texture, with BlockFormat::None if the texture is not compressed.
+         */
+        const CompressedTexture& GetCompressedData();
+
+        /**
+         * @brief Checks whether the texture was imported block compressed.
+         * @return True if the GPU storage uses a BCn format.
+         */
+        bool IsCompressed() const { return m_Compressed.Format != BlockFormat::None; }
+
+        /**
+         * @brief Keeps the pixels in memory until ReleaseCPUData, reloading them from the cache if needed.
+         */
+        void AcquireCPUData();
+
+        /**
+         * @brief Releases a hold taken with AcquireCPUData. The pixels are dropped when no hold is left.
+         */
+        void ReleaseCPUData();
+
+        /**
+         * @brief Drops the pixels if nothing holds them and the residency policy allows it.
+         */
+        void TrimCPUData() override;
+
+        /**
+         * @brief Checks whether the pixels are in memory.
+         * @return True if the CPU data is resident.
+         */
+        bool IsCPUDataResident() const { return m_DataSize == 0 || !m_Data.empty() || !m_Compressed.Data.empty(); }
+
+        /**
+         * @brief Gets the finest mip in GPU memory. Streamed textures start with their small mips only.
+         * @return The mip index, 0 when the texture is fully resident.
+         */
+        uint32_t GetFirstResidentMip() const { return m_FirstResidentMip; }
+
+        /**
+         * @brief Gets the handle of the texture in TextureStreaming.
+         * @return The handle, InvalidStreamingHandle if the texture is not streamed.
+         */
+        StreamingHandle GetStreamingHandle() const { return m_StreamingHandle; }
+
         static Ref<Texture2D> Load(const std::filesystem::path& path);
         static Ref<Texture2D> Create(uint32_t width, uint32_t height, ImageFormat format);
         static Ref<Texture2D> Create(const TextureProperties& properties);
 
+        /**
+         * @brief Starts decoding the source image of a texture on the job system, so loading it later does not wait for the decode.
+         * @param importData The import settings of the texture. Textures that are already cached are skipped.
+         */
+        static void Prefetch(const Texture2DImportData& importData);
+
     private:
-        void LoadFromFile(const std::filesystem::path& path);
+        void LoadFromFile(const std::filesystem::path& path, TextureUsage usage = TextureUsage::Color, bool compress = false, bool highQuality = false);
         void InitializeTexture2D();
+        void CreateStorage(uint32_t mipLevels, uint32_t width, uint32_t height);
+        void UploadData();
+
+        /**
+         * @brief Recreates the GPU texture with the mips from firstMip, keeping the ones already resident.
+         * @param firstMip The finest mip to make resident.
+         * @param source The mip chain to upload the mips that are not resident from, can be null when evicting.
+         */
+        void SetResidentMips(uint32_t firstMip, const CompressedTexture* source);
+        void LoadCPUData();
+        void UpdateResidentBytes();
 
         friend class cereal::access;
+        friend class TextureStreaming;
 
         template<class Archive>
-        void save(Archive& archive) const
+        void save(Archive& archive, std::uint32_t const version) const
         {
+            COFFEE_CORE_ASSERT(IsCPUDataResident(), "Texture2D::save: The CPU data of the texture was dropped, acquire it before saving!");
             archive(m_Properties, m_Data, m_Width, m_Height, cereal::base_class<Texture>(this));
+            archive(m_Compressed);
         }
 
         template <class Archive>
-        void load(Archive& archive)
+        void load(Archive& archive, std::uint32_t const version)
         {
             archive(m_Properties, m_Data, m_Width, m_Height, cereal::base_class<Texture>(this));
+
+            if (version >= 1)
+                archive(m_Compressed);
+
+            m_DataSize = m_Data.size() + m_Compressed.Data.size();
+            UpdateResidentBytes();
         }
 
         template <class Archive>
-        static void load_and_construct(Archive& data, cereal::construct<Texture2D>& construct)
+        static void load_and_construct(Archive& data, cereal::construct<Texture2D>& construct, std::uint32_t const version)
         {
             TextureProperties properties;
             data(properties);
@@ -165,17 +259,32 @@ namespace Coffee {
 
             data(construct->m_Data, construct->m_Width, construct->m_Height,
                  cereal::base_class<Texture>(construct.ptr()));
+
+            if (version >= 1)
+                data(construct->m_Compressed);
+
             construct->m_Properties = properties;
-            construct->SetData(construct->m_Data.data(), construct->m_Data.size());
+            construct->m_DataSize = construct->m_Data.size() + construct->m_Compressed.Data.size();
+            construct->UpdateResidentBytes();
+
+            // Reloading dropped CPU data from the cache must not upload the texture again
+            if (!ResourceResidency::IsLoadingCPUDataOnly())
+                construct->UploadData();
         }
     private:
         TextureProperties m_Properties;
         std::vector<unsigned char> m_Data;
-        uint32_t m_textureID;
+        CompressedTexture m_Compressed; ///< The block compressed mip chain, replaces m_Data when the texture is imported compressed.
+        uint32_t m_textureID = 0;
         int m_Width, m_Height;
-    };
 
-    class Mesh;
+        size_t m_DataSize = 0; ///< The size of the pixel and block data, kept when the CPU data is dropped.
+        uint32_t m_CPUDataUsers = 0; ///< The number of holds on the CPU data.
+        size_t m_ResidentBytes = 0; ///< The CPU bytes reported to ResourceResidency.
+
+        StreamingHandle m_StreamingHandle = InvalidStreamingHandle; ///< The handle in TextureStreaming, if the texture is streamed.
+        uint32_t m_FirstResidentMip = 0; ///< The mip of the full chain stored in the level 0 of the GPU texture.
+    };
 
     class Cubemap : public Texture
     {
@@ -201,154 +310,67 @@ namespace Coffee {
         static Ref<Cubemap> Create(const std::filesystem::path& path);
     private:
         void LoadFromFile(const std::filesystem::path& path);
-        void LoadFromData(const std::vector<float>& data);
-        
-        void LoadEquirectangularMapFromFile(const std::filesystem::path& path);
-        void EquirectToCubemap(float* data, int width, int height);
 
-        void GenerateIrradianceMap();
-        void GeneratePrefilteredMap();
+        /**
+         * @brief Creates the environment, irradiance and prefiltered cubemaps from a CPU bake.
+         * @param environment The baked environment, see IBLBaker.
+         */
+        void UploadBakedEnvironment(const BakedEnvironment& environment);
 
         friend class cereal::access;
 
         template<class Archive>
-        void save(Archive& archive) const
+        void save(Archive& archive, std::uint32_t const version) const
         {
-            archive(m_Properties);
-
-            // Get all the data from opengl and save it
-
-            // Cubemap data (faces)
-            std::vector<float> cubeMapData = std::vector<float>(m_Properties.Width * m_Properties.Height * 3 * 6);
-            glGetTextureImage(m_CubeMapID, 0, GL_RGB, GL_FLOAT, cubeMapData.size() * sizeof(float), cubeMapData.data());
-
-            archive(cubeMapData);
-
-            // Irradiance map data (faces only)
-
-            std::vector<float> irradianceMapData = std::vector<float>(m_IrradianceMapResolution * m_IrradianceMapResolution * 3 * 6);
-            glGetTextureImage(m_IrradianceMapID, 0, GL_RGB, GL_FLOAT, irradianceMapData.size() * sizeof(float), irradianceMapData.data());
-
-            archive(irradianceMapData, m_IrradianceMapResolution);
-
-            // Prefiltered map data (faces and mip levels)
-            std::vector<float> prefilteredMapData;
-            unsigned int maxMipLevels = 5; // TODO: make it a member variable
-            for (int j = 0; j < maxMipLevels; ++j)
-            {
-                int width = m_PrefilteredMapResolution >> j;
-                int height = m_PrefilteredMapResolution >> j;
-
-                std::vector<float> data(width * height * 3 * 6);
-                glGetTextureImage(m_PrefilteredMapID, j, GL_RGB, GL_FLOAT, data.size() * sizeof(float), data.data());
-                prefilteredMapData.insert(prefilteredMapData.end(), data.begin(), data.end());
-            }
-
-            archive(prefilteredMapData, m_PrefilteredMapResolution);
-
+            // The bake itself lives in the IBL cache, keyed by the hash of the source
+            archive(m_Properties, m_BakeKey);
             archive(cereal::base_class<Texture>(this));
         }
 
         template <class Archive>
-        void load(Archive& archive)
+        void load(Archive& archive, std::uint32_t const version)
         {
-           archive(m_Properties);
-
-            // Load the cubemap data
-            std::vector<float> cubeMapData;
-            archive(cubeMapData);
-
-            glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_CubeMapID);
-            glTextureStorage2D(m_CubeMapID, 1, GL_RGB32F, m_Properties.Width, m_Properties.Height);
-            glTextureParameteri(m_CubeMapID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTextureParameteri(m_CubeMapID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTextureParameteri(m_CubeMapID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTextureParameteri(m_CubeMapID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTextureParameteri(m_CubeMapID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-            int offset = 0;
-            int faceSize = m_Properties.Width * m_Properties.Height * 3;
-
-            for (int i = 0; i < 6; ++i)
-            {
-                glTextureSubImage3D(m_CubeMapID, 0, 0, 0, i, m_Properties.Width, m_Properties.Height, 1, GL_RGB, GL_FLOAT, cubeMapData.data() + offset);
-                offset += faceSize;
-            }
-
-            // Load the irradiance map data
-            std::vector<float> irradianceMapData;
-            archive(irradianceMapData, m_IrradianceMapResolution);
-
-            glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_IrradianceMapID);
-            glTextureStorage2D(m_IrradianceMapID, 1, GL_RGB32F, m_IrradianceMapResolution, m_IrradianceMapResolution);
-            glTextureParameteri(m_IrradianceMapID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTextureParameteri(m_IrradianceMapID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTextureParameteri(m_IrradianceMapID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTextureParameteri(m_IrradianceMapID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-            offset = 0;
-            faceSize = m_IrradianceMapResolution * m_IrradianceMapResolution * 3;
-
-            for (int i = 0; i < 6; ++i)
+            if (version >= 1)
             {
-                glTextureSubImage3D(m_IrradianceMapID, 0, 0, 0, i, m_IrradianceMapResolution, m_IrradianceMapResolution, 1, GL_RGB, GL_FLOAT, irradianceMapData.data() + offset);
-                offset += faceSize;
-            }
-
-            // Load the prefiltered map data
-            std::vector<float> prefilteredMapData;
-            archive(prefilteredMapData, m_PrefilteredMapResolution);
-
-            unsigned int maxMipLevels = 5; // TODO: make it a member variable
+                archive(m_Properties, m_BakeKey);
+                archive(cereal::base_class<Texture>(this));
 
-            glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_PrefilteredMapID);
-            glTextureStorage2D(m_PrefilteredMapID, maxMipLevels, GL_RGB32F, m_PrefilteredMapResolution, m_PrefilteredMapResolution);
-            glTextureParameteri(m_PrefilteredMapID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTextureParameteri(m_PrefilteredMapID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTextureParameteri(m_PrefilteredMapID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTextureParameteri(m_PrefilteredMapID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTextureParameteri(m_PrefilteredMapID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+                BakedEnvironment environment;
+                if (m_BakeKey != 0 && IBLBaker::LoadFromCache(m_BakeKey, environment))
+                    UploadBakedEnvironment(environment);
+                else
+                    LoadFromFile(m_FilePath);
 
-            offset = 0;
-            
-            for (int mip = 0; mip < maxMipLevels; ++mip)
-            {
-                int width = m_PrefilteredMapResolution >> mip;
-                int height = m_PrefilteredMapResolution >> mip;
-                int faceSize = width * height * 3;
-
-               for (int faceIdx = 0; faceIdx < 6; ++faceIdx)
-                {
-                    glTextureSubImage3D(m_PrefilteredMapID, mip, 0, 0, faceIdx, width, height, 1, GL_RGB, GL_FLOAT, prefilteredMapData.data() + offset);
-                    offset += faceSize;
-                }
+                return;
             }
 
+            // Older caches hold the maps read back from the GPU
+            BakedEnvironment environment;
+            archive(m_Properties);
+            archive(environment.Environment);
+            archive(environment.Irradiance, environment.IrradianceSize);
+            archive(environment.Prefiltered, environment.PrefilteredSize);
             archive(cereal::base_class<Texture>(this));
-        }
 
-/*         template <class Archive>
-        static void load_and_construct(Archive& data, cereal::construct<Cubemap>& construct)
-        {
-        } */
+            environment.FaceSize = m_Properties.Width;
+            environment.PrefilteredMipCount = 5;
+            UploadBakedEnvironment(environment);
+        }
 
     private:
         TextureProperties m_Properties;
         
-        uint32_t m_CubeMapID;
-        uint32_t m_IrradianceMapID;
-        uint32_t m_PrefilteredMapID;
+        uint32_t m_CubeMapID = 0;
+        uint32_t m_IrradianceMapID = 0;
+        uint32_t m_PrefilteredMapID = 0;
 
-        uint32_t m_IrradianceMapResolution = 32;
-        uint32_t m_PrefilteredMapResolution = 128;
-        
-        // common variables for map generation
-        uint32_t fbo, rbo;
-        static Ref<Mesh> m_CubeMesh;
+        uint64_t m_BakeKey = 0; ///< The IBL cache key of the baked maps, 0 if the source could not be read.
     };
 
 }
 
+CEREAL_CLASS_VERSION(Coffee::Texture2D, 1);
+CEREAL_CLASS_VERSION(Coffee::Cubemap, 1);
 CEREAL_REGISTER_TYPE(Coffee::Texture);
 CEREAL_REGISTER_TYPE(Coffee::Texture2D);
 CEREAL_REGISTER_TYPE(Coffee::Cubemap);
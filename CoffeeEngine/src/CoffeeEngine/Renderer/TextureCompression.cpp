@@ -0,0 +1,848 @@
+#include "TextureCompression.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Coffee {
+
+    // BC7 mode 6 interpolation weights for 4-bit indices, out of 64
+    static constexpr int s_BC7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    static const std::array<float, 256>& GetSRGBToLinearTable()
+    {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> values;
+            for (int i = 0; i < 256; i++)
+            {
+                float c = i / 255.0f;
+                values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    static uint8_t LinearToSRGB(float linear)
+    {
+        linear = std::clamp(linear, 0.0f, 1.0f);
+        float c = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+        return (uint8_t)std::lround(c * 255.0f);
+    }
+
+    static uint8_t ToUnorm8(float value)
+    {
+        return (uint8_t)std::lround(std::clamp(value, 0.0f, 255.0f));
+    }
+
+    // Finds the direction of largest variance of a set of points by power iteration on their covariance
+    template<int N>
+    static void PrincipalAxis(const float (*points)[N], int count, float mean[N], float axis[N])
+    {
+        for (int c = 0; c < N; c++)
+        {
+            mean[c] = 0.0f;
+            for (int i = 0; i < count; i++)
+                mean[c] += points[i][c];
+            mean[c] /= count;
+        }
+
+        float covariance[N][N] = {};
+        for (int i = 0; i < count; i++)
+            for (int a = 0; a < N; a++)
+                for (int b = 0; b < N; b++)
+                    covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+
+        for (int c = 0; c < N; c++)
+            axis[c] = 1.0f;
+
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[N] = {};
+            for (int a = 0; a < N; a++)
+                for (int b = 0; b < N; b++)
+                    next[a] += covariance[a][b] * axis[b];
+
+            float length = 0.0f;
+            for (int c = 0; c < N; c++)
+                length = std::max(length, std::abs(next[c]));
+
+            if (length <= std::numeric_limits<float>::epsilon())
+                break;
+
+            for (int c = 0; c < N; c++)
+                axis[c] = next[c] / length;
+        }
+    }
+
+    // Projects the points on the principal axis and returns the extremes as the initial endpoints
+    template<int N>
+    static void ExtremeEndpoints(const float (*points)[N], int count, float endpoint0[N], float endpoint1[N])
+    {
+        float mean[N], axis[N];
+        PrincipalAxis<N>(points, count, mean, axis);
+
+        float minT = std::numeric_limits<float>::max();
+        float maxT = std::numeric_limits<float>::lowest();
+        for (int i = 0; i < count; i++)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < N; c++)
+                t += (points[i][c] - mean[c]) * axis[c];
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        float lengthSquared = 0.0f;
+        for (int c = 0; c < N; c++)
+            lengthSquared += axis[c] * axis[c];
+        if (lengthSquared > 0.0f)
+        {
+            minT /= lengthSquared;
+            maxT /= lengthSquared;
+        }
+
+        for (int c = 0; c < N; c++)
+        {
+            endpoint0[c] = mean[c] + axis[c] * maxT;
+            endpoint1[c] = mean[c] + axis[c] * minT;
+        }
+    }
+
+    // Least squares fit of the endpoints given the interpolation factor of every point, returns false if the system is singular
+    template<int N>
+    static bool RefitEndpoints(const float (*points)[N], const float* factors, int count, float endpoint0[N], float endpoint1[N])
+    {
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        float rhs0[N] = {}, rhs1[N] = {};
+        for (int i = 0; i < count; i++)
+        {
+            float t = factors[i];
+            float s = 1.0f - t;
+            a += s * s;
+            b += s * t;
+            c += t * t;
+            for (int k = 0; k < N; k++)
+            {
+                rhs0[k] += s * points[i][k];
+                rhs1[k] += t * points[i][k];
+            }
+        }
+
+        float determinant = a * c - b * b;
+        if (std::abs(determinant) <= 1e-6f)
+            return false;
+
+        for (int k = 0; k < N; k++)
+        {
+            endpoint0[k] = (c * rhs0[k] - b * rhs1[k]) / determinant;
+            endpoint1[k] = (a * rhs1[k] - b * rhs0[k]) / determinant;
+        }
+        return true;
+    }
+
+    // BC1
+
+    static uint16_t PackRGB565(const float color[3])
+    {
+        uint16_t r = (uint16_t)std::lround(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f);
+        uint16_t g = (uint16_t)std::lround(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f);
+        uint16_t b = (uint16_t)std::lround(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    static void UnpackRGB565(uint16_t packed, int color[3])
+    {
+        int r = (packed >> 11) & 0x1F;
+        int g = (packed >> 5) & 0x3F;
+        int b = packed & 0x1F;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    static void BC1Palette(uint16_t color0, uint16_t color1, int palette[4][3])
+    {
+        UnpackRGB565(color0, palette[0]);
+        UnpackRGB565(color1, palette[1]);
+        for (int c = 0; c < 3; c++)
+        {
+            if (color0 > color1)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            else
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+    }
+
+    // Assigns every texel its nearest palette entry, returns the total squared error
+    static int BC1Indices(const float (*points)[3], uint16_t color0, uint16_t color1, uint8_t indices[16])
+    {
+        int palette[4][3];
+        BC1Palette(color0, color1, palette);
+
+        // Equal endpoints select the 3-color mode, where only the first entries are usable
+        int paletteSize = color0 > color1 ? 4 : 3;
+
+        int total = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            int best = std::numeric_limits<int>::max();
+            for (int p = 0; p < paletteSize; p++)
+            {
+                int error = 0;
+                for (int c = 0; c < 3; c++)
+                {
+                    int d = (int)points[i][c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < best)
+                {
+                    best = error;
+                    indices[i] = (uint8_t)p;
+                }
+            }
+            total += best;
+        }
+        return total;
+    }
+
+    static int BC1Evaluate(const float (*points)[3], const float endpoint0[3], const float endpoint1[3], uint16_t& color0, uint16_t& color1, uint8_t indices[16])
+    {
+        color0 = PackRGB565(endpoint0);
+        color1 = PackRGB565(endpoint1);
+
+        // Only the 4-color mode is used, it needs color0 > color1
+        if (color0 < color1)
+            std::swap(color0, color1);
+
+        return BC1Indices(points, color0, color1, indices);
+    }
+
+    void TextureCompression::EncodeBC1(const uint8_t rgba[64], uint8_t output[8])
+    {
+        float points[16][3];
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < 3; c++)
+                points[i][c] = rgba[i * 4 + c];
+
+        float endpoint0[3], endpoint1[3];
+        ExtremeEndpoints<3>(points, 16, endpoint0, endpoint1);
+
+        uint16_t color0, color1;
+        uint8_t indices[16];
+        int error = BC1Evaluate(points, endpoint0, endpoint1, color0, color1, indices);
+
+        // One least squares pass on the chosen indices usually recovers most of the quantization loss
+        if (color0 != color1)
+        {
+            static constexpr float factors4[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+            float factors[16];
+            for (int i = 0; i < 16; i++)
+                factors[i] = factors4[indices[i]];
+
+            if (RefitEndpoints<3>(points, factors, 16, endpoint0, endpoint1))
+            {
+                uint16_t refitColor0, refitColor1;
+                uint8_t refitIndices[16];
+                int refitError = BC1Evaluate(points, endpoint0, endpoint1, refitColor0, refitColor1, refitIndices);
+                if (refitError < error)
+                {
+                    color0 = refitColor0;
+                    color1 = refitColor1;
+                    std::memcpy(indices, refitIndices, 16);
+                }
+            }
+        }
+
+        uint32_t packedIndices = 0;
+        for (int i = 0; i < 16; i++)
+            packedIndices |= (uint32_t)indices[i] << (i * 2);
+
+        output[0] = (uint8_t)(color0 & 0xFF);
+        output[1] = (uint8_t)(color0 >> 8);
+        output[2] = (uint8_t)(color1 & 0xFF);
+        output[3] = (uint8_t)(color1 >> 8);
+        for (int i = 0; i < 4; i++)
+            output[4 + i] = (uint8_t)(packedIndices >> (i * 8));
+    }
+
+    // BC4
+
+    static void BC4Palette(uint8_t value0, uint8_t value1, int palette[8])
+    {
+        palette[0] = value0;
+        palette[1] = value1;
+        if (value0 > value1)
+        {
+            for (int i = 2; i < 8; i++)
+                palette[i] = ((8 - i) * value0 + (i - 1) * value1) / 7;
+        }
+        else
+        {
+            for (int i = 2; i < 6; i++)
+                palette[i] = ((6 - i) * value0 + (i - 1) * value1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void TextureCompression::EncodeBC4(const uint8_t values[16], uint8_t output[8])
+    {
+        uint8_t minValue = 255, maxValue = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            minValue = std::min(minValue, values[i]);
+            maxValue = std::max(maxValue, values[i]);
+        }
+
+        // The 8-value mode between the extremes, equal extremes fall back to the first entry for every texel
+        int palette[8];
+        BC4Palette(maxValue, minValue, palette);
+        int paletteSize = maxValue > minValue ? 8 : 1;
+
+        uint64_t packedIndices = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            int best = std::numeric_limits<int>::max();
+            uint64_t index = 0;
+            for (int p = 0; p < paletteSize; p++)
+            {
+                int error = std::abs((int)values[i] - palette[p]);
+                if (error < best)
+                {
+                    best = error;
+                    index = (uint64_t)p;
+                }
+            }
+            packedIndices |= index << (i * 3);
+        }
+
+        output[0] = maxValue;
+        output[1] = minValue;
+        for (int i = 0; i < 6; i++)
+            output[2 + i] = (uint8_t)(packedIndices >> (i * 8));
+    }
+
+    // BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a unique p-bit each, 4-bit indices
+
+    struct BC7Endpoint
+    {
+        int Value[4]; ///< The 7-bit channels.
+        int PBit;
+    };
+
+    static BC7Endpoint QuantizeBC7Endpoint(const float endpoint[4])
+    {
+        BC7Endpoint best = {};
+        float bestError = std::numeric_limits<float>::max();
+        for (int pBit = 0; pBit < 2; pBit++)
+        {
+            BC7Endpoint candidate;
+            candidate.PBit = pBit;
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++)
+            {
+                float value = std::clamp(endpoint[c], 0.0f, 255.0f);
+                candidate.Value[c] = std::clamp((int)std::lround((value - pBit) / 2.0f), 0, 127);
+                float d = (float)((candidate.Value[c] << 1) | pBit) - value;
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                best = candidate;
+            }
+        }
+        return best;
+    }
+
+    static int BC7Indices(const float (*points)[4], const BC7Endpoint& endpoint0, const BC7Endpoint& endpoint1, uint8_t indices[16])
+    {
+        int palette[16][4];
+        for (int c = 0; c < 4; c++)
+        {
+            int e0 = (endpoint0.Value[c] << 1) | endpoint0.PBit;
+            int e1 = (endpoint1.Value[c] << 1) | endpoint1.PBit;
+            for (int i = 0; i < 16; i++)
+                palette[i][c] = ((64 - s_BC7Weights[i]) * e0 + s_BC7Weights[i] * e1 + 32) >> 6;
+        }
+
+        int total = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            int best = std::numeric_limits<int>::max();
+            for (int p = 0; p < 16; p++)
+            {
+                int error = 0;
+                for (int c = 0; c < 4; c++)
+                {
+                    int d = (int)points[i][c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < best)
+                {
+                    best = error;
+                    indices[i] = (uint8_t)p;
+                }
+            }
+            total += best;
+        }
+        return total;
+    }
+
+    class BitWriter
+    {
+    public:
+        BitWriter(uint8_t* output, size_t size) : m_Output(output) { std::memset(output, 0, size); }
+
+        void Write(uint32_t value, int bits)
+        {
+            for (int i = 0; i < bits; i++, m_Position++)
+            {
+                if (value & (1u << i))
+                    m_Output[m_Position >> 3] |= (uint8_t)(1u << (m_Position & 7));
+            }
+        }
+
+    private:
+        uint8_t* m_Output;
+        size_t m_Position = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* input) : m_Input(input) {}
+
+        uint32_t Read(int bits)
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < bits; i++, m_Position++)
+                value |= (uint32_t)((m_Input[m_Position >> 3] >> (m_Position & 7)) & 1) << i;
+            return value;
+        }
+
+    private:
+        const uint8_t* m_Input;
+        size_t m_Position = 0;
+    };
+
+    void TextureCompression::EncodeBC7(const uint8_t rgba[64], uint8_t output[16])
+    {
+        float points[16][4];
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < 4; c++)
+                points[i][c] = rgba[i * 4 + c];
+
+        float endpoint0[4], endpoint1[4];
+        ExtremeEndpoints<4>(points, 16, endpoint0, endpoint1);
+
+        BC7Endpoint quantized0 = QuantizeBC7Endpoint(endpoint0);
+        BC7Endpoint quantized1 = QuantizeBC7Endpoint(endpoint1);
+        uint8_t indices[16];
+        int error = BC7Indices(points, quantized0, quantized1, indices);
+
+        float factors[16];
+        for (int i = 0; i < 16; i++)
+            factors[i] = s_BC7Weights[indices[i]] / 64.0f;
+
+        if (RefitEndpoints<4>(points, factors, 16, endpoint0, endpoint1))
+        {
+            BC7Endpoint refit0 = QuantizeBC7Endpoint(endpoint0);
+            BC7Endpoint refit1 = QuantizeBC7Endpoint(endpoint1);
+            uint8_t refitIndices[16];
+            int refitError = BC7Indices(points, refit0, refit1, refitIndices);
+            if (refitError < error)
+            {
+                quantized0 = refit0;
+                quantized1 = refit1;
+                std::memcpy(indices, refitIndices, 16);
+            }
+        }
+
+        // The top bit of the first index is implicitly 0, swapping the endpoints mirrors the indices
+        if (indices[0] >= 8)
+        {
+            std::swap(quantized0, quantized1);
+            for (int i = 0; i < 16; i++)
+                indices[i] = (uint8_t)(15 - indices[i]);
+        }
+
+        BitWriter writer(output, 16);
+        writer.Write(1u << 6, 7);
+        for (int c = 0; c < 4; c++)
+        {
+            writer.Write((uint32_t)quantized0.Value[c], 7);
+            writer.Write((uint32_t)quantized1.Value[c], 7);
+        }
+        writer.Write((uint32_t)quantized0.PBit, 1);
+        writer.Write((uint32_t)quantized1.PBit, 1);
+        writer.Write(indices[0], 3);
+        for (int i = 1; i < 16; i++)
+            writer.Write(indices[i], 4);
+    }
+
+    static void DecompressBC1(const uint8_t* block, uint8_t rgba[64])
+    {
+        uint16_t color0 = (uint16_t)(block[0] | (block[1] << 8));
+        uint16_t color1 = (uint16_t)(block[2] | (block[3] << 8));
+        uint32_t packedIndices = (uint32_t)block[4] | ((uint32_t)block[5] << 8) | ((uint32_t)block[6] << 16) | ((uint32_t)block[7] << 24);
+
+        int palette[4][3];
+        BC1Palette(color0, color1, palette);
+        for (int i = 0; i < 16; i++)
+        {
+            int index = (packedIndices >> (i * 2)) & 3;
+            for (int c = 0; c < 3; c++)
+                rgba[i * 4 + c] = (uint8_t)palette[index][c];
+            rgba[i * 4 + 3] = (color0 <= color1 && index == 3) ? 0 : 255;
+        }
+    }
+
+    static void DecompressBC4(const uint8_t* block, uint8_t* output, int stride)
+    {
+        int palette[8];
+        BC4Palette(block[0], block[1], palette);
+
+        uint64_t packedIndices = 0;
+        for (int i = 0; i < 6; i++)
+            packedIndices |= (uint64_t)block[2 + i] << (i * 8);
+
+        for (int i = 0; i < 16; i++)
+            output[i * stride] = (uint8_t)palette[(packedIndices >> (i * 3)) & 7];
+    }
+
+    static void DecompressBC7(const uint8_t* block, uint8_t rgba[64])
+    {
+        BitReader reader(block);
+
+        // Only mode 6 is written by the encoder, other modes decode to magenta
+        if (reader.Read(7) != (1u << 6))
+        {
+            for (int i = 0; i < 16; i++)
+            {
+                rgba[i * 4 + 0] = 255;
+                rgba[i * 4 + 1] = 0;
+                rgba[i * 4 + 2] = 255;
+                rgba[i * 4 + 3] = 255;
+            }
+            return;
+        }
+
+        int endpoints[2][4];
+        for (int c = 0; c < 4; c++)
+        {
+            endpoints[0][c] = (int)reader.Read(7);
+            endpoints[1][c] = (int)reader.Read(7);
+        }
+        int pBit0 = (int)reader.Read(1);
+        int pBit1 = (int)reader.Read(1);
+        for (int c = 0; c < 4; c++)
+        {
+            endpoints[0][c] = (endpoints[0][c] << 1) | pBit0;
+            endpoints[1][c] = (endpoints[1][c] << 1) | pBit1;
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            int weight = s_BC7Weights[reader.Read(i == 0 ? 3 : 4)];
+            for (int c = 0; c < 4; c++)
+                rgba[i * 4 + c] = (uint8_t)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+        }
+    }
+
+    void TextureCompression::DecompressBlock(BlockFormat format, const uint8_t* block, uint8_t rgba[64])
+    {
+        std::memset(rgba, 0, 64);
+        for (int i = 0; i < 16; i++)
+            rgba[i * 4 + 3] = 255;
+
+        switch (format)
+        {
+            case BlockFormat::BC1:
+                DecompressBC1(block, rgba);
+            break;
+            case BlockFormat::BC3:
+                DecompressBC1(block + 8, rgba);
+                DecompressBC4(block, rgba + 3, 4);
+            break;
+            case BlockFormat::BC4:
+                DecompressBC4(block, rgba, 4);
+            break;
+            case BlockFormat::BC5:
+                DecompressBC4(block, rgba, 4);
+                DecompressBC4(block + 8, rgba + 1, 4);
+            break;
+            case BlockFormat::BC7:
+                DecompressBC7(block, rgba);
+            break;
+            case BlockFormat::None:
+            break;
+        }
+    }
+
+    BlockFormat TextureCompression::SelectFormat(TextureUsage usage, int channels, bool hasAlpha, bool highQuality)
+    {
+        switch (usage)
+        {
+            case TextureUsage::Color:
+                if (highQuality)
+                    return BlockFormat::BC7;
+                return hasAlpha ? BlockFormat::BC3 : BlockFormat::BC1;
+            case TextureUsage::Normal:
+                return BlockFormat::BC5;
+            case TextureUsage::Data:
+                if (channels == 1)
+                    return BlockFormat::BC4;
+                return highQuality || hasAlpha ? BlockFormat::BC7 : BlockFormat::BC1;
+        }
+        return BlockFormat::None;
+    }
+
+    uint32_t TextureCompression::GetBlockSize(BlockFormat format)
+    {
+        switch (format)
+        {
+            case BlockFormat::BC1:
+            case BlockFormat::BC4:
+                return 8;
+            case BlockFormat::BC3:
+            case BlockFormat::BC5:
+            case BlockFormat::BC7:
+                return 16;
+            case BlockFormat::None:
+                return 0;
+        }
+        return 0;
+    }
+
+    size_t TextureCompression::GetCompressedSize(BlockFormat format, uint32_t width, uint32_t height)
+    {
+        size_t blocksX = (width + 3) / 4;
+        size_t blocksY = (height + 3) / 4;
+        return blocksX * blocksY * GetBlockSize(format);
+    }
+
+    bool TextureCompression::HasAlpha(const uint8_t* rgba, size_t texelCount)
+    {
+        for (size_t i = 0; i < texelCount; i++)
+        {
+            if (rgba[i * 4 + 3] != 255)
+                return true;
+        }
+        return false;
+    }
+
+    std::vector<uint8_t> TextureCompression::ToRGBA8(const uint8_t* pixels, uint32_t width, uint32_t height, int channels)
+    {
+        size_t texelCount = (size_t)width * height;
+        std::vector<uint8_t> rgba(texelCount * 4);
+        for (size_t i = 0; i < texelCount; i++)
+        {
+            const uint8_t* texel = pixels + i * channels;
+            uint8_t* output = rgba.data() + i * 4;
+            switch (channels)
+            {
+                case 1:
+                    output[0] = output[1] = output[2] = texel[0];
+                    output[3] = 255;
+                break;
+                case 2:
+                    output[0] = output[1] = output[2] = texel[0];
+                    output[3] = texel[1];
+                break;
+                case 3:
+                    std::memcpy(output, texel, 3);
+                    output[3] = 255;
+                break;
+                default:
+                    std::memcpy(output, texel, 4);
+                break;
+            }
+        }
+        return rgba;
+    }
+
+    static std::vector<uint8_t> Downsample(const std::vector<uint8_t>& source, uint32_t width, uint32_t height, TextureUsage usage, bool srgb)
+    {
+        const std::array<float, 256>& toLinear = GetSRGBToLinearTable();
+        bool linearizeColor = srgb;
+
+        uint32_t mipWidth = std::max(width / 2, 1u);
+        uint32_t mipHeight = std::max(height / 2, 1u);
+        std::vector<uint8_t> mip((size_t)mipWidth * mipHeight * 4);
+
+        for (uint32_t y = 0; y < mipHeight; y++)
+        {
+            for (uint32_t x = 0; x < mipWidth; x++)
+            {
+                // 2x2 box filter, clamped on the edges of odd or 1 texel wide images
+                uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+                const uint8_t* texels[4] = {
+                    &source[((size_t)y0 * width + x0) * 4], &source[((size_t)y0 * width + x1) * 4],
+                    &source[((size_t)y1 * width + x0) * 4], &source[((size_t)y1 * width + x1) * 4]};
+
+                uint8_t* output = &mip[((size_t)y * mipWidth + x) * 4];
+
+                if (usage == TextureUsage::Normal)
+                {
+                    // Averaging normals shortens them, the result is renormalized so the lighting does not darken
+                    float normal[3] = {};
+                    for (const uint8_t* texel : texels)
+                        for (int c = 0; c < 3; c++)
+                            normal[c] += texel[c] / 255.0f * 2.0f - 1.0f;
+
+                    float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                    if (length <= std::numeric_limits<float>::epsilon())
+                    {
+                        normal[0] = normal[1] = 0.0f;
+                        normal[2] = length = 1.0f;
+                    }
+
+                    for (int c = 0; c < 3; c++)
+                        output[c] = ToUnorm8((normal[c] / length * 0.5f + 0.5f) * 255.0f);
+                }
+                else if (linearizeColor)
+                {
+                    for (int c = 0; c < 3; c++)
+                    {
+                        float sum = 0.0f;
+                        for (const uint8_t* texel : texels)
+                            sum += toLinear[texel[c]];
+                        output[c] = LinearToSRGB(sum * 0.25f);
+                    }
+                }
+                else
+                {
+                    for (int c = 0; c < 3; c++)
+                        output[c] = (uint8_t)((texels[0][c] + texels[1][c] + texels[2][c] + texels[3][c] + 2) / 4);
+                }
+
+                // Alpha is linear coverage in every usage
+                output[3] = (uint8_t)((texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3] + 2) / 4);
+            }
+        }
+
+        return mip;
+    }
+
+    std::vector<std::vector<uint8_t>> TextureCompression::GenerateMipChain(const uint8_t* rgba, uint32_t width, uint32_t height, TextureUsage usage, bool srgb)
+    {
+        ZoneScoped;
+
+        std::vector<std::vector<uint8_t>> mips;
+        mips.emplace_back(rgba, rgba + (size_t)width * height * 4);
+
+        while (width > 1 || height > 1)
+        {
+            mips.push_back(Downsample(mips.back(), width, height, usage, srgb));
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+        }
+
+        return mips;
+    }
+
+    void TextureCompression::CompressImage(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format, uint8_t* output)
+    {
+        ZoneScoped;
+
+        uint32_t blockSize = GetBlockSize(format);
+        uint32_t blocksX = (width + 3) / 4;
+        uint32_t blocksY = (height + 3) / 4;
+
+        for (uint32_t blockY = 0; blockY < blocksY; blockY++)
+        {
+            for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+            {
+                uint8_t block[64];
+                for (uint32_t y = 0; y < 4; y++)
+                {
+                    for (uint32_t x = 0; x < 4; x++)
+                    {
+                        uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+                        uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+                        std::memcpy(&block[(y * 4 + x) * 4], &rgba[((size_t)sourceY * width + sourceX) * 4], 4);
+                    }
+                }
+
+                uint8_t* destination = output + ((size_t)blockY * blocksX + blockX) * blockSize;
+                uint8_t channel[16];
+                switch (format)
+                {
+                    case BlockFormat::BC1:
+                        EncodeBC1(block, destination);
+                    break;
+                    case BlockFormat::BC3:
+                        for (int i = 0; i < 16; i++)
+                            channel[i] = block[i * 4 + 3];
+                        EncodeBC4(channel, destination);
+                        EncodeBC1(block, destination + 8);
+                    break;
+                    case BlockFormat::BC4:
+                        for (int i = 0; i < 16; i++)
+                            channel[i] = block[i * 4];
+                        EncodeBC4(channel, destination);
+                    break;
+                    case BlockFormat::BC5:
+                        for (int c = 0; c < 2; c++)
+                        {
+                            for (int i = 0; i < 16; i++)
+                                channel[i] = block[i * 4 + c];
+                            EncodeBC4(channel, destination + c * 8);
+                        }
+                    break;
+                    case BlockFormat::BC7:
+                        EncodeBC7(block, destination);
+                    break;
+                    case BlockFormat::None:
+                    break;
+                }
+            }
+        }
+    }
+
+    CompressedTexture TextureCompression::Compress(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format, TextureUsage usage, bool srgb)
+    {
+        ZoneScoped;
+
+        CompressedTexture texture;
+        texture.Format = format;
+        texture.Width = width;
+        texture.Height = height;
+
+        std::vector<std::vector<uint8_t>> mips = GenerateMipChain(rgba, width, height, usage, srgb);
+
+        size_t totalSize = 0;
+        for (uint32_t mip = 0; mip < mips.size(); mip++)
+            totalSize += GetCompressedSize(format, std::max(width >> mip, 1u), std::max(height >> mip, 1u));
+
+        texture.Data.resize(totalSize);
+        texture.MipOffsets.reserve(mips.size());
+
+        size_t offset = 0;
+        for (uint32_t mip = 0; mip < mips.size(); mip++)
+        {
+            uint32_t mipWidth = std::max(width >> mip, 1u);
+            uint32_t mipHeight = std::max(height >> mip, 1u);
+
+            texture.MipOffsets.push_back((uint32_t)offset);
+            CompressImage(mips[mip].data(), mipWidth, mipHeight, format, texture.Data.data() + offset);
+            offset += GetCompressedSize(format, mipWidth, mipHeight);
+        }
+
+        return texture;
+    }
+
+}
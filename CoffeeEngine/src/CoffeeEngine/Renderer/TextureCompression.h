@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief What the texels of a texture represent. Decides how mips are filtered and which block format is used.
+     */
+    enum class TextureUsage
+    {
+        Color, ///< Colors such as albedo or emissive.
+        Normal, ///< Tangent space normal maps, renormalized in every mip and stored as two channels.
+        Data ///< Linear data such as metallic, roughness or occlusion (ORM).
+    };
+
+    /**
+     * @brief Block compression formats the importer can encode.
+     */
+    enum class BlockFormat
+    {
+        None, ///< Uncompressed RGBA8.
+        BC1, ///< RGB, 4 bits per texel.
+        BC3, ///< RGBA with smooth alpha, 8 bits per texel.
+        BC4, ///< Single channel, 4 bits per texel.
+        BC5, ///< Two channels, 8 bits per texel.
+        BC7 ///< High quality RGBA, 8 bits per texel.
+    };
+
+    /**
+     * @brief A block compressed texture with its whole mip chain, as stored in the texture cache.
+     */
+    struct CompressedTexture
+    {
+        BlockFormat Format = BlockFormat::None; ///< The block format of every mip.
+        uint32_t Width = 0; ///< The width of the first mip.
+        uint32_t Height = 0; ///< The height of the first mip.
+        std::vector<uint32_t> MipOffsets; ///< The byte offset of each mip in Data.
+        std::vector<uint8_t> Data; ///< The blocks of every mip, one after the other.
+
+        uint32_t GetMipCount() const { return (uint32_t)MipOffsets.size(); }
+        uint32_t GetMipSize(uint32_t mip) const { return (mip + 1 < MipOffsets.size() ? MipOffsets[mip + 1] : (uint32_t)Data.size()) - MipOffsets[mip]; }
+
+        template<class Archive>
+        void serialize(Archive& archive, std::uint32_t const version)
+        {
+            int formatInt = static_cast<int>(Format);
+            archive(formatInt, Width, Height, MipOffsets, Data);
+            Format = static_cast<BlockFormat>(formatInt);
+        }
+    };
+
+    /**
+     * @brief Builds mip chains and encodes them to BCn blocks on the CPU.
+     *
+     * Does not touch OpenGL, so it can run on any thread and headless. Images are RGBA8, rows top to bottom.
+     */
+    class TextureCompression
+    {
+    public:
+        /**
+         * @brief Picks the block format of a texture.
+         * @param usage What the texture represents.
+         * @param channels The number of channels of the source image.
+         * @param hasAlpha Whether the alpha channel has texels below 255.
+         * @param highQuality Prefer BC7 over BC1 and BC3 for colors and data.
+         * @return The block format.
+         */
+        static BlockFormat SelectFormat(TextureUsage usage, int channels, bool hasAlpha, bool highQuality);
+
+        /**
+         * @brief Gets the size of a 4x4 block.
+         * @param format The block format.
+         * @return 8 or 16 bytes.
+         */
+        static uint32_t GetBlockSize(BlockFormat format);
+
+        /**
+         * @brief Gets the size of an image once compressed. Partial blocks on the edges count as whole blocks.
+         */
+        static size_t GetCompressedSize(BlockFormat format, uint32_t width, uint32_t height);
+
+        /**
+         * @brief Checks whether any texel of an RGBA8 image is not fully opaque.
+         */
+        static bool HasAlpha(const uint8_t* rgba, size_t texelCount);
+
+        /**
+         * @brief Expands an image with 1 to 4 channels to RGBA8. Grey images are replicated to RGB.
+         */
+        static std::vector<uint8_t> ToRGBA8(const uint8_t* pixels, uint32_t width, uint32_t height, int channels);
+
+        /**
+         * @brief Builds the full mip chain of an RGBA8 image, down to 1x1.
+         * @param rgba The first mip.
+         * @param width The width of the first mip.
+         * @param height The height of the first mip.
+         * @param usage Normals are renormalized, other usages average the channels.
+         * @param srgb Whether the color channels are sRGB encoded, they are then averaged in linear space. Ignored for normals.
+         * @return Every mip, the first one included.
+         */
+        static std::vector<std::vector<uint8_t>> GenerateMipChain(const uint8_t* rgba, uint32_t width, uint32_t height, TextureUsage usage, bool srgb);
+
+        /**
+         * @brief Encodes an RGBA8 image to blocks. Edge blocks repeat the last row and column.
+         * @param output Receives GetCompressedSize bytes.
+         */
+        static void CompressImage(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format, uint8_t* output);
+
+        /**
+         * @brief Builds the mip chain of an image and encodes every mip.
+         * @param rgba The image, RGBA8.
+         * @param width The width of the image.
+         * @param height The height of the image.
+         * @param format The block format, see SelectFormat.
+         * @param usage What the texture represents.
+         * @param srgb Whether the color channels are sRGB encoded.
+         * @return The compressed texture.
+         */
+        static CompressedTexture Compress(const uint8_t* rgba, uint32_t width, uint32_t height, BlockFormat format, TextureUsage usage, bool srgb);
+
+        /**
+         * @brief Decodes one block to 16 RGBA8 texels. Channels missing from the format are 0, alpha is 255.
+         */
+        static void DecompressBlock(BlockFormat format, const uint8_t* block, uint8_t rgba[64]);
+
+        static void EncodeBC1(const uint8_t rgba[64], uint8_t output[8]); ///< Encodes the RGB of a block, always in 4-color mode.
+        static void EncodeBC4(const uint8_t values[16], uint8_t output[8]); ///< Encodes one channel of a block.
+        static void EncodeBC7(const uint8_t rgba[64], uint8_t output[16]); ///< Encodes a block with BC7 mode 6.
+    };
+
+    /** @} */
+}
@@ -0,0 +1,107 @@
+#include "TextureDecoder.h"
+
+#include "CoffeeEngine/Core/JobSystem.h"
+
+#include <stb_image.h>
+#include <tracy/Tracy.hpp>
+
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
+namespace Coffee {
+
+    struct PrefetchedTexture
+    {
+        TextureDecodeSettings Settings;
+        std::future<DecodedTexture> Result;
+    };
+
+    static std::unordered_map<std::string, PrefetchedTexture> s_Prefetched;
+    static std::mutex s_PrefetchedMutex;
+
+    DecodedTexture TextureDecoder::Decode(const std::filesystem::path& path, const TextureDecodeSettings& settings)
+    {
+        ZoneScoped;
+
+        DecodedTexture decoded;
+
+        // The thread variant overrides the process-wide flag on this thread only
+        stbi_set_flip_vertically_on_load_thread(settings.FlipVertically);
+        unsigned char* data = stbi_load(path.string().c_str(), &decoded.Width, &decoded.Height, &decoded.Channels, 0);
+
+        if (!data)
+        {
+            const char* reason = stbi_failure_reason();
+            decoded.Error = reason ? reason : "unknown error";
+            return decoded;
+        }
+
+        if (settings.Compress)
+        {
+            std::vector<uint8_t> rgba = TextureCompression::ToRGBA8(data, decoded.Width, decoded.Height, decoded.Channels);
+            bool hasAlpha = TextureCompression::HasAlpha(rgba.data(), (size_t)decoded.Width * decoded.Height);
+            BlockFormat format = TextureCompression::SelectFormat(settings.Usage, decoded.Channels, hasAlpha, settings.HighQuality);
+
+            decoded.Compressed = TextureCompression::Compress(rgba.data(), decoded.Width, decoded.Height, format, settings.Usage, settings.SRGB);
+        }
+        else
+        {
+            decoded.Pixels.assign(data, data + (size_t)decoded.Width * decoded.Height * decoded.Channels);
+        }
+
+        stbi_image_free(data);
+        return decoded;
+    }
+
+    void TextureDecoder::Prefetch(const std::filesystem::path& path, const TextureDecodeSettings& settings)
+    {
+        std::string key = path.lexically_normal().string();
+
+        std::lock_guard<std::mutex> lock(s_PrefetchedMutex);
+
+        auto it = s_Prefetched.find(key);
+        if (it != s_Prefetched.end() && it->second.Settings == settings)
+            return;
+
+        // A pending decode with other settings is dropped, its job finishes on its own
+        s_Prefetched[key] = {settings, JobSystem::Submit([path, settings]() { return Decode(path, settings); })};
+    }
+
+    DecodedTexture TextureDecoder::Acquire(const std::filesystem::path& path, const TextureDecodeSettings& settings)
+    {
+        ZoneScoped;
+
+        std::future<DecodedTexture> result;
+        {
+            std::lock_guard<std::mutex> lock(s_PrefetchedMutex);
+
+            auto it = s_Prefetched.find(path.lexically_normal().string());
+            if (it != s_Prefetched.end())
+            {
+                if (it->second.Settings == settings)
+                    result = std::move(it->second.Result);
+
+                s_Prefetched.erase(it);
+            }
+        }
+
+        if (result.valid())
+            return result.get();
+
+        return Decode(path, settings);
+    }
+
+    void TextureDecoder::ClearPrefetched()
+    {
+        std::lock_guard<std::mutex> lock(s_PrefetchedMutex);
+        s_Prefetched.clear();
+    }
+
+    size_t TextureDecoder::GetPrefetchedCount()
+    {
+        std::lock_guard<std::mutex> lock(s_PrefetchedMutex);
+        return s_Prefetched.size();
+    }
+
+}
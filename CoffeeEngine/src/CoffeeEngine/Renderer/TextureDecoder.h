@@ -0,0 +1,99 @@
+#pragma once
+
+#include "CoffeeEngine/Renderer/TextureCompression.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief How a texture file is decoded and prepared for the upload.
+     */
+    struct TextureDecodeSettings
+    {
+        bool FlipVertically = true; ///< Flip the rows so the first one is the bottom of the image, as OpenGL expects.
+        bool Compress = false; ///< Build the mips and block compress them, see TextureCompression.
+        TextureUsage Usage = TextureUsage::Color; ///< What the texels represent, used when compressing.
+        bool SRGB = true; ///< Whether the color channels are sRGB encoded, used when compressing.
+        bool HighQuality = false; ///< Prefer BC7, used when compressing.
+
+        bool operator==(const TextureDecodeSettings& other) const = default;
+    };
+
+    /**
+     * @brief A decoded texture ready to be uploaded by the main thread.
+     */
+    struct DecodedTexture
+    {
+        int Width = 0; ///< The width of the image.
+        int Height = 0; ///< The height of the image.
+        int Channels = 0; ///< The number of channels in the file.
+        std::vector<unsigned char> Pixels; ///< The pixels with Channels per texel, empty when compressed.
+        CompressedTexture Compressed; ///< The compressed mip chain, when the settings asked for it.
+        std::string Error; ///< Why the decode failed, empty on success.
+
+        bool IsValid() const { return Error.empty() && Width > 0 && Height > 0; }
+    };
+
+    /**
+     * @class TextureDecoder
+     * @brief Decodes texture files on any thread, and on the job system ahead of time.
+     *
+     * The vertical flip is set per thread, so decodes do not race on the global state of stb_image. Nothing here
+     * touches OpenGL: the decoded pixels are handed to the main thread, which creates and uploads the texture.
+     *
+     * Importers that know which textures they are about to load call Prefetch for all of them. The decodes
+     * then run in parallel and Acquire only waits for the one it needs.
+     */
+    class TextureDecoder
+    {
+    public:
+        /**
+         * @brief Decodes a texture file on the calling thread.
+         * @param path The path of the image.
+         * @param settings How to decode it.
+         * @return The decoded texture, check IsValid.
+         */
+        static DecodedTexture Decode(const std::filesystem::path& path, const TextureDecodeSettings& settings);
+
+        /**
+         * @brief Starts decoding a texture file on the job system. Does nothing if it is already prefetched with the same settings.
+         * @param path The path of the image.
+         * @param settings How to decode it.
+         */
+        static void Prefetch(const std::filesystem::path& path, const TextureDecodeSettings& settings);
+
+        /**
+         * @brief Gets a decoded texture, waiting for its prefetch or decoding it on the calling thread if it was not prefetched.
+         *
+         * A prefetch with other settings is discarded.
+         *
+         * @param path The path of the image.
+         * @param settings How to decode it.
+         * @return The decoded texture, check IsValid.
+         */
+        static DecodedTexture Acquire(const std::filesystem::path& path, const TextureDecodeSettings& settings);
+
+        /**
+         * @brief Drops the prefetched textures that were never acquired.
+         */
+        static void ClearPrefetched();
+
+        /**
+         * @brief Gets the number of prefetched textures not acquired yet.
+         * @return The number of pending prefetches.
+         */
+        static size_t GetPrefetchedCount();
+    };
+
+    /** @} */
+}
@@ -0,0 +1,229 @@
+#include "TextureStreaming.h"
+
+#include "CoffeeEngine/Core/JobSystem.h"
+#include "CoffeeEngine/Core/Log.h"
+#include "CoffeeEngine/IO/ResourceImporter.h"
+#include "CoffeeEngine/IO/ResourceResidency.h"
+#include "CoffeeEngine/Renderer/Texture.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Coffee {
+
+    class TextureStreaming::Backend : public TextureStreamingBackend
+    {
+    public:
+        void LoadMips(StreamingHandle handle, uint32_t firstMip) override { TextureStreaming::LoadMips(handle, firstMip); }
+        void EvictMips(StreamingHandle handle, uint32_t firstMip) override { TextureStreaming::EvictMips(handle, firstMip); }
+    };
+
+    struct PendingMipLoad
+    {
+        StreamingHandle Handle;
+        uint32_t FirstMip;
+        std::future<CompressedTexture> Result;
+    };
+
+    struct TextureStreamingData
+    {
+        // Textures can be destroyed on the job system workers, which unregisters them
+        std::mutex Mutex;
+
+        std::unique_ptr<TextureStreamingPolicy> Policy;
+        TextureStreamingSettings Settings;
+
+        std::unordered_map<StreamingHandle, Texture2D*> Textures;
+        std::vector<PendingMipLoad> PendingLoads;
+    };
+
+    static TextureStreamingData s_StreamingData;
+
+    void TextureStreaming::Init(const TextureStreamingSettings& settings)
+    {
+        static Backend backend;
+
+        std::lock_guard<std::mutex> lock(s_StreamingData.Mutex);
+        s_StreamingData.Settings = settings;
+        s_StreamingData.Policy = std::make_unique<TextureStreamingPolicy>(backend, settings);
+
+        COFFEE_CORE_INFO("TextureStreaming: {0} MiB budget", settings.BudgetBytes / (1024 * 1024));
+    }
+
+    void TextureStreaming::Shutdown()
+    {
+        std::lock_guard<std::mutex> lock(s_StreamingData.Mutex);
+
+        // The jobs only capture the UUID of their texture, dropping their futures does not wait for them
+        s_StreamingData.PendingLoads.clear();
+        s_StreamingData.Textures.clear();
+        s_StreamingData.Policy.reset();
+    }
+
+    bool TextureStreaming::IsEnabled()
+    {
+        std::lock_guard<std::mutex> lock(s_StreamingData.Mutex);
+        return s_StreamingData.Policy != nullptr;
+    }
+
+    void TextureStreaming::Update()
+    {
+        ZoneScoped;
+
+        std::lock_guard<std::mutex> lock(s_StreamingData.Mutex);
+
+        if (!s_StreamingData.Policy)
+            return;
+
+        auto& pendingLoads = s_StreamingData.PendingLoads;
+        for (auto it = pendingLoads.begin(); it != pendingLoads.end();)
+        {
+            if (it->Result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                ++it;
+                continue;
+            }
+
+            CompressedTexture mips = it->Result.get();
+            Texture2D* texture = s_StreamingData.Textures.at(it->Handle);
+
+            if (mips.GetMipCount() == texture->m_Compressed.GetMipCount() && !mips.Data.empty())
+            {
+                texture->SetResidentMips(it->FirstMip, &mips);
+                s_StreamingData.Policy->OnLoadFinished(it->Handle, it->FirstMip);
+            }
+            else
+            {
+                COFFEE_CORE_ERROR("TextureStreaming: Could not load the mips of texture {0} from the cache", texture->GetName());
+                s_StreamingData.Policy->OnLoadFinished(it->Handle, texture->m_FirstResidentMip);
+            }
+
+            it = pendingLoads.erase(it);
+        }
+
+        s_StreamingData.Policy->Update();
+    }
+
+    StreamingHandle TextureStreaming::Register(Texture2D& texture)
+    {
+        std::lock_guard<std::mutex> lock(s_StreamingData.Mutex);
+
+        if (!s_StreamingData.Policy || !texture.IsCompressed() || texture.m_Compressed.GetMipCount() <= 1)
+            return InvalidStreamingHandle;
+
+        const CompressedTexture& compressed = texture.m_Compressed;
+
+        // From the block format, the data itself may already be dropped
+        std::vector<uint64_t> mipBytes(compressed.GetMipCount());
+        for (uint32_t mip = 0; mip < mipBytes.size(); mip++)
+        {
+            uint32_t width = std::max<uint32_t>(compressed.Width >> mip, 1);
+            uint32_t height = std::max<uint32_t>(compressed.Height >> mip, 1);
+            mipBytes[mip] = TextureCompression::GetCompressedSize(compressed.Format, width, height);
+        }
+
+        StreamingHandle handle = s_StreamingData.Policy->Register(compressed.Width, compressed.Height, mipBytes);
+        s_StreamingData.Textures[handle] = &texture;
+        return handle;
+    }
+
+    void TextureStreaming::Unregister(StreamingHandle handle)
+    {
+        // Checked before locking: the textures deserialized by a load that runs inline are dropped inside Update
+        if (handle == InvalidStreamingHandle)
+            return;
+
+        std::lock_guard<std::mutex> lock(s_StreamingData.Mutex);
+
+        if (!s_StreamingData.Policy)
+            return;
+
+        auto& pendingLoads = s_StreamingData.PendingLoads;
+        pendingLoads.erase(std::remove_if(pendingLoads.begin(), pendingLoads.end(), [handle](const PendingMipLoad& load) { return load.Handle == handle; }),
+                           pendingLoads.end());
+
+        s_StreamingData.Textures.erase(handle);
+        s_StreamingData.Policy->Unregister(handle);
+    }
+
+    uint32_t TextureStreaming::GetResidentMip(StreamingHandle handle)
+    {
+        std::lock_guard<std::mutex> lock(s_StreamingData.Mutex);
+        return s_StreamingData.Policy ? s_StreamingData.Policy->GetResidentMip(handle) : 0;
+    }
+
+    void TextureStreaming::Request(const Texture2D& texture, float screenSize)
+    {
+        std::lock_guard<std::mutex> lock(s_StreamingData.Mutex);
+
+        if (!s_StreamingData.Policy || texture.m_StreamingHandle == InvalidStreamingHandle)
+            return;
+
+        uint32_t mip = ComputeRequiredMip(texture.m_Compressed.Width, texture.m_Compressed.Height, screenSize, s_StreamingData.Settings.MipBias);
+        s_StreamingData.Policy->Request(texture.m_StreamingHandle, mip);
+    }
+
+    uint32_t TextureStreaming::ComputeRequiredMip(uint32_t width, uint32_t height, float screenSize, float mipBias)
+    {
+        // One texel per pixel, assuming the UVs cover the texture once across the mesh
+        float mip = std::log2(float(std::max(width, height)) / std::max(screenSize, 1.0f)) + mipBias;
+        return mip > 0.0f ? (uint32_t)mip : 0;
+    }
+
+    const TextureStreamingSettings& TextureStreaming::GetSettings()
+    {
+        return s_StreamingData.Settings;
+    }
+
+    void TextureStreaming::SetSettings(const TextureStreamingSettings& settings)
+    {
+        std::lock_guard<std::mutex> lock(s_StreamingData.Mutex);
+        s_StreamingData.Settings = settings;
+
+        if (s_StreamingData.Policy)
+            s_StreamingData.Policy->SetSettings(settings);
+    }
+
+    uint64_t TextureStreaming::GetUsedBytes()
+    {
+        std::lock_guard<std::mutex> lock(s_StreamingData.Mutex);
+        return s_StreamingData.Policy ? s_StreamingData.Policy->GetUsedBytes() : 0;
+    }
+
+    // Called by the policy from Update, with the lock held
+    void TextureStreaming::LoadMips(StreamingHandle handle, uint32_t firstMip)
+    {
+        Texture2D* texture = s_StreamingData.Textures.at(handle);
+
+        // Textures that still hold their CPU data are uploaded right away
+        if (!texture->m_Compressed.Data.empty())
+        {
+            texture->SetResidentMips(firstMip, &texture->m_Compressed);
+            s_StreamingData.Policy->OnLoadFinished(handle, firstMip);
+            return;
+        }
+
+        UUID uuid = texture->GetUUID();
+        std::future<CompressedTexture> result = JobSystem::Submit([uuid]() {
+            ResourceResidency::CPUDataLoadScope scope;
+            Ref<Texture2D> cached = ResourceImporter().ImportFromCache<Texture2D>(uuid);
+            return cached ? std::move(cached->m_Compressed) : CompressedTexture();
+        });
+
+        s_StreamingData.PendingLoads.push_back({handle, firstMip, std::move(result)});
+    }
+
+    void TextureStreaming::EvictMips(StreamingHandle handle, uint32_t firstMip)
+    {
+        s_StreamingData.Textures.at(handle)->SetResidentMips(firstMip, nullptr);
+    }
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "CoffeeEngine/Renderer/TextureStreamingPolicy.h"
+
+#include <cstdint>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    class Texture2D;
+
+    /**
+     * @class TextureStreaming
+     * @brief Streams the mips of the block compressed textures in and out of GPU memory under a budget.
+     *
+     * A streamed texture is uploaded with its small mips only. The renderer requests the mip each visible texture
+     * needs from the screen size of the meshes using it, and the missing mips are read back from the resource
+     * cache on the job system and uploaded on the main thread. See TextureStreamingPolicy for the decisions.
+     *
+     * Uncompressed textures build their mips on the GPU and are always fully resident.
+     */
+    class TextureStreaming
+    {
+    public:
+        /**
+         * @brief Enables the streaming for the textures uploaded from now on.
+         * @param settings The budget and limits.
+         */
+        static void Init(const TextureStreamingSettings& settings = {});
+
+        /**
+         * @brief Drops the loads in flight and disables the streaming.
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Checks whether the textures are streamed.
+         * @return True between Init and Shutdown.
+         */
+        static bool IsEnabled();
+
+        /**
+         * @brief Uploads the loaded mips and starts the loads and evictions for the requests of the frame.
+         */
+        static void Update();
+
+        /**
+         * @brief Starts streaming a texture if it can be streamed.
+         * @param texture The texture, block compressed with its mip chain.
+         * @return The handle of the texture, InvalidStreamingHandle if it is not streamed.
+         */
+        static StreamingHandle Register(Texture2D& texture);
+
+        /**
+         * @brief Stops streaming a texture, dropping its pending loads.
+         * @param handle The handle returned by Register.
+         */
+        static void Unregister(StreamingHandle handle);
+
+        /**
+         * @brief Gets the mip a streamed texture starts with, before any request.
+         * @param handle The handle returned by Register.
+         * @return The finest resident mip.
+         */
+        static uint32_t GetResidentMip(StreamingHandle handle);
+
+        /**
+         * @brief Requests the mip a texture needs to be drawn at a size on screen.
+         * @param texture The texture, ignored if it is not streamed.
+         * @param screenSize The size in pixels the texture covers on screen.
+         */
+        static void Request(const Texture2D& texture, float screenSize);
+
+        /**
+         * @brief Gets the mip to sample for a texture covering a size on screen.
+         * @param width The width of the first mip.
+         * @param height The height of the first mip.
+         * @param screenSize The size in pixels the texture covers on screen.
+         * @param mipBias Added to the mip, positive values are blurrier.
+         * @return The mip index, 0 for the finest.
+         */
+        static uint32_t ComputeRequiredMip(uint32_t width, uint32_t height, float screenSize, float mipBias = 0.0f);
+
+        static const TextureStreamingSettings& GetSettings();
+        static void SetSettings(const TextureStreamingSettings& settings);
+
+        /**
+         * @brief Gets the GPU bytes used by the streamed textures.
+         * @return The used part of the budget.
+         */
+        static uint64_t GetUsedBytes();
+
+    private:
+        class Backend;
+
+        static void LoadMips(StreamingHandle handle, uint32_t firstMip);
+        static void EvictMips(StreamingHandle handle, uint32_t firstMip);
+    };
+
+    /** @} */
+}
@@ -0,0 +1,237 @@
+#include "TextureStreamingPolicy.h"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+
+namespace Coffee {
+
+    TextureStreamingPolicy::TextureStreamingPolicy(TextureStreamingBackend& backend, const TextureStreamingSettings& settings)
+        : m_Backend(backend), m_Settings(settings)
+    {
+    }
+
+    StreamingHandle TextureStreamingPolicy::Register(uint32_t width, uint32_t height, const std::vector<uint64_t>& mipBytes)
+    {
+        StreamingHandle handle;
+        if (!m_FreeHandles.empty())
+        {
+            handle = m_FreeHandles.back();
+            m_FreeHandles.pop_back();
+        }
+        else
+        {
+            handle = (StreamingHandle)m_Entries.size();
+            m_Entries.emplace_back();
+        }
+
+        Entry& entry = m_Entries[handle];
+        entry = Entry();
+        entry.Alive = true;
+        entry.MipBytes = mipBytes;
+
+        // The first mip small enough to always stay resident, the last one if none is
+        uint32_t mipCount = (uint32_t)mipBytes.size();
+        uint32_t baseMip = 0;
+        while (baseMip + 1 < mipCount && std::max(width >> baseMip, height >> baseMip) > m_Settings.MinResidentSize)
+            baseMip++;
+
+        entry.BaseMip = baseMip;
+        entry.ResidentMip = baseMip;
+        entry.RequiredMip = baseMip;
+
+        m_UsedBytes += GetBytes(entry, baseMip, mipCount);
+
+        return handle;
+    }
+
+    void TextureStreamingPolicy::Unregister(StreamingHandle handle)
+    {
+        if (handle >= m_Entries.size() || !m_Entries[handle].Alive)
+            return;
+
+        Entry& entry = m_Entries[handle];
+
+        uint32_t firstMip = entry.Loading ? std::min(entry.LoadingMip, entry.ResidentMip) : entry.ResidentMip;
+        m_UsedBytes -= GetBytes(entry, firstMip, (uint32_t)entry.MipBytes.size());
+
+        if (entry.Loading)
+            m_LoadsInFlight--;
+
+        entry = Entry();
+        m_FreeHandles.push_back(handle);
+    }
+
+    void TextureStreamingPolicy::Request(StreamingHandle handle, uint32_t mip)
+    {
+        if (handle >= m_Entries.size() || !m_Entries[handle].Alive)
+            return;
+
+        Entry& entry = m_Entries[handle];
+        entry.RequestedMip = std::min(entry.RequestedMip, mip);
+    }
+
+    void TextureStreamingPolicy::Update()
+    {
+        ZoneScoped;
+
+        // Requests of the frame that just ended
+        std::vector<StreamingHandle>& candidates = m_Candidates;
+        candidates.clear();
+        for (StreamingHandle handle = 0; handle < m_Entries.size(); handle++)
+        {
+            Entry& entry = m_Entries[handle];
+            if (!entry.Alive || entry.RequestedMip == UINT32_MAX)
+                continue;
+
+            entry.RequiredMip = std::min(entry.RequestedMip, entry.BaseMip);
+            entry.LastNeededFrame = m_Frame;
+            entry.RequestedMip = UINT32_MAX;
+
+            if (!entry.Loading && entry.RequiredMip < entry.ResidentMip)
+                candidates.push_back(handle);
+        }
+
+        // A lowered budget is given back first, as far as the visible textures allow
+        if (m_UsedBytes > m_Settings.BudgetBytes)
+            Evict(m_UsedBytes - m_Settings.BudgetBytes, InvalidStreamingHandle, true);
+
+        // The textures missing the most mips are the most visibly blurry, they load first
+        std::sort(candidates.begin(), candidates.end(), [this](StreamingHandle a, StreamingHandle b) {
+            const Entry& entryA = m_Entries[a];
+            const Entry& entryB = m_Entries[b];
+            uint32_t missingA = entryA.ResidentMip - entryA.RequiredMip;
+            uint32_t missingB = entryB.ResidentMip - entryB.RequiredMip;
+            return missingA != missingB ? missingA > missingB : a < b;
+        });
+
+        for (StreamingHandle handle : candidates)
+        {
+            if (m_LoadsInFlight >= m_Settings.MaxLoadsInFlight)
+                break;
+
+            Entry& entry = m_Entries[handle];
+            uint32_t mipCount = (uint32_t)entry.MipBytes.size();
+
+            // Settles for a coarser mip when the finest one does not fit, even after evicting
+            uint32_t target = entry.RequiredMip;
+            uint64_t cost = 0;
+            for (; target < entry.ResidentMip; target++)
+            {
+                cost = GetBytes(entry, target, entry.ResidentMip);
+                if (m_UsedBytes + cost <= m_Settings.BudgetBytes || Evict(m_UsedBytes + cost - m_Settings.BudgetBytes, handle, false))
+                    break;
+            }
+
+            if (target >= entry.ResidentMip || target >= mipCount)
+                continue;
+
+            entry.Loading = true;
+            entry.LoadingMip = target;
+            m_UsedBytes += cost;
+            m_LoadsInFlight++;
+
+            // The backend may finish synchronously, so the state is set before calling it
+            m_Backend.LoadMips(handle, target);
+        }
+
+        m_Frame++;
+    }
+
+    void TextureStreamingPolicy::OnLoadFinished(StreamingHandle handle, uint32_t firstMip)
+    {
+        if (handle >= m_Entries.size() || !m_Entries[handle].Alive || !m_Entries[handle].Loading)
+            return;
+
+        Entry& entry = m_Entries[handle];
+
+        // The budget reserved for the load is given back for the mips that did not make it
+        firstMip = std::min(std::max(firstMip, entry.LoadingMip), entry.ResidentMip);
+        m_UsedBytes -= GetBytes(entry, entry.LoadingMip, firstMip);
+
+        entry.ResidentMip = firstMip;
+        entry.Loading = false;
+        m_LoadsInFlight--;
+    }
+
+    uint32_t TextureStreamingPolicy::GetResidentMip(StreamingHandle handle) const
+    {
+        return handle < m_Entries.size() ? m_Entries[handle].ResidentMip : 0;
+    }
+
+    uint32_t TextureStreamingPolicy::GetRequiredMip(StreamingHandle handle) const
+    {
+        return handle < m_Entries.size() ? m_Entries[handle].RequiredMip : 0;
+    }
+
+    bool TextureStreamingPolicy::IsLoading(StreamingHandle handle) const
+    {
+        return handle < m_Entries.size() && m_Entries[handle].Loading;
+    }
+
+    uint64_t TextureStreamingPolicy::GetBytes(const Entry& entry, uint32_t firstMip, uint32_t endMip) const
+    {
+        uint64_t bytes = 0;
+        for (uint32_t mip = firstMip; mip < endMip && mip < entry.MipBytes.size(); mip++)
+            bytes += entry.MipBytes[mip];
+        return bytes;
+    }
+
+    uint32_t TextureStreamingPolicy::GetKeepMip(const Entry& entry) const
+    {
+        // Textures visible last frame keep what they need, the others only their base mips
+        return entry.LastNeededFrame == m_Frame ? entry.RequiredMip : entry.BaseMip;
+    }
+
+    bool TextureStreamingPolicy::Evict(uint64_t bytes, StreamingHandle exclude, bool partial)
+    {
+        ZoneScoped;
+
+        std::vector<StreamingHandle>& victims = m_Victims;
+        victims.clear();
+        uint64_t available = 0;
+        for (StreamingHandle handle = 0; handle < m_Entries.size(); handle++)
+        {
+            const Entry& entry = m_Entries[handle];
+            if (!entry.Alive || entry.Loading || handle == exclude || entry.ResidentMip >= GetKeepMip(entry))
+                continue;
+
+            victims.push_back(handle);
+            available += GetBytes(entry, entry.ResidentMip, GetKeepMip(entry));
+        }
+
+        // Nothing is evicted for a load that would not fit anyway
+        if (available < bytes && !partial)
+            return false;
+
+        // Least recently needed first, and among those the finest mips first
+        std::sort(victims.begin(), victims.end(), [this](StreamingHandle a, StreamingHandle b) {
+            const Entry& entryA = m_Entries[a];
+            const Entry& entryB = m_Entries[b];
+            if (entryA.LastNeededFrame != entryB.LastNeededFrame)
+                return entryA.LastNeededFrame < entryB.LastNeededFrame;
+            return entryA.ResidentMip != entryB.ResidentMip ? entryA.ResidentMip < entryB.ResidentMip : a < b;
+        });
+
+        uint64_t freed = 0;
+        for (StreamingHandle handle : victims)
+        {
+            if (freed >= bytes)
+                break;
+
+            Entry& entry = m_Entries[handle];
+            uint32_t keepMip = GetKeepMip(entry);
+            uint32_t firstMip = entry.ResidentMip;
+
+            while (firstMip < keepMip && freed < bytes)
+                freed += entry.MipBytes[firstMip++];
+
+            m_UsedBytes -= GetBytes(entry, entry.ResidentMip, firstMip);
+            entry.ResidentMip = firstMip;
+            m_Backend.EvictMips(handle, firstMip);
+        }
+
+        return freed >= bytes;
+    }
+
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    using StreamingHandle = uint32_t;
+    static constexpr StreamingHandle InvalidStreamingHandle = UINT32_MAX;
+
+    /**
+     * @brief The limits of the texture streaming.
+     */
+    struct TextureStreamingSettings
+    {
+        uint64_t BudgetBytes = 512ull * 1024 * 1024; ///< The GPU memory the streamed textures may use.
+        uint32_t MinResidentSize = 64; ///< Mips this size or smaller are always resident, so a texture is never missing.
+        uint32_t MaxLoadsInFlight = 8; ///< The number of mip loads that can be pending at once.
+        float MipBias = 0.0f; ///< Added to the required mip, positive values trade sharpness for memory.
+    };
+
+    /**
+     * @class TextureStreamingBackend
+     * @brief Moves the mips of the streamed textures in and out of GPU memory for a TextureStreamingPolicy.
+     */
+    class TextureStreamingBackend
+    {
+    public:
+        virtual ~TextureStreamingBackend() = default;
+
+        /**
+         * @brief Starts making the mips from firstMip to the last one resident.
+         *
+         * When done, now or in a later frame, the backend calls TextureStreamingPolicy::OnLoadFinished.
+         *
+         * @param handle The streamed texture.
+         * @param firstMip The finest mip to load.
+         */
+        virtual void LoadMips(StreamingHandle handle, uint32_t firstMip) = 0;
+
+        /**
+         * @brief Drops the mips finer than firstMip, immediately.
+         * @param handle The streamed texture.
+         * @param firstMip The finest mip to keep.
+         */
+        virtual void EvictMips(StreamingHandle handle, uint32_t firstMip) = 0;
+    };
+
+    /**
+     * @class TextureStreamingPolicy
+     * @brief Decides which mips of the streamed textures are resident under a memory budget.
+     *
+     * Textures start with only their small mips. Every frame the renderer requests the finest mip each visible
+     * texture needs, and Update asks the backend to load the missing mips, the most blurry textures first. When
+     * the budget is full, the mips of the least recently needed textures are evicted to make room.
+     *
+     * The policy does not touch the GPU, everything goes through the backend.
+     */
+    class TextureStreamingPolicy
+    {
+    public:
+        /**
+         * @brief Creates a policy.
+         * @param backend The backend that loads and evicts the mips, must outlive the policy.
+         * @param settings The budget and limits.
+         */
+        TextureStreamingPolicy(TextureStreamingBackend& backend, const TextureStreamingSettings& settings = {});
+
+        /**
+         * @brief Starts streaming a texture. The caller makes the mips from GetResidentMip resident itself.
+         * @param width The width of the first mip.
+         * @param height The height of the first mip.
+         * @param mipBytes The GPU size of every mip, from the finest.
+         * @return The handle of the texture.
+         */
+        StreamingHandle Register(uint32_t width, uint32_t height, const std::vector<uint64_t>& mipBytes);
+
+        /**
+         * @brief Stops streaming a texture and releases its memory from the budget.
+         * @param handle The streamed texture.
+         */
+        void Unregister(StreamingHandle handle);
+
+        /**
+         * @brief Requests a mip of a texture for the current frame. The finest request of the frame wins.
+         * @param handle The streamed texture.
+         * @param mip The finest mip needed.
+         */
+        void Request(StreamingHandle handle, uint32_t mip);
+
+        /**
+         * @brief Ends the frame: starts the loads and evictions for the requests made since the last update.
+         */
+        void Update();
+
+        /**
+         * @brief Called by the backend when a load finished.
+         * @param handle The streamed texture.
+         * @param firstMip The finest mip now resident, the previous one if the load failed.
+         */
+        void OnLoadFinished(StreamingHandle handle, uint32_t firstMip);
+
+        /**
+         * @brief Gets the finest resident mip of a texture.
+         * @param handle The streamed texture.
+         * @return The mip index.
+         */
+        uint32_t GetResidentMip(StreamingHandle handle) const;
+
+        /**
+         * @brief Gets the finest mip the last frame needed for a texture.
+         * @param handle The streamed texture.
+         * @return The mip index.
+         */
+        uint32_t GetRequiredMip(StreamingHandle handle) const;
+
+        /**
+         * @brief Checks whether a load is pending for a texture.
+         * @param handle The streamed texture.
+         * @return True while the backend loads its mips.
+         */
+        bool IsLoading(StreamingHandle handle) const;
+
+        /**
+         * @brief Gets the bytes of the resident mips, including the loads in flight.
+         * @return The used part of the budget.
+         */
+        uint64_t GetUsedBytes() const { return m_UsedBytes; }
+
+        /**
+         * @brief Gets the number of loads in flight.
+         * @return The pending loads.
+         */
+        uint32_t GetLoadsInFlight() const { return m_LoadsInFlight; }
+
+        const TextureStreamingSettings& GetSettings() const { return m_Settings; }
+        void SetSettings(const TextureStreamingSettings& settings) { m_Settings = settings; }
+
+    private:
+        struct Entry
+        {
+            bool Alive = false;
+            std::vector<uint64_t> MipBytes;
+            uint32_t BaseMip = 0; ///< The mips from this one are always resident.
+            uint32_t ResidentMip = 0; ///< The finest resident mip.
+            uint32_t LoadingMip = 0; ///< The finest mip of the load in flight.
+            bool Loading = false;
+            uint32_t RequestedMip = UINT32_MAX; ///< The finest mip requested in the current frame.
+            uint32_t RequiredMip = 0; ///< The finest mip needed the last time the texture was visible.
+            uint64_t LastNeededFrame = 0;
+        };
+
+        uint64_t GetBytes(const Entry& entry, uint32_t firstMip, uint32_t endMip) const;
+        uint32_t GetKeepMip(const Entry& entry) const;
+        bool Evict(uint64_t bytes, StreamingHandle exclude, bool partial);
+
+    private:
+        TextureStreamingBackend& m_Backend;
+        TextureStreamingSettings m_Settings;
+
+        std::vector<Entry> m_Entries;
+        std::vector<StreamingHandle> m_FreeHandles;
+
+        // Reused every frame so the update does not allocate
+        std::vector<StreamingHandle> m_Candidates;
+        std::vector<StreamingHandle> m_Victims;
+
+        uint64_t m_Frame = 1;
+        uint64_t m_UsedBytes = 0;
+        uint32_t m_LoadsInFlight = 0;
+    };
+
+    /** @} */
+}
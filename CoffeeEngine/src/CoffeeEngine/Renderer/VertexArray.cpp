@@ -20,6 +20,11 @@ namespace Coffee {
 		    case ShaderDataType::Mat2:     return GL_FLOAT;
 			case ShaderDataType::Mat3:     return GL_FLOAT;
 			case ShaderDataType::Mat4:     return GL_FLOAT;
+			case ShaderDataType::Half2:    return GL_HALF_FLOAT;
+			case ShaderDataType::Short2:   return GL_SHORT;
+			case ShaderDataType::UShort4:  return GL_UNSIGNED_SHORT;
+			case ShaderDataType::UByte4:   return GL_UNSIGNED_BYTE;
+			case ShaderDataType::UInt:     return GL_UNSIGNED_INT;
 		}
 
 		COFFEE_CORE_ASSERT(false, "Unknown ShaderDataType!");
@@ -68,10 +73,26 @@ namespace Coffee {
 		{
 			switch (attribute.Type)
 			{
+				case ShaderDataType::UByte4:
+				{
+					// Normalized bytes are read as floats, the others as integers (bone indices)
+					glEnableVertexAttribArray(m_VertexBufferIndex);
+					if (attribute.Normalized)
+						glVertexAttribPointer(m_VertexBufferIndex, 4, GL_UNSIGNED_BYTE, GL_TRUE, layout.GetStride(), (const void*)attribute.Offset);
+					else
+						glVertexAttribIPointer(m_VertexBufferIndex, 4, GL_UNSIGNED_BYTE, layout.GetStride(), (const void*)attribute.Offset);
+					if (attribute.Instanced)
+						glVertexAttribDivisor(m_VertexBufferIndex, 1);
+					m_VertexBufferIndex++;
+					break;
+				}
 				case ShaderDataType::Float:
 				case ShaderDataType::Vec2:
 				case ShaderDataType::Vec3:
 				case ShaderDataType::Vec4:
+				case ShaderDataType::Half2:
+				case ShaderDataType::Short2:
+				case ShaderDataType::UShort4:
 				{
 					glEnableVertexAttribArray(m_VertexBufferIndex);
 					glVertexAttribPointer(m_VertexBufferIndex,
@@ -80,12 +101,15 @@ namespace Coffee {
 						attribute.Normalized ? GL_TRUE : GL_FALSE,
 						layout.GetStride(),
 						(const void*)attribute.Offset);
+					if (attribute.Instanced)
+						glVertexAttribDivisor(m_VertexBufferIndex, 1);
 					m_VertexBufferIndex++;
 					break;
 				}
 				case ShaderDataType::Int:
 				case ShaderDataType::Bool:
 			    case ShaderDataType::IVec4:
+				case ShaderDataType::UInt:
 				{
 					glEnableVertexAttribArray(m_VertexBufferIndex);
 					glVertexAttribIPointer(m_VertexBufferIndex,
@@ -93,6 +117,8 @@ namespace Coffee {
 						ShaderDataTypeToOpenGLBaseType(attribute.Type),
 						layout.GetStride(),
 						(const void*)attribute.Offset);
+					if (attribute.Instanced)
+						glVertexAttribDivisor(m_VertexBufferIndex, 1);
 					m_VertexBufferIndex++;
 					break;
 				}
@@ -0,0 +1,211 @@
+#include "VertexQuantization.h"
+
+#include "CoffeeEngine/Renderer/Mesh.h"
+
+#include <glm/packing.hpp>
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Coffee {
+
+    static constexpr uint32_t s_TangentMask = 0x7FFF;
+    static constexpr float s_TangentMax = 32767.0f;
+    static constexpr uint32_t s_TangentSignBit = 0x80000000u;
+
+    static glm::vec2 SignNotZero(const glm::vec2& v)
+    {
+        return {v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f};
+    }
+
+    glm::vec2 VertexQuantization::OctEncode(const glm::vec3& vector)
+    {
+        float l1 = std::abs(vector.x) + std::abs(vector.y) + std::abs(vector.z);
+        if (l1 <= std::numeric_limits<float>::epsilon())
+            return {0.0f, 0.0f};
+
+        glm::vec2 encoded = glm::vec2(vector.x, vector.y) / l1;
+
+        // The lower hemisphere is folded over the diagonals of the square
+        if (vector.z < 0.0f)
+            encoded = (1.0f - glm::abs(glm::vec2(encoded.y, encoded.x))) * SignNotZero(encoded);
+
+        return encoded;
+    }
+
+    glm::vec3 VertexQuantization::OctDecode(const glm::vec2& encoded)
+    {
+        glm::vec3 vector(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+        float t = std::max(-vector.z, 0.0f);
+        vector.x += vector.x >= 0.0f ? -t : t;
+        vector.y += vector.y >= 0.0f ? -t : t;
+        return glm::normalize(vector);
+    }
+
+    uint32_t VertexQuantization::PackTexCoords(const glm::vec2& texCoords)
+    {
+        return glm::packHalf2x16(texCoords);
+    }
+
+    glm::vec2 VertexQuantization::UnpackTexCoords(uint32_t packed)
+    {
+        return glm::unpackHalf2x16(packed);
+    }
+
+    uint32_t VertexQuantization::PackNormal(const glm::vec3& normal)
+    {
+        return glm::packSnorm2x16(OctEncode(normal));
+    }
+
+    glm::vec3 VertexQuantization::UnpackNormal(uint32_t packed)
+    {
+        return OctDecode(glm::unpackSnorm2x16(packed));
+    }
+
+    uint32_t VertexQuantization::PackTangent(const glm::vec3& tangent, float bitangentSign)
+    {
+        // Meshes without texture coordinates have no tangents, any unit vector will do
+        glm::vec3 direction = glm::dot(tangent, tangent) > 0.0f ? tangent : glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec2 encoded = OctEncode(direction) * 0.5f + 0.5f;
+
+        uint32_t x = (uint32_t)std::lround(glm::clamp(encoded.x, 0.0f, 1.0f) * s_TangentMax);
+        uint32_t y = (uint32_t)std::lround(glm::clamp(encoded.y, 0.0f, 1.0f) * s_TangentMax);
+        uint32_t sign = bitangentSign < 0.0f ? s_TangentSignBit : 0u;
+        return x | (y << 15) | sign;
+    }
+
+    glm::vec4 VertexQuantization::UnpackTangent(uint32_t packed)
+    {
+        glm::vec2 encoded((packed & s_TangentMask) / s_TangentMax, ((packed >> 15) & s_TangentMask) / s_TangentMax);
+        float sign = (packed & s_TangentSignBit) ? -1.0f : 1.0f;
+        return glm::vec4(OctDecode(encoded * 2.0f - 1.0f), sign);
+    }
+
+    float VertexQuantization::GetBitangentSign(const Vertex& vertex)
+    {
+        return glm::dot(glm::cross(vertex.Normals, vertex.Tangent), vertex.Bitangent) < 0.0f ? -1.0f : 1.0f;
+    }
+
+    uint32_t VertexQuantization::PackBones(const glm::ivec4& boneIDs, const glm::vec4& boneWeights, uint8_t packedIDs[4])
+    {
+        glm::vec4 weights(0.0f);
+        for (int i = 0; i < 4; i++)
+        {
+            // Unused influences point to bone 0 with a zero weight, so the shader can skip the -1 test
+            bool used = boneIDs[i] >= 0 && boneWeights[i] > 0.0f;
+            packedIDs[i] = used ? (uint8_t)std::min(boneIDs[i], 255) : 0;
+            weights[i] = used ? boneWeights[i] : 0.0f;
+        }
+
+        float sum = weights.x + weights.y + weights.z + weights.w;
+        if (sum <= 0.0f)
+            return 0;
+
+        int quantized[4];
+        int total = 0;
+        int largest = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            quantized[i] = (int)std::lround(weights[i] / sum * 255.0f);
+            total += quantized[i];
+            if (weights[i] > weights[largest])
+                largest = i;
+        }
+
+        // Rounding can make the weights sum to slightly more or less than one, the largest weight absorbs it
+        quantized[largest] = std::clamp(quantized[largest] + 255 - total, 0, 255);
+
+        return (uint32_t)quantized[0] | ((uint32_t)quantized[1] << 8) | ((uint32_t)quantized[2] << 16) | ((uint32_t)quantized[3] << 24);
+    }
+
+    glm::vec4 VertexQuantization::UnpackBoneWeights(uint32_t packed)
+    {
+        return glm::unpackUnorm4x8(packed);
+    }
+
+    void VertexQuantization::GetPositionBounds(const std::vector<Vertex>& vertices, glm::vec3& offset, float& scale)
+    {
+        glm::vec3 min(std::numeric_limits<float>::max());
+        glm::vec3 max(std::numeric_limits<float>::lowest());
+        for (const Vertex& vertex : vertices)
+        {
+            min = glm::min(min, vertex.Position);
+            max = glm::max(max, vertex.Position);
+        }
+
+        if (vertices.empty())
+            min = max = glm::vec3(0.0f);
+
+        glm::vec3 extent = max - min;
+        offset = min;
+        scale = std::max({extent.x, extent.y, extent.z, std::numeric_limits<float>::epsilon()});
+    }
+
+    glm::vec3 VertexQuantization::UnpackPosition(const uint16_t packed[4], const glm::vec3& offset, float scale)
+    {
+        return offset + glm::vec3(packed[0], packed[1], packed[2]) / 65535.0f * scale;
+    }
+
+    bool VertexQuantization::IsSkinned(const std::vector<Vertex>& vertices)
+    {
+        return std::any_of(vertices.begin(), vertices.end(), [](const Vertex& vertex) {
+            return vertex.BoneIDs.x >= 0 && vertex.BoneWeights.x > 0.0f;
+        });
+    }
+
+    std::vector<StaticVertex> VertexQuantization::EncodeStatic(const std::vector<Vertex>& vertices)
+    {
+        ZoneScoped;
+
+        std::vector<StaticVertex> encoded(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const Vertex& vertex = vertices[i];
+            encoded[i].Position = vertex.Position;
+            encoded[i].TexCoords = PackTexCoords(vertex.TexCoords);
+            encoded[i].Normal = PackNormal(vertex.Normals);
+            encoded[i].Tangent = PackTangent(vertex.Tangent, GetBitangentSign(vertex));
+        }
+        return encoded;
+    }
+
+    std::vector<SkinnedVertex> VertexQuantization::EncodeSkinned(const std::vector<Vertex>& vertices)
+    {
+        ZoneScoped;
+
+        std::vector<SkinnedVertex> encoded(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const Vertex& vertex = vertices[i];
+            encoded[i].Position = vertex.Position;
+            encoded[i].TexCoords = PackTexCoords(vertex.TexCoords);
+            encoded[i].Normal = PackNormal(vertex.Normals);
+            encoded[i].Tangent = PackTangent(vertex.Tangent, GetBitangentSign(vertex));
+            encoded[i].BoneWeights = PackBones(vertex.BoneIDs, vertex.BoneWeights, encoded[i].BoneIDs);
+        }
+        return encoded;
+    }
+
+    std::vector<QuantizedStaticVertex> VertexQuantization::EncodeQuantizedStatic(const std::vector<Vertex>& vertices, const glm::vec3& offset, float scale)
+    {
+        ZoneScoped;
+
+        std::vector<QuantizedStaticVertex> encoded(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const Vertex& vertex = vertices[i];
+            glm::vec3 normalized = glm::clamp((vertex.Position - offset) / scale, 0.0f, 1.0f);
+            encoded[i].Position[0] = (uint16_t)std::lround(normalized.x * 65535.0f);
+            encoded[i].Position[1] = (uint16_t)std::lround(normalized.y * 65535.0f);
+            encoded[i].Position[2] = (uint16_t)std::lround(normalized.z * 65535.0f);
+            encoded[i].Position[3] = 0;
+            encoded[i].TexCoords = PackTexCoords(vertex.TexCoords);
+            encoded[i].Normal = PackNormal(vertex.Normals);
+            encoded[i].Tangent = PackTangent(vertex.Tangent, GetBitangentSign(vertex));
+        }
+        return encoded;
+    }
+
+}
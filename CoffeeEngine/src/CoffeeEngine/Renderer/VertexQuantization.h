@@ -0,0 +1,155 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    struct Vertex;
+
+    /**
+     * @defgroup renderer Renderer
+     * @brief Renderer components of the CoffeeEngine.
+     * @{
+     */
+
+    /**
+     * @brief GPU vertex of a mesh without bones (24 bytes).
+     *
+     * Attribute locations: 0 position, 1 half-float texture coordinates, 2 octahedral normal (snorm16x2),
+     * 3 octahedral tangent with the bitangent sign (uint). The bitangent is rebuilt in the vertex shader.
+     */
+    struct StaticVertex {
+        glm::vec3 Position; ///< The position of the vertex.
+        uint32_t TexCoords; ///< The texture coordinates as two half floats.
+        uint32_t Normal; ///< The octahedral normal as two snorm16.
+        uint32_t Tangent; ///< The octahedral tangent as two 15-bit unorms, the bitangent sign in the top bit.
+    };
+
+    /**
+     * @brief GPU vertex of a mesh without bones with positions quantized to the mesh bounds (20 bytes).
+     *
+     * The position is stored as unorm16 relative to the mesh bounds and scaled uniformly, so the
+     * dequantization is a translation and a uniform scale that the renderer folds into the model matrix.
+     */
+    struct QuantizedStaticVertex {
+        uint16_t Position[4]; ///< The position as unorm16 in the mesh bounds, the last component is padding.
+        uint32_t TexCoords; ///< The texture coordinates as two half floats.
+        uint32_t Normal; ///< The octahedral normal as two snorm16.
+        uint32_t Tangent; ///< The octahedral tangent as two 15-bit unorms, the bitangent sign in the top bit.
+    };
+
+    /**
+     * @brief GPU vertex of a skinned mesh (32 bytes).
+     *
+     * Same as StaticVertex followed by the bone indices (location 4, u8x4) and the bone weights (location 5, unorm8x4).
+     */
+    struct SkinnedVertex {
+        glm::vec3 Position; ///< The position of the vertex.
+        uint32_t TexCoords; ///< The texture coordinates as two half floats.
+        uint32_t Normal; ///< The octahedral normal as two snorm16.
+        uint32_t Tangent; ///< The octahedral tangent as two 15-bit unorms, the bitangent sign in the top bit.
+        uint8_t BoneIDs[4]; ///< The bone indices, unused influences point to bone 0 with a zero weight.
+        uint32_t BoneWeights; ///< The bone weights as unorm8x4, summing to exactly 255.
+    };
+
+    static_assert(sizeof(StaticVertex) == 24, "StaticVertex must be tightly packed");
+    static_assert(sizeof(QuantizedStaticVertex) == 20, "QuantizedStaticVertex must be tightly packed");
+    static_assert(sizeof(SkinnedVertex) == 32, "SkinnedVertex must be tightly packed");
+
+    /**
+     * @brief Encodes the vertices of a mesh into the compact GPU vertex formats, and decodes them back.
+     *
+     * Worst case decode errors: 0.004 degrees for normals, 0.008 degrees for tangents, half-float
+     * precision for texture coordinates (11 significant bits), 1.5/255 for bone weights and 1/131070 of the
+     * largest mesh extent for quantized positions. The bitangent sign is exact.
+     */
+    class VertexQuantization
+    {
+    public:
+        /**
+         * @brief Maps a unit vector to the [-1, 1] square with an octahedral projection.
+         * @param vector The unit vector.
+         * @return The octahedral coordinates.
+         */
+        static glm::vec2 OctEncode(const glm::vec3& vector);
+
+        /**
+         * @brief Maps octahedral coordinates back to a unit vector.
+         * @param encoded The octahedral coordinates.
+         * @return The normalized vector.
+         */
+        static glm::vec3 OctDecode(const glm::vec2& encoded);
+
+        static uint32_t PackTexCoords(const glm::vec2& texCoords); ///< Packs texture coordinates as two half floats.
+        static glm::vec2 UnpackTexCoords(uint32_t packed); ///< Unpacks texture coordinates packed with PackTexCoords.
+
+        static uint32_t PackNormal(const glm::vec3& normal); ///< Packs a normal as octahedral snorm16x2.
+        static glm::vec3 UnpackNormal(uint32_t packed); ///< Unpacks a normal packed with PackNormal.
+
+        /**
+         * @brief Packs a tangent and the sign of the bitangent in 32 bits.
+         * @param tangent The tangent.
+         * @param bitangentSign The handedness of the tangent frame, bitangent = cross(normal, tangent) * sign.
+         * @return The packed tangent.
+         */
+        static uint32_t PackTangent(const glm::vec3& tangent, float bitangentSign);
+
+        /**
+         * @brief Unpacks a tangent packed with PackTangent.
+         * @return The tangent in xyz and the bitangent sign in w.
+         */
+        static glm::vec4 UnpackTangent(uint32_t packed);
+
+        /**
+         * @brief Gets the handedness of the tangent frame of a vertex.
+         * @param vertex The vertex.
+         * @return -1 if the bitangent is opposite to cross(normal, tangent), 1 otherwise.
+         */
+        static float GetBitangentSign(const Vertex& vertex);
+
+        /**
+         * @brief Packs the bone influences of a vertex.
+         * @param boneIDs The bone indices, -1 for unused influences. Indices are clamped to 255.
+         * @param boneWeights The bone weights. They are normalized so the packed weights sum to 255.
+         * @param packedIDs Receives the bone indices.
+         * @return The weights as unorm8x4.
+         */
+        static uint32_t PackBones(const glm::ivec4& boneIDs, const glm::vec4& boneWeights, uint8_t packedIDs[4]);
+
+        static glm::vec4 UnpackBoneWeights(uint32_t packed); ///< Unpacks bone weights packed with PackBones.
+
+        /**
+         * @brief Gets the bounds used to quantize the positions of a mesh.
+         * @param vertices The vertices of the mesh.
+         * @param offset Receives the minimum corner of the mesh bounds.
+         * @param scale Receives the largest extent of the mesh bounds.
+         */
+        static void GetPositionBounds(const std::vector<Vertex>& vertices, glm::vec3& offset, float& scale);
+
+        static glm::vec3 UnpackPosition(const uint16_t packed[4], const glm::vec3& offset, float scale); ///< Unpacks a quantized position.
+
+        /**
+         * @brief Checks whether any vertex of a mesh is influenced by a bone.
+         * @param vertices The vertices of the mesh.
+         * @return True if the mesh needs the skinned vertex format.
+         */
+        static bool IsSkinned(const std::vector<Vertex>& vertices);
+
+        static std::vector<StaticVertex> EncodeStatic(const std::vector<Vertex>& vertices); ///< Encodes the vertices of a static mesh.
+        static std::vector<SkinnedVertex> EncodeSkinned(const std::vector<Vertex>& vertices); ///< Encodes the vertices of a skinned mesh.
+
+        /**
+         * @brief Encodes the vertices of a static mesh with positions quantized to the mesh bounds.
+         * @param vertices The vertices of the mesh.
+         * @param offset The position offset returned by GetPositionBounds.
+         * @param scale The position scale returned by GetPositionBounds.
+         * @return The encoded vertices.
+         */
+        static std::vector<QuantizedStaticVertex> EncodeQuantizedStatic(const std::vector<Vertex>& vertices, const glm::vec3& offset, float scale);
+    };
+
+    /** @} */
+}
@@ -13,14 +13,21 @@ namespace Coffee
             : Loop(other.Loop), BlendDuration(other.BlendDuration), AnimationSpeed(other.AnimationSpeed),
               JointMatrices(other.JointMatrices), modelUUID(other.modelUUID), animatorUUID(other.animatorUUID),
               m_Skeleton(other.m_Skeleton), m_AnimationController(other.m_AnimationController),
-              UpperAnimation(other.UpperAnimation), LowerAnimation(other.LowerAnimation),
+              UpperAnimation(other.UpperAnimation ? CreateRef<AnimationLayer>(*other.UpperAnimation) : nullptr),
+              LowerAnimation(other.LowerAnimation ? CreateRef<AnimationLayer>(*other.LowerAnimation) : nullptr),
               PartialBlendThreshold(other.PartialBlendThreshold), UpperBodyWeight(other.UpperBodyWeight),
-              LowerBodyWeight(other.LowerBodyWeight), UpperBodyRootJoint(other.UpperBodyRootJoint)
+              LowerBodyWeight(other.LowerBodyWeight), UpperBodyRootJoint(other.UpperBodyRootJoint), LOD(other.LOD),
+              SharePose(other.SharePose)
     {
         m_BlendJob.layers = ozz::make_span(m_BlendLayers);
-        const std::string rootJointName = GetSkeleton()->GetJoints()[UpperBodyRootJoint].name;
-        AnimationSystem::SetupPartialBlending(UpperAnimation->CurrentAnimation, LowerAnimation->CurrentAnimation,
-                                                rootJointName, this);
+
+        // A default constructed or partially loaded component has nothing to blend yet
+        if (UpperAnimation && LowerAnimation && GetSkeleton())
+        {
+            const std::string rootJointName = GetSkeleton()->GetJoints()[UpperBodyRootJoint].name;
+            AnimationSystem::SetupPartialBlending(UpperAnimation->CurrentAnimation, LowerAnimation->CurrentAnimation,
+                                                    rootJointName, this);
+        }
         AnimationSystem::AddAnimator(this);
     }
 
@@ -32,6 +39,21 @@ namespace Coffee
         JointMatrices = m_Skeleton->GetJointMatrices();
     }
 
+    ozz::animation::SamplingJob::Context& AnimatorComponent::GetContext(const AnimationLayer* layer, bool next)
+    {
+        unsigned int layerIndex = layer == UpperAnimation.get() ? 1 : 0;
+        return m_Contexts[layerIndex][layer->ContextSlot ^ (next ? 1 : 0)];
+    }
+
+    void AnimatorComponent::ResizeContexts(int maxTracks)
+    {
+        for (auto& layerContexts : m_Contexts)
+        {
+            for (auto& context : layerContexts)
+                context.Resize(maxTracks);
+        }
+    }
+
     void AnimatorComponent::SetCurrentAnimation(unsigned int index)
     {
         AnimationSystem::SetCurrentAnimation(index, this, UpperAnimation.get());
@@ -61,6 +83,9 @@ namespace Coffee
                 cereal::make_nvp("UpperBodyWeight", UpperBodyWeight),
                 cereal::make_nvp("LowerBodyWeight", LowerBodyWeight),
                 cereal::make_nvp("UpperBodyRootJoint", UpperBodyRootJoint));
+
+        archive(cereal::make_nvp("LOD", LOD));
+        archive(cereal::make_nvp("SharePose", SharePose));
     }
 
     template <class Archive> 
@@ -76,6 +101,12 @@ namespace Coffee
                 cereal::make_nvp("LowerBodyWeight", LowerBodyWeight),
                 cereal::make_nvp("UpperBodyRootJoint", UpperBodyRootJoint));
 
+        if (version >= 1)
+            archive(cereal::make_nvp("LOD", LOD));
+
+        if (version >= 2)
+            archive(cereal::make_nvp("SharePose", SharePose));
+
         AnimationSystem::LoadAnimator(this);
     }
 
@@ -1,10 +1,12 @@
 #pragma once
 
+#include "CoffeeEngine/Animation/AnimationLOD.h"
 #include "CoffeeEngine/Core/Base.h"
 #include "CoffeeEngine/Core/UUID.h"
 
 #include <cereal/cereal.hpp>
 #include <glm/fwd.hpp>
+#include <ozz/base/maths/simd_math.h>
 #include <ozz/base/maths/soa_transform.h>
 #include <ozz/animation/runtime/sampling_job.h>
 #include <ozz/animation/runtime/blending_job.h>
@@ -69,10 +71,22 @@ namespace Coffee
         }
 
         /**
-         * @brief Gets the sampling job context.
+         * @brief Gets the sampling job context of a layer.
+         *
+         * Each layer has one context for its current animation and one for the animation it blends to. A context
+         * caches the keyframes of the last animation it sampled, so they are never shared between animations.
+         *
+         * @param layer The upper or lower animation layer.
+         * @param next Whether to get the context of the next animation of the blend.
          * @return The sampling job context.
          */
-        ozz::animation::SamplingJob::Context& GetContext() { return m_Context; }
+        ozz::animation::SamplingJob::Context& GetContext(const AnimationLayer* layer, bool next = false);
+
+        /**
+         * @brief Resizes every sampling job context.
+         * @param maxTracks The number of tracks of the animations, the number of joints of the skeleton.
+         */
+        void ResizeContexts(int maxTracks);
 
         /**
          * @brief Gets the blend layers.
@@ -128,6 +142,7 @@ namespace Coffee
         UUID animatorUUID;                                       ///< The UUID of the animator.
         int UpperBodyRootJoint = 0;                              ///< Index of the root joint for upper body animations.
         std::vector<ozz::math::SoaTransform> PartialBlendOutput; ///< Output transforms for partial blending.
+        std::vector<ozz::math::Float4x4> ModelSpaceTransforms;   ///< Model space transforms of the joints, reused every frame.
 
         float UpperBodyWeight = 1.0f;        ///< Weight for blending upper body animations.
         float LowerBodyWeight = 1.0f;        ///< Weight for blending lower body animations.
@@ -138,14 +153,19 @@ namespace Coffee
 
         bool NeedsUpdate = true; ///< Flag to indicate if the animator needs an update.
 
+        AnimationLODSettings LOD; ///< When to update the animator at a reduced rate.
+        AnimationLODState LODState; ///< The level of detail inputs and state, not serialized.
+
+        bool SharePose = false; ///< Whether to sample at the pose sharing time step and reuse the pose of identical animators.
+
       private:
         Ref<Skeleton> m_Skeleton;                       ///< The skeleton reference.
         Ref<AnimationController> m_AnimationController; ///< The animation controller reference.
 
-        ozz::animation::SamplingJob::Context m_Context;      ///< The sampling job context.
-        ozz::animation::BlendingJob::Layer m_BlendLayers[2]; ///< The blend layers.
-        ozz::animation::BlendingJob m_BlendJob;              ///< The blending job.
+        ozz::animation::SamplingJob::Context m_Contexts[2][2]; ///< The sampling job contexts, per layer (lower, upper) and per blend slot.
+        ozz::animation::BlendingJob::Layer m_BlendLayers[2];   ///< The blend layers.
+        ozz::animation::BlendingJob m_BlendJob;                ///< The blending job.
     };
 }
 
-CEREAL_CLASS_VERSION(Coffee::AnimatorComponent, 0);
+CEREAL_CLASS_VERSION(Coffee::AnimatorComponent, 2);
@@ -21,6 +21,7 @@ namespace Coffee
 
         AnimatorComponent* animator = nullptr; ///< The animator component.
         UUID animatorUUID = 0;                 ///< The UUID of the animator.
+        uint32_t lodLevel = 0;                 ///< The LOD drawn last frame, not serialized.
 
         MeshComponent() {}
         MeshComponent(const MeshComponent&) = default;
@@ -1,8 +1,12 @@
 #include "PrimitiveMesh.h"
 #include "CoffeeEngine/Core/Base.h"
+#include "CoffeeEngine/Core/Hash.h"
+#include "CoffeeEngine/IO/ResourceRegistry.h"
 #include "CoffeeEngine/Renderer/Mesh.h"
 #include <stdint.h>
 #include <glm/gtc/constants.hpp>
+#include <tracy/Tracy.hpp>
+#include <unordered_map>
 #include <vector>
 
 namespace Coffee {
@@ -22,7 +26,95 @@ namespace Coffee {
     }
     */
 
+    static std::unordered_map<UUID, Ref<Mesh>> s_PrimitiveCache;
+
+    // The UUID is derived from the shape, so the same primitive gets the same UUID in every session
+    template<typename... Args>
+    static UUID GetPrimitiveUUID(PrimitiveType type, const Args&... args)
+    {
+        uint64_t hash = Hash::FNV1a(&type, sizeof(type));
+        ((hash = Hash::FNV1a(&args, sizeof(args), hash)), ...);
+        return UUID(hash);
+    }
+
+    template<typename BuildFn>
+    static Ref<Mesh> GetOrBuild(UUID uuid, BuildFn&& build)
+    {
+        ZoneScoped;
+
+        auto it = s_PrimitiveCache.find(uuid);
+        if (it == s_PrimitiveCache.end())
+        {
+            Ref<Mesh> mesh = build();
+            mesh->SetUUID(uuid);
+            it = s_PrimitiveCache.emplace(uuid, mesh).first;
+        }
+
+        // Registered again if the registry was cleared, scenes reference the primitives by UUID
+        if (!ResourceRegistry::Exists(uuid))
+            ResourceRegistry::Add(uuid, it->second);
+
+        return it->second;
+    }
+
     Ref<Mesh> PrimitiveMesh::CreateQuad()
+    {
+        return GetOrBuild(GetPrimitiveUUID(PrimitiveType::Quad), [] { return BuildQuad(); });
+    }
+
+    Ref<Mesh> PrimitiveMesh::CreateCube(const glm::vec3& size, int subdivideW, int subdivideH, int subdivideD)
+    {
+        return GetOrBuild(GetPrimitiveUUID(PrimitiveType::Cube, size, subdivideW, subdivideH, subdivideD),
+                          [&] { return BuildCube(size, subdivideW, subdivideH, subdivideD); });
+    }
+
+    Ref<Mesh> PrimitiveMesh::CreateSphere(float radius, float height, int radialSegments, int rings, bool isHemiSphere)
+    {
+        return GetOrBuild(GetPrimitiveUUID(PrimitiveType::Sphere, radius, height, radialSegments, rings, isHemiSphere),
+                          [&] { return BuildSphere(radius, height, radialSegments, rings, isHemiSphere); });
+    }
+
+    Ref<Mesh> PrimitiveMesh::CreatePlane(const glm::vec2& size, const glm::vec3& normal)
+    {
+        return GetOrBuild(GetPrimitiveUUID(PrimitiveType::Plane, size, normal), [&] { return BuildPlane(size, normal); });
+    }
+
+    Ref<Mesh> PrimitiveMesh::CreateCylinder(float topRadius, float bottomRadius, float height, int radialSegments, int rings, bool capTop, bool capBottom)
+    {
+        return GetOrBuild(GetPrimitiveUUID(PrimitiveType::Cylinder, topRadius, bottomRadius, height, radialSegments, rings, capTop, capBottom),
+                          [&] { return BuildCylinder(topRadius, bottomRadius, height, radialSegments, rings, capTop, capBottom); });
+    }
+
+    Ref<Mesh> PrimitiveMesh::CreateCone(float radius, float height, int radialSegments, int rings, bool cap)
+    {
+        return GetOrBuild(GetPrimitiveUUID(PrimitiveType::Cone, radius, height, radialSegments, rings, cap),
+                          [&] { return BuildCone(radius, height, radialSegments, rings, cap); });
+    }
+
+    Ref<Mesh> PrimitiveMesh::CreateTorus(float innerRadius, float outerRadius, int rings, int ringSegments)
+    {
+        return GetOrBuild(GetPrimitiveUUID(PrimitiveType::Torus, innerRadius, outerRadius, rings, ringSegments),
+                          [&] { return BuildTorus(innerRadius, outerRadius, rings, ringSegments); });
+    }
+
+    Ref<Mesh> PrimitiveMesh::CreateCapsule(float radius, float height, int radialSegments, int rings)
+    {
+        return GetOrBuild(GetPrimitiveUUID(PrimitiveType::Capsule, radius, height, radialSegments, rings),
+                          [&] { return BuildCapsule(radius, height, radialSegments, rings); });
+    }
+
+    void PrimitiveMesh::ClearCache()
+    {
+        for (const auto& [uuid, mesh] : s_PrimitiveCache)
+        {
+            if (ResourceRegistry::Exists(uuid))
+                ResourceRegistry::Remove(uuid);
+        }
+
+        s_PrimitiveCache.clear();
+    }
+
+    Ref<Mesh> PrimitiveMesh::BuildQuad()
     {
         std::vector<Vertex> data(4);
 
@@ -51,7 +143,7 @@ namespace Coffee {
         return quadMesh;
     }
 
-    Ref<Mesh> PrimitiveMesh::CreatePlane(const glm::vec2& size, const glm::vec3& normal)
+    Ref<Mesh> PrimitiveMesh::BuildPlane(const glm::vec2& size, const glm::vec3& normal)
     {
         std::vector<Vertex> vertices(4);
 
@@ -83,7 +175,7 @@ namespace Coffee {
     }
 
     /**
-     * @brief Creates a cube mesh.
+     * @brief Builds the vertex data and buffers of a cube mesh.
      * 
      * @param size The size of the cube.
      * @param subdivideW Subdivision parameter for width (currently not functional).
@@ -91,7 +183,7 @@ namespace Coffee {
      * @param subdivideD Subdivision parameter for depth (currently not functional).
      * @return Ref<Mesh> A reference to the created cube mesh.
      */
-    Ref<Mesh> PrimitiveMesh::CreateCube(const glm::vec3& size, int subdivideW, int subdivideH, int subdivideD)
+    Ref<Mesh> PrimitiveMesh::BuildCube(const glm::vec3& size, int subdivideW, int subdivideH, int subdivideD)
     {
         std::vector<Vertex> vertices(24);
 
@@ -216,7 +308,7 @@ namespace Coffee {
         return cubeMesh;
     }
 
-    Ref<Mesh> PrimitiveMesh::CreateSphere(float radius, float height, int radialSegments, int rings, bool isHemiSphere)
+    Ref<Mesh> PrimitiveMesh::BuildSphere(float radius, float height, int radialSegments, int rings, bool isHemiSphere)
     {
 
         int i, j, prevrow, thisrow, point = 0;
@@ -285,7 +377,7 @@ namespace Coffee {
         return sphereMesh;
     }
 
-    Ref<Mesh> PrimitiveMesh::CreateCylinder(float topRadius, float bottomRadius, float height, int radialSegments, int rings, bool capTop, bool capBottom)
+    Ref<Mesh> PrimitiveMesh::BuildCylinder(float topRadius, float bottomRadius, float height, int radialSegments, int rings, bool capTop, bool capBottom)
     {
         std::vector<Vertex> data;
         std::vector<uint32_t> indices;
@@ -401,7 +493,7 @@ namespace Coffee {
         return cylinderMesh;
     }
 
-    Ref<Mesh> PrimitiveMesh::CreateCone(float radius, float height, int radialSegments, int rings, bool cap)
+    Ref<Mesh> PrimitiveMesh::BuildCone(float radius, float height, int radialSegments, int rings, bool cap)
     {
         std::vector<Vertex> data;
         std::vector<uint32_t> indices;
@@ -485,7 +577,7 @@ namespace Coffee {
         return coneMesh;
     }
 
-    Ref<Mesh> PrimitiveMesh::CreateTorus(float innerRadius, float outerRadius, int rings, int ringSegments)
+    Ref<Mesh> PrimitiveMesh::BuildTorus(float innerRadius, float outerRadius, int rings, int ringSegments)
     {
         std::vector<uint32_t> indices;
         auto data = std::vector<Vertex>{};
@@ -554,7 +646,7 @@ namespace Coffee {
         return torusMesh;
     }
 
-    Ref<Mesh> PrimitiveMesh::CreateCapsule(float radius, float height, int radialSegments, int rings)
+    Ref<Mesh> PrimitiveMesh::BuildCapsule(float radius, float height, int radialSegments, int rings)
     {
         std::vector<uint32_t> indices;
         std::vector<Vertex> data;
@@ -33,6 +33,13 @@ namespace Coffee {
 
     /**
      * @brief Class representing different types of primitive meshes.
+     *
+     * The meshes are cached by shape and parameters: creating the same primitive twice returns the same mesh,
+     * so every entity using it shares one set of GPU buffers. The UUID of a primitive is derived from its
+     * parameters and registered in the ResourceRegistry, and is stable across sessions.
+     *
+     * The returned meshes are shared, they should not be modified.
+     *
      * @ingroup scene
      */
     class PrimitiveMesh
@@ -50,7 +57,7 @@ namespace Coffee {
     // private:
     /**
      * Creates a quad mesh.
-     * @return A reference to the created quad mesh.
+     * @return A reference to the shared quad mesh.
      */
         static Ref<Mesh> CreateQuad();
 
@@ -60,7 +67,7 @@ namespace Coffee {
          * @param subdivideW Number of subdivisions along the width.
          * @param subdivideH Number of subdivisions along the height.
          * @param subdivideD Number of subdivisions along the depth.
-         * @return A reference to the created cube mesh.
+         * @return A reference to the shared cube mesh.
          */
         static Ref<Mesh> CreateCube(const glm::vec3& size = { 1.0f, 1.0f, 1.0f }, int subdivideW = 0, int subdidiveH = 0, int subdivideD = 0);
 
@@ -71,7 +78,7 @@ namespace Coffee {
          * @param radialSegments Number of radial segments.
          * @param rings Number of rings.
          * @param isHemiSphere Whether the sphere is a hemisphere.
-         * @return A reference to the created sphere mesh.
+         * @return A reference to the shared sphere mesh.
          */
         static Ref<Mesh> CreateSphere(float radius = 0.5f, float height = 1.0f, int radialSegments = 64, int rings = 32, bool isHemiSphere = false);
 
@@ -79,7 +86,7 @@ namespace Coffee {
          * Creates a plane mesh.
          * @param size The size of the plane.
          * @param normal The normal vector of the plane.
-         * @return A reference to the created plane mesh.
+         * @return A reference to the shared plane mesh.
          */
         static Ref<Mesh> CreatePlane(const glm::vec2& size = { 1.0f, 1.0f }, const glm::vec3& normal = { 0.0f, 1.0f, 0.0f });
 
@@ -92,7 +99,7 @@ namespace Coffee {
          * @param rings Number of rings.
          * @param capTop Whether to cap the top of the cylinder.
          * @param capBottom Whether to cap the bottom of the cylinder.
-         * @return A reference to the created cylinder mesh.
+         * @return A reference to the shared cylinder mesh.
          */
         static Ref<Mesh> CreateCylinder(float topRadius = 0.5f, float bottomRadius = 0.5f, float height = 1.0f, int radialSegments = 64, int rings = 1, bool capTop = true, bool capBottom = true);
 
@@ -103,7 +110,7 @@ namespace Coffee {
          * @param radialSegments Number of radial segments.
          * @param rings Number of rings.
          * @param cap Whether to cap the base of the cone.
-         * @return A reference to the created cone mesh.
+         * @return A reference to the shared cone mesh.
          */
         static Ref<Mesh> CreateCone(float radius = 0.5f, float height = 1.0f, int radialSegments = 64, int rings = 1, bool cap = true);
 
@@ -113,7 +120,7 @@ namespace Coffee {
          * @param outerRadius The outer radius of the torus.
          * @param rings Number of rings.
          * @param ringSegments Number of ring segments.
-         * @return A reference to the created torus mesh.
+         * @return A reference to the shared torus mesh.
          */
         static Ref<Mesh> CreateTorus(float innerRadius = 0.5f, float outerRadius = 1.0f, int rings = 64, int ringSegments = 32);
 
@@ -123,10 +130,25 @@ namespace Coffee {
          * @param height The height of the capsule.
          * @param radialSegments Number of radial segments.
          * @param rings Number of rings.
-         * @return A reference to the created capsule mesh.
+         * @return A reference to the shared capsule mesh.
          */
         static Ref<Mesh> CreateCapsule(float radius = 0.5f, float height = 2.0f, int radialSegments = 64, int rings = 8);
 
+        /**
+         * Releases the cached primitives and removes them from the ResourceRegistry.
+         * The meshes still referenced elsewhere stay alive.
+         */
+        static void ClearCache();
+
+    private:
+        static Ref<Mesh> BuildQuad();
+        static Ref<Mesh> BuildCube(const glm::vec3& size, int subdivideW, int subdivideH, int subdivideD);
+        static Ref<Mesh> BuildSphere(float radius, float height, int radialSegments, int rings, bool isHemiSphere);
+        static Ref<Mesh> BuildPlane(const glm::vec2& size, const glm::vec3& normal);
+        static Ref<Mesh> BuildCylinder(float topRadius, float bottomRadius, float height, int radialSegments, int rings, bool capTop, bool capBottom);
+        static Ref<Mesh> BuildCone(float radius, float height, int radialSegments, int rings, bool cap);
+        static Ref<Mesh> BuildTorus(float innerRadius, float outerRadius, int rings, int ringSegments);
+        static Ref<Mesh> BuildCapsule(float radius, float height, int radialSegments, int rings);
     };
 
     // Explicit specialization declaration
@@ -31,6 +31,8 @@
 #include "entt/entity/snapshot.hpp"
 
 #include <stdint.h>
+#include <algorithm>
+#include <limits>
 #include <glm/detail/type_quat.hpp>
 #include <glm/fwd.hpp>
 #include <memory>
@@ -77,6 +79,8 @@ namespace Coffee {
             .template get<UIButtonComponent>(archive)
             .template get<UISliderComponent>(archive)
             .template get<UIComponent>(archive);
+
+        archive(cereal::make_nvp("PhysicsTimestep", m_PhysicsWorld.getTimestepSettings()));
     }
 
     template <class Archive>
@@ -161,7 +165,7 @@ namespace Coffee {
                 .template get<UISliderComponent>(archive)
                 .template get<UIComponent>(archive);
         }
-        else if (version == 3)
+        else if (version == 3 || version == 4)
         {
             entt::snapshot_loader{m_Registry}
                 .get<entt::entity>(archive)
@@ -191,6 +195,14 @@ namespace Coffee {
                 .template get<UIComponent>(archive);
         }
 
+        // Older scenes keep the default, which steps with the frame time as they always did
+        if (version >= 4)
+        {
+            PhysicsTimestepSettings timestepSettings;
+            archive(cereal::make_nvp("PhysicsTimestep", timestepSettings));
+            m_PhysicsWorld.setTimestepSettings(timestepSettings);
+        }
+
         AssignAnimatorsToMeshes(AnimationSystem::GetAnimators());
 
         m_IsLoading = false;
@@ -496,6 +508,11 @@ namespace Coffee {
         return Entity{entt::null, this};
     }
 
+    Entity Scene::GetUIElementAt(const glm::vec2& position, bool widgetsOnly)
+    {
+        return Entity{UIManager::GetElementAt(m_Registry, position, widgetsOnly), this};
+    }
+
     std::vector<Entity> Scene::GetAllEntities()
     {
         std::vector<Entity> entities;
@@ -691,15 +708,18 @@ namespace Coffee {
             auto animatorView = m_Registry.view<ActiveComponent, AnimatorComponent>();
             ZoneScopedN("AnimatorComponent View");
 
+            m_AnimatorBatch.clear();
             for (auto& entity : animatorView)
             {
                 AnimatorComponent* animatorComponent = &animatorView.get<AnimatorComponent>(entity);
                 if (animatorComponent->NeedsUpdate)
                 {
-                    AnimationSystem::Update(dt, animatorComponent);
+                    m_AnimatorBatch.push_back(animatorComponent);
                     animatorComponent->NeedsUpdate = false;
                 }
             }
+
+            AnimationSystem::UpdateAll(m_AnimatorBatch, dt);
         }
 
         {
@@ -723,8 +743,11 @@ namespace Coffee {
                 Ref<Mesh> mesh = meshComponent.GetMesh();
                 Ref<Material> material = (materialComponent) ? materialComponent->material : nullptr;
 
+                if (mesh && !Renderer3D::SelectLOD(*mesh, transformComponent.GetWorldTransform(), meshComponent.lodLevel))
+                    continue;
+
                 //Renderer::Submit(material, mesh, transformComponent.GetWorldTransform(), (uint32_t)entity);
-                Renderer3D::Submit(RenderCommand{transformComponent.GetWorldTransform(), mesh, material, (uint32_t)entity, meshComponent.animator});
+                Renderer3D::Submit(RenderCommand{transformComponent.GetWorldTransform(), mesh, material, (uint32_t)entity, meshComponent.animator, meshComponent.lodLevel});
             }
         }
 
@@ -876,15 +899,16 @@ namespace Coffee {
         m_PhysicsWorld.stepSimulation(dt);
 
         {
-            // Update transforms from physics
+            // Update transforms from physics, blended between the last two substeps
             auto viewPhysics = m_Registry.view<ActiveComponent, RigidbodyComponent, TransformComponent>();
             ZoneScopedN("Physics Update View");
 
             for (auto entity : viewPhysics) {
                 auto [rb, transform] = viewPhysics.get<RigidbodyComponent, TransformComponent>(entity);
                 if (rb.rb) {
-                    transform.SetLocalPosition(rb.rb->GetPosition());
-                    transform.SetLocalRotation(rb.rb->GetRotation());
+                    const btTransform worldTransform = m_PhysicsWorld.getInterpolatedTransform(rb.rb->GetNativeBody());
+                    transform.SetLocalPosition(rb.rb->GetPosition(worldTransform));
+                    transform.SetLocalRotation(rb.rb->GetRotation(worldTransform));
                 }
             }
         }
@@ -931,14 +955,37 @@ namespace Coffee {
             auto animatorView = m_Registry.view<ActiveComponent, AnimatorComponent>();
             ZoneScopedN("AnimatorComponent View");
 
+            m_AnimatorBatch.clear();
             for (auto& entity : animatorView)
             {
                 /*if (staticView.contains(entity) && visibleEntitySet.find(entity) == visibleEntitySet.end())
                     continue;*/
 
                 AnimatorComponent* animatorComponent = &animatorView.get<AnimatorComponent>(entity);
-                AnimationSystem::Update(dt, animatorComponent);
+                animatorComponent->LODState.Distance = std::numeric_limits<float>::max();
+                animatorComponent->LODState.Visible = false;
+                m_AnimatorBatch.push_back(animatorComponent);
             }
+
+            // Animation level of detail inputs, from the meshes skinned by each animator
+            glm::vec3 cameraPosition = cameraTransform[3];
+            auto skinnedMeshView = m_Registry.view<ActiveComponent, MeshComponent, TransformComponent>();
+            for (auto& entity : skinnedMeshView)
+            {
+                auto& meshComponent = skinnedMeshView.get<MeshComponent>(entity);
+                if (!meshComponent.animator || !meshComponent.GetMesh())
+                    continue;
+
+                // The bind pose bounds, animated poses may reach slightly out of them
+                AABB bounds = meshComponent.GetMesh()->GetAABB().CalculateTransformedAABB(skinnedMeshView.get<TransformComponent>(entity).GetWorldTransform());
+
+                AnimationLODState& lodState = meshComponent.animator->LODState;
+                lodState.Distance = std::min(lodState.Distance, glm::length(bounds.GetCenter() - cameraPosition));
+                lodState.Visible = lodState.Visible || frustum.Contains(bounds);
+            }
+
+            // Evaluated across the workers, the palettes are ready before the meshes are submitted
+            AnimationSystem::UpdateAll(m_AnimatorBatch, dt);
         }
 
         {
@@ -960,7 +1007,10 @@ namespace Coffee {
                 Ref<Mesh> mesh = meshComponent.GetMesh();
                 Ref<Material> material = (materialComponent) ? materialComponent->material : nullptr;
 
-                Renderer3D::Submit(RenderCommand{transformComponent.GetWorldTransform(), mesh, material, (uint32_t)entity, meshComponent.animator});
+                if (mesh && !Renderer3D::SelectLOD(*mesh, transformComponent.GetWorldTransform(), meshComponent.lodLevel))
+                    continue;
+
+                Renderer3D::Submit(RenderCommand{transformComponent.GetWorldTransform(), mesh, material, (uint32_t)entity, meshComponent.animator, meshComponent.lodLevel});
             }
         }
 
@@ -1173,7 +1223,7 @@ namespace Coffee {
         parent = Entity{entt::null, scene};
     }
 
-    void Scene::AssignAnimatorsToMeshes(const std::vector<AnimatorComponent*> animators)
+    void Scene::AssignAnimatorsToMeshes(const std::vector<AnimatorComponent*>& animators)
     {
         std::vector<Entity> entities = GetAllEntities();
         for (auto entity : entities)
@@ -6,6 +6,7 @@
 #include <cereal/cereal.hpp>
 
 #include <entt/entt.hpp>
+#include <glm/vec2.hpp>
 #include <filesystem>
 
 namespace Coffee {
@@ -76,6 +77,14 @@ namespace Coffee {
 
         Entity GetEntityByName(const std::string& name);
 
+        /**
+         * @brief Gets the topmost active UI element under a position, looked up in the UI hit-test grid.
+         * @param position The position in the render target, in pixels.
+         * @param widgetsOnly If true, only buttons, toggles and sliders are returned.
+         * @return The entity under the position, or an invalid entity if there is none.
+         */
+        Entity GetUIElementAt(const glm::vec2& position, bool widgetsOnly = true);
+
         std::vector<Entity> GetAllEntities();
 
         template<typename... Components>
@@ -152,7 +161,7 @@ namespace Coffee {
          * @brief Assigns animators to meshes.
          * @param animators The vector of animator components.
          */
-        void AssignAnimatorsToMeshes(const std::vector<AnimatorComponent*> animators);
+        void AssignAnimatorsToMeshes(const std::vector<AnimatorComponent*>& animators);
 
         static std::map<UUID, UUID> s_UUIDMap;
         static std::vector<MeshComponent*> s_MeshComponents;
@@ -191,6 +200,8 @@ namespace Coffee {
         PhysicsWorld m_PhysicsWorld;
         SceneDebugFlags m_SceneDebugFlags;
 
+        std::vector<AnimatorComponent*> m_AnimatorBatch; ///< The animators updated this frame, kept to reuse its memory.
+
         // Temporal: Scenes should be Resources and the Base Resource class already has a path variable.
         std::filesystem::path m_FilePath;
 
@@ -211,4 +222,4 @@ namespace Coffee {
 
     /** @} */ // end of scene group
 } // namespace Coffee
-CEREAL_CLASS_VERSION(Coffee::Scene, 3);
+CEREAL_CLASS_VERSION(Coffee::Scene, 4);
@@ -456,6 +456,32 @@ void Coffee::RegisterPhysicsBindings(sol::state& luaState)
         return scene->GetPhysicsWorld().RaycastAny(origin, direction, maxDistance);
     };
 
+    // Bind the timestep settings of the active scene
+    luaState.new_usertype<PhysicsTimestepSettings>("PhysicsTimestepSettings",
+        sol::constructors<PhysicsTimestepSettings()>(),
+        "fixedTimestep", &PhysicsTimestepSettings::fixedTimestep,
+        "fixedDeltaTime", &PhysicsTimestepSettings::fixedDeltaTime,
+        "maxSubSteps", &PhysicsTimestepSettings::maxSubSteps,
+        "maxFrameTime", &PhysicsTimestepSettings::maxFrameTime,
+        "interpolate", &PhysicsTimestepSettings::interpolate
+    );
+
+    physicsTable["GetTimestepSettings"] = []() -> PhysicsTimestepSettings {
+        auto scene = SceneManager::GetActiveScene();
+        if (!scene)
+            return PhysicsTimestepSettings{};
+
+        return scene->GetPhysicsWorld().getTimestepSettings();
+    };
+
+    physicsTable["SetTimestepSettings"] = [](const PhysicsTimestepSettings& settings) {
+        auto scene = SceneManager::GetActiveScene();
+        if (!scene)
+            return;
+
+        scene->GetPhysicsWorld().setTimestepSettings(settings);
+    };
+
     physicsTable["DebugDrawRaycast"] = [](const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
         sol::optional<glm::vec4> rayColor, sol::optional<glm::vec4> hitColor) {
         auto scene = SceneManager::GetActiveScene();
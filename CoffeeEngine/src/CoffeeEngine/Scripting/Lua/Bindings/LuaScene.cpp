@@ -12,6 +12,10 @@ void Coffee::RegisterSceneBindings(sol::state& luaState)
         "destroy_entity", &Scene::DestroyEntity,
         "duplicate_entity", &Scene::Duplicate,
         "get_entity_by_name", &Scene::GetEntityByName,
+        "get_ui_element_at", sol::overload(
+            [](Scene& self, const glm::vec2& position) { return self.GetUIElementAt(position); },
+            [](Scene& self, const glm::vec2& position, bool widgetsOnly) { return self.GetUIElementAt(position, widgetsOnly); }
+        ),
         "get_all_entities", &Scene::GetAllEntities,
         "debug_flags", sol::property(&Scene::GetDebugFlags)
     );
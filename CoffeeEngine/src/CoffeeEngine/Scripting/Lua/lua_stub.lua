@@ -601,6 +601,14 @@ CapsuleCollider = {
     new = function(radius, height) return {} end
 }
 
+PhysicsTimestepSettings = {
+    fixedTimestep = false,
+    fixedDeltaTime = 1.0 / 60.0,
+    maxSubSteps = 8,
+    maxFrameTime = 0.25,
+    interpolate = true
+}
+
 Physics = {
     raycast = function(origin, direction, maxDistance)
         return {
@@ -617,6 +625,11 @@ Physics = {
     raycast_any = function(origin, direction, maxDistance)
         return false
     end,
+    get_timestep_settings = function()
+        return PhysicsTimestepSettings
+    end,
+    set_timestep_settings = function(settings)
+    end,
     debug_draw_raycast = function(origin, direction, maxDistance, rayColor, hitColor)
         -- Implementation here
     end
@@ -674,6 +687,8 @@ Scene = {
     destroy_entity = function(self, entity) end,
     duplicate_entity = function(self, entity) return Entity end,
     get_entity_by_name = function(self, name) return Entity end,
+    -- The topmost active button, toggle or slider under a position of the render target, any UI element if widgets_only is false
+    get_ui_element_at = function(self, position, widgets_only) return Entity end,
     get_all_entities = function(self) return {} end
 }
 
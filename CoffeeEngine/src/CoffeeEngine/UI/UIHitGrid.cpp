@@ -0,0 +1,54 @@
+#include "UIHitGrid.h"
+
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Coffee {
+
+    void UIHitGrid::Reset(const glm::vec2& area, float cellSize)
+    {
+        m_Area = glm::max(area, glm::vec2(0.0f));
+        m_CellSize = std::max(cellSize, 1.0f);
+        m_Columns = std::max(1u, (uint32_t)std::ceil(m_Area.x / m_CellSize));
+        m_Rows = std::max(1u, (uint32_t)std::ceil(m_Area.y / m_CellSize));
+
+        // Keep the capacity of the cells that survive the resize
+        m_Cells.resize((size_t)m_Columns * m_Rows);
+        for (std::vector<uint32_t>& cell : m_Cells)
+            cell.clear();
+    }
+
+    void UIHitGrid::Insert(uint32_t id, const glm::vec4& rect)
+    {
+        if (rect.z < 0.0f || rect.w < 0.0f || rect.x > m_Area.x || rect.y > m_Area.y || rect.x > rect.z || rect.y > rect.w)
+            return;
+
+        uint32_t minColumn = (uint32_t)std::max(0.0f, std::floor(rect.x / m_CellSize));
+        uint32_t minRow = (uint32_t)std::max(0.0f, std::floor(rect.y / m_CellSize));
+        uint32_t maxColumn = std::min(m_Columns - 1, (uint32_t)std::floor(rect.z / m_CellSize));
+        uint32_t maxRow = std::min(m_Rows - 1, (uint32_t)std::floor(rect.w / m_CellSize));
+
+        for (uint32_t row = minRow; row <= maxRow; row++)
+        {
+            for (uint32_t column = minColumn; column <= maxColumn; column++)
+            {
+                m_Cells[(size_t)row * m_Columns + column].push_back(id);
+            }
+        }
+    }
+
+    const std::vector<uint32_t>& UIHitGrid::Query(const glm::vec2& point) const
+    {
+        static const std::vector<uint32_t> empty;
+
+        if (m_Cells.empty() || point.x < 0.0f || point.y < 0.0f || point.x > m_Area.x || point.y > m_Area.y)
+            return empty;
+
+        uint32_t column = std::min(m_Columns - 1, (uint32_t)(point.x / m_CellSize));
+        uint32_t row = std::min(m_Rows - 1, (uint32_t)(point.y / m_CellSize));
+        return m_Cells[(size_t)row * m_Columns + column];
+    }
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace Coffee {
+
+    /**
+     * @brief Uniform grid over screen space used to find the UI elements under a point.
+     *
+     * Each element is inserted into every cell its rect overlaps, so a query only has to test the few
+     * elements of one cell instead of every element on screen. Cell storage is kept between rebuilds.
+     */
+    class UIHitGrid
+    {
+    public:
+        static constexpr float DefaultCellSize = 64.0f; ///< Default cell size in pixels.
+
+        /**
+         * @brief Removes every element and resizes the grid to cover an area.
+         * @param area The size of the covered area in pixels, starting at the origin.
+         * @param cellSize The size of a cell in pixels.
+         */
+        void Reset(const glm::vec2& area, float cellSize = DefaultCellSize);
+
+        /**
+         * @brief Inserts an element. Elements must be inserted back to front for Query to return them in draw order.
+         * @param id The id of the element.
+         * @param rect The bounds of the element as (minX, minY, maxX, maxY).
+         */
+        void Insert(uint32_t id, const glm::vec4& rect);
+
+        /**
+         * @brief Gets the elements whose cell contains a point. The rects still have to be tested against the point.
+         * @param point The point in pixels.
+         * @return The ids of the candidate elements, in insertion order.
+         */
+        const std::vector<uint32_t>& Query(const glm::vec2& point) const;
+
+    private:
+        std::vector<std::vector<uint32_t>> m_Cells;
+        glm::vec2 m_Area = {0.0f, 0.0f};
+        float m_CellSize = DefaultCellSize;
+        uint32_t m_Columns = 0;
+        uint32_t m_Rows = 0;
+    };
+
+}
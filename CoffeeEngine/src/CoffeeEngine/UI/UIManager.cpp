@@ -13,6 +13,8 @@
 #include "CoffeeEngine/Scene/SceneTree.h"
 #include "CoffeeEngine/Renderer/Font.h"
 
+#include <numeric>
+
 namespace Coffee {
 
     glm::vec2 UIManager::WindowSize;
@@ -20,6 +22,10 @@ namespace Coffee {
     bool UIManager::s_NeedsSorting = true;
     std::vector<UIManager::UIRenderItem> UIManager::s_SortedUIItems;
     std::unordered_map<entt::entity, UIManager::AnchoredTransform> UIManager::s_LastTransforms;
+    std::unordered_map<entt::entity, uint32_t> UIManager::s_ItemIndex;
+    std::vector<uint32_t> UIManager::s_ChildIndices;
+    bool UIManager::s_HasDirtyItems = true;
+    UIHitGrid UIManager::s_HitGrid;
 
     glm::vec2 UIManager::CanvasReferenceSize = { 1920.0f, 1080.0f };
     float UIManager::UIScale = 1.0f;
@@ -39,6 +45,7 @@ namespace Coffee {
                 item.ParentSizeDirty = true;
             }
             m_lastWindowSize = WindowSize;
+            s_HasDirtyItems = true;
         }
 
         if (s_NeedsSorting)
@@ -49,10 +56,17 @@ namespace Coffee {
 
         ProcessPendingTransforms(registry);
 
-        for (auto& item : s_SortedUIItems)
+        // Only dirty subtrees are recalculated, a static UI skips the layout pass entirely
+        if (s_HasDirtyItems)
         {
-            if (item.Parent == entt::null)
-                UpdateUITranformRecursive(registry, item);
+            for (uint32_t i = 0; i < s_SortedUIItems.size(); i++)
+            {
+                if (s_SortedUIItems[i].ParentIndex == InvalidIndex)
+                    UpdateUITranformRecursive(registry, i, false);
+            }
+
+            BuildHitGrid();
+            s_HasDirtyItems = false;
         }
 
         for (auto& item : s_SortedUIItems)
@@ -118,57 +132,129 @@ namespace Coffee {
         AddUIItems<UISliderComponent, UIComponentType::Slider>(registry, s_SortedUIItems);
         AddUIItems<UIComponent, UIComponentType::Empty>(registry, s_SortedUIItems);
 
-        std::sort(s_SortedUIItems.begin(), s_SortedUIItems.end(), [&registry](const UIRenderItem& a, const UIRenderItem& b) {
-            if (a.Layer != b.Layer)
-                return a.Layer < b.Layer;
+        // Index the unsorted items so the hierarchy can be walked without searching the list
+        s_ItemIndex.clear();
+        s_ItemIndex.reserve(s_SortedUIItems.size());
+        for (uint32_t i = 0; i < s_SortedUIItems.size(); i++)
+            s_ItemIndex.emplace(s_SortedUIItems[i].Entity, i);
 
-            if (a.Parent == b.Parent)
-            {
-                entt::entity current = a.Entity;
-                while (current != entt::null)
-                {
-                    if (current == b.Entity)
-                        return true;
+        // Items without a UI parent are roots, unrelated roots keep the entity order
+        std::vector<uint32_t> roots;
+        for (uint32_t i = 0; i < s_SortedUIItems.size(); i++)
+        {
+            if (s_ItemIndex.find(s_SortedUIItems[i].Parent) == s_ItemIndex.end())
+                roots.push_back(i);
+        }
 
-                    if (registry.any_of<HierarchyComponent>(current))
-                        current = registry.get<HierarchyComponent>(current).m_Next;
-                }
+        std::sort(roots.begin(), roots.end(), [](uint32_t a, uint32_t b) {
+            return static_cast<uint32_t>(s_SortedUIItems[a].Entity) < static_cast<uint32_t>(s_SortedUIItems[b].Entity);
+        });
 
-                return false;
-            }
+        // Pre-order position in the UI hierarchy: parents before children, siblings in scene tree order
+        std::vector<uint32_t> preorder(s_SortedUIItems.size(), InvalidIndex);
+        std::vector<uint32_t> stack;
+        std::vector<uint32_t> children;
+        uint32_t position = 0;
+
+        for (auto rootIt = roots.rbegin(); rootIt != roots.rend(); ++rootIt)
+            stack.push_back(*rootIt);
 
+        while (!stack.empty())
+        {
+            uint32_t index = stack.back();
+            stack.pop_back();
+            preorder[index] = position++;
+
+            children.clear();
+            entt::entity entity = s_SortedUIItems[index].Entity;
+            entt::entity child = registry.any_of<HierarchyComponent>(entity) ? registry.get<HierarchyComponent>(entity).m_First : entt::null;
+            while (child != entt::null)
             {
-                entt::entity parent = b.Parent;
-                while (parent != entt::null)
-                {
-                    if (parent == a.Entity)
-                        return true;
+                auto it = s_ItemIndex.find(child);
+                if (it != s_ItemIndex.end())
+                    children.push_back(it->second);
 
-                    if (registry.any_of<HierarchyComponent>(parent))
-                        parent = registry.get<HierarchyComponent>(parent).m_Parent;
-                }
+                child = registry.any_of<HierarchyComponent>(child) ? registry.get<HierarchyComponent>(child).m_Next : entt::null;
             }
 
-            {
-                entt::entity parent = a.Parent;
-                while (parent != entt::null)
-                {
-                    if (parent == b.Entity)
-                        return false;
+            for (auto childIt = children.rbegin(); childIt != children.rend(); ++childIt)
+                stack.push_back(*childIt);
+        }
 
-                    if (registry.any_of<HierarchyComponent>(parent))
-                        parent = registry.get<HierarchyComponent>(parent).m_Parent;
-                }
-            }
+        // Entities with more than one UI component are only reached once by the walk
+        for (uint32_t& order : preorder)
+        {
+            if (order == InvalidIndex)
+                order = position++;
+        }
 
-            return static_cast<uint32_t>(a.Entity) < static_cast<uint32_t>(b.Entity);
+        std::vector<uint32_t> sortedIndices(s_SortedUIItems.size());
+        std::iota(sortedIndices.begin(), sortedIndices.end(), 0);
+        std::sort(sortedIndices.begin(), sortedIndices.end(), [&preorder](uint32_t a, uint32_t b) {
+            const UIRenderItem& itemA = s_SortedUIItems[a];
+            const UIRenderItem& itemB = s_SortedUIItems[b];
+            if (itemA.Layer != itemB.Layer)
+                return itemA.Layer < itemB.Layer;
+
+            return preorder[a] < preorder[b];
         });
 
+        std::vector<UIRenderItem> sortedItems;
+        sortedItems.reserve(s_SortedUIItems.size());
+        for (uint32_t index : sortedIndices)
+            sortedItems.push_back(s_SortedUIItems[index]);
+        s_SortedUIItems = std::move(sortedItems);
+
         for (auto& item : s_SortedUIItems)
         {
             item.TransformDirty = true;
             item.ParentSizeDirty = true;
         }
+
+        BuildItemIndex();
+        s_HasDirtyItems = true;
+    }
+
+    void UIManager::BuildItemIndex()
+    {
+        s_ItemIndex.clear();
+        s_ItemIndex.reserve(s_SortedUIItems.size());
+        for (uint32_t i = 0; i < s_SortedUIItems.size(); i++)
+            s_ItemIndex.emplace(s_SortedUIItems[i].Entity, i);
+
+        for (auto& item : s_SortedUIItems)
+        {
+            auto it = s_ItemIndex.find(item.Parent);
+            item.ParentIndex = it != s_ItemIndex.end() ? it->second : InvalidIndex;
+            item.FirstChild = 0;
+            item.ChildCount = 0;
+        }
+
+        // Children are stored contiguously per parent, in draw order
+        for (auto& item : s_SortedUIItems)
+        {
+            if (item.ParentIndex != InvalidIndex)
+                s_SortedUIItems[item.ParentIndex].ChildCount++;
+        }
+
+        uint32_t offset = 0;
+        for (auto& item : s_SortedUIItems)
+        {
+            item.FirstChild = offset;
+            offset += item.ChildCount;
+            item.ChildCount = 0;
+        }
+
+        s_ChildIndices.resize(offset);
+        for (uint32_t i = 0; i < s_SortedUIItems.size(); i++)
+        {
+            uint32_t parentIndex = s_SortedUIItems[i].ParentIndex;
+            if (parentIndex == InvalidIndex)
+                continue;
+
+            UIRenderItem& parentItem = s_SortedUIItems[parentIndex];
+            s_ChildIndices[parentItem.FirstChild + parentItem.ChildCount++] = i;
+        }
     }
 
     void UIManager::RenderUIImage(entt::registry& registry, UIRenderItem& item)
@@ -258,11 +344,8 @@ namespace Coffee {
     {
         entt::entity entity = item.Entity;
         auto& sliderComponent = registry.get<UISliderComponent>(entity);
-        auto& transformComponent = registry.get<TransformComponent>(entity);
-
-        auto anchored = CalculateAnchoredTransform(registry, sliderComponent.Anchor, item);
-
-        float rotation = transformComponent.GetLocalRotation().z;
+        const AnchoredTransform& anchored = item.Anchored;
+        float rotation = item.Rotation;
 
         if (sliderComponent.BackgroundTexture)
             Renderer2D::DrawQuad(item.WorldTransform, sliderComponent.BackgroundTexture, 1.0f, glm::vec4(1.0f), Renderer2D::RenderMode::Screen, (uint32_t)entity);
@@ -301,56 +384,54 @@ namespace Coffee {
         if (!item.ParentSizeDirty)
             return item.ParentSize;
 
-        for (auto& parentItem : s_SortedUIItems)
+        if (item.ParentIndex != InvalidIndex)
         {
-            if (parentItem.Entity == item.Parent)
+            UIRenderItem& parentItem = s_SortedUIItems[item.ParentIndex];
+
+            if (parentItem.ParentSizeDirty)
             {
-                if (parentItem.ParentSizeDirty)
-                {
-                    glm::vec2 parentParentSize = GetParentSize(registry, parentItem);
+                glm::vec2 parentParentSize = GetParentSize(registry, parentItem);
 
-                    RectAnchor* parentAnchor = GetComponentAnchor(registry, item.Parent, parentItem.ComponentType);
+                RectAnchor* parentAnchor = GetComponentAnchor(registry, item.Parent, parentItem.ComponentType);
 
-                    if (parentAnchor)
-                    {
-                        bool isStretchedX = (parentAnchor->AnchorMin.x != parentAnchor->AnchorMax.x);
-                        bool isStretchedY = (parentAnchor->AnchorMin.y != parentAnchor->AnchorMax.y);
+                if (parentAnchor)
+                {
+                    bool isStretchedX = (parentAnchor->AnchorMin.x != parentAnchor->AnchorMax.x);
+                    bool isStretchedY = (parentAnchor->AnchorMin.y != parentAnchor->AnchorMax.y);
 
-                        glm::vec2 offsetSize = parentAnchor->OffsetMax - parentAnchor->OffsetMin;
+                    glm::vec2 offsetSize = parentAnchor->OffsetMax - parentAnchor->OffsetMin;
 
-                        glm::vec2 finalSize;
-                        finalSize.x = isStretchedX ? parentParentSize.x * (parentAnchor->AnchorMax.x - parentAnchor->AnchorMin.x) + offsetSize.x : offsetSize.x;
-                        finalSize.y = isStretchedY ? parentParentSize.y * (parentAnchor->AnchorMax.y - parentAnchor->AnchorMin.y) + offsetSize.y : offsetSize.y;
+                    glm::vec2 finalSize;
+                    finalSize.x = isStretchedX ? parentParentSize.x * (parentAnchor->AnchorMax.x - parentAnchor->AnchorMin.x) + offsetSize.x : offsetSize.x;
+                    finalSize.y = isStretchedY ? parentParentSize.y * (parentAnchor->AnchorMax.y - parentAnchor->AnchorMin.y) + offsetSize.y : offsetSize.y;
 
-                        parentItem.ParentSize = parentParentSize;
-                        parentItem.ParentSizeDirty = false;
+                    parentItem.ParentSize = parentParentSize;
+                    parentItem.ParentSizeDirty = false;
 
-                        item.ParentSize = finalSize;
-                        item.ParentSizeDirty = false;
-                        return finalSize;
-                    }
+                    item.ParentSize = finalSize;
+                    item.ParentSizeDirty = false;
+                    return finalSize;
                 }
-                else
-                {
-                    RectAnchor* parentAnchor = GetComponentAnchor(registry, item.Parent, parentItem.ComponentType);
+            }
+            else
+            {
+                RectAnchor* parentAnchor = GetComponentAnchor(registry, item.Parent, parentItem.ComponentType);
 
-                    if (parentAnchor)
-                    {
-                        bool isStretchedX = (parentAnchor->AnchorMin.x != parentAnchor->AnchorMax.x);
-                        bool isStretchedY = (parentAnchor->AnchorMin.y != parentAnchor->AnchorMax.y);
+                if (parentAnchor)
+                {
+                    bool isStretchedX = (parentAnchor->AnchorMin.x != parentAnchor->AnchorMax.x);
+                    bool isStretchedY = (parentAnchor->AnchorMin.y != parentAnchor->AnchorMax.y);
 
-                        glm::vec2 offsetSize = parentAnchor->OffsetMax - parentAnchor->OffsetMin;
+                    glm::vec2 offsetSize = parentAnchor->OffsetMax - parentAnchor->OffsetMin;
 
-                        glm::vec2 finalSize;
-                        finalSize.x = isStretchedX ? parentItem.ParentSize.x * (parentAnchor->AnchorMax.x - parentAnchor->AnchorMin.x) + offsetSize.x : offsetSize.x;
-                        finalSize.y = isStretchedY ? parentItem.ParentSize.y * (parentAnchor->AnchorMax.y - parentAnchor->AnchorMin.y) + offsetSize.y : offsetSize.y;
+                    glm::vec2 finalSize;
+                    finalSize.x = isStretchedX ? parentItem.ParentSize.x * (parentAnchor->AnchorMax.x - parentAnchor->AnchorMin.x) + offsetSize.x : offsetSize.x;
+                    finalSize.y = isStretchedY ? parentItem.ParentSize.y * (parentAnchor->AnchorMax.y - parentAnchor->AnchorMin.y) + offsetSize.y : offsetSize.y;
 
-                        item.ParentSize = finalSize;
-                        item.ParentSizeDirty = false;
-                        return finalSize;
-                    }
+                    item.ParentSize = finalSize;
+                    item.ParentSizeDirty = false;
+                    return finalSize;
                 }
-                break;
             }
         }
 
@@ -413,25 +494,9 @@ namespace Coffee {
 
                 if (parentIsUIElement)
                 {
-                    UIRenderItem* parentItem = nullptr;
-                    for (auto& renderItem : s_SortedUIItems)
-                    {
-                        if (renderItem.Entity == item.Parent)
-                        {
-                            parentItem = &renderItem;
-                            break;
-                        }
-                    }
-
-                    if (parentItem)
-                    {
-                        RectAnchor* parentAnchor = GetComponentAnchor(registry, item.Parent, parentItem->ComponentType);
-                        if (parentAnchor)
-                        {
-                            AnchoredTransform parentAnchored = CalculateAnchoredTransform(registry, *parentAnchor, *parentItem);
-                            parentPosition = parentAnchored.Position;
-                        }
-                    }
+                    // Parents are laid out before their children, so the cached transform is up to date
+                    if (item.ParentIndex != InvalidIndex)
+                        parentPosition = s_SortedUIItems[item.ParentIndex].Anchored.Position;
                 }
                 else
                 {
@@ -485,15 +550,20 @@ namespace Coffee {
 
     void UIManager::MarkChildrenForUpdate(entt::entity parentEntity)
     {
-        for (auto& item : s_SortedUIItems)
+        auto it = s_ItemIndex.find(parentEntity);
+        if (it == s_ItemIndex.end())
+            return;
+
+        const UIRenderItem& parentItem = s_SortedUIItems[it->second];
+        for (uint32_t i = parentItem.FirstChild; i < parentItem.FirstChild + parentItem.ChildCount; i++)
         {
-            if (item.Parent == parentEntity)
-            {
-                item.TransformDirty = true;
-                item.ParentSizeDirty = true;
-                MarkChildrenForUpdate(item.Entity);
-            }
+            UIRenderItem& item = s_SortedUIItems[s_ChildIndices[i]];
+            item.TransformDirty = true;
+            item.ParentSizeDirty = true;
+            MarkChildrenForUpdate(item.Entity);
         }
+
+        s_HasDirtyItems = true;
     }
 
     void UIManager::SetReferenceCanvasSize(const glm::vec2& referenceSize)
@@ -525,21 +595,73 @@ namespace Coffee {
 
     UIManager::UIRenderItem& UIManager::GetUIRenderItem(entt::entity entity)
     {
-        for (auto& item : s_SortedUIItems)
-        {
-            if (item.Entity == entity)
-                return item;
-        }
+        auto it = s_ItemIndex.find(entity);
+        if (it != s_ItemIndex.end())
+            return s_SortedUIItems[it->second];
 
         static UIRenderItem defaultItem;
+        defaultItem = UIRenderItem();
         return defaultItem;
     }
 
+    entt::entity UIManager::GetElementAt(entt::registry& registry, const glm::vec2& position, bool widgetsOnly)
+    {
+        const std::vector<uint32_t>& candidates = s_HitGrid.Query(position);
+
+        // Items are inserted in draw order, the last hit is the one on top
+        for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+        {
+            const UIRenderItem& item = s_SortedUIItems[*it];
+
+            if (widgetsOnly && item.ComponentType != UIComponentType::Button &&
+                item.ComponentType != UIComponentType::Toggle && item.ComponentType != UIComponentType::Slider)
+                continue;
+
+            if (!registry.valid(item.Entity) || !registry.any_of<ActiveComponent>(item.Entity))
+                continue;
+
+            // Test against the rotated rect, the grid only knows its bounds
+            glm::vec2 local = position - item.Anchored.Position;
+            float angle = glm::radians(-item.Rotation);
+            float cosAngle = std::cos(angle);
+            float sinAngle = std::sin(angle);
+            local = glm::vec2(local.x * cosAngle - local.y * sinAngle, local.x * sinAngle + local.y * cosAngle);
+
+            glm::vec2 halfSize = glm::abs(item.Anchored.Size) * 0.5f;
+            if (std::abs(local.x) <= halfSize.x && std::abs(local.y) <= halfSize.y)
+                return item.Entity;
+        }
+
+        return entt::null;
+    }
+
+    void UIManager::BuildHitGrid()
+    {
+        s_HitGrid.Reset(WindowSize);
+
+        for (uint32_t i = 0; i < s_SortedUIItems.size(); i++)
+        {
+            const UIRenderItem& item = s_SortedUIItems[i];
+            if (item.ComponentType == UIComponentType::Empty)
+                continue;
+
+            float angle = glm::radians(item.Rotation);
+            float cosAngle = std::abs(std::cos(angle));
+            float sinAngle = std::abs(std::sin(angle));
+            glm::vec2 halfSize = glm::abs(item.Anchored.Size) * 0.5f;
+            glm::vec2 extents = glm::vec2(halfSize.x * cosAngle + halfSize.y * sinAngle,
+                                          halfSize.x * sinAngle + halfSize.y * cosAngle);
+
+            s_HitGrid.Insert(i, glm::vec4(item.Anchored.Position - extents, item.Anchored.Position + extents));
+        }
+    }
+
     void UIManager::MarkDirty(entt::entity entity)
     {
         UIRenderItem& item = GetUIRenderItem(entity);
         item.TransformDirty = true;
         MarkChildrenForUpdate(entity);
+        s_HasDirtyItems = true;
     }
 
     void UIManager::UpdateUITranform(entt::registry& registry, UIRenderItem& item)
@@ -597,6 +719,9 @@ namespace Coffee {
 
             float rotation = transformComponent.GetLocalRotation().z;
 
+            item.Anchored = anchored;
+            item.Rotation = rotation;
+
             item.WorldTransform = glm::mat4(1.0f);
             item.WorldTransform = glm::translate(item.WorldTransform, glm::vec3(anchored.Position, 0.0f));
             item.WorldTransform = glm::rotate(item.WorldTransform, glm::radians(rotation), glm::vec3(0.0f, 0.0f, 1.0f));
@@ -609,15 +734,21 @@ namespace Coffee {
         }
     }
 
-    void UIManager::UpdateUITranformRecursive(entt::registry& registry, UIRenderItem& item)
+    void UIManager::UpdateUITranformRecursive(entt::registry& registry, uint32_t index, bool parentChanged)
     {
-        UpdateUITranform(registry, item);
+        UIRenderItem& item = s_SortedUIItems[index];
 
-        for (auto& childItem : s_SortedUIItems)
+        if (parentChanged)
         {
-            if (childItem.Parent == item.Entity)
-                UpdateUITranformRecursive(registry, childItem);
+            item.TransformDirty = true;
+            item.ParentSizeDirty = true;
         }
+
+        bool changed = item.TransformDirty;
+        UpdateUITranform(registry, item);
+
+        for (uint32_t i = item.FirstChild; i < item.FirstChild + item.ChildCount; i++)
+            UpdateUITranformRecursive(registry, s_ChildIndices[i], changed);
     }
 
     RectAnchor* UIManager::GetComponentAnchor(entt::registry& registry, entt::entity entity, UIComponentType componentType)
@@ -667,14 +798,10 @@ namespace Coffee {
             }
 
             item.TransformDirty = true;
+            s_HasDirtyItems = true;
 
-            for (auto& childItem : s_SortedUIItems)
-            {
-                if (childItem.Parent == entity)
-                {
-                    ScaleUIElement(registry, childItem.Entity, scale);
-                }
-            }
+            for (uint32_t i = item.FirstChild; i < item.FirstChild + item.ChildCount; i++)
+                ScaleUIElement(registry, s_SortedUIItems[s_ChildIndices[i]].Entity, scale);
         }
     }
 
@@ -709,14 +836,10 @@ namespace Coffee {
             transform.SetLocalRotation(rotation);
 
             item.TransformDirty = true;
+            s_HasDirtyItems = true;
 
-            for (auto& childItem : s_SortedUIItems)
-            {
-                if (childItem.Parent == entity)
-                {
-                    RotateUIElement(registry, childItem.Entity, angle);
-                }
-            }
+            for (uint32_t i = item.FirstChild; i < item.FirstChild + item.ChildCount; i++)
+                RotateUIElement(registry, s_SortedUIItems[s_ChildIndices[i]].Entity, angle);
         }
     }
 
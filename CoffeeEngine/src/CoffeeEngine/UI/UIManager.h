@@ -1,8 +1,10 @@
 #pragma once
 
+#include <entt/entity/entity.hpp>
 #include <entt/entity/fwd.hpp>
 #include <unordered_map>
 #include "UIAnchor.h"
+#include "UIHitGrid.h"
 
 namespace Coffee {
 
@@ -19,27 +21,34 @@ namespace Coffee {
             Slider
         };
 
+        static constexpr uint32_t InvalidIndex = UINT32_MAX; ///< Index used for items without a UI parent.
+
         /**
-         * @brief Represents a renderable UI item.
+         * @brief Represents the anchored transform of a UI element.
          */
-        struct UIRenderItem {
-            entt::entity Entity; ///< The entity associated with the UI item.
-            int Layer; ///< The rendering layer of the UI item.
-            UIComponentType ComponentType; ///< The type of UI component.
-            entt::entity Parent; ///< The parent entity in the hierarchy.
-            entt::entity Next; ///< The next sibling entity in the hierarchy.
-            glm::mat4 WorldTransform; ///< Cached world transform matrix
-            bool TransformDirty = true; ///< Flag to indicate if transform needs updating
-            glm::vec2 ParentSize; ///< Cached size of the parent element
-            bool ParentSizeDirty = true; ///< Flag to indicate if parent size needs updating
+        struct AnchoredTransform {
+            glm::vec2 Position = { 0.0f, 0.0f }; ///< The position of the UI element.
+            glm::vec2 Size = { 0.0f, 0.0f }; ///< The size of the UI element.
         };
 
         /**
-         * @brief Represents the anchored transform of a UI element.
+         * @brief Represents a renderable UI item.
          */
-        struct AnchoredTransform {
-            glm::vec2 Position; ///< The position of the UI element.
-            glm::vec2 Size; ///< The size of the UI element.
+        struct UIRenderItem {
+            entt::entity Entity = entt::null; ///< The entity associated with the UI item.
+            int Layer = 0; ///< The rendering layer of the UI item.
+            UIComponentType ComponentType = UIComponentType::Empty; ///< The type of UI component.
+            entt::entity Parent = entt::null; ///< The parent entity in the hierarchy.
+            entt::entity Next = entt::null; ///< The next sibling entity in the hierarchy.
+            glm::mat4 WorldTransform = glm::mat4(1.0f); ///< Cached world transform matrix
+            bool TransformDirty = true; ///< Flag to indicate if transform needs updating
+            glm::vec2 ParentSize = { 0.0f, 0.0f }; ///< Cached size of the parent element
+            bool ParentSizeDirty = true; ///< Flag to indicate if parent size needs updating
+            uint32_t ParentIndex = InvalidIndex; ///< Index of the parent UI item in the sorted list.
+            uint32_t FirstChild = 0; ///< Offset of the first child in the child index list.
+            uint32_t ChildCount = 0; ///< Number of UI items parented to this one.
+            AnchoredTransform Anchored; ///< Cached anchored transform, valid once the transform is clean.
+            float Rotation = 0.0f; ///< Cached rotation around the Z axis, in degrees.
         };
 
         struct TransformOperation {
@@ -138,6 +147,15 @@ namespace Coffee {
          */
         static UIRenderItem& GetUIRenderItem(entt::entity entity);
 
+        /**
+         * @brief Gets the topmost active UI element under a screen position.
+         * @param registry The entity registry containing UI elements.
+         * @param position The position in the render target, in pixels.
+         * @param widgetsOnly If true, only buttons, toggles and sliders are returned.
+         * @return The entity under the position, or entt::null if there is none.
+         */
+        static entt::entity GetElementAt(entt::registry& registry, const glm::vec2& position, bool widgetsOnly = true);
+
         /**
          * @brief Marks a UI element as dirty, indicating that it needs to be updated.
          * @param entity The entity to mark as dirty.
@@ -240,9 +258,20 @@ namespace Coffee {
         /**
          * @brief Recursively updates the transform of a UI element and its children.
          * @param registry The entity registry.
-         * @param item Reference to the UIRenderItem to update.
+         * @param index Index of the UIRenderItem to update.
+         * @param parentChanged True if the parent transform was recalculated, which dirties the whole subtree.
+         */
+        static void UpdateUITranformRecursive(entt::registry& registry, uint32_t index, bool parentChanged);
+
+        /**
+         * @brief Rebuilds the entity lookup and the parent/children indices of the sorted UI items.
+         */
+        static void BuildItemIndex();
+
+        /**
+         * @brief Rebuilds the hit-test grid from the screen rects of the UI items.
          */
-        static void UpdateUITranformRecursive(entt::registry& registry, UIRenderItem& item);
+        static void BuildHitGrid();
 
         /**
          * @brief Processes pending transformations for UI elements.
@@ -290,6 +319,10 @@ namespace Coffee {
         static bool s_NeedsSorting;
         static std::vector<UIRenderItem> s_SortedUIItems;
         static std::unordered_map<entt::entity, AnchoredTransform> s_LastTransforms;
+        static std::unordered_map<entt::entity, uint32_t> s_ItemIndex; ///< Entity to index in s_SortedUIItems.
+        static std::vector<uint32_t> s_ChildIndices; ///< Children of every item, addressed by FirstChild/ChildCount.
+        static bool s_HasDirtyItems;
+        static UIHitGrid s_HitGrid;
 
         static glm::vec2 CanvasReferenceSize;
         static float UIScale;
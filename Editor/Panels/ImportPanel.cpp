@@ -2,10 +2,12 @@
 
 #include "CoffeeEngine/Core/Application.h"
 #include "CoffeeEngine/IO/ImportData/ImportData.h"
+#include "CoffeeEngine/IO/ImportData/ModelImportData.h"
 #include "CoffeeEngine/IO/ImportData/Texture2DImportData.h"
 #include "CoffeeEngine/IO/Resource.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
 #include "CoffeeEngine/IO/ResourceUtils.h"
+#include "CoffeeEngine/Renderer/Model.h"
 #include "CoffeeEngine/Renderer/Texture.h"
 #include "imgui.h"
 
@@ -50,6 +52,10 @@ namespace Coffee {
                         Texture2DImportData& textureImportData = static_cast<Texture2DImportData&>(*m_CachedImportData);
                         
                         ImGui::Checkbox("sRGB", &textureImportData.sRGB);
+                        ImGui::Combo("Usage", (int*)&textureImportData.usage, "Color\0Normal\0Data\0");
+                        ImGui::Checkbox("Compress", &textureImportData.compress);
+                        if (textureImportData.compress)
+                            ImGui::Checkbox("High Quality (BC7)", &textureImportData.highQuality);
 /*                      ImGui::Checkbox("Flip Y", &textureImportData.flipY);
                         ImGui::Checkbox("Anisotropic Filtering", &textureImportData.anisotropicFiltering);
                         ImGui::Checkbox("Generate Mipmaps", &textureImportData.generateMipmaps);
@@ -64,6 +70,87 @@ namespace Coffee {
                             //m_SelectedResource = ResourceLoader::Load<Texture2D>(*m_CachedImportData);
                         }
 
+                        break;
+                    }
+                    case ResourceType::Model:
+                    {
+                        ModelImportData& modelImportData = static_cast<ModelImportData&>(*m_CachedImportData);
+                        MeshLODSettings& lodSettings = modelImportData.lodSettings;
+
+                        ImGui::Checkbox("Generate LODs", &lodSettings.Enabled);
+                        ImGui::BeginDisabled(!lodSettings.Enabled);
+                        ImGui::SliderInt("LOD Count", (int*)&lodSettings.MaxLODCount, 1, 8);
+                        ImGui::SliderFloat("Reduction", &lodSettings.Reduction, 0.1f, 0.9f);
+                        ImGui::SliderFloat("Max Error", &lodSettings.MaxError, 0.001f, 0.5f, "%.3f", ImGuiSliderFlags_Logarithmic);
+                        ImGui::DragScalar("Min Triangles", ImGuiDataType_U32, &lodSettings.MinTriangleCount);
+                        ImGui::EndDisabled();
+
+                        ImGui::Checkbox("Quantize Positions", &modelImportData.quantizePositions);
+
+                        if (ImGui::TreeNode("Animation Optimization"))
+                        {
+                            AnimationOptimizationSettings& animationSettings = modelImportData.animationSettings;
+
+                            ImGui::Checkbox("Optimize Keyframes", &animationSettings.Enabled);
+                            ImGui::BeginDisabled(!animationSettings.Enabled);
+                            ImGui::SliderFloat("Tolerance", &animationSettings.Default.Tolerance, 0.0001f, 0.01f, "%.4f m", ImGuiSliderFlags_Logarithmic);
+                            ImGui::SliderFloat("Distance", &animationSettings.Default.Distance, 0.01f, 1.0f, "%.2f m");
+
+                            static char jointName[128] = "";
+                            ImGui::InputText("##JointName", jointName, sizeof(jointName));
+                            ImGui::SameLine();
+                            if (ImGui::Button("Add Joint Override") && jointName[0] != '\0')
+                            {
+                                animationSettings.JointOverrides.emplace(jointName, animationSettings.Default);
+                                jointName[0] = '\0';
+                            }
+
+                            for (auto it = animationSettings.JointOverrides.begin(); it != animationSettings.JointOverrides.end();)
+                            {
+                                ImGui::PushID(it->first.c_str());
+                                ImGui::TextUnformatted(it->first.c_str());
+                                ImGui::DragFloat("Tolerance", &it->second.Tolerance, 0.0001f, 0.0001f, 0.01f, "%.4f m");
+                                ImGui::DragFloat("Distance", &it->second.Distance, 0.01f, 0.01f, 1.0f, "%.2f m");
+                                bool remove = ImGui::Button("Remove");
+                                ImGui::PopID();
+
+                                it = remove ? animationSettings.JointOverrides.erase(it) : std::next(it);
+                            }
+                            ImGui::EndDisabled();
+
+                            Ref<Model> model = std::static_pointer_cast<Model>(m_SelectedResource);
+                            if (!model->GetAnimationReports().empty() && ImGui::BeginTable("AnimationReports", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+                            {
+                                ImGui::TableSetupColumn("Animation");
+                                ImGui::TableSetupColumn("Keys");
+                                ImGui::TableSetupColumn("Size (KB)");
+                                ImGui::TableSetupColumn("Max Error (mm)");
+                                ImGui::TableHeadersRow();
+
+                                for (const AnimationOptimizationReport& report : model->GetAnimationReports())
+                                {
+                                    ImGui::TableNextRow();
+                                    ImGui::TableNextColumn();
+                                    ImGui::TextUnformatted(report.Name.c_str());
+                                    ImGui::TableNextColumn();
+                                    ImGui::Text("%u -> %u", report.KeysBefore, report.KeysAfter);
+                                    ImGui::TableNextColumn();
+                                    ImGui::Text("%.1f -> %.1f", report.BytesBefore / 1024.0f, report.BytesAfter / 1024.0f);
+                                    ImGui::TableNextColumn();
+                                    ImGui::Text("%.3f", report.MaxError * 1000.0f);
+                                }
+                                ImGui::EndTable();
+                            }
+
+                            ImGui::TreePop();
+                        }
+
+                        if (ImGui::Button("Reimport"))
+                        {
+                            ImportDataUtils::SaveImportData(m_CachedImportData);
+                            ResourceLoader::ReimportResource(m_SelectedResource);
+                        }
+
                         break;
                     }
                 }
@@ -3,6 +3,8 @@
 #include "CoffeeEngine/Core/FileDialog.h"
 #include "CoffeeEngine/Core/Input.h"
 #include "CoffeeEngine/Project/Project.h"
+#include "CoffeeEngine/Scene/Scene.h"
+#include "CoffeeEngine/Scene/SceneManager.h"
 #include "CoffeeEngine/Audio/Audio.h"
 
 #include <imgui.h>
@@ -288,6 +290,56 @@ namespace Coffee {
         ImGui::EndChild();
     }
 
+    void ProjectSettingsPanel::RenderPhysicsSettings(const ImGuiWindowFlags flags)
+    {
+        if (!(m_VisiblePanels & PanelDisplayEnum::Physics))
+            return;
+
+        BeginHorizontalChild("Physics", flags);
+
+        ImGui::Text("Physics Settings");
+
+        bool multithreaded = Project::GetMultithreadedPhysics();
+        if (ImGui::Checkbox("Multithreaded physics", &multithreaded))
+        {
+            Project::SetMultithreadedPhysics(multithreaded);
+        }
+        ImGui::TextDisabled("Steps the physics on the job system workers. Applies to the scenes loaded afterwards.");
+
+        ImGui::Separator();
+        ImGui::Text("Timestep of the active scene");
+
+        Ref<Scene> scene = SceneManager::GetActiveScene();
+        if (!scene)
+        {
+            ImGui::TextDisabled("No scene loaded");
+            ImGui::EndChild();
+            return;
+        }
+
+        // Saved with the scene
+        PhysicsTimestepSettings settings = scene->GetPhysicsWorld().getTimestepSettings();
+        bool changed = false;
+
+        changed |= ImGui::Checkbox("Fixed timestep", &settings.fixedTimestep);
+        ImGui::BeginDisabled(!settings.fixedTimestep);
+        changed |= ImGui::DragFloat("Fixed delta time", &settings.fixedDeltaTime, 0.0005f, 1.0f / 480.0f, 0.1f, "%.4f s");
+        changed |= ImGui::DragInt("Max substeps", &settings.maxSubSteps, 1.0f, 1, 32);
+        changed |= ImGui::DragFloat("Max frame time", &settings.maxFrameTime, 0.01f, settings.fixedDeltaTime, 1.0f, "%.3f s");
+        changed |= ImGui::Checkbox("Interpolate", &settings.interpolate);
+        ImGui::EndDisabled();
+
+        if (changed)
+        {
+            scene->GetPhysicsWorld().setTimestepSettings(settings);
+        }
+
+        const PhysicsStepStats& stats = scene->GetPhysicsWorld().getStepStats();
+        ImGui::TextDisabled("Last frame: %i substeps, %.3f s dropped", stats.subSteps, stats.droppedTime);
+
+        ImGui::EndChild();
+    }
+
     void ProjectSettingsPanel::OnImGuiRender()
     {
         if (!m_Visible) return;
@@ -323,12 +375,19 @@ namespace Coffee {
                 m_VisiblePanels = PanelDisplayEnum::Input;
             ImGui::TreePop();
         }
+        if (ImGui::TreeNodeEx("Physics", ImGuiTreeNodeFlags_Leaf))
+        {
+            if (ImGui::IsItemClicked())
+                m_VisiblePanels = PanelDisplayEnum::Physics;
+            ImGui::TreePop();
+        }
 
         ImGui::SameLine();
         ImGui::Separator();
 
         RenderGeneralSettings(flags);
         RenderInputSettings(flags);
+        RenderPhysicsSettings(flags);
 
         ImGui::PopID();
         ImGui::End();
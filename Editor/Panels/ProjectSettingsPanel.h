@@ -16,7 +16,8 @@ namespace Coffee {
         enum : uint8_t{
             None = 0,
             General = BIT(1),
-            Input = BIT(2)
+            Input = BIT(2),
+            Physics = BIT(3)
         };
     }
 
@@ -33,6 +34,7 @@ namespace Coffee {
       void SetSelectedBinding(std::string actionName, InputBinding* binding);
       void RenderInputSettings(ImGuiWindowFlags flags);
         void RenderGeneralSettings(ImGuiWindowFlags flags);
+        void RenderPhysicsSettings(ImGuiWindowFlags flags);
 
         uint8_t m_VisiblePanels = 0;
 
@@ -926,6 +926,22 @@ namespace Coffee
                         return "RGBA32F";
                     case ImageFormat::DEPTH24STENCIL8:
                         return "DEPTH24STENCIL8";
+                    case ImageFormat::BC1:
+                        return "BC1";
+                    case ImageFormat::BC1_SRGB:
+                        return "BC1_SRGB";
+                    case ImageFormat::BC3:
+                        return "BC3";
+                    case ImageFormat::BC3_SRGB:
+                        return "BC3_SRGB";
+                    case ImageFormat::BC4:
+                        return "BC4";
+                    case ImageFormat::BC5:
+                        return "BC5";
+                    case ImageFormat::BC7:
+                        return "BC7";
+                    case ImageFormat::BC7_SRGB:
+                        return "BC7_SRGB";
                     }
                 };
 
@@ -1099,6 +1115,22 @@ namespace Coffee
                         return "RGBA32F";
                     case ImageFormat::DEPTH24STENCIL8:
                         return "DEPTH24STENCIL8";
+                    case ImageFormat::BC1:
+                        return "BC1";
+                    case ImageFormat::BC1_SRGB:
+                        return "BC1_SRGB";
+                    case ImageFormat::BC3:
+                        return "BC3";
+                    case ImageFormat::BC3_SRGB:
+                        return "BC3_SRGB";
+                    case ImageFormat::BC4:
+                        return "BC4";
+                    case ImageFormat::BC5:
+                        return "BC5";
+                    case ImageFormat::BC7:
+                        return "BC7";
+                    case ImageFormat::BC7_SRGB:
+                        return "BC7_SRGB";
                     }
                 };
 
@@ -2251,6 +2283,22 @@ namespace Coffee
 
                 ImGui::Checkbox("Loop", &animatorComponent.Loop);
 
+                ImGui::Checkbox("Share Pose", &animatorComponent.SharePose);
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Reuse the pose of animators playing the same animations at the same time");
+
+                if (ImGui::TreeNode("Level of Detail"))
+                {
+                    AnimationLODSettings& lod = animatorComponent.LOD;
+                    ImGui::Checkbox("Enabled", &lod.Enabled);
+                    ImGui::DragFloat("Reduced Rate Distance", &lod.ReducedRateDistance, 0.5f, 0.0f, 1000.0f, "%.1f");
+                    ImGui::DragScalar("Reduced Rate Interval", ImGuiDataType_U32, &lod.ReducedRateInterval, 0.1f);
+                    ImGui::DragFloat("Low Rate Distance", &lod.LowRateDistance, 0.5f, 0.0f, 1000.0f, "%.1f");
+                    ImGui::DragScalar("Low Rate Interval", ImGuiDataType_U32, &lod.LowRateInterval, 0.1f);
+                    ImGui::Checkbox("Pause When Culled", &lod.PauseWhenCulled);
+                    ImGui::TreePop();
+                }
+
                 animatorComponent.NeedsUpdate = true;
             }
 
@@ -1,11 +1,12 @@
+#pragma keywords HAS_ALBEDO_MAP HAS_NORMAL_MAP HAS_METALLIC_MAP HAS_ROUGHNESS_MAP HAS_AO_MAP HAS_EMISSIVE_MAP
+
 #[vertex]
 
 #version 450 core
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec2 aTexCoord;
-layout (location = 2) in vec3 aNormals;
-layout (location = 3) in vec3 aTangent;
-layout (location = 4) in vec3 aBitangent;
+layout (location = 2) in vec2 aNormal;
+layout (location = 3) in uint aTangent;
 
 layout (std140, binding = 0) uniform camera
 {
@@ -28,10 +29,29 @@ layout (location = 2) out VertexData Output;
 uniform mat4 model;
 uniform mat3 normalMatrix;
 
+// Normals and tangents are octahedral encoded, see VertexQuantization
+vec3 octDecode(vec2 e)
+{
+    vec3 v = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+    return normalize(v);
+}
+
+vec4 decodeTangent(uint packed)
+{
+    vec2 e = vec2(packed & 0x7FFFu, (packed >> 15) & 0x7FFFu) / 32767.0 * 2.0 - 1.0;
+    return vec4(octDecode(e), (packed & 0x80000000u) != 0u ? -1.0 : 1.0);
+}
+
 void main()
 {
+    vec3 normal = octDecode(aNormal);
+    vec4 tangent = decodeTangent(aTangent);
+    vec3 bitangent = cross(normal, tangent.xyz) * tangent.w;
+
     Output.WorldPos = vec3(model * vec4(aPosition, 1.0));
-    Output.Normal = normalMatrix * aNormals;
+    Output.Normal = normalMatrix * normal;
     Output.camPos = cameraPos;
     Output.TexCoords = aTexCoord;
 
@@ -43,9 +63,9 @@ void main()
     //and then pass them to the fragment shader. But this way is more simple and easy to understand + for PBR is better to transform
     //the normal map to view space + im lazy to move the lights to the vertex shader
 
-    vec3 T = normalize(vec3(model * vec4(aTangent, 0.0)));
-    vec3 B = normalize(vec3(model * vec4(aBitangent, 0.0)));
-    vec3 N = normalize(vec3(model * vec4(aNormals, 0.0)));
+    vec3 T = normalize(vec3(model * vec4(tangent.xyz, 0.0)));
+    vec3 B = normalize(vec3(model * vec4(bitangent, 0.0)));
+    vec3 N = normalize(vec3(model * vec4(normal, 0.0)));
 
     Output.TBN = mat3(T, B, N);
 }
@@ -86,13 +106,6 @@ struct Material
     float roughness;
     float ao;
     vec3 emissive;
-
-    int hasAlbedo;
-    int hasNormal;
-    int hasMetallic;
-    int hasRoughness;
-    int hasAO;
-    int hasEmissive;
 };
 
 uniform Material material;
@@ -167,19 +180,43 @@ float GeometrySmith(vec3 N, vec3 V, vec3 L, float roughness)
 
 void main()
 {
-    vec3 albedo = material.hasAlbedo * (texture(material.albedoMap, VertexInput.TexCoords).rgb * material.color.rgb) + (1 - material.hasAlbedo) * material.color.rgb;
-
-    // Revise this type of conditional assignment (the commented one) because i think can lead to some undefined behavior in the shader!!!!!
-    vec3 normal/*  = material.hasNormal * (VertexInput.TBN * (texture(material.normalMap, VertexInput.TexCoords).rgb * 2.0 - 1.0)) + (1 - material.hasNormal) * VertexInput.Normal */;
-    if (material.hasNormal == 1) {
-        normal = VertexInput.TBN * (texture(material.normalMap, VertexInput.TexCoords).rgb * 2.0 - 1.0);
-    } else {
-        normal = VertexInput.Normal;
-    }
-    float metallic = material.hasMetallic * (texture(material.metallicMap, VertexInput.TexCoords).b * material.metallic) + (1 - material.hasMetallic) * material.metallic;
-    float roughness = material.hasRoughness * (texture(material.roughnessMap, VertexInput.TexCoords).g * material.roughness) + (1 - material.hasRoughness) * material.roughness;
-    float ao = material.hasAO * (texture(material.aoMap, VertexInput.TexCoords).r * material.ao) + (1 - material.hasAO) * material.ao;
-    vec3 emissive = material.hasEmissive * (texture(material.emissiveMap, VertexInput.TexCoords).rgb * material.emissive) + (1 - material.hasEmissive) * material.emissive;
+#ifdef HAS_ALBEDO_MAP
+    vec3 albedo = texture(material.albedoMap, VertexInput.TexCoords).rgb * material.color.rgb;
+#else
+    vec3 albedo = material.color.rgb;
+#endif
+
+#ifdef HAS_NORMAL_MAP
+    // Normal maps can be stored with two channels (BC5), the z is rebuilt from the unit length
+    vec2 normalXY = texture(material.normalMap, VertexInput.TexCoords).rg * 2.0 - 1.0;
+    vec3 normal = VertexInput.TBN * vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
+#else
+    vec3 normal = VertexInput.Normal;
+#endif
+
+#ifdef HAS_METALLIC_MAP
+    float metallic = texture(material.metallicMap, VertexInput.TexCoords).b * material.metallic;
+#else
+    float metallic = material.metallic;
+#endif
+
+#ifdef HAS_ROUGHNESS_MAP
+    float roughness = texture(material.roughnessMap, VertexInput.TexCoords).g * material.roughness;
+#else
+    float roughness = material.roughness;
+#endif
+
+#ifdef HAS_AO_MAP
+    float ao = texture(material.aoMap, VertexInput.TexCoords).r * material.ao;
+#else
+    float ao = material.ao;
+#endif
+
+#ifdef HAS_EMISSIVE_MAP
+    vec3 emissive = texture(material.emissiveMap, VertexInput.TexCoords).rgb * material.emissive;
+#else
+    vec3 emissive = material.emissive;
+#endif
 
     vec3 N = normalize(normal);
     vec3 V = normalize(VertexInput.camPos - VertexInput.WorldPos);
@@ -1,5 +1,6 @@
 #include "EditorLayer.h"
 
+#include "CoffeeEngine/Animation/AnimationSystem.h"
 #include "CoffeeEngine/Core/Application.h"
 #include "CoffeeEngine/Core/Assert.h"
 #include "CoffeeEngine/Core/Base.h"
@@ -11,6 +12,7 @@
 #include "CoffeeEngine/Events/KeyEvent.h"
 #include "CoffeeEngine/IO/ResourceLoader.h"
 #include "CoffeeEngine/IO/ResourceRegistry.h"
+#include "CoffeeEngine/IO/ResourceResidency.h"
 #include "CoffeeEngine/IO/ResourceUtils.h"
 #include "CoffeeEngine/Project/Project.h"
 #include "CoffeeEngine/Renderer/EditorCamera.h"
@@ -569,7 +571,7 @@ namespace Coffee {
         //transparent overlay displaying fps draw calls etc
         ImGuiWindowFlags window_flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoDocking | /*ImGuiWindowFlags_AlwaysAutoResize |*/ ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
 
-        ImGui::SetNextWindowPos(ImVec2(ImGui::GetWindowPos().x + ImGui::GetWindowSize().x - 205, ImGui::GetWindowPos().y + ImGui::GetWindowSize().y - 100));
+        ImGui::SetNextWindowPos(ImVec2(ImGui::GetWindowPos().x + ImGui::GetWindowSize().x - 205, ImGui::GetWindowPos().y + ImGui::GetWindowSize().y - 150));
 
         ImGui::SetNextWindowBgAlpha(0.35f); // Transparent background
 
@@ -578,6 +580,9 @@ namespace Coffee {
         ImGui::Text("Draw Calls: %d", Renderer3D::GetStats().DrawCalls);
         ImGui::Text("Vertex Count: %d", Renderer3D::GetStats().VertexCount);
         ImGui::Text("Index Count: %d", Renderer3D::GetStats().IndexCount);
+        ImGui::Text("Mesh RAM: %.1f MB", ResourceResidency::GetResidentBytes(ResourceType::Mesh) / (1024.0f * 1024.0f));
+        ImGui::Text("Texture RAM: %.1f MB", ResourceResidency::GetResidentBytes(ResourceType::Texture2D) / (1024.0f * 1024.0f));
+        ImGui::Text("Animators: %d / %d (%.0f%% shared)", AnimationSystem::GetStats().Evaluated, AnimationSystem::GetStats().Animators, AnimationSystem::GetStats().GetPoseCacheHitRate() * 100.0f);
         ImGui::End();
 
         // Display EditorCamera speed vertical slider & zoom vertical slider at the center left
@@ -0,0 +1,73 @@
+#include "BenchmarkFramework.h"
+
+#include "CoffeeEngine/Animation/AnimationSystem.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace Coffee;
+
+namespace {
+
+    // Rigid joint transforms with some scale, as a skinned skeleton has
+    std::vector<glm::mat4> MakeTransforms(uint32_t count, uint32_t seed)
+    {
+        std::vector<glm::mat4> transforms(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            float t = (float)(i * 7 + seed);
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(std::sin(t), std::cos(t * 0.3f), t * 0.01f));
+            transform = glm::rotate(transform, t * 0.17f, glm::normalize(glm::vec3(1.0f, std::sin(t), 0.5f)));
+            transforms[i] = glm::scale(transform, glm::vec3(1.0f + 0.01f * (i % 5)));
+        }
+        return transforms;
+    }
+
+    std::vector<ozz::math::Float4x4> ToOzz(const std::vector<glm::mat4>& transforms)
+    {
+        std::vector<ozz::math::Float4x4> result(transforms.size());
+        for (size_t i = 0; i < transforms.size(); i++)
+        {
+            const float* values = glm::value_ptr(transforms[i]);
+            for (int column = 0; column < 4; column++)
+                result[i].cols[column] = ozz::math::simd_float4::LoadPtrU(values + column * 4);
+        }
+        return result;
+    }
+
+} // namespace
+
+// The skinning palette of skeletons from a simple character to a detailed one, against the glm path it replaced:
+// a copy of each model space matrix into a glm::mat4, then a glm product with the inverse bind pose
+COFFEE_BENCHMARK(JointPalette)
+{
+    for (uint32_t jointCount : {50u, 100u, 150u, 200u, 250u})
+    {
+        std::vector<glm::mat4> glmModels = MakeTransforms(jointCount, 1);
+        std::vector<glm::mat4> glmInverseBindPoses = MakeTransforms(jointCount, 2);
+        std::vector<ozz::math::Float4x4> models = ToOzz(glmModels);
+        std::vector<ozz::math::Float4x4> inverseBindPoses = ToOzz(glmInverseBindPoses);
+        std::vector<glm::mat4> palette(jointCount);
+
+        double glmTime = Benchmark::Measure(fmt::format("{} joints, glm", jointCount), [&]() {
+            for (uint32_t i = 0; i < jointCount; i++)
+            {
+                glm::mat4 model;
+                std::memcpy(glm::value_ptr(model), &models[i].cols[0], sizeof(glm::mat4));
+                palette[i] = model * glmInverseBindPoses[i];
+            }
+            Benchmark::DoNotOptimize(palette[jointCount - 1]);
+        });
+
+        double simdTime = Benchmark::Measure(fmt::format("{} joints, BuildJointPalette", jointCount), [&]() {
+            AnimationSystem::BuildJointPalette(models, inverseBindPoses, palette);
+            Benchmark::DoNotOptimize(palette[jointCount - 1]);
+        });
+
+        fmt::print("    {:<48} {:>12.2f}x\n", "speedup", glmTime / simdTime);
+    }
+}
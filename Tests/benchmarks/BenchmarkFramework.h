@@ -0,0 +1,90 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace Coffee::Benchmark {
+
+    /**
+     * @brief A benchmark registered with COFFEE_BENCHMARK.
+     */
+    struct BenchmarkCase
+    {
+        const char* Name;
+        void (*Function)();
+    };
+
+    /**
+     * @brief Gets every registered benchmark, in registration order.
+     * @return The registered benchmarks.
+     */
+    inline std::vector<BenchmarkCase>& GetBenchmarks()
+    {
+        static std::vector<BenchmarkCase> benchmarks;
+        return benchmarks;
+    }
+
+    /**
+     * @brief Registers a benchmark at static initialization time.
+     */
+    struct BenchmarkRegistrar
+    {
+        BenchmarkRegistrar(const char* name, void (*function)())
+        {
+            GetBenchmarks().push_back({name, function});
+        }
+    };
+
+    /**
+     * @brief Keeps the compiler from removing a computation whose result is otherwise unused.
+     * @param value The result to keep.
+     */
+    template<typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+        static const void* volatile s_Sink;
+        s_Sink = &value;
+    }
+
+    /**
+     * @brief Times a function and prints the mean time per call.
+     *
+     * The function runs once to warm up, then in batches that double until a batch lasts at least minSeconds.
+     *
+     * @param label The name printed with the timing.
+     * @param function The code to time.
+     * @param minSeconds The shortest batch that is reported.
+     * @return The mean time per call in nanoseconds.
+     */
+    template<typename F>
+    double Measure(const std::string& label, F&& function, double minSeconds = 0.25)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        function();
+
+        for (uint64_t iterations = 1;; iterations *= 2)
+        {
+            Clock::time_point start = Clock::now();
+            for (uint64_t i = 0; i < iterations; i++)
+                function();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            if (seconds >= minSeconds)
+            {
+                double nanoseconds = seconds * 1e9 / iterations;
+                fmt::print("    {:<48} {:>12.1f} ns\n", label, nanoseconds);
+                return nanoseconds;
+            }
+        }
+    }
+
+} // namespace Coffee::Benchmark
+
+#define COFFEE_BENCHMARK(name)                                                                                     \
+    static void Benchmark_##name();                                                                                \
+    static ::Coffee::Benchmark::BenchmarkRegistrar Benchmark_##name##_Registrar(#name, &Benchmark_##name);         \
+    static void Benchmark_##name()
@@ -0,0 +1,38 @@
+#include "BenchmarkFramework.h"
+
+#include "CoffeeEngine/Core/Log.h"
+
+#include <cstdio>
+#include <cstring>
+
+/**
+ * @brief Runs the benchmarks whose name contains the first argument, or every benchmark without arguments.
+ * @return 0, or 1 if no benchmark matched.
+ */
+int main(int argc, char** argv)
+{
+    using namespace Coffee;
+
+    Log::Init();
+
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    int run = 0;
+    for (const Benchmark::BenchmarkCase& benchmark : Benchmark::GetBenchmarks())
+    {
+        if (filter && !std::strstr(benchmark.Name, filter))
+            continue;
+
+        std::printf("%s\n", benchmark.Name);
+        benchmark.Function();
+        run++;
+    }
+
+    if (run == 0)
+    {
+        std::fprintf(stderr, "No benchmarks found for %s\n", filter ? filter : "<all>");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "BenchmarkFramework.h"
+
+#include "CoffeeEngine/Core/JobSystem.h"
+#include "CoffeeEngine/Physics/PhysicsWorld.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace Coffee;
+
+namespace {
+
+    // Columns of boxes and spheres piled on a ground box, kept awake so every step does the same work
+    struct PhysicsStressScene
+    {
+        btBoxShape GroundShape{btVector3(200.0f, 1.0f, 200.0f)};
+        btBoxShape BoxShape{btVector3(0.5f, 0.5f, 0.5f)};
+        btSphereShape SphereShape{0.5f};
+        std::vector<std::unique_ptr<btDefaultMotionState>> MotionStates;
+        std::vector<std::unique_ptr<btRigidBody>> Bodies;
+
+        // Declared last so it is destroyed first, while the bodies it removes still exist
+        PhysicsWorld World;
+
+        PhysicsStressScene(uint32_t bodyCount, bool multithreaded) : World(multithreaded)
+        {
+            AddBody(&GroundShape, 0.0f, btVector3(0.0f, -1.0f, 0.0f));
+
+            const uint32_t columnHeight = 10;
+            const uint32_t columnsPerRow = (uint32_t)std::ceil(std::sqrt((double)bodyCount / columnHeight));
+            for (uint32_t i = 0; i < bodyCount; i++)
+            {
+                uint32_t column = i / columnHeight;
+                btVector3 position(2.0f * (column % columnsPerRow) - columnsPerRow, 0.5f + 1.05f * (i % columnHeight),
+                                   2.0f * (column / columnsPerRow) - columnsPerRow);
+                btRigidBody* body = AddBody(i % 3 == 0 ? (btCollisionShape*)&SphereShape : &BoxShape, 1.0f, position);
+                body->setActivationState(DISABLE_DEACTIVATION);
+            }
+        }
+
+        btRigidBody* AddBody(btCollisionShape* shape, float mass, const btVector3& position)
+        {
+            btVector3 inertia(0.0f, 0.0f, 0.0f);
+            if (mass > 0.0f)
+                shape->calculateLocalInertia(mass, inertia);
+
+            auto motionState = std::make_unique<btDefaultMotionState>(btTransform(btQuaternion::getIdentity(), position));
+            auto body = std::make_unique<btRigidBody>(btRigidBody::btRigidBodyConstructionInfo(mass, motionState.get(), shape, inertia));
+            World.addRigidBody(body.get());
+
+            MotionStates.push_back(std::move(motionState));
+            Bodies.push_back(std::move(body));
+            return Bodies.back().get();
+        }
+    };
+
+} // namespace
+
+// A step of a world full of resting contacts, on the calling thread against the job system workers
+COFFEE_BENCHMARK(PhysicsWorldStress)
+{
+    // Multithreaded worlds need the workers running when they are created
+    JobSystem::Init();
+
+    const float deltaTime = 1.0f / 60.0f;
+    for (uint32_t bodyCount : {500u, 2000u, 8000u})
+    {
+        PhysicsStressScene singleThreaded(bodyCount, false);
+        PhysicsStressScene multithreaded(bodyCount, true);
+
+        // Let the columns settle, the contacts of a resting pile are what the steps of a game mostly solve
+        for (int frame = 0; frame < 60; frame++)
+        {
+            singleThreaded.World.stepSimulation(deltaTime);
+            multithreaded.World.stepSimulation(deltaTime);
+        }
+
+        double singleTime = Benchmark::Measure(fmt::format("{} bodies, single-threaded", bodyCount), [&]() {
+            singleThreaded.World.stepSimulation(deltaTime);
+        }, 1.0);
+
+        double multiTime = Benchmark::Measure(fmt::format("{} bodies, {} threads", bodyCount, JobSystem::GetWorkerCount() + 1), [&]() {
+            multithreaded.World.stepSimulation(deltaTime);
+        }, 1.0);
+
+        fmt::print("    {:<48} {:>12.2f}x\n", "speedup", singleTime / multiTime);
+    }
+
+    JobSystem::Shutdown();
+}
@@ -0,0 +1,44 @@
+#include "BenchmarkFramework.h"
+
+#include "CoffeeEngine/IO/CacheManager.h"
+#include "CoffeeEngine/Renderer/Font.h"
+#include "CoffeeEngine/Renderer/MSDFData.h"
+
+#include <filesystem>
+
+using namespace Coffee;
+
+// Loading a font atlas cold, generating the MSDF atlas and storing it, against a warm load from the cache.
+// The GL upload is the same for both and is left out, so no context is needed.
+COFFEE_BENCHMARK(FontAtlas)
+{
+    const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / "CoffeeBenchmarkCache";
+    CacheManager::SetCachePath(cachePath);
+
+    for (const char* fontName : {"Brawler-Bold.ttf", "OpenSans-SemiBold.ttf"})
+    {
+        const std::filesystem::path fontPath = std::filesystem::path(COFFEE_BENCHMARK_ASSETS_DIR) / "fonts" / fontName;
+
+        auto buildAtlas = [&fontPath](bool readCache) {
+            MSDFData data;
+            Font::AtlasSource source = Font::BuildAtlas(fontPath, data, [](const uint8_t* pixels, uint32_t width, uint32_t height) {
+                Benchmark::DoNotOptimize(pixels[(width * height * 3) / 2]);
+            }, readCache);
+            Benchmark::DoNotOptimize(data.Glyphs.size());
+            return source;
+        };
+
+        if (buildAtlas(false) != Font::AtlasSource::Generated || buildAtlas(true) != Font::AtlasSource::Cache)
+        {
+            fmt::print("    {} could not be generated and cached, skipped\n", fontPath.string());
+            continue;
+        }
+
+        double coldTime = Benchmark::Measure(fmt::format("{}, generated", fontName), [&]() { buildAtlas(false); }, 1.0);
+        double warmTime = Benchmark::Measure(fmt::format("{}, cache hit", fontName), [&]() { buildAtlas(true); });
+
+        fmt::print("    {:<48} {:>12.2f}x\n", "speedup", coldTime / warmTime);
+    }
+
+    std::filesystem::remove_all(cachePath);
+}
@@ -0,0 +1,85 @@
+#include "BenchmarkFramework.h"
+
+#include "CoffeeEngine/UI/UIHitGrid.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace Coffee;
+
+namespace {
+
+    bool RectContains(const glm::vec4& rect, const glm::vec2& point)
+    {
+        return point.x >= rect.x && point.y >= rect.y && point.x <= rect.z && point.y <= rect.w;
+    }
+
+} // namespace
+
+// Finding the topmost element under the cursor: the linear test of every rect the UI did before, against the grid
+COFFEE_BENCHMARK(UIHitGrid)
+{
+    const glm::vec2 area = {1920.0f, 1080.0f};
+    const uint32_t queryCount = 1000;
+
+    for (uint32_t elementCount : {100u, 1000u, 5000u})
+    {
+        std::mt19937 random(elementCount);
+        std::uniform_real_distribution<float> x(0.0f, area.x), y(0.0f, area.y), size(20.0f, 200.0f);
+
+        std::vector<glm::vec4> rects(elementCount);
+        for (glm::vec4& rect : rects)
+        {
+            glm::vec2 min = {x(random), y(random)};
+            rect = glm::vec4(min, min + glm::vec2(size(random), size(random) * 0.5f));
+        }
+
+        std::vector<glm::vec2> points(queryCount);
+        for (glm::vec2& point : points)
+            point = {x(random), y(random)};
+
+        UIHitGrid grid;
+        grid.Reset(area);
+        for (uint32_t i = 0; i < elementCount; i++)
+            grid.Insert(i, rects[i]);
+
+        // Accumulated outside the timed functions so the searches can not be optimized away
+        uint64_t linearHits = 0;
+        uint64_t gridHits = 0;
+
+        double linearTime = Benchmark::Measure(fmt::format("{} elements, {} queries, linear", elementCount, queryCount), [&]() {
+            for (const glm::vec2& point : points)
+            {
+                for (uint32_t i = elementCount; i-- > 0;)
+                {
+                    if (RectContains(rects[i], point))
+                    {
+                        linearHits += i;
+                        break;
+                    }
+                }
+            }
+        });
+
+        double gridTime = Benchmark::Measure(fmt::format("{} elements, {} queries, grid", elementCount, queryCount), [&]() {
+            for (const glm::vec2& point : points)
+            {
+                const std::vector<uint32_t>& candidates = grid.Query(point);
+                for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+                {
+                    if (RectContains(rects[*it], point))
+                    {
+                        gridHits += *it;
+                        break;
+                    }
+                }
+            }
+        });
+
+        Benchmark::DoNotOptimize(linearHits);
+        Benchmark::DoNotOptimize(gridHits);
+
+        fmt::print("    {:<48} {:>12.2f}x\n", "speedup", linearTime / gridTime);
+    }
+}
@@ -0,0 +1,181 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Animation/AnimationLOD.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Coffee;
+
+namespace {
+
+    AnimationLODSettings GetEnabledSettings()
+    {
+        AnimationLODSettings settings;
+        settings.Enabled = true;
+        return settings;
+    }
+
+    // Runs the scheduler over frames [first, first + count) and returns which ones evaluated
+    std::vector<bool> Run(const AnimationLODSettings& settings, AnimationLODState& state, uint64_t first, uint32_t count, float deltaTime, float* evaluatedTime = nullptr)
+    {
+        std::vector<bool> evaluated;
+        for (uint64_t frame = first; frame < first + count; frame++)
+        {
+            AnimationLODDecision decision = AnimationLOD::Schedule(settings, state, frame, deltaTime);
+            evaluated.push_back(decision.Evaluate);
+            if (evaluatedTime)
+                *evaluatedTime += decision.DeltaTime;
+        }
+        return evaluated;
+    }
+
+} // namespace
+
+COFFEE_TEST(AnimationLOD, DisabledUpdatesEveryFrame)
+{
+    AnimationLODSettings settings;
+    AnimationLODState state;
+    state.Phase = 0;
+    state.Distance = 1000.0f;
+    state.Visible = false;
+
+    for (uint64_t frame = 0; frame < 16; frame++)
+    {
+        AnimationLODDecision decision = AnimationLOD::Schedule(settings, state, frame, 0.02f);
+        COFFEE_CHECK(decision.Evaluate);
+        COFFEE_CHECK(decision.FullBody);
+        COFFEE_CHECK_EQ(decision.DeltaTime, 0.02f);
+    }
+    COFFEE_CHECK(state.Level == AnimationLODLevel::Full);
+}
+
+COFFEE_TEST(AnimationLOD, LevelsFollowDistanceAndVisibility)
+{
+    AnimationLODSettings settings = GetEnabledSettings();
+
+    COFFEE_CHECK(AnimationLOD::SelectLevel(settings, 0.0f, true) == AnimationLODLevel::Full);
+    COFFEE_CHECK(AnimationLOD::SelectLevel(settings, settings.ReducedRateDistance, true) == AnimationLODLevel::Reduced);
+    COFFEE_CHECK(AnimationLOD::SelectLevel(settings, settings.LowRateDistance - 0.01f, true) == AnimationLODLevel::Reduced);
+    COFFEE_CHECK(AnimationLOD::SelectLevel(settings, settings.LowRateDistance, true) == AnimationLODLevel::Low);
+    COFFEE_CHECK(AnimationLOD::SelectLevel(settings, 0.0f, false) == AnimationLODLevel::Paused);
+
+    settings.PauseWhenCulled = false;
+    COFFEE_CHECK(AnimationLOD::SelectLevel(settings, 0.0f, false) == AnimationLODLevel::Full);
+
+    // A zero interval is treated as every frame, only the paused level never updates
+    settings.ReducedRateInterval = 0;
+    COFFEE_CHECK_EQ(AnimationLOD::GetUpdateInterval(settings, AnimationLODLevel::Reduced), 1u);
+    COFFEE_CHECK_EQ(AnimationLOD::GetUpdateInterval(settings, AnimationLODLevel::Paused), 0u);
+}
+
+COFFEE_TEST(AnimationLOD, ThrottledAnimatorsKeepTheElapsedTime)
+{
+    AnimationLODSettings settings = GetEnabledSettings();
+    AnimationLODState state;
+    state.Phase = 0;
+    state.Distance = settings.LowRateDistance;
+    state.Level = AnimationLODLevel::Low;
+
+    float evaluatedTime = 0.0f;
+    std::vector<bool> evaluated = Run(settings, state, 0, 16, 0.01f, &evaluatedTime);
+
+    COFFEE_CHECK((evaluated == std::vector<bool>{true, false, false, false, true, false, false, false,
+                                                 true, false, false, false, true, false, false, false}));
+
+    // Every frame but the last three was handed to an update, the rest is pending
+    COFFEE_CHECK_NEAR(evaluatedTime, 0.13f, 1e-5f);
+    COFFEE_CHECK_NEAR(state.PendingTime, 0.03f, 1e-5f);
+}
+
+COFFEE_TEST(AnimationLOD, PhasesSpreadTheUpdates)
+{
+    AnimationLODSettings settings = GetEnabledSettings();
+
+    std::vector<AnimationLODState> states(8);
+    for (uint32_t i = 0; i < states.size(); i++)
+    {
+        states[i].Phase = i;
+        states[i].Distance = settings.LowRateDistance;
+        states[i].Level = AnimationLODLevel::Low;
+    }
+
+    // With an interval of 4, eight animators with consecutive phases update two per frame
+    for (uint64_t frame = 0; frame < 12; frame++)
+    {
+        uint32_t updates = 0;
+        for (AnimationLODState& state : states)
+            updates += AnimationLOD::Schedule(settings, state, frame, 0.01f).Evaluate ? 1 : 0;
+        COFFEE_CHECK_EQ(updates, 2u);
+    }
+}
+
+COFFEE_TEST(AnimationLOD, RefiningUpdatesAtOnce)
+{
+    AnimationLODSettings settings = GetEnabledSettings();
+    AnimationLODState state;
+    state.Phase = 0;
+    state.Distance = settings.LowRateDistance;
+    state.Level = AnimationLODLevel::Low;
+
+    // Frame 1 is off the Low interval, but coming closer must not wait for it
+    Run(settings, state, 0, 1, 0.01f);
+    state.Distance = 0.0f;
+    AnimationLODDecision decision = AnimationLOD::Schedule(settings, state, 1, 0.01f);
+    COFFEE_CHECK(decision.Evaluate);
+    COFFEE_CHECK(decision.FullBody);
+    COFFEE_CHECK(state.Level == AnimationLODLevel::Full);
+
+    // Getting coarser waits for the interval
+    state.Distance = settings.LowRateDistance;
+    COFFEE_CHECK(!AnimationLOD::Schedule(settings, state, 2, 0.01f).Evaluate);
+    COFFEE_CHECK(!AnimationLOD::Schedule(settings, state, 3, 0.01f).Evaluate);
+    decision = AnimationLOD::Schedule(settings, state, 4, 0.01f);
+    COFFEE_CHECK(decision.Evaluate);
+    COFFEE_CHECK(!decision.FullBody);
+}
+
+COFFEE_TEST(AnimationLOD, PausedAnimatorsCatchUpWhenVisible)
+{
+    AnimationLODSettings settings = GetEnabledSettings();
+    AnimationLODState state;
+    state.Phase = 0;
+
+    Run(settings, state, 0, 1, 0.01f);
+
+    state.Visible = false;
+    std::vector<bool> evaluated = Run(settings, state, 1, 50, 0.01f);
+    COFFEE_CHECK(std::find(evaluated.begin(), evaluated.end(), true) == evaluated.end());
+    COFFEE_CHECK(state.Level == AnimationLODLevel::Paused);
+
+    // The clips continue where they would be, not where they were paused
+    state.Visible = true;
+    AnimationLODDecision decision = AnimationLOD::Schedule(settings, state, 51, 0.01f);
+    COFFEE_CHECK(decision.Evaluate);
+    COFFEE_CHECK_NEAR(decision.DeltaTime, 0.51f, 1e-5f);
+    COFFEE_CHECK_EQ(state.PendingTime, 0.0f);
+}
+
+COFFEE_TEST(AnimationLOD, SchedulingIsDeterministic)
+{
+    AnimationLODSettings settings = GetEnabledSettings();
+
+    // The same inputs give the same decisions, whatever ran before
+    auto simulate = [&settings]() {
+        AnimationLODState state;
+        state.Phase = 3;
+
+        std::vector<bool> evaluated;
+        for (uint64_t frame = 0; frame < 200; frame++)
+        {
+            state.Distance = (float)((frame * 7) % 80);
+            state.Visible = frame % 37 < 30;
+            AnimationLODDecision decision = AnimationLOD::Schedule(settings, state, frame, 1.0f / 60.0f);
+            evaluated.push_back(decision.Evaluate);
+            evaluated.push_back(decision.FullBody);
+        }
+        return evaluated;
+    };
+
+    COFFEE_CHECK(simulate() == simulate());
+}
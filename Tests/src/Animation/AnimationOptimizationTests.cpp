@@ -0,0 +1,128 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Animation/AnimationOptimization.h"
+
+#include <ozz/animation/offline/animation_builder.h>
+#include <ozz/animation/offline/raw_animation.h>
+#include <ozz/animation/offline/raw_skeleton.h>
+#include <ozz/animation/offline/skeleton_builder.h>
+#include <ozz/base/maths/quaternion.h>
+
+#include <cmath>
+#include <map>
+#include <string>
+
+using namespace Coffee;
+
+namespace {
+
+    constexpr float BoneLength = 0.1f;
+
+    // A chain of joints, one bone length apart
+    ozz::unique_ptr<ozz::animation::Skeleton> BuildChain(int jointCount)
+    {
+        ozz::animation::offline::RawSkeleton rawSkeleton;
+        rawSkeleton.roots.resize(1);
+        ozz::animation::offline::RawSkeleton::Joint* joint = &rawSkeleton.roots[0];
+        for (int i = 0; i < jointCount; i++)
+        {
+            joint->name = ("joint" + std::to_string(i)).c_str();
+            joint->transform = ozz::math::Transform::identity();
+            joint->transform.translation = ozz::math::Float3(0.0f, BoneLength, 0.0f);
+            if (i + 1 < jointCount)
+            {
+                joint->children.resize(1);
+                joint = &joint->children[0];
+            }
+        }
+
+        ozz::animation::offline::SkeletonBuilder builder;
+        return builder(rawSkeleton);
+    }
+
+    // Two seconds baked at 30 frames per second, the root swings and the other joints hold their pose
+    ozz::animation::offline::RawAnimation BuildSwing(int jointCount)
+    {
+        ozz::animation::offline::RawAnimation rawAnimation;
+        rawAnimation.name = "Swing";
+        rawAnimation.duration = 2.0f;
+        rawAnimation.tracks.resize(jointCount);
+
+        for (auto& track : rawAnimation.tracks)
+        {
+            track.translations.push_back({0.0f, ozz::math::Float3(0.0f, BoneLength, 0.0f)});
+            track.rotations.push_back({0.0f, ozz::math::Quaternion::identity()});
+            track.scales.push_back({0.0f, ozz::math::Float3::one()});
+        }
+
+        auto& root = rawAnimation.tracks[0];
+        root.rotations.clear();
+        for (int frame = 0; frame <= 60; frame++)
+        {
+            float time = frame / 30.0f;
+            float angle = 0.5f * std::sin(time * 3.14159265f);
+            root.rotations.push_back({time, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::z_axis(), angle)});
+        }
+
+        return rawAnimation;
+    }
+
+} // namespace
+
+COFFEE_TEST(AnimationOptimization, OptimizedClipStaysWithinTolerance)
+{
+    const int jointCount = 4;
+    auto skeleton = BuildChain(jointCount);
+    ozz::animation::offline::RawAnimation rawAnimation = BuildSwing(jointCount);
+    COFFEE_CHECK(skeleton && rawAnimation.Validate());
+
+    AnimationOptimizationSettings settings;
+    AnimationOptimizationReport report;
+    auto optimized = AnimationOptimization::Build(rawAnimation, *skeleton, {}, settings, report);
+    COFFEE_CHECK(optimized != nullptr);
+
+    COFFEE_CHECK_EQ(report.Name, std::string("Swing"));
+    COFFEE_CHECK(report.KeysAfter < report.KeysBefore);
+    COFFEE_CHECK(report.BytesAfter < report.BytesBefore);
+
+    // The optimizer measures the root at its farthest descendant, the end of the chain moves the most. The error is
+    // estimated from the rotation by ozz and measured on the positions here, so allow for float noise.
+    COFFEE_CHECK(report.MaxError >= 0.0f);
+    COFFEE_CHECK_LE(report.MaxError, settings.Default.Tolerance * 1.1f);
+
+    ozz::animation::offline::AnimationBuilder builder;
+    auto reference = builder(rawAnimation);
+    float error = AnimationOptimization::MeasureError(*skeleton, *reference, *optimized);
+    COFFEE_CHECK_NEAR(error, report.MaxError, 1e-6f);
+}
+
+COFFEE_TEST(AnimationOptimization, DisabledKeepsEveryKeyframe)
+{
+    const int jointCount = 4;
+    auto skeleton = BuildChain(jointCount);
+    ozz::animation::offline::RawAnimation rawAnimation = BuildSwing(jointCount);
+
+    AnimationOptimizationSettings settings;
+    settings.Enabled = false;
+    AnimationOptimizationReport report;
+    auto animation = AnimationOptimization::Build(rawAnimation, *skeleton, {}, settings, report);
+    COFFEE_CHECK(animation != nullptr);
+
+    COFFEE_CHECK_EQ(report.KeysAfter, report.KeysBefore);
+    COFFEE_CHECK_EQ(report.KeysBefore, AnimationOptimization::CountKeys(rawAnimation));
+    COFFEE_CHECK_EQ(report.BytesAfter, report.BytesBefore);
+    COFFEE_CHECK_EQ(report.MaxError, 0.0f);
+}
+
+COFFEE_TEST(AnimationOptimization, MeasureErrorFailsOnMismatchedSkeleton)
+{
+    // Eight tracks do not fit the pose of a two joint skeleton, the sampling job refuses to run
+    auto skeleton = BuildChain(2);
+    ozz::animation::offline::AnimationBuilder builder;
+    auto animation = builder(BuildSwing(8));
+    COFFEE_CHECK(skeleton && animation);
+
+    float error = AnimationOptimization::MeasureError(*skeleton, *animation, *animation);
+    COFFEE_CHECK(error < 0.0f);
+    COFFEE_CHECK_EQ(error, AnimationOptimization::MeasureFailed);
+}
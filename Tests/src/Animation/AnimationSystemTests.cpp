@@ -0,0 +1,229 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Animation/Animation.h"
+#include "CoffeeEngine/Animation/AnimationSystem.h"
+#include "CoffeeEngine/Animation/Skeleton.h"
+#include "CoffeeEngine/Core/JobSystem.h"
+#include "CoffeeEngine/Scene/Components/AnimatorComponent.h"
+
+#include <ozz/animation/offline/animation_builder.h>
+#include <ozz/animation/offline/raw_animation.h>
+#include <ozz/animation/offline/raw_skeleton.h>
+#include <ozz/animation/offline/skeleton_builder.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// Counts the heap allocations of every thread while enabled. The allocations of ozz go through its own allocator and
+// are not counted, its runtime jobs do not allocate.
+static std::atomic<bool> s_CountAllocations = false;
+static std::atomic<uint64_t> s_Allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    if (s_CountAllocations.load(std::memory_order_relaxed))
+        s_Allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* block = std::malloc(size ? size : 1))
+        return block;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+using namespace Coffee;
+
+namespace {
+
+    // A chain of joints, so the upper body is the end of the chain from the given joint
+    Ref<Skeleton> BuildSkeleton(int jointCount)
+    {
+        std::vector<Joint> joints(jointCount);
+        for (int i = 0; i < jointCount; i++)
+        {
+            joints[i].name = "joint" + std::to_string(i);
+            joints[i].parentIndex = i - 1;
+            joints[i].localTransform = ozz::math::Transform::identity();
+            joints[i].localTransform.translation = ozz::math::Float3(0.0f, 0.1f, 0.0f);
+            joints[i].invBindPose = glm::mat4(1.0f);
+        }
+
+        ozz::animation::offline::RawSkeleton rawSkeleton;
+        rawSkeleton.roots.resize(1);
+        ozz::animation::offline::RawSkeleton::Joint* parent = &rawSkeleton.roots[0];
+        for (int i = 0; i < jointCount; i++)
+        {
+            parent->name = joints[i].name.c_str();
+            parent->transform = joints[i].localTransform;
+            if (i + 1 < jointCount)
+            {
+                parent->children.resize(1);
+                parent = &parent->children[0];
+            }
+        }
+
+        ozz::animation::offline::SkeletonBuilder builder;
+        auto skeleton = CreateRef<Skeleton>();
+        skeleton->SetSkeleton(builder(rawSkeleton));
+        skeleton->SetJoints(joints);
+        return skeleton;
+    }
+
+    // One second of every joint bending around an axis, back and forth
+    ozz::unique_ptr<ozz::animation::Animation> BuildAnimation(int jointCount, const ozz::math::Float3& axis)
+    {
+        ozz::animation::offline::RawAnimation rawAnimation;
+        rawAnimation.duration = 1.0f;
+        rawAnimation.tracks.resize(jointCount);
+
+        for (auto& track : rawAnimation.tracks)
+        {
+            for (float time : {0.0f, 0.25f, 0.5f, 0.75f, 1.0f})
+            {
+                float angle = 0.3f * std::sin(time * 6.2831853f);
+                track.translations.push_back({time, ozz::math::Float3(0.0f, 0.1f, 0.0f)});
+                track.rotations.push_back({time, ozz::math::Quaternion::FromAxisAngle(axis, angle)});
+                track.scales.push_back({time, ozz::math::Float3::one()});
+            }
+        }
+
+        ozz::animation::offline::AnimationBuilder builder;
+        return builder(rawAnimation);
+    }
+
+    struct AnimatedCrowd
+    {
+        Ref<Skeleton> SharedSkeleton;
+        Ref<AnimationController> Controller;
+        std::vector<std::unique_ptr<AnimatorComponent>> Components;
+        std::vector<AnimatorComponent*> Animators;
+
+        AnimatedCrowd(int animatorCount, int jointCount)
+        {
+            SharedSkeleton = BuildSkeleton(jointCount);
+            Controller = CreateRef<AnimationController>();
+            Controller->AddAnimation("Bend", BuildAnimation(jointCount, ozz::math::Float3::x_axis()));
+            Controller->AddAnimation("Twist", BuildAnimation(jointCount, ozz::math::Float3::y_axis()));
+
+            for (int i = 0; i < animatorCount; i++)
+            {
+                auto animator = std::make_unique<AnimatorComponent>(SharedSkeleton, Controller);
+                AnimationSystem::SetupPartialBlending(0, 1, "joint" + std::to_string(jointCount / 2), animator.get());
+
+                // Half of them share their pose, so the copies of the shared poses run too
+                animator->SharePose = i % 2 == 0;
+                Animators.push_back(animator.get());
+                Components.push_back(std::move(animator));
+            }
+        }
+
+        // Starts a transition on every animator, so the frames also blend between clips
+        void SwitchAnimations(unsigned int index)
+        {
+            for (AnimatorComponent* animator : Animators)
+                animator->SetUpperAnimation(index);
+        }
+    };
+
+    // Allocations per frame of the steady state: after warming up, over a few transitions
+    double MeasureAllocationsPerFrame(AnimatedCrowd& crowd)
+    {
+        const float deltaTime = 1.0f / 60.0f;
+
+        for (int frame = 0; frame < 30; frame++)
+            AnimationSystem::UpdateAll(crowd.Animators, deltaTime);
+
+        const int frames = 120;
+        s_Allocations = 0;
+        s_CountAllocations = true;
+
+        for (int frame = 0; frame < frames; frame++)
+        {
+            if (frame % 40 == 0)
+                crowd.SwitchAnimations((frame / 40) % 2);
+            AnimationSystem::UpdateAll(crowd.Animators, deltaTime);
+        }
+
+        s_CountAllocations = false;
+        return (double)s_Allocations.load() / frames;
+    }
+
+} // namespace
+
+COFFEE_TEST(AnimationSystem, UpdateAllDoesNotAllocate)
+{
+    // Without workers the ranges run on this thread, only the animation work is measured
+    JobSystem::Shutdown();
+
+    AnimatedCrowd crowd(32, 60);
+    COFFEE_CHECK_EQ(MeasureAllocationsPerFrame(crowd), 0.0);
+    COFFEE_CHECK(AnimationSystem::GetStats().Evaluated == 32);
+}
+
+COFFEE_TEST(AnimationSystem, DispatchAllocationsDoNotGrowWithAnimators)
+{
+    // The ParallelFor state and the helper jobs come from the pools of the job system, whatever the batch size
+    JobSystem::Init(2);
+
+    AnimatedCrowd small(16, 60);
+    AnimatedCrowd large(256, 60);
+    COFFEE_CHECK_EQ(MeasureAllocationsPerFrame(small), 0.0);
+    COFFEE_CHECK_EQ(MeasureAllocationsPerFrame(large), 0.0);
+
+    JobSystem::Shutdown();
+}
+
+COFFEE_TEST(AnimationSystem, JointPaletteMatchesGlm)
+{
+    // Odd sizes and a shorter palette check the bounds, the values are affine transforms with scale
+    const uint32_t jointCount = 67;
+
+    std::vector<glm::mat4> models(jointCount), inverseBindPoses(jointCount);
+    std::vector<ozz::math::Float4x4> ozzModels(jointCount), ozzInverseBindPoses(jointCount);
+    for (uint32_t i = 0; i < jointCount; i++)
+    {
+        float t = (float)i;
+        models[i] = glm::mat4(1.0f + 0.1f * std::sin(t), 0.2f, 0.0f, 0.0f,
+                              -0.2f, 1.0f, 0.3f * std::cos(t), 0.0f,
+                              0.1f, 0.0f, 0.9f, 0.0f,
+                              t, -2.0f * t, 0.5f, 1.0f);
+        inverseBindPoses[i] = glm::mat4(0.8f, 0.0f, 0.1f * t, 0.0f,
+                                        0.0f, 1.2f, 0.0f, 0.0f,
+                                        -0.1f, 0.05f, 1.0f, 0.0f,
+                                        1.0f, 0.0f, -t, 1.0f);
+
+        for (int column = 0; column < 4; column++)
+        {
+            ozzModels[i].cols[column] = ozz::math::simd_float4::LoadPtrU(&models[i][column][0]);
+            ozzInverseBindPoses[i].cols[column] = ozz::math::simd_float4::LoadPtrU(&inverseBindPoses[i][column][0]);
+        }
+    }
+
+    std::vector<glm::mat4> palette(jointCount - 2, glm::mat4(0.0f));
+    AnimationSystem::BuildJointPalette(ozzModels, ozzInverseBindPoses, palette);
+
+    float maxError = 0.0f;
+    for (uint32_t i = 0; i < palette.size(); i++)
+    {
+        glm::mat4 expected = models[i] * inverseBindPoses[i];
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+                maxError = std::max(maxError, std::abs(palette[i][column][row] - expected[column][row]) / std::max(1.0f, std::abs(expected[column][row])));
+    }
+    // The SIMD path fuses multiply-adds in another order than glm, the translations sum terms of up to a hundred
+    COFFEE_CHECK_LE(maxError, 1e-4);
+}
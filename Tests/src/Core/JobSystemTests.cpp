@@ -0,0 +1,95 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Core/JobSystem.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Coffee;
+
+COFFEE_TEST(JobSystem, SubmitRunsOnTheWorkers)
+{
+    JobSystem::Init(2);
+    COFFEE_CHECK_EQ(JobSystem::GetWorkerCount(), 2u);
+
+    std::vector<std::future<std::thread::id>> futures;
+    for (int i = 0; i < 16; i++)
+        futures.push_back(JobSystem::Submit([]() { return std::this_thread::get_id(); }));
+
+    bool onWorkers = true;
+    for (std::future<std::thread::id>& future : futures)
+        onWorkers &= future.get() != std::this_thread::get_id();
+    COFFEE_CHECK(onWorkers);
+
+    // A second Init keeps the running pool
+    JobSystem::Init(4);
+    COFFEE_CHECK_EQ(JobSystem::GetWorkerCount(), 2u);
+
+    JobSystem::Shutdown();
+}
+
+COFFEE_TEST(JobSystem, ShutdownFinishesQueuedJobs)
+{
+    JobSystem::Init(1);
+
+    std::atomic<int> done = 0;
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 64; i++)
+        futures.push_back(JobSystem::Submit([&done]() { done++; }));
+
+    JobSystem::Shutdown();
+
+    COFFEE_CHECK_EQ(done.load(), 64);
+    COFFEE_CHECK_EQ(JobSystem::GetWorkerCount(), 0u);
+}
+
+COFFEE_TEST(JobSystem, LateJobsDoNotRestartThePool)
+{
+    JobSystem::Init(2);
+    JobSystem::Shutdown();
+
+    std::future<std::thread::id> late = JobSystem::Submit([]() { return std::this_thread::get_id(); });
+
+    COFFEE_CHECK(late.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    COFFEE_CHECK(late.get() == std::this_thread::get_id());
+    COFFEE_CHECK_EQ(JobSystem::GetWorkerCount(), 0u);
+}
+
+COFFEE_TEST(JobSystem, ParallelForCoversEveryItemOnce)
+{
+    for (uint32_t workers : {0u, 3u})
+    {
+        if (workers)
+            JobSystem::Init(workers);
+
+        for (uint32_t grainSize : {1u, 7u, 1000u})
+        {
+            std::vector<std::atomic<int>> visits(1000);
+            JobSystem::ParallelFor(1000, grainSize, [&visits](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++)
+                    visits[i]++;
+            });
+
+            bool once = true;
+            for (std::atomic<int>& count : visits)
+                once &= count.load() == 1;
+            COFFEE_CHECK(once);
+        }
+
+        JobSystem::Shutdown();
+    }
+}
+
+COFFEE_TEST(JobSystem, NestedParallelForDoesNotDeadlock)
+{
+    JobSystem::Init(2);
+
+    std::atomic<uint32_t> total = 0;
+    JobSystem::ParallelFor(8, 1, [&total](uint32_t, uint32_t) {
+        JobSystem::ParallelFor(100, 10, [&total](uint32_t begin, uint32_t end) { total += end - begin; });
+    });
+    COFFEE_CHECK_EQ(total.load(), 800u);
+
+    JobSystem::Shutdown();
+}
@@ -0,0 +1,316 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Physics/Collider.h"
+#include "CoffeeEngine/Physics/CollisionSystem.h"
+#include "CoffeeEngine/Scene/Entity.h"
+#include "CoffeeEngine/Scene/Scene.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Coffee;
+
+namespace {
+
+    enum class EventType
+    {
+        Enter,
+        Stay,
+        Exit
+    };
+
+    struct RecordedEvent
+    {
+        EventType Type;
+        entt::entity Other;
+        btPersistentManifold* Manifold;
+    };
+
+    // The events raised on one entity, with the other entity of each pair
+    struct EventLog
+    {
+        std::vector<RecordedEvent> Events;
+
+        void Attach(Entity entity)
+        {
+            entt::entity self = entity;
+            auto record = [this, self](EventType type) {
+                return [this, self, type](CollisionInfo& info) {
+                    entt::entity other = (entt::entity)info.entityA == self ? (entt::entity)info.entityB : (entt::entity)info.entityA;
+                    Events.push_back({type, other, info.manifold});
+                };
+            };
+
+            CollisionCallback& callback = entity.GetComponent<RigidbodyComponent>().callback;
+            callback.OnCollisionEnter(record(EventType::Enter));
+            callback.OnCollisionStay(record(EventType::Stay));
+            callback.OnCollisionExit(record(EventType::Exit));
+        }
+
+        int Count(EventType type) const
+        {
+            return (int)std::count_if(Events.begin(), Events.end(), [type](const RecordedEvent& event) { return event.Type == type; });
+        }
+    };
+
+    // Two boxes side by side in one body, touching another of them gives one manifold per pair of boxes
+    class CompoundTestCollider : public Collider
+    {
+    public:
+        CompoundTestCollider()
+        {
+            auto* compound = new btCompoundShape();
+            for (float x : {-1.0f, 1.0f})
+            {
+                m_Children.push_back(std::make_unique<btBoxShape>(btVector3(0.5f, 0.5f, 0.5f)));
+                compound->addChildShape(btTransform(btQuaternion::getIdentity(), btVector3(x, 0.0f, 0.0f)), m_Children.back().get());
+            }
+            m_Shape = compound;
+        }
+
+        void ResizeToFitAABB(const AABB&) override {}
+
+    private:
+        // The compound shape does not own its children, they outlive it since the base class deletes it
+        std::vector<std::unique_ptr<btBoxShape>> m_Children;
+    };
+
+    // A scene stepped by exactly one substep per frame, without the runtime so no script or audio is involved
+    struct CollisionTestScene
+    {
+        Scene ActiveScene;
+
+        CollisionTestScene()
+        {
+            PhysicsTimestepSettings settings;
+            settings.fixedTimestep = true;
+            settings.interpolate = false;
+            ActiveScene.GetPhysicsWorld().setTimestepSettings(settings);
+
+            CollisionSystem::Initialize(&ActiveScene);
+        }
+
+        ~CollisionTestScene() { CollisionSystem::Shutdown(); }
+
+        // Registered like Scene::Load does, the user pointer of the body is the entity
+        Entity AddBody(const std::string& name, RigidBody::Type type, const Ref<Collider>& collider, const glm::vec3& position)
+        {
+            Entity entity = ActiveScene.CreateEntity(name);
+
+            RigidBody::Properties props;
+            props.type = type;
+            props.mass = type == RigidBody::Type::Static ? 0.0f : 1.0f;
+
+            auto& rbComponent = entity.AddComponent<RigidbodyComponent>(props, collider);
+            rbComponent.rb->SetPosition(position);
+            ActiveScene.GetPhysicsWorld().addRigidBody(rbComponent.rb->GetNativeBody());
+            rbComponent.rb->GetNativeBody()->setUserPointer(reinterpret_cast<void*>(static_cast<uintptr_t>((entt::entity)entity)));
+            return entity;
+        }
+
+        // A ground whose top is at y = 0
+        Entity AddGround()
+        {
+            return AddBody("Ground", RigidBody::Type::Static, CreateRef<BoxCollider>(glm::vec3(20.0f, 1.0f, 20.0f)), {0.0f, -0.5f, 0.0f});
+        }
+
+        // A unit box resting on the ground, slightly sunk so it touches from the first substep
+        Entity AddBox(const std::string& name, float x)
+        {
+            return AddBody(name, RigidBody::Type::Dynamic, CreateRef<BoxCollider>(glm::vec3(1.0f)), {x, 0.49f, 0.0f});
+        }
+
+        void Step(int frames)
+        {
+            PhysicsWorld& world = ActiveScene.GetPhysicsWorld();
+            for (int frame = 0; frame < frames; frame++)
+                world.stepSimulation(world.getTimestepSettings().fixedDeltaTime);
+        }
+
+        int CountManifolds(Entity a, Entity b)
+        {
+            const btCollisionObject* bodyA = a.GetComponent<RigidbodyComponent>().rb->GetNativeBody();
+            const btCollisionObject* bodyB = b.GetComponent<RigidbodyComponent>().rb->GetNativeBody();
+            btDispatcher* dispatcher = ActiveScene.GetPhysicsWorld().getDynamicsWorld()->getDispatcher();
+
+            int count = 0;
+            for (int i = 0; i < dispatcher->getNumManifolds(); i++)
+            {
+                const btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+                const bool samePair = (manifold->getBody0() == bodyA && manifold->getBody1() == bodyB) ||
+                                      (manifold->getBody0() == bodyB && manifold->getBody1() == bodyA);
+                if (samePair && manifold->getNumContacts() > 0)
+                    count++;
+            }
+            return count;
+        }
+    };
+
+}
+
+COFFEE_TEST(CollisionSystem, EnterStayThenExit)
+{
+    CollisionTestScene scene;
+    Entity ground = scene.AddGround();
+    Entity box = scene.AddBox("Box", 0.0f);
+
+    EventLog log;
+    log.Attach(box);
+
+    scene.Step(5);
+
+    // Lift the box off the ground, the pair exits on the next substep
+    auto& rbComponent = box.GetComponent<RigidbodyComponent>();
+    rbComponent.rb->SetPosition({0.0f, 10.0f, 0.0f});
+    rbComponent.rb->ResetVelocity();
+    scene.Step(3);
+
+    COFFEE_CHECK(log.Events.size() >= 3);
+    COFFEE_CHECK_EQ(log.Count(EventType::Enter), 1);
+    COFFEE_CHECK_EQ(log.Count(EventType::Exit), 1);
+    COFFEE_CHECK_EQ(log.Count(EventType::Stay), (int)log.Events.size() - 2);
+    if (!log.Events.empty())
+    {
+        COFFEE_CHECK(log.Events.front().Type == EventType::Enter);
+        COFFEE_CHECK(log.Events.back().Type == EventType::Exit);
+    }
+
+    for (const RecordedEvent& event : log.Events)
+    {
+        COFFEE_CHECK(event.Other == (entt::entity)ground);
+
+        // The pair is gone when it exits, so is its manifold
+        COFFEE_CHECK_EQ(event.Manifold == nullptr, event.Type == EventType::Exit);
+    }
+}
+
+COFFEE_TEST(CollisionSystem, CompoundShapesRaiseOneEventPerPair)
+{
+    CollisionTestScene scene;
+    Entity base = scene.AddBody("Base", RigidBody::Type::Static, CreateRef<CompoundTestCollider>(), {0.0f, 0.0f, 0.0f});
+    Entity top = scene.AddBody("Top", RigidBody::Type::Dynamic, CreateRef<CompoundTestCollider>(), {0.0f, 0.99f, 0.0f});
+
+    EventLog baseLog, topLog;
+    baseLog.Attach(base);
+    topLog.Attach(top);
+
+    const int frames = 4;
+    scene.Step(1);
+
+    // Both boxes of the top touch a box of the base, Bullet keeps a manifold for each
+    COFFEE_CHECK(scene.CountManifolds(base, top) >= 2);
+
+    scene.Step(frames - 1);
+
+    for (const EventLog* log : {&baseLog, &topLog})
+    {
+        COFFEE_CHECK_EQ((int)log->Events.size(), frames);
+        COFFEE_CHECK_EQ(log->Count(EventType::Enter), 1);
+        COFFEE_CHECK_EQ(log->Count(EventType::Stay), frames - 1);
+    }
+}
+
+COFFEE_TEST(CollisionSystem, DestroyedEntityRaisesNoLaterEvents)
+{
+    CollisionTestScene scene;
+
+    // Created first so its component is not moved in the storage when the boxes are destroyed
+    Entity ground = scene.AddGround();
+    Entity left = scene.AddBox("Left", -3.0f);
+    Entity right = scene.AddBox("Right", 3.0f);
+
+    // Whichever box enters first destroys the other one, whose enter is later in the same batch
+    std::vector<entt::entity> entered;
+    std::vector<btPersistentManifold*> manifolds;
+    entt::entity destroyed = entt::null;
+    ground.GetComponent<RigidbodyComponent>().callback.OnCollisionEnter([&](CollisionInfo& info) {
+        entt::entity other = (entt::entity)info.entityA == (entt::entity)ground ? (entt::entity)info.entityB : (entt::entity)info.entityA;
+        entered.push_back(other);
+        manifolds.push_back(info.manifold);
+
+        if (destroyed == entt::null)
+        {
+            destroyed = other == (entt::entity)left ? (entt::entity)right : (entt::entity)left;
+            scene.ActiveScene.DestroyEntity(Entity(destroyed, &scene.ActiveScene));
+        }
+    });
+
+    int exits = 0;
+    ground.GetComponent<RigidbodyComponent>().callback.OnCollisionExit([&exits](CollisionInfo&) { exits++; });
+
+    scene.Step(3);
+
+    COFFEE_CHECK_EQ(entered.size(), (size_t)1);
+    COFFEE_CHECK(destroyed != entt::null);
+    COFFEE_CHECK(!entered.empty() && entered.front() != destroyed);
+    COFFEE_CHECK(std::find(manifolds.begin(), manifolds.end(), nullptr) == manifolds.end());
+
+    // The pair of the destroyed box leaves the active pairs without an exit, its entity is gone
+    COFFEE_CHECK_EQ(exits, 0);
+}
+
+COFFEE_TEST(CollisionSystem, RemovedBodyLeavesLaterEventsWithoutManifold)
+{
+    CollisionTestScene scene;
+    Entity ground = scene.AddGround();
+    Entity left = scene.AddBox("Left", -3.0f);
+    Entity right = scene.AddBox("Right", 3.0f);
+
+    // Whichever box enters first takes the other one out of the world, which frees the manifold of its pending enter
+    EventLog log;
+    log.Attach(ground);
+    CollisionCallback& callback = ground.GetComponent<RigidbodyComponent>().callback;
+    CollisionCallback::CollisionFunction record = callback.GetOnCollisionEnter();
+    callback.OnCollisionEnter([&](CollisionInfo& info) {
+        record(info);
+        if (log.Events.size() == 1)
+        {
+            Entity other(log.Events.front().Other == (entt::entity)left ? (entt::entity)right : (entt::entity)left, &scene.ActiveScene);
+            other.SetActive(false);
+        }
+    });
+
+    scene.Step(1);
+
+    COFFEE_CHECK_EQ(log.Events.size(), (size_t)2);
+    if (log.Events.size() == 2)
+    {
+        COFFEE_CHECK(log.Events[0].Manifold != nullptr);
+        COFFEE_CHECK(log.Events[1].Type == EventType::Enter);
+        COFFEE_CHECK(log.Events[1].Manifold == nullptr);
+    }
+}
+
+COFFEE_TEST(CollisionSystem, UntrackedPairsRaiseNothing)
+{
+    CollisionTestScene scene;
+    scene.AddGround();
+    Entity box = scene.AddBox("Box", 0.0f);
+
+    // Far from everything, it would only hear of the pair through a bug
+    Entity bystander = scene.AddBody("Bystander", RigidBody::Type::Dynamic, CreateRef<BoxCollider>(glm::vec3(1.0f)), {8.0f, 10.0f, 0.0f});
+
+    EventLog bystanderLog;
+    bystanderLog.Attach(bystander);
+
+    // Neither the ground nor the box has a callback, their contact is not tracked
+    scene.Step(3);
+    COFFEE_CHECK(bystanderLog.Events.empty());
+
+    // Once tracked the pair enters, it was never active before
+    EventLog boxLog;
+    boxLog.Attach(box);
+    scene.Step(2);
+
+    COFFEE_CHECK_EQ(boxLog.Events.size(), (size_t)2);
+    if (boxLog.Events.size() == 2)
+    {
+        COFFEE_CHECK(boxLog.Events[0].Type == EventType::Enter);
+        COFFEE_CHECK(boxLog.Events[1].Type == EventType::Stay);
+    }
+    COFFEE_CHECK(bystanderLog.Events.empty());
+}
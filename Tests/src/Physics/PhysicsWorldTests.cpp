@@ -0,0 +1,145 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Physics/PhysicsWorld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace Coffee;
+
+namespace {
+
+    // A few bodies falling, tumbling and colliding on a ground box, without a Scene so the collision callbacks are skipped
+    struct PhysicsTestScene
+    {
+        std::vector<std::unique_ptr<btCollisionShape>> Shapes;
+        std::vector<std::unique_ptr<btDefaultMotionState>> MotionStates;
+        std::vector<std::unique_ptr<btRigidBody>> Bodies;
+
+        // Declared last so it is destroyed first, while the bodies it removes still exist
+        PhysicsWorld World{false};
+
+        explicit PhysicsTestScene(const PhysicsTimestepSettings& settings)
+        {
+            World.setTimestepSettings(settings);
+
+            AddBody(std::make_unique<btBoxShape>(btVector3(50.0f, 1.0f, 50.0f)), 0.0f, btVector3(0.0f, -1.0f, 0.0f));
+
+            for (int i = 0; i < 6; i++)
+            {
+                btRigidBody* box = AddBody(std::make_unique<btBoxShape>(btVector3(0.5f, 0.5f, 0.5f)), 1.0f,
+                                           btVector3(0.3f * i, 1.0f + 1.2f * i, 0.2f * (i % 2)),
+                                           btQuaternion(btVector3(1.0f, 0.0f, 1.0f).normalized(), 0.3f * i));
+                box->setAngularVelocity(btVector3(0.0f, 1.0f + i, 0.0f));
+            }
+
+            btRigidBody* sphere = AddBody(std::make_unique<btSphereShape>(0.4f), 2.0f, btVector3(-4.0f, 0.5f, 0.0f));
+            sphere->setLinearVelocity(btVector3(3.0f, 0.0f, 0.5f));
+        }
+
+        btRigidBody* AddBody(std::unique_ptr<btCollisionShape> shape, float mass, const btVector3& position, const btQuaternion& rotation = btQuaternion::getIdentity())
+        {
+            btVector3 inertia(0.0f, 0.0f, 0.0f);
+            if (mass > 0.0f)
+                shape->calculateLocalInertia(mass, inertia);
+
+            auto motionState = std::make_unique<btDefaultMotionState>(btTransform(rotation, position));
+            auto body = std::make_unique<btRigidBody>(btRigidBody::btRigidBodyConstructionInfo(mass, motionState.get(), shape.get(), inertia));
+            World.addRigidBody(body.get());
+
+            Shapes.push_back(std::move(shape));
+            MotionStates.push_back(std::move(motionState));
+            Bodies.push_back(std::move(body));
+            return Bodies.back().get();
+        }
+    };
+
+    struct SimulationResult
+    {
+        int SubSteps = 0;
+        std::vector<btTransform> Transforms;
+    };
+
+    SimulationResult Simulate(const PhysicsTimestepSettings& settings, float frameRate, float seconds)
+    {
+        PhysicsTestScene scene(settings);
+        SimulationResult result;
+
+        // Half a substep ahead, so the rounding of the frame times cannot move the last substep across a frame
+        scene.World.stepSimulation(0.5f * settings.fixedDeltaTime);
+        result.SubSteps += scene.World.getStepStats().subSteps;
+
+        const int frames = (int)std::lround(seconds * frameRate);
+        for (int frame = 0; frame < frames; frame++)
+        {
+            scene.World.stepSimulation(1.0f / frameRate);
+            result.SubSteps += scene.World.getStepStats().subSteps;
+        }
+
+        for (const auto& body : scene.Bodies)
+            result.Transforms.push_back(body->getWorldTransform());
+        return result;
+    }
+
+    PhysicsTimestepSettings GetFixedSettings()
+    {
+        PhysicsTimestepSettings settings;
+        settings.fixedTimestep = true;
+        return settings;
+    }
+
+} // namespace
+
+COFFEE_TEST(PhysicsWorld, FixedTimestepIsOptIn)
+{
+    // Scenes saved before the fixed timestep keep stepping with the frame time
+    COFFEE_CHECK(!PhysicsTimestepSettings().fixedTimestep);
+
+    PhysicsTestScene scene{PhysicsTimestepSettings()};
+    scene.World.stepSimulation(1.0f / 30.0f);
+    COFFEE_CHECK_EQ(scene.World.getStepStats().subSteps, 0);
+}
+
+COFFEE_TEST(PhysicsWorld, FixedTimestepDoesNotDependOnFrameRate)
+{
+    const PhysicsTimestepSettings settings = GetFixedSettings();
+    const float seconds = 3.0f;
+
+    SimulationResult slow = Simulate(settings, 30.0f, seconds);
+    SimulationResult fast = Simulate(settings, 144.0f, seconds);
+
+    const int expectedSubSteps = (int)std::lround(seconds / settings.fixedDeltaTime);
+    COFFEE_CHECK_EQ(slow.SubSteps, expectedSubSteps);
+    COFFEE_CHECK_EQ(fast.SubSteps, expectedSubSteps);
+
+    // The same substeps in the same order: the bodies end up in the same place whatever the frame rate
+    float maxDistance = 0.0f, maxAngle = 0.0f;
+    for (size_t i = 0; i < slow.Transforms.size(); i++)
+    {
+        maxDistance = std::max(maxDistance, (float)slow.Transforms[i].getOrigin().distance(fast.Transforms[i].getOrigin()));
+        maxAngle = std::max(maxAngle, (float)slow.Transforms[i].getRotation().angleShortestPath(fast.Transforms[i].getRotation()));
+    }
+    COFFEE_CHECK_LE(maxDistance, 1e-5);
+    COFFEE_CHECK_LE(maxAngle, 1e-5);
+
+    // The bodies did move: the boxes fell and the sphere rolled
+    for (int i = 1; i <= 6; i++)
+        COFFEE_CHECK(slow.Transforms[i].getOrigin().y() < 1.0f + 1.2f * (i - 1) - 0.1f);
+    COFFEE_CHECK(slow.Transforms[7].getOrigin().x() > -3.0f);
+}
+
+COFFEE_TEST(PhysicsWorld, SlowFramesAreClamped)
+{
+    PhysicsTimestepSettings settings = GetFixedSettings();
+    PhysicsTestScene scene(settings);
+
+    scene.World.stepSimulation(1.0f);
+    const PhysicsStepStats& stats = scene.World.getStepStats();
+
+    COFFEE_CHECK_EQ(stats.subSteps, settings.maxSubSteps);
+    COFFEE_CHECK_LE(1.0f - settings.maxFrameTime, stats.droppedTime);
+    COFFEE_CHECK_LE(stats.droppedTime + stats.subSteps * settings.fixedDeltaTime, 1.0f + 1e-5f);
+    COFFEE_CHECK(stats.interpolationAlpha >= 0.0f && stats.interpolationAlpha < 1.0f);
+}
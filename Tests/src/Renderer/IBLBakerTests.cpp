@@ -0,0 +1,169 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Core/JobSystem.h"
+#include "CoffeeEngine/Renderer/IBLBaker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+using namespace Coffee;
+
+namespace {
+
+    // Small sizes, the checks do not depend on the resolution
+    IBLBakeSettings MakeSettings()
+    {
+        IBLBakeSettings settings;
+        settings.IrradianceSize = 8;
+        settings.PrefilteredSize = 16;
+        settings.PrefilteredMipCount = 3;
+        settings.PrefilteredSampleCount = 64;
+        return settings;
+    }
+
+    // An equirectangular image, the first row being the bottom of the sky
+    std::vector<float> MakeEquirectangular(uint32_t width, uint32_t height, glm::vec3 (*radiance)(uint32_t x, uint32_t y, uint32_t height))
+    {
+        std::vector<float> pixels((size_t)width * height * 3);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                glm::vec3 color = radiance(x, y, height);
+                float* pixel = &pixels[((size_t)y * width + x) * 3];
+                pixel[0] = color.r;
+                pixel[1] = color.g;
+                pixel[2] = color.b;
+            }
+        }
+        return pixels;
+    }
+
+    glm::vec3 GetTexel(const float* faces, uint32_t size, uint32_t face, uint32_t x, uint32_t y)
+    {
+        const float* texel = faces + ((size_t(face) * size + y) * size + x) * 3;
+        return glm::vec3(texel[0], texel[1], texel[2]);
+    }
+
+    // The texel next to the center of a face, its direction is within a few degrees of the face axis
+    glm::vec3 GetCenterTexel(const float* faces, uint32_t size, uint32_t face)
+    {
+        return GetTexel(faces, size, face, size / 2, size / 2);
+    }
+
+    constexpr uint32_t PositiveY = 2, NegativeY = 3;
+
+}
+
+COFFEE_TEST(IBLBaker, UniformEnvironmentBakesToConstantLighting)
+{
+    const IBLBakeSettings settings = MakeSettings();
+    std::vector<float> pixels = MakeEquirectangular(64, 32, [](uint32_t, uint32_t, uint32_t) { return glm::vec3(0.5f, 1.0f, 2.0f); });
+
+    BakedEnvironment environment = IBLBaker::Bake(pixels.data(), 64, 32, settings);
+    COFFEE_CHECK(environment.IsValid());
+    COFFEE_CHECK_EQ(environment.FaceSize, 16u);
+
+    // A constant radiance L is reflected as L by a white lambertian surface, whatever the normal
+    float maxIrradianceError = 0.0f;
+    for (size_t i = 0; i < environment.Irradiance.size(); i += 3)
+    {
+        maxIrradianceError = std::max(maxIrradianceError, std::abs(environment.Irradiance[i + 0] - 0.5f));
+        maxIrradianceError = std::max(maxIrradianceError, std::abs(environment.Irradiance[i + 1] - 1.0f));
+        maxIrradianceError = std::max(maxIrradianceError, std::abs(environment.Irradiance[i + 2] - 2.0f));
+    }
+    COFFEE_CHECK_LE(maxIrradianceError, 1e-3f);
+
+    // Every mip filters the same constant, whatever the roughness
+    float maxPrefilteredError = 0.0f;
+    for (size_t i = 0; i < environment.Prefiltered.size(); i += 3)
+    {
+        maxPrefilteredError = std::max(maxPrefilteredError, std::abs(environment.Prefiltered[i + 0] - 0.5f));
+        maxPrefilteredError = std::max(maxPrefilteredError, std::abs(environment.Prefiltered[i + 1] - 1.0f));
+        maxPrefilteredError = std::max(maxPrefilteredError, std::abs(environment.Prefiltered[i + 2] - 2.0f));
+    }
+    COFFEE_CHECK_LE(maxPrefilteredError, 1e-4f);
+}
+
+COFFEE_TEST(IBLBaker, HalfLitSkySplitsTheHemispheres)
+{
+    const IBLBakeSettings settings = MakeSettings();
+
+    // The upper half of the image is the sky above the horizon
+    std::vector<float> pixels = MakeEquirectangular(64, 32, [](uint32_t, uint32_t y, uint32_t height) {
+        return y >= height / 2 ? glm::vec3(1.0f) : glm::vec3(0.0f);
+    });
+
+    BakedEnvironment environment = IBLBaker::Bake(pixels.data(), 64, 32, settings);
+    COFFEE_CHECK(environment.IsValid());
+
+    // Order 2 SH represent the cosine convolution of a hemisphere exactly, (1 + N.y) / 2: 1 facing the sky, 0 facing
+    // the ground and 0.5 on the horizon, up to the discretization of the boundary
+    const uint32_t irradianceSize = environment.IrradianceSize;
+    float maxIrradianceError = 0.0f;
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        for (uint32_t y = 0; y < irradianceSize; y++)
+        {
+            for (uint32_t x = 0; x < irradianceSize; x++)
+            {
+                glm::vec3 normal = IBLBaker::CubemapDirection(face, (x + 0.5f) / irradianceSize, (y + 0.5f) / irradianceSize);
+                glm::vec3 texel = GetTexel(environment.Irradiance.data(), irradianceSize, face, x, y);
+                maxIrradianceError = std::max(maxIrradianceError, std::abs(texel.g - 0.5f * (1.0f + normal.y)));
+            }
+        }
+    }
+    COFFEE_CHECK_LE(maxIrradianceError, 0.05f);
+
+    // The faces above and below the horizon receive the whole sky and nothing, whatever the roughness
+    size_t mipOffset = 0;
+    for (uint32_t mip = 0; mip < environment.PrefilteredMipCount; mip++)
+    {
+        const uint32_t size = std::max(environment.PrefilteredSize >> mip, 1u);
+        const float* prefiltered = environment.Prefiltered.data() + mipOffset;
+
+        const float up = GetCenterTexel(prefiltered, size, PositiveY).g;
+        const float down = GetCenterTexel(prefiltered, size, NegativeY).g;
+        COFFEE_CHECK_NEAR(up, 1.0f, 0.05f);
+        COFFEE_CHECK_NEAR(down, 0.0f, 0.05f);
+
+        mipOffset += (size_t)size * size * 3 * 6;
+    }
+    COFFEE_CHECK_EQ(mipOffset, environment.Prefiltered.size());
+}
+
+COFFEE_TEST(IBLBaker, BakesAreBitIdentical)
+{
+    const IBLBakeSettings settings = MakeSettings();
+
+    // Bright spots and noise, where a scheduling dependent sum order would show
+    std::vector<float> pixels = MakeEquirectangular(64, 32, [](uint32_t x, uint32_t y, uint32_t height) {
+        uint32_t state = (y * 64 + x) * 2654435761u;
+        float noise = float(state >> 8) / float(1u << 24);
+        float sun = x == 40 && y == 24 ? 500.0f : 0.0f;
+        return glm::vec3(noise + sun, 0.5f * noise, float(y) / height);
+    });
+
+    JobSystem::Init(4);
+    BakedEnvironment first = IBLBaker::Bake(pixels.data(), 64, 32, settings);
+    BakedEnvironment second = IBLBaker::Bake(pixels.data(), 64, 32, settings);
+    JobSystem::Shutdown();
+
+    // And the same again on the calling thread alone
+    BakedEnvironment serial = IBLBaker::Bake(pixels.data(), 64, 32, settings);
+
+    auto bitIdentical = [](const std::vector<float>& a, const std::vector<float>& b) {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+    };
+
+    for (const BakedEnvironment* other : {&second, &serial})
+    {
+        COFFEE_CHECK(bitIdentical(first.Environment, other->Environment));
+        COFFEE_CHECK(bitIdentical(first.Irradiance, other->Irradiance));
+        COFFEE_CHECK(bitIdentical(first.Prefiltered, other->Prefiltered));
+        COFFEE_CHECK(std::memcmp(first.IrradianceSH.data(), other->IrradianceSH.data(), sizeof(first.IrradianceSH)) == 0);
+    }
+}
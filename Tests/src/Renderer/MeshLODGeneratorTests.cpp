@@ -0,0 +1,133 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Renderer/Mesh.h"
+#include "CoffeeEngine/Renderer/MeshLODGenerator.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Coffee;
+
+// A unit sphere with smooth normals, dense enough to leave room for several LODs
+static void BuildSphere(uint32_t rings, uint32_t segments, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+    for (uint32_t ring = 0; ring <= rings; ring++)
+    {
+        float phi = glm::pi<float>() * ring / rings;
+        for (uint32_t segment = 0; segment <= segments; segment++)
+        {
+            float theta = glm::two_pi<float>() * segment / segments;
+
+            Vertex vertex;
+            vertex.Position = glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            vertex.Normals = vertex.Position;
+            vertex.TexCoords = glm::vec2((float)segment / segments, (float)ring / rings);
+            vertices.push_back(vertex);
+        }
+    }
+
+    for (uint32_t ring = 0; ring < rings; ring++)
+    {
+        for (uint32_t segment = 0; segment < segments; segment++)
+        {
+            uint32_t a = ring * (segments + 1) + segment;
+            uint32_t b = a + segments + 1;
+            indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+}
+
+COFFEE_TEST(MeshLODGenerator, TriangleCountsDecrease)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    BuildSphere(64, 128, vertices, indices);
+
+    MeshLODSettings settings;
+    std::vector<uint32_t> lodIndices;
+    std::vector<MeshLOD> lods;
+    MeshLODGenerator::Generate(vertices, indices, settings, lodIndices, lods);
+
+    COFFEE_CHECK(!lods.empty());
+    COFFEE_CHECK_LE(lods.size() + 1, settings.MaxLODCount);
+
+    uint32_t previousIndexCount = (uint32_t)indices.size();
+    float previousError = 0.0f;
+    uint32_t nextOffset = 0;
+
+    for (const MeshLOD& lod : lods)
+    {
+        COFFEE_CHECK_EQ(lod.IndexCount % 3, 0u);
+        COFFEE_CHECK_EQ(lod.IndexOffset, nextOffset);
+        COFFEE_CHECK_LE(lod.IndexCount, previousIndexCount * 0.9);
+        COFFEE_CHECK_LE(settings.MinTriangleCount, lod.IndexCount / 3);
+        COFFEE_CHECK_LE(previousError, lod.Error);
+
+        previousIndexCount = lod.IndexCount;
+        previousError = lod.Error;
+        nextOffset += lod.IndexCount;
+    }
+
+    COFFEE_CHECK_EQ(lodIndices.size(), nextOffset);
+    COFFEE_CHECK(std::all_of(lodIndices.begin(), lodIndices.end(), [&](uint32_t index) { return index < vertices.size(); }));
+}
+
+COFFEE_TEST(MeshLODGenerator, LODsStayCloseToTheSurface)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    BuildSphere(64, 128, vertices, indices);
+
+    MeshLODSettings settings;
+    std::vector<uint32_t> lodIndices;
+    std::vector<MeshLOD> lods;
+    MeshLODGenerator::Generate(vertices, indices, settings, lodIndices, lods);
+
+    // MaxError is relative to the extents of the mesh, 2 for the unit sphere
+    const float maxError = settings.MaxError * 2.0f;
+
+    for (const MeshLOD& lod : lods)
+    {
+        COFFEE_CHECK_LE(lod.Error, maxError);
+
+        // The centroid of every triangle must stay within the error bound of the sphere
+        float maxDeviation = 0.0f;
+        for (uint32_t i = lod.IndexOffset; i < lod.IndexOffset + lod.IndexCount; i += 3)
+        {
+            glm::vec3 centroid = (vertices[lodIndices[i]].Position + vertices[lodIndices[i + 1]].Position + vertices[lodIndices[i + 2]].Position) / 3.0f;
+            maxDeviation = std::max(maxDeviation, 1.0f - glm::length(centroid));
+        }
+
+        COFFEE_CHECK_LE(maxDeviation, maxError);
+    }
+}
+
+COFFEE_TEST(MeshLODGenerator, SmallOrDisabledMeshesAreNotSimplified)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> lodIndices;
+    std::vector<MeshLOD> lods;
+
+    // 2 * 4 * 8 = 64 triangles, not above the minimum
+    BuildSphere(4, 8, vertices, indices);
+    MeshLODGenerator::Generate(vertices, indices, MeshLODSettings(), lodIndices, lods);
+    COFFEE_CHECK(lods.empty());
+    COFFEE_CHECK(lodIndices.empty());
+
+    vertices.clear();
+    indices.clear();
+    BuildSphere(64, 128, vertices, indices);
+
+    MeshLODSettings disabled;
+    disabled.Enabled = false;
+    MeshLODGenerator::Generate(vertices, indices, disabled, lodIndices, lods);
+    COFFEE_CHECK(lods.empty());
+
+    MeshLODSettings single;
+    single.MaxLODCount = 1;
+    MeshLODGenerator::Generate(vertices, indices, single, lodIndices, lods);
+    COFFEE_CHECK(lods.empty());
+}
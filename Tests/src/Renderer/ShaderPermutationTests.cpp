@@ -0,0 +1,138 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Core/Hash.h"
+#include "CoffeeEngine/Renderer/ShaderPermutation.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace Coffee;
+
+COFFEE_TEST(ShaderPermutation, ParseKeywordsSortsAndRemovesDuplicates)
+{
+    const std::string source =
+        "#pragma keywords RECEIVE_SHADOWS ANIMATED\n"
+        "#type vertex\n"
+        "#version 450 core\n"
+        "#pragma keywords HAS_ALBEDO_MAP   ANIMATED\n"
+        "void main() {}\n";
+
+    std::vector<std::string> keywords = ShaderPermutation::ParseKeywords(source);
+
+    COFFEE_CHECK((keywords == std::vector<std::string>{"ANIMATED", "HAS_ALBEDO_MAP", "RECEIVE_SHADOWS"}));
+}
+
+COFFEE_TEST(ShaderPermutation, ParseKeywordsWithoutPragma)
+{
+    COFFEE_CHECK(ShaderPermutation::ParseKeywords("#version 450 core\nvoid main() {}\n").empty());
+}
+
+COFFEE_TEST(ShaderPermutation, ParseKeywordsClampsToMaxKeywords)
+{
+    std::string source = "#pragma keywords";
+    for (uint32_t i = 0; i < ShaderPermutation::MaxKeywords + 8; i++)
+        source += fmt::format(" KEYWORD_{:02}", i);
+
+    COFFEE_CHECK_EQ(ShaderPermutation::ParseKeywords(source).size(), ShaderPermutation::MaxKeywords);
+}
+
+COFFEE_TEST(ShaderPermutation, EnumerateVariantsCoversEveryCombination)
+{
+    const std::vector<std::string> keywords = {"A", "B", "C", "D"};
+
+    std::vector<ShaderKeywordMask> variants = ShaderPermutation::EnumerateVariants(keywords);
+
+    COFFEE_CHECK_EQ(variants.size(), 16u);
+    COFFEE_CHECK_EQ(variants.front(), 0u);
+    COFFEE_CHECK_EQ(std::set<ShaderKeywordMask>(variants.begin(), variants.end()).size(), variants.size());
+    COFFEE_CHECK(std::all_of(variants.begin(), variants.end(), [](ShaderKeywordMask mask) { return mask < 16u; }));
+
+    COFFEE_CHECK_EQ(ShaderPermutation::EnumerateVariants({}).size(), 1u);
+}
+
+COFFEE_TEST(ShaderPermutation, MaskAndDefinesRoundTrip)
+{
+    const std::vector<std::string> keywords = {"ANIMATED", "HAS_ALBEDO_MAP", "RECEIVE_SHADOWS"};
+
+    for (ShaderKeywordMask mask : ShaderPermutation::EnumerateVariants(keywords))
+    {
+        std::vector<std::string> defines = ShaderPermutation::GetDefines(keywords, mask);
+        COFFEE_CHECK(std::is_sorted(defines.begin(), defines.end()));
+        COFFEE_CHECK_EQ(ShaderPermutation::GetMask(keywords, defines), mask);
+    }
+}
+
+COFFEE_TEST(ShaderPermutation, GetMaskIgnoresUndeclaredDefines)
+{
+    const std::vector<std::string> keywords = {"ANIMATED", "RECEIVE_SHADOWS"};
+
+    COFFEE_CHECK_EQ(ShaderPermutation::GetMask(keywords, {"UNKNOWN", "RECEIVE_SHADOWS"}), 0b10u);
+    COFFEE_CHECK_EQ(ShaderPermutation::GetMask(keywords, {"UNKNOWN"}), 0u);
+}
+
+COFFEE_TEST(ShaderPermutation, HashVariantIgnoresOrderAndDuplicates)
+{
+    const uint64_t sourceHash = Hash::FNV1a("shader source");
+
+    const uint64_t hash = ShaderPermutation::HashVariant(sourceHash, {"ANIMATED", "RECEIVE_SHADOWS"});
+
+    COFFEE_CHECK_EQ(ShaderPermutation::HashVariant(sourceHash, {"RECEIVE_SHADOWS", "ANIMATED"}), hash);
+    COFFEE_CHECK_EQ(ShaderPermutation::HashVariant(sourceHash, {"ANIMATED", "RECEIVE_SHADOWS", "ANIMATED"}), hash);
+}
+
+COFFEE_TEST(ShaderPermutation, HashVariantSeparatesVariants)
+{
+    const uint64_t sourceHash = Hash::FNV1a("shader source");
+    const std::vector<std::string> keywords = {"A", "AB", "B", "C", "D"};
+
+    std::set<uint64_t> hashes;
+    for (ShaderKeywordMask mask : ShaderPermutation::EnumerateVariants(keywords))
+        hashes.insert(ShaderPermutation::HashVariant(sourceHash, ShaderPermutation::GetDefines(keywords, mask)));
+
+    COFFEE_CHECK_EQ(hashes.size(), 32u);
+
+    // The defines are delimited, concatenations of keywords must not collide
+    COFFEE_CHECK(ShaderPermutation::HashVariant(sourceHash, {"AB"}) != ShaderPermutation::HashVariant(sourceHash, {"A", "B"}));
+
+    // The same defines of another source are another variant
+    COFFEE_CHECK(ShaderPermutation::HashVariant(sourceHash, {"A"}) != ShaderPermutation::HashVariant(Hash::FNV1a("other source"), {"A"}));
+}
+
+COFFEE_TEST(ShaderPermutation, HashVariantIsStable)
+{
+    // The hash names the program binaries in the cache, it must not change between runs or builds
+    constexpr uint64_t sourceHash = Hash::FNV1a(std::string_view("shader source"));
+
+    uint64_t expected = sourceHash;
+    expected = Hash::Combine(expected, Hash::FNV1a("ANIMATED", sizeof("ANIMATED")));
+    expected = Hash::Combine(expected, Hash::FNV1a("RECEIVE_SHADOWS", sizeof("RECEIVE_SHADOWS")));
+
+    COFFEE_CHECK_EQ(ShaderPermutation::HashVariant(sourceHash, {"RECEIVE_SHADOWS", "ANIMATED"}), expected);
+}
+
+COFFEE_TEST(ShaderPermutation, InjectDefinesAfterVersion)
+{
+    const std::string stage = "#version 450 core\nvoid main() {}\n";
+
+    COFFEE_CHECK_EQ(ShaderPermutation::InjectDefines(stage, {"ANIMATED", "RECEIVE_SHADOWS"}),
+                    std::string("#version 450 core\n#define ANIMATED\n#define RECEIVE_SHADOWS\nvoid main() {}\n"));
+    COFFEE_CHECK_EQ(ShaderPermutation::InjectDefines(stage, {}), stage);
+    COFFEE_CHECK_EQ(ShaderPermutation::InjectDefines("void main() {}\n", {"A"}), std::string("#define A\nvoid main() {}\n"));
+}
+
+COFFEE_TEST(ShaderPermutation, EnumerateVariantsStopsAtMaxEnumeratedKeywords)
+{
+    std::vector<std::string> keywords;
+    for (uint32_t i = 0; i < ShaderPermutation::MaxEnumeratedKeywords; i++)
+        keywords.push_back(fmt::format("KEYWORD_{:02}", i));
+
+    COFFEE_CHECK_EQ(ShaderPermutation::EnumerateVariants(keywords).size(), size_t(1) << ShaderPermutation::MaxEnumeratedKeywords);
+
+    // Past the limit the variants are compiled on demand, only the one without keywords is precompiled
+    keywords.push_back("KEYWORD_LAST");
+    COFFEE_CHECK((ShaderPermutation::EnumerateVariants(keywords) == std::vector<ShaderKeywordMask>{0}));
+
+    for (uint32_t i = (uint32_t)keywords.size(); i < ShaderPermutation::MaxKeywords; i++)
+        keywords.push_back(fmt::format("KEYWORD_{:02}", i));
+    COFFEE_CHECK_EQ(ShaderPermutation::EnumerateVariants(keywords).size(), 1u);
+}
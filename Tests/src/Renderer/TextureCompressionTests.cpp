@@ -0,0 +1,333 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Renderer/TextureCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Coffee;
+
+namespace {
+
+    struct Image
+    {
+        uint32_t Width;
+        uint32_t Height;
+        std::vector<uint8_t> Texels; ///< RGBA8, rows top to bottom.
+
+        uint8_t* At(uint32_t x, uint32_t y) { return &Texels[((size_t)y * Width + x) * 4]; }
+    };
+
+    Image MakeImage(uint32_t width, uint32_t height)
+    {
+        return {width, height, std::vector<uint8_t>((size_t)width * height * 4, 255)};
+    }
+
+    // Smooth color gradients, the content block compression handles best
+    Image MakeGradient(uint32_t width, uint32_t height)
+    {
+        Image image = MakeImage(width, height);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                uint8_t* texel = image.At(x, y);
+                texel[0] = (uint8_t)(x * 255 / (width - 1));
+                texel[1] = (uint8_t)(y * 255 / (height - 1));
+                texel[2] = (uint8_t)(128 + 100 * std::sin(x * 0.05f + y * 0.03f));
+                texel[3] = (uint8_t)((x + y) * 255 / (width + height - 2));
+            }
+        }
+        return image;
+    }
+
+    // Low contrast noise over a gradient, closer to photographic textures
+    Image MakeNoisyGradient(uint32_t width, uint32_t height)
+    {
+        Image image = MakeGradient(width, height);
+        uint32_t state = 12345;
+        for (uint8_t& value : image.Texels)
+        {
+            state = state * 1664525u + 1013904223u;
+            value = (uint8_t)std::clamp((int)value + (int)(state >> 28) - 8, 0, 255);
+        }
+        return image;
+    }
+
+    // A tangent space normal map of a bumpy height field
+    Image MakeNormalMap(uint32_t width, uint32_t height)
+    {
+        Image image = MakeImage(width, height);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                float dx = 0.6f * std::cos(x * 0.2f) * std::sin(y * 0.13f);
+                float dy = 0.6f * std::sin(x * 0.2f) * std::cos(y * 0.13f);
+                float length = std::sqrt(dx * dx + dy * dy + 1.0f);
+
+                uint8_t* texel = image.At(x, y);
+                texel[0] = (uint8_t)std::lround((dx / length * 0.5f + 0.5f) * 255.0f);
+                texel[1] = (uint8_t)std::lround((dy / length * 0.5f + 0.5f) * 255.0f);
+                texel[2] = (uint8_t)std::lround((1.0f / length * 0.5f + 0.5f) * 255.0f);
+            }
+        }
+        return image;
+    }
+
+    Image RoundTrip(const Image& source, BlockFormat format)
+    {
+        std::vector<uint8_t> blocks(TextureCompression::GetCompressedSize(format, source.Width, source.Height));
+        TextureCompression::CompressImage(source.Texels.data(), source.Width, source.Height, format, blocks.data());
+
+        Image decoded = MakeImage(source.Width, source.Height);
+        uint32_t blockSize = TextureCompression::GetBlockSize(format);
+        uint32_t blocksX = (source.Width + 3) / 4;
+
+        for (size_t block = 0; block * blockSize < blocks.size(); block++)
+        {
+            uint8_t texels[64];
+            TextureCompression::DecompressBlock(format, &blocks[block * blockSize], texels);
+
+            uint32_t blockX = (uint32_t)(block % blocksX) * 4;
+            uint32_t blockY = (uint32_t)(block / blocksX) * 4;
+            for (uint32_t y = 0; y < 4 && blockY + y < source.Height; y++)
+                for (uint32_t x = 0; x < 4 && blockX + x < source.Width; x++)
+                    std::memcpy(decoded.At(blockX + x, blockY + y), &texels[(y * 4 + x) * 4], 4);
+        }
+
+        return decoded;
+    }
+
+    // Root mean square error of the channels [first, first + count)
+    double RMSE(const Image& a, const Image& b, int first, int count)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < a.Texels.size(); i += 4)
+        {
+            for (int c = first; c < first + count; c++)
+            {
+                double difference = (double)a.Texels[i + c] - b.Texels[i + c];
+                sum += difference * difference;
+            }
+        }
+        return std::sqrt(sum / (a.Texels.size() / 4 * count));
+    }
+
+    int MaxError(const Image& a, const Image& b, int first, int count)
+    {
+        int maxError = 0;
+        for (size_t i = 0; i < a.Texels.size(); i += 4)
+            for (int c = first; c < first + count; c++)
+                maxError = std::max(maxError, std::abs((int)a.Texels[i + c] - (int)b.Texels[i + c]));
+        return maxError;
+    }
+
+    // Writes the bits of a block from the least significant bit of the first byte, as BC7 lays them out
+    struct BlockBits
+    {
+        uint8_t Bytes[16] = {};
+        uint32_t Position = 0;
+
+        void Write(uint32_t value, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; i++, Position++)
+                Bytes[Position / 8] |= (uint8_t)(((value >> i) & 1) << (Position % 8));
+        }
+    };
+
+} // namespace
+
+COFFEE_TEST(TextureCompression, BC1RoundTrip)
+{
+    Image gradient = MakeGradient(64, 64);
+    Image noisy = MakeNoisyGradient(64, 64);
+
+    Image decodedGradient = RoundTrip(gradient, BlockFormat::BC1);
+    Image decodedNoisy = RoundTrip(noisy, BlockFormat::BC1);
+
+    COFFEE_CHECK_LE(RMSE(gradient, decodedGradient, 0, 3), 4.0);
+    COFFEE_CHECK_LE(MaxError(gradient, decodedGradient, 0, 3), 16);
+    COFFEE_CHECK_LE(RMSE(noisy, decodedNoisy, 0, 3), 6.0);
+
+    // BC1 is always written in 4-color mode, the texels stay opaque
+    COFFEE_CHECK_EQ(MaxError(MakeImage(64, 64), decodedGradient, 3, 1), 0);
+}
+
+COFFEE_TEST(TextureCompression, BC3RoundTrip)
+{
+    Image gradient = MakeGradient(64, 64);
+    Image decoded = RoundTrip(gradient, BlockFormat::BC3);
+
+    COFFEE_CHECK_LE(RMSE(gradient, decoded, 0, 3), 4.0);
+    COFFEE_CHECK_LE(RMSE(gradient, decoded, 3, 1), 1.0);
+    COFFEE_CHECK_LE(MaxError(gradient, decoded, 3, 1), 4);
+}
+
+COFFEE_TEST(TextureCompression, BC4RoundTrip)
+{
+    Image noisy = MakeNoisyGradient(64, 64);
+    Image decoded = RoundTrip(noisy, BlockFormat::BC4);
+
+    COFFEE_CHECK_LE(RMSE(noisy, decoded, 0, 1), 2.5);
+    COFFEE_CHECK_LE(MaxError(noisy, decoded, 0, 1), 10);
+}
+
+COFFEE_TEST(TextureCompression, BC5RoundTrip)
+{
+    Image normals = MakeNormalMap(64, 64);
+    Image decoded = RoundTrip(normals, BlockFormat::BC5);
+
+    COFFEE_CHECK_LE(RMSE(normals, decoded, 0, 2), 1.5);
+    COFFEE_CHECK_LE(MaxError(normals, decoded, 0, 2), 6);
+
+    // The reconstructed Z must stay close to the source normal
+    double maxAngle = 0.0;
+    for (size_t i = 0; i < normals.Texels.size(); i += 4)
+    {
+        auto unpack = [](const uint8_t* texel, double n[3]) {
+            n[0] = texel[0] / 127.5 - 1.0;
+            n[1] = texel[1] / 127.5 - 1.0;
+            n[2] = std::sqrt(std::max(0.0, 1.0 - n[0] * n[0] - n[1] * n[1]));
+        };
+        double a[3], b[3];
+        unpack(&normals.Texels[i], a);
+        unpack(&decoded.Texels[i], b);
+        double dot = std::min(1.0, (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) /
+                                       std::sqrt((a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) * (b[0] * b[0] + b[1] * b[1] + b[2] * b[2])));
+        maxAngle = std::max(maxAngle, std::acos(dot) * 180.0 / 3.14159265358979);
+    }
+    COFFEE_CHECK_LE(maxAngle, 3.0);
+}
+
+COFFEE_TEST(TextureCompression, BC7RoundTrip)
+{
+    Image gradient = MakeGradient(64, 64);
+    Image noisy = MakeNoisyGradient(64, 64);
+
+    Image decodedGradient = RoundTrip(gradient, BlockFormat::BC7);
+    Image decodedNoisy = RoundTrip(noisy, BlockFormat::BC7);
+
+    COFFEE_CHECK_LE(RMSE(gradient, decodedGradient, 0, 4), 3.0);
+    COFFEE_CHECK_LE(RMSE(noisy, decodedNoisy, 0, 4), 5.0);
+
+    // The high quality format must not be worse than BC1 on the same colors
+    COFFEE_CHECK_LE(RMSE(noisy, decodedNoisy, 0, 3), RMSE(noisy, RoundTrip(noisy, BlockFormat::BC1), 0, 3));
+}
+
+COFFEE_TEST(TextureCompression, SolidBlocksAreNearlyExact)
+{
+    const uint8_t colors[][4] = {{0, 0, 0, 255}, {255, 255, 255, 255}, {200, 17, 96, 255}, {3, 250, 128, 40}};
+
+    for (const uint8_t* color : colors)
+    {
+        Image solid = MakeImage(4, 4);
+        for (uint32_t i = 0; i < 16; i++)
+            std::memcpy(&solid.Texels[i * 4], color, 4);
+
+        // RGB565 endpoints interpolated in thirds
+        COFFEE_CHECK_LE(MaxError(solid, RoundTrip(solid, BlockFormat::BC1), 0, 3), 4);
+        COFFEE_CHECK_EQ(MaxError(solid, RoundTrip(solid, BlockFormat::BC4), 0, 1), 0);
+        COFFEE_CHECK_EQ(MaxError(solid, RoundTrip(solid, BlockFormat::BC5), 0, 2), 0);
+        COFFEE_CHECK_EQ(MaxError(solid, RoundTrip(solid, BlockFormat::BC3), 3, 1), 0);
+        COFFEE_CHECK_LE(MaxError(solid, RoundTrip(solid, BlockFormat::BC7), 0, 4), 1);
+    }
+}
+
+COFFEE_TEST(TextureCompression, EdgeBlocksRepeatTheBorder)
+{
+    // 13x7 leaves partial blocks on the right and bottom edges
+    Image source = MakeNoisyGradient(13, 7);
+
+    COFFEE_CHECK_EQ(TextureCompression::GetCompressedSize(BlockFormat::BC1, 13, 7), 4u * 2u * 8u);
+    COFFEE_CHECK_EQ(TextureCompression::GetCompressedSize(BlockFormat::BC7, 13, 7), 4u * 2u * 16u);
+
+    // The missing texels must be filled with the last column and row, exactly as a padded 16x8 image
+    Image padded = MakeImage(16, 8);
+    for (uint32_t y = 0; y < 8; y++)
+        for (uint32_t x = 0; x < 16; x++)
+            std::memcpy(padded.At(x, y), source.At(std::min(x, 12u), std::min(y, 6u)), 4);
+
+    for (BlockFormat format : {BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5, BlockFormat::BC7})
+    {
+        size_t size = TextureCompression::GetCompressedSize(format, 16, 8);
+        COFFEE_CHECK_EQ(TextureCompression::GetCompressedSize(format, 13, 7), size);
+
+        std::vector<uint8_t> edgeBlocks(size), paddedBlocks(size);
+        TextureCompression::CompressImage(source.Texels.data(), 13, 7, format, edgeBlocks.data());
+        TextureCompression::CompressImage(padded.Texels.data(), 16, 8, format, paddedBlocks.data());
+        COFFEE_CHECK(edgeBlocks == paddedBlocks);
+    }
+}
+
+// Decodes hand written blocks, so an encoder and a decoder that are wrong in the same way do not pass the round trips
+COFFEE_TEST(TextureCompression, DecodeKnownBlocks)
+{
+    uint8_t texels[64];
+
+    // BC1: red and blue endpoints, color0 > color1 selects the 4-color mode, each row walks through the palette
+    const uint8_t bc1[8] = {0x00, 0xF8, 0x1F, 0x00, 0xE4, 0xE4, 0xE4, 0xE4};
+    TextureCompression::DecompressBlock(BlockFormat::BC1, bc1, texels);
+    // Index 0 and 1 are the endpoints, 2 and 3 the thirds in between
+    const uint8_t bc1Expected[4][3] = {{255, 0, 0}, {0, 0, 255}, {170, 0, 85}, {85, 0, 170}};
+    for (int i = 0; i < 16; i++)
+    {
+        const uint8_t* expected = bc1Expected[i % 4];
+        COFFEE_CHECK_LE(std::abs(texels[i * 4 + 0] - expected[0]), 1);
+        COFFEE_CHECK_EQ(texels[i * 4 + 1], expected[1]);
+        COFFEE_CHECK_LE(std::abs(texels[i * 4 + 2] - expected[2]), 1);
+        COFFEE_CHECK_EQ(texels[i * 4 + 3], 255);
+    }
+
+    // BC4: endpoints 200 and 100, value0 > value1 selects the 8-value mode, index 1 is the second endpoint
+    const uint8_t bc4[8] = {200, 100, 0x49, 0x92, 0x24, 0x49, 0x92, 0x24};
+    TextureCompression::DecompressBlock(BlockFormat::BC4, bc4, texels);
+    for (int i = 0; i < 16; i++)
+        COFFEE_CHECK_EQ(texels[i * 4], 100);
+
+    // BC7 mode 6: endpoint 0 is black, endpoint 1 is white, the anchor uses weight 30 and the others weight 64
+    BlockBits bc7;
+    bc7.Write(1u << 6, 7);
+    for (int c = 0; c < 4; c++)
+    {
+        bc7.Write(0, 7);
+        bc7.Write(127, 7);
+    }
+    bc7.Write(0, 1);
+    bc7.Write(1, 1);
+    bc7.Write(7, 3);
+    for (int i = 1; i < 16; i++)
+        bc7.Write(15, 4);
+    COFFEE_CHECK_EQ(bc7.Position, 128u);
+
+    TextureCompression::DecompressBlock(BlockFormat::BC7, bc7.Bytes, texels);
+    for (int c = 0; c < 4; c++)
+        COFFEE_CHECK_EQ(texels[c], (30 * 255 + 32) >> 6);
+    for (int i = 1; i < 16; i++)
+        for (int c = 0; c < 4; c++)
+            COFFEE_CHECK_EQ(texels[i * 4 + c], 255);
+}
+
+COFFEE_TEST(TextureCompression, MipChainReachesOneTexel)
+{
+    Image gradient = MakeGradient(64, 16);
+    std::vector<std::vector<uint8_t>> mips = TextureCompression::GenerateMipChain(gradient.Texels.data(), 64, 16, TextureUsage::Color, true);
+
+    COFFEE_CHECK_EQ(mips.size(), 7u);
+    for (uint32_t mip = 0; mip < mips.size(); mip++)
+        COFFEE_CHECK_EQ(mips[mip].size(), (size_t)std::max(64u >> mip, 1u) * std::max(16u >> mip, 1u) * 4);
+
+    // Black and white averaged in linear space is brighter than the sRGB midpoint
+    Image checker = MakeImage(2, 2);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint8_t value = (i == 0 || i == 3) ? 255 : 0;
+        std::memset(&checker.Texels[i * 4], value, 3);
+    }
+    std::vector<std::vector<uint8_t>> srgbMips = TextureCompression::GenerateMipChain(checker.Texels.data(), 2, 2, TextureUsage::Color, true);
+    std::vector<std::vector<uint8_t>> linearMips = TextureCompression::GenerateMipChain(checker.Texels.data(), 2, 2, TextureUsage::Data, false);
+    COFFEE_CHECK_NEAR(srgbMips[1][0], 188, 1);
+    COFFEE_CHECK_NEAR(linearMips[1][0], 128, 1);
+}
@@ -0,0 +1,216 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Renderer/TextureStreamingPolicy.h"
+
+#include <utility>
+
+using namespace Coffee;
+
+namespace {
+
+    // Records the requests of the policy, and finishes the loads right away when given the policy
+    class FakeStreamingBackend : public TextureStreamingBackend
+    {
+    public:
+        void LoadMips(StreamingHandle handle, uint32_t firstMip) override
+        {
+            Loads.emplace_back(handle, firstMip);
+            if (Policy)
+                Policy->OnLoadFinished(handle, firstMip);
+        }
+
+        void EvictMips(StreamingHandle handle, uint32_t firstMip) override { Evictions.emplace_back(handle, firstMip); }
+
+        TextureStreamingPolicy* Policy = nullptr;
+        std::vector<std::pair<StreamingHandle, uint32_t>> Loads;
+        std::vector<std::pair<StreamingHandle, uint32_t>> Evictions;
+    };
+
+    // A square texture with one byte per texel
+    std::vector<uint64_t> GetMipBytes(uint32_t size)
+    {
+        std::vector<uint64_t> mipBytes;
+        for (; size > 0; size >>= 1)
+            mipBytes.push_back((uint64_t)size * size);
+        return mipBytes;
+    }
+
+    // The bytes of the mips from 4, always resident for a 1024 texture with the default MinResidentSize of 64
+    constexpr uint64_t s_BaseBytes = 4096 + 1024 + 256 + 64 + 16 + 4 + 1;
+
+} // namespace
+
+COFFEE_TEST(TextureStreamingPolicy, RegisterKeepsTheSmallMips)
+{
+    FakeStreamingBackend backend;
+    TextureStreamingPolicy policy(backend);
+
+    StreamingHandle handle = policy.Register(1024, 1024, GetMipBytes(1024));
+
+    COFFEE_CHECK_EQ(policy.GetResidentMip(handle), 4u);
+    COFFEE_CHECK_EQ(policy.GetUsedBytes(), s_BaseBytes);
+
+    // Textures at or below the minimum size are fully resident
+    StreamingHandle small = policy.Register(64, 64, GetMipBytes(64));
+    COFFEE_CHECK_EQ(policy.GetResidentMip(small), 0u);
+
+    policy.Unregister(handle);
+    policy.Unregister(small);
+    COFFEE_CHECK_EQ(policy.GetUsedBytes(), 0u);
+
+    // Handles are reused
+    COFFEE_CHECK_EQ(policy.Register(1024, 1024, GetMipBytes(1024)), small);
+}
+
+COFFEE_TEST(TextureStreamingPolicy, RequestedMipsAreLoaded)
+{
+    FakeStreamingBackend backend;
+    TextureStreamingPolicy policy(backend);
+    StreamingHandle handle = policy.Register(1024, 1024, GetMipBytes(1024));
+
+    // The finest request of the frame wins
+    policy.Request(handle, 3);
+    policy.Request(handle, 1);
+    policy.Update();
+
+    COFFEE_CHECK_EQ(backend.Loads.size(), 1u);
+    COFFEE_CHECK(backend.Loads[0] == std::make_pair(handle, 1u));
+    COFFEE_CHECK(policy.IsLoading(handle));
+    COFFEE_CHECK_EQ(policy.GetLoadsInFlight(), 1u);
+
+    // The budget is reserved while the load is in flight
+    COFFEE_CHECK_EQ(policy.GetUsedBytes(), s_BaseBytes + 262144 + 65536 + 16384);
+
+    // No second load while the first one is pending
+    policy.Request(handle, 1);
+    policy.Update();
+    COFFEE_CHECK_EQ(backend.Loads.size(), 1u);
+
+    policy.OnLoadFinished(handle, 1);
+    COFFEE_CHECK_EQ(policy.GetResidentMip(handle), 1u);
+    COFFEE_CHECK(!policy.IsLoading(handle));
+    COFFEE_CHECK_EQ(policy.GetLoadsInFlight(), 0u);
+    COFFEE_CHECK_EQ(policy.GetUsedBytes(), s_BaseBytes + 262144 + 65536 + 16384);
+}
+
+COFFEE_TEST(TextureStreamingPolicy, FailedLoadsReturnTheBudget)
+{
+    FakeStreamingBackend backend;
+    TextureStreamingPolicy policy(backend);
+    StreamingHandle handle = policy.Register(1024, 1024, GetMipBytes(1024));
+
+    policy.Request(handle, 0);
+    policy.Update();
+    policy.OnLoadFinished(handle, 4);
+
+    COFFEE_CHECK_EQ(policy.GetResidentMip(handle), 4u);
+    COFFEE_CHECK_EQ(policy.GetUsedBytes(), s_BaseBytes);
+    COFFEE_CHECK_EQ(policy.GetLoadsInFlight(), 0u);
+
+    // Unregistering a texture with a load in flight releases the reservation too
+    policy.Request(handle, 0);
+    policy.Update();
+    policy.Unregister(handle);
+    COFFEE_CHECK_EQ(policy.GetUsedBytes(), 0u);
+    COFFEE_CHECK_EQ(policy.GetLoadsInFlight(), 0u);
+
+    // A late completion of an unregistered texture is ignored
+    policy.OnLoadFinished(handle, 0);
+    COFFEE_CHECK_EQ(policy.GetUsedBytes(), 0u);
+}
+
+COFFEE_TEST(TextureStreamingPolicy, BlurriestTexturesLoadFirst)
+{
+    FakeStreamingBackend backend;
+    TextureStreamingSettings settings;
+    settings.MaxLoadsInFlight = 1;
+    TextureStreamingPolicy policy(backend, settings);
+
+    StreamingHandle nearlySharp = policy.Register(1024, 1024, GetMipBytes(1024));
+    StreamingHandle blurry = policy.Register(1024, 1024, GetMipBytes(1024));
+
+    policy.Request(nearlySharp, 3);
+    policy.Request(blurry, 0);
+    policy.Update();
+
+    COFFEE_CHECK_EQ(backend.Loads.size(), 1u);
+    COFFEE_CHECK(backend.Loads[0] == std::make_pair(blurry, 0u));
+
+    policy.OnLoadFinished(blurry, 0);
+    policy.Request(nearlySharp, 3);
+    policy.Update();
+
+    COFFEE_CHECK_EQ(backend.Loads.size(), 2u);
+    COFFEE_CHECK(backend.Loads[1] == std::make_pair(nearlySharp, 3u));
+}
+
+COFFEE_TEST(TextureStreamingPolicy, LeastRecentlyNeededMipsAreEvicted)
+{
+    FakeStreamingBackend backend;
+    TextureStreamingSettings settings;
+    settings.BudgetBytes = 2 * s_BaseBytes + 65536 + 16384; // Room for mips 2 and 3 of one texture
+    TextureStreamingPolicy policy(backend, settings);
+    backend.Policy = &policy;
+
+    StreamingHandle first = policy.Register(1024, 1024, GetMipBytes(1024));
+    StreamingHandle second = policy.Register(1024, 1024, GetMipBytes(1024));
+
+    policy.Request(first, 2);
+    policy.Update();
+    COFFEE_CHECK_EQ(policy.GetResidentMip(first), 2u);
+
+    // While the first texture stays visible, the second one gets what is left
+    policy.Request(first, 2);
+    policy.Request(second, 2);
+    policy.Update();
+    COFFEE_CHECK_EQ(policy.GetResidentMip(first), 2u);
+    COFFEE_CHECK_EQ(policy.GetResidentMip(second), 4u);
+    COFFEE_CHECK(backend.Evictions.empty());
+
+    // Once it is out of view, its mips make room
+    policy.Request(second, 2);
+    policy.Update();
+    COFFEE_CHECK_EQ(backend.Evictions.size(), 1u);
+    COFFEE_CHECK(backend.Evictions[0] == std::make_pair(first, 4u));
+    COFFEE_CHECK_EQ(policy.GetResidentMip(first), 4u);
+    COFFEE_CHECK_EQ(policy.GetResidentMip(second), 2u);
+    COFFEE_CHECK_LE(policy.GetUsedBytes(), settings.BudgetBytes);
+}
+
+COFFEE_TEST(TextureStreamingPolicy, SettlesForCoarserMipsOverBudget)
+{
+    FakeStreamingBackend backend;
+    TextureStreamingSettings settings;
+    settings.BudgetBytes = s_BaseBytes + 16384 + 100;
+    TextureStreamingPolicy policy(backend, settings);
+    backend.Policy = &policy;
+
+    StreamingHandle handle = policy.Register(1024, 1024, GetMipBytes(1024));
+    policy.Request(handle, 0);
+    policy.Update();
+
+    COFFEE_CHECK_EQ(backend.Loads.size(), 1u);
+    COFFEE_CHECK_EQ(policy.GetResidentMip(handle), 3u);
+    COFFEE_CHECK_LE(policy.GetUsedBytes(), settings.BudgetBytes);
+}
+
+COFFEE_TEST(TextureStreamingPolicy, LoweredBudgetIsGivenBack)
+{
+    FakeStreamingBackend backend;
+    TextureStreamingPolicy policy(backend);
+    backend.Policy = &policy;
+
+    StreamingHandle handle = policy.Register(1024, 1024, GetMipBytes(1024));
+    policy.Request(handle, 0);
+    policy.Update();
+    COFFEE_CHECK_EQ(policy.GetResidentMip(handle), 0u);
+
+    TextureStreamingSettings settings = policy.GetSettings();
+    settings.BudgetBytes = s_BaseBytes + 65536 + 16384;
+    policy.SetSettings(settings);
+
+    // The texture is not visible anymore, only what is over the budget is evicted
+    policy.Update();
+    COFFEE_CHECK_EQ(policy.GetResidentMip(handle), 2u);
+    COFFEE_CHECK_EQ(policy.GetUsedBytes(), settings.BudgetBytes);
+}
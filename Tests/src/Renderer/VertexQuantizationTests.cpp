@@ -0,0 +1,173 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Renderer/Mesh.h"
+#include "CoffeeEngine/Renderer/VertexQuantization.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Coffee;
+
+// The bounds documented on VertexQuantization
+static constexpr double s_MaxNormalError = 0.004; // degrees
+static constexpr double s_MaxTangentError = 0.008; // degrees
+static constexpr double s_MaxBoneWeightError = 1.5 / 255.0;
+
+// Angle between two directions in degrees, from atan2 in double precision so the float rounding of acos(dot) near 1 does not hide the encoding error
+static double AngleDegrees(const glm::vec3& a, const glm::vec3& b)
+{
+    glm::dvec3 da(a), db(b);
+    return glm::degrees(std::atan2(glm::length(glm::cross(da, db)), glm::dot(da, db)));
+}
+
+// Directions spread evenly over the sphere, plus the axes and the octant diagonals where the octahedral folding is the least precise
+static std::vector<glm::vec3> GetTestDirections()
+{
+    std::vector<glm::vec3> directions;
+
+    const uint32_t count = 100000;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float z = 1.0f - 2.0f * (i + 0.5f) / count;
+        float radius = std::sqrt(1.0f - z * z);
+        float phi = i * glm::pi<float>() * (3.0f - std::sqrt(5.0f));
+        directions.push_back(glm::vec3(radius * std::cos(phi), radius * std::sin(phi), z));
+    }
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        glm::vec3 direction(0.0f);
+        direction[axis] = 1.0f;
+        directions.push_back(direction);
+        directions.push_back(-direction);
+    }
+
+    for (int octant = 0; octant < 8; octant++)
+        directions.push_back(glm::normalize(glm::vec3(octant & 1 ? -1.0f : 1.0f, octant & 2 ? -1.0f : 1.0f, octant & 4 ? -1.0f : 1.0f)));
+
+    return directions;
+}
+
+COFFEE_TEST(VertexQuantization, OctahedralNormalError)
+{
+    double maxError = 0.0;
+    for (const glm::vec3& normal : GetTestDirections())
+        maxError = std::max(maxError, AngleDegrees(normal, VertexQuantization::UnpackNormal(VertexQuantization::PackNormal(normal))));
+
+    COFFEE_CHECK_LE(maxError, s_MaxNormalError);
+}
+
+COFFEE_TEST(VertexQuantization, TangentErrorAndSign)
+{
+    double maxError = 0.0;
+    bool signsPreserved = true;
+
+    for (const glm::vec3& tangent : GetTestDirections())
+    {
+        for (float sign : {1.0f, -1.0f})
+        {
+            glm::vec4 decoded = VertexQuantization::UnpackTangent(VertexQuantization::PackTangent(tangent, sign));
+            maxError = std::max(maxError, AngleDegrees(tangent, glm::vec3(decoded)));
+            signsPreserved &= decoded.w == sign;
+        }
+    }
+
+    COFFEE_CHECK_LE(maxError, s_MaxTangentError);
+    COFFEE_CHECK(signsPreserved);
+
+    // Meshes without texture coordinates have zero tangents, the sign must survive anyway
+    COFFEE_CHECK_EQ(VertexQuantization::UnpackTangent(VertexQuantization::PackTangent(glm::vec3(0.0f), -1.0f)).w, -1.0f);
+}
+
+COFFEE_TEST(VertexQuantization, BitangentSignFollowsHandedness)
+{
+    Vertex vertex;
+    vertex.Normals = glm::vec3(0.0f, 0.0f, 1.0f);
+    vertex.Tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+
+    vertex.Bitangent = glm::cross(vertex.Normals, vertex.Tangent);
+    COFFEE_CHECK_EQ(VertexQuantization::GetBitangentSign(vertex), 1.0f);
+
+    vertex.Bitangent = -vertex.Bitangent;
+    COFFEE_CHECK_EQ(VertexQuantization::GetBitangentSign(vertex), -1.0f);
+}
+
+COFFEE_TEST(VertexQuantization, QuantizedPositionError)
+{
+    std::vector<Vertex> vertices;
+    for (int i = 0; i < 10000; i++)
+    {
+        Vertex vertex;
+        // Deterministic spread over an elongated box away from the origin
+        vertex.Position = glm::vec3(100.0f + std::fmod(i * 7.31f, 40.0f), -3.0f + std::fmod(i * 0.137f, 2.5f), std::fmod(i * 1.73f, 9.0f));
+        vertices.push_back(vertex);
+    }
+
+    glm::vec3 offset;
+    float scale;
+    VertexQuantization::GetPositionBounds(vertices, offset, scale);
+    COFFEE_CHECK_NEAR(scale, 40.0f, 0.01f);
+
+    std::vector<QuantizedStaticVertex> encoded = VertexQuantization::EncodeQuantizedStatic(vertices, offset, scale);
+
+    // Half a quantization step of the largest extent, with room for the float rounding of the encode and the decode
+    const double bound = scale / 131070.0 * 1.01 + 1e-4;
+
+    double maxError = 0.0;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        glm::vec3 decoded = VertexQuantization::UnpackPosition(encoded[i].Position, offset, scale);
+        glm::vec3 error = glm::abs(decoded - vertices[i].Position);
+        maxError = std::max({maxError, (double)error.x, (double)error.y, (double)error.z});
+    }
+
+    COFFEE_CHECK_LE(maxError, bound);
+}
+
+COFFEE_TEST(VertexQuantization, TexCoordsKeepHalfPrecision)
+{
+    for (float u = -4.0f; u <= 4.0f; u += 0.0137f)
+    {
+        glm::vec2 texCoords(u, 1.0f - u);
+        glm::vec2 decoded = VertexQuantization::UnpackTexCoords(VertexQuantization::PackTexCoords(texCoords));
+
+        // 11 significant bits, with an absolute floor for the values near zero
+        COFFEE_CHECK_LE(std::abs(decoded.x - texCoords.x), std::abs(texCoords.x) / 2048.0 + 1e-4);
+        COFFEE_CHECK_LE(std::abs(decoded.y - texCoords.y), std::abs(texCoords.y) / 2048.0 + 1e-4);
+    }
+}
+
+COFFEE_TEST(VertexQuantization, BoneWeightsSumToOne)
+{
+    const glm::vec4 weightSets[] = {
+        {1.0f, 0.0f, 0.0f, 0.0f},
+        {0.5f, 0.5f, 0.0f, 0.0f},
+        {0.333f, 0.333f, 0.334f, 0.0f},
+        {0.25f, 0.25f, 0.25f, 0.25f},
+        {0.7f, 0.1f, 0.1f, 0.1f},
+        {0.002f, 0.002f, 0.002f, 0.994f},
+        {2.0f, 1.0f, 1.0f, 0.0f}, // Not normalized
+    };
+
+    for (const glm::vec4& weights : weightSets)
+    {
+        uint8_t ids[4];
+        uint32_t packed = VertexQuantization::PackBones(glm::ivec4(3, 7, 11, 200), weights, ids);
+
+        uint32_t sum = (packed & 0xFF) + ((packed >> 8) & 0xFF) + ((packed >> 16) & 0xFF) + (packed >> 24);
+        COFFEE_CHECK_EQ(sum, 255u);
+
+        glm::vec4 decoded = VertexQuantization::UnpackBoneWeights(packed);
+        glm::vec4 normalized = weights / (weights.x + weights.y + weights.z + weights.w);
+        for (int i = 0; i < 4; i++)
+            COFFEE_CHECK_NEAR(decoded[i], normalized[i], s_MaxBoneWeightError + 1e-6);
+    }
+
+    // Unused influences point to bone 0 with a zero weight
+    uint8_t ids[4];
+    uint32_t packed = VertexQuantization::PackBones(glm::ivec4(5, -1, -1, -1), glm::vec4(1.0f, 0.0f, 0.0f, 0.0f), ids);
+    COFFEE_CHECK_EQ(packed, 255u);
+    COFFEE_CHECK(ids[0] == 5 && ids[1] == 0 && ids[2] == 0 && ids[3] == 0);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <string>
+#include <vector>
+
+namespace Coffee::Test {
+
+    /**
+     * @brief A test registered with COFFEE_TEST.
+     */
+    struct TestCase
+    {
+        const char* Suite;
+        const char* Name;
+        void (*Function)();
+    };
+
+    /**
+     * @brief Gets every registered test, in registration order.
+     * @return The registered tests.
+     */
+    inline std::vector<TestCase>& GetTests()
+    {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    /**
+     * @brief Registers a test at static initialization time.
+     */
+    struct TestRegistrar
+    {
+        TestRegistrar(const char* suite, const char* name, void (*function)())
+        {
+            GetTests().push_back({suite, name, function});
+        }
+    };
+
+    /**
+     * @brief Records a failed check of the running test.
+     * @param file The file of the check.
+     * @param line The line of the check.
+     * @param message The description of the failure.
+     */
+    void ReportFailure(const char* file, int line, const std::string& message);
+
+} // namespace Coffee::Test
+
+#define COFFEE_TEST(suite, name)                                                                                   \
+    static void suite##_##name();                                                                                  \
+    static ::Coffee::Test::TestRegistrar suite##_##name##_Registrar(#suite, #name, &suite##_##name);               \
+    static void suite##_##name()
+
+#define COFFEE_CHECK(expr)                                                                                         \
+    do                                                                                                             \
+    {                                                                                                              \
+        if (!(expr))                                                                                               \
+            ::Coffee::Test::ReportFailure(__FILE__, __LINE__, #expr);                                              \
+    } while (0)
+
+#define COFFEE_CHECK_EQ(a, b)                                                                                      \
+    do                                                                                                             \
+    {                                                                                                              \
+        if (!((a) == (b)))                                                                                         \
+            ::Coffee::Test::ReportFailure(__FILE__, __LINE__, #a " == " #b);                                       \
+    } while (0)
+
+#define COFFEE_CHECK_NEAR(a, b, tolerance)                                                                         \
+    do                                                                                                             \
+    {                                                                                                              \
+        const double coffeeCheckA = (double)(a), coffeeCheckB = (double)(b);                                     \
+        if (!(coffeeCheckA - coffeeCheckB <= (tolerance) && coffeeCheckB - coffeeCheckA <= (tolerance)))          \
+            ::Coffee::Test::ReportFailure(__FILE__, __LINE__,                                                      \
+                fmt::format("{} ~= {} ({} vs {}, tolerance {})", #a, #b, coffeeCheckA, coffeeCheckB, (double)(tolerance))); \
+    } while (0)
+
+#define COFFEE_CHECK_LE(a, b)                                                                                      \
+    do                                                                                                             \
+    {                                                                                                              \
+        const double coffeeCheckA = (double)(a), coffeeCheckB = (double)(b);                                     \
+        if (!(coffeeCheckA <= coffeeCheckB))                                                                       \
+            ::Coffee::Test::ReportFailure(__FILE__, __LINE__, fmt::format("{} <= {} ({} vs {})", #a, #b, coffeeCheckA, coffeeCheckB)); \
+    } while (0)
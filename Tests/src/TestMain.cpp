@@ -0,0 +1,55 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/Core/Log.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace Coffee::Test {
+
+    static int s_Failures = 0; ///< Failed checks of the running test.
+
+    void ReportFailure(const char* file, int line, const std::string& message)
+    {
+        std::fprintf(stderr, "    %s:%d: check failed: %s\n", file, line, message.c_str());
+        s_Failures++;
+    }
+
+} // namespace Coffee::Test
+
+/**
+ * @brief Runs the tests of the suite given as first argument, or every test without arguments.
+ * @return 0 if every test passed, 1 otherwise.
+ */
+int main(int argc, char** argv)
+{
+    using namespace Coffee;
+
+    Log::Init();
+
+    const char* suite = argc > 1 ? argv[1] : nullptr;
+
+    int run = 0, failed = 0;
+    for (const Test::TestCase& test : Test::GetTests())
+    {
+        if (suite && std::strcmp(suite, test.Suite) != 0)
+            continue;
+
+        Test::s_Failures = 0;
+        test.Function();
+        run++;
+
+        std::printf("[%s] %s.%s\n", Test::s_Failures ? "FAILED" : "  OK  ", test.Suite, test.Name);
+        if (Test::s_Failures)
+            failed++;
+    }
+
+    if (run == 0)
+    {
+        std::fprintf(stderr, "No tests found for suite %s\n", suite ? suite : "<all>");
+        return 1;
+    }
+
+    std::printf("%d tests, %d failed\n", run, failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+#include "TestFramework.h"
+
+#include "CoffeeEngine/UI/UIHitGrid.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Coffee;
+
+namespace {
+
+    bool Contains(const std::vector<uint32_t>& ids, uint32_t id)
+    {
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    }
+
+} // namespace
+
+COFFEE_TEST(UIHitGrid, InsertAndQuery)
+{
+    UIHitGrid grid;
+    grid.Reset({256.0f, 256.0f}, 64.0f);
+    grid.Insert(7, {10.0f, 10.0f, 50.0f, 50.0f});
+
+    COFFEE_CHECK((grid.Query({20.0f, 20.0f}) == std::vector<uint32_t>{7}));
+
+    // The grid works by cells, a point of the same cell outside the rect is still a candidate
+    COFFEE_CHECK(Contains(grid.Query({60.0f, 60.0f}), 7));
+
+    COFFEE_CHECK(grid.Query({100.0f, 100.0f}).empty());
+    COFFEE_CHECK(grid.Query({200.0f, 20.0f}).empty());
+}
+
+COFFEE_TEST(UIHitGrid, RectsSpanEveryOverlappedCell)
+{
+    UIHitGrid grid;
+    grid.Reset({256.0f, 256.0f}, 64.0f);
+    grid.Insert(1, {32.0f, 32.0f, 200.0f, 100.0f});
+
+    COFFEE_CHECK(Contains(grid.Query({40.0f, 40.0f}), 1));
+    COFFEE_CHECK(Contains(grid.Query({130.0f, 70.0f}), 1));
+    COFFEE_CHECK(Contains(grid.Query({199.0f, 99.0f}), 1));
+    COFFEE_CHECK(grid.Query({40.0f, 150.0f}).empty());
+    COFFEE_CHECK(grid.Query({100.0f, 200.0f}).empty());
+}
+
+COFFEE_TEST(UIHitGrid, OverlappingRectsKeepInsertionOrder)
+{
+    UIHitGrid grid;
+    grid.Reset({256.0f, 256.0f}, 64.0f);
+    grid.Insert(1, {0.0f, 0.0f, 100.0f, 100.0f});
+    grid.Insert(2, {70.0f, 70.0f, 150.0f, 150.0f});
+    grid.Insert(3, {20.0f, 20.0f, 40.0f, 40.0f});
+
+    // The UI inserts back to front, so the last candidate is the one drawn on top
+    COFFEE_CHECK((grid.Query({30.0f, 30.0f}) == std::vector<uint32_t>{1, 3}));
+    COFFEE_CHECK((grid.Query({80.0f, 80.0f}) == std::vector<uint32_t>{1, 2}));
+    COFFEE_CHECK((grid.Query({140.0f, 140.0f}) == std::vector<uint32_t>{2}));
+}
+
+COFFEE_TEST(UIHitGrid, PointsAndRectsOutsideTheArea)
+{
+    UIHitGrid grid;
+    grid.Reset({256.0f, 128.0f}, 64.0f);
+    grid.Insert(1, {0.0f, 0.0f, 256.0f, 128.0f});
+
+    COFFEE_CHECK(grid.Query({-1.0f, 10.0f}).empty());
+    COFFEE_CHECK(grid.Query({10.0f, -1.0f}).empty());
+    COFFEE_CHECK(grid.Query({257.0f, 10.0f}).empty());
+    COFFEE_CHECK(grid.Query({10.0f, 129.0f}).empty());
+
+    // The far edges belong to the last cells
+    COFFEE_CHECK(Contains(grid.Query({256.0f, 128.0f}), 1));
+
+    // Rects fully outside are dropped, rects partly outside are clamped to the area
+    grid.Insert(2, {300.0f, 10.0f, 400.0f, 50.0f});
+    grid.Insert(3, {-50.0f, -50.0f, 10.0f, 10.0f});
+    grid.Insert(4, {200.0f, 100.0f, 1000.0f, 1000.0f});
+    COFFEE_CHECK(!Contains(grid.Query({250.0f, 20.0f}), 2));
+    COFFEE_CHECK(Contains(grid.Query({5.0f, 5.0f}), 3));
+    COFFEE_CHECK(Contains(grid.Query({250.0f, 120.0f}), 4));
+
+    // Inverted rects are ignored
+    grid.Insert(5, {50.0f, 50.0f, 10.0f, 10.0f});
+    COFFEE_CHECK(!Contains(grid.Query({30.0f, 30.0f}), 5));
+}
+
+COFFEE_TEST(UIHitGrid, ResetRemovesEveryElement)
+{
+    UIHitGrid grid;
+    COFFEE_CHECK(grid.Query({0.0f, 0.0f}).empty());
+
+    grid.Reset({128.0f, 128.0f}, 64.0f);
+    grid.Insert(1, {0.0f, 0.0f, 128.0f, 128.0f});
+    COFFEE_CHECK(Contains(grid.Query({100.0f, 100.0f}), 1));
+
+    // A larger area after a resize, as when the window grows
+    grid.Reset({512.0f, 256.0f}, 64.0f);
+    COFFEE_CHECK(grid.Query({100.0f, 100.0f}).empty());
+    COFFEE_CHECK(grid.Query({500.0f, 250.0f}).empty());
+
+    grid.Insert(2, {400.0f, 200.0f, 510.0f, 250.0f});
+    COFFEE_CHECK((grid.Query({500.0f, 250.0f}) == std::vector<uint32_t>{2}));
+    COFFEE_CHECK(grid.Query({100.0f, 100.0f}).empty());
+}